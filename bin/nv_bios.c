@@ -0,0 +1,162 @@
+#include <ctype.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <unistd.h>
+
+#include <nvif/client.h>
+#include <nvif/device.h>
+#include <nvif/class.h>
+
+#include <subdev/bios.h>
+#include <subdev/bios/bit.h>
+#include <subdev/bios/conn.h>
+#include <subdev/bios/dcb.h>
+#include <subdev/bios/perf.h>
+#include <subdev/bios/rammap.h>
+#include <subdev/bios/timing.h>
+
+#include "util.h"
+
+static void
+print_table(const char *name, u32 data, u8 ver, u8 hdr, u8 cnt, u8 len,
+	    u8 snr, u8 ssz)
+{
+	if (!data) {
+		printf("%-8s: not found\n", name);
+		return;
+	}
+
+	printf("%-8s: %08x ver %02x hdr %02x cnt %02x len %02x snr %02x "
+	       "ssz %02x\n", name, data, ver, hdr, cnt, len, snr, ssz);
+}
+
+static void
+dump(struct nvkm_bios *bios)
+{
+	struct bit_entry bit;
+	u8  ver, hdr, cnt, len, snr = 0, ssz = 0;
+	u32 data;
+	int id;
+
+	printf("size    : %08x\n", bios->size);
+	printf("version : %02x.%02x.%02x.%02x.%02x\n",
+	       bios->version.major, bios->version.chip, bios->version.minor,
+	       bios->version.micro, bios->version.patch);
+	printf("bmp     : %08x\n", bios->bmp_offset);
+	printf("bit     : %08x\n", bios->bit_offset);
+
+	for (id = 0; id < 256; id++) {
+		if (bit_entry(bios, id, &bit))
+			continue;
+		printf("  BIT '%c': ver %02x len %04x offset %04x\n",
+		       isprint(bit.id) ? bit.id : '?', bit.version,
+		       bit.length, bit.offset);
+	}
+
+	data = dcb_table(bios, &ver, &hdr, &cnt, &len);
+	print_table("dcb", data, ver, hdr, cnt, len, 0, 0);
+	data = nvbios_connTe(bios, &ver, &hdr, &cnt, &len);
+	print_table("conn", data, ver, hdr, cnt, len, 0, 0);
+	data = nvbios_perf_table(bios, &ver, &hdr, &cnt, &len, &snr, &ssz);
+	print_table("perf", data, ver, hdr, cnt, len, snr, ssz);
+	data = nvbios_rammapTe(bios, &ver, &hdr, &cnt, &len, &snr, &ssz);
+	print_table("rammap", data, ver, hdr, cnt, len, snr, ssz);
+	data = nvbios_timingTe(bios, &ver, &hdr, &cnt, &len, &snr, &ssz);
+	print_table("timing", data, ver, hdr, cnt, len, snr, ssz);
+}
+
+static u64
+bench_run(struct nvkm_bios *bios, int loops)
+{
+	struct bit_entry bit;
+	u8  ver, hdr, cnt, len, snr, ssz;
+	u64 time = ktime_to_ns(ktime_get());
+	int i;
+
+	for (i = 0; i < loops; i++) {
+		bit_entry(bios, 'P', &bit);
+		bit_entry(bios, 'i', &bit);
+		dcb_table(bios, &ver, &hdr, &cnt, &len);
+		nvbios_connTe(bios, &ver, &hdr, &cnt, &len);
+		nvbios_perf_table(bios, &ver, &hdr, &cnt, &len, &snr, &ssz);
+		nvbios_rammapTe(bios, &ver, &hdr, &cnt, &len, &snr, &ssz);
+		nvbios_timingTe(bios, &ver, &hdr, &cnt, &len, &snr, &ssz);
+	}
+
+	return ktime_to_ns(ktime_get()) - time;
+}
+
+static void
+bench(struct nvkm_bios *bios, int loops)
+{
+	struct nvbios_index *index = bios->index;
+	u64 indexed, parsed;
+
+	indexed = bench_run(bios, loops);
+
+	/* detach the index to time the raw parsers */
+	bios->index = NULL;
+	parsed = bench_run(bios, loops);
+	bios->index = index;
+
+	printf("%d lookups: indexed %llu ns, parsed %llu ns\n",
+	       loops, indexed / loops, parsed / loops);
+}
+
+int
+main(int argc, char **argv)
+{
+	struct nvif_client client;
+	struct nvif_device device;
+	struct nvkm_bios *bios;
+	char *cfg = NULL;
+	int loops = 0;
+	int ret, c;
+
+	while ((c = getopt(argc, argv, "t:"U_GETOPT)) != -1) {
+		switch (c) {
+		case 't':
+			loops = strtol(optarg, NULL, 0);
+			break;
+		default:
+			if (!u_option(c))
+				return 1;
+			break;
+		}
+	}
+
+	/* load the image from a file instead of the board, if requested */
+	if (optind < argc) {
+		int size = (u_cfg ? strlen(u_cfg) : 0) + strlen(argv[optind]) + 9;
+		if (!(cfg = malloc(size)))
+			return -ENOMEM;
+		snprintf(cfg, size, "%s%sNvBios=%s", u_cfg ? u_cfg : "",
+			 u_cfg ? "," : "", argv[optind]);
+		u_cfg = cfg;
+	}
+
+	ret = u_device("lib", argv[0], "error", true, true,
+		       (1ULL << NVKM_SUBDEV_PCI) |
+		       (1ULL << NVKM_SUBDEV_VBIOS),
+		       0x00000000, &client, &device);
+	if (ret)
+		goto done;
+
+	bios = nvxx_bios(&device);
+	if (!bios) {
+		ret = -ENODEV;
+		goto fini;
+	}
+
+	if (loops > 0)
+		bench(bios, loops);
+	else
+		dump(bios);
+
+fini:
+	nvif_device_fini(&device);
+	nvif_client_fini(&client);
+done:
+	free(cfg);
+	return ret;
+}
@@ -0,0 +1,325 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <nvif/bocache.h>
+
+/* Replays a trace of pushbuf submissions on a channel through the cache
+ * of recently submitted buffer lists, and reports how often a list was
+ * found, and how much validation and fence syncing it saved.
+ *
+ * Relocations are handled as the pushbuf ioctl does: fetched up front if
+ * the list needed them last time, otherwise only once validation finds a
+ * buffer isn't where userspace presumed, followed by validating again.
+ * Checks that they're applied whenever a buffer had moved since userspace
+ * last heard, and counts how often they were fetched up front.
+ *
+ * The trace is text, one event per line:
+ *
+ *   s H[w] H[w]...  submit with these handles ("w" if written)
+ *   m H             buffer was moved (evicted, or validated elsewhere)
+ *   f H             buffer was fenced by another channel
+ *   c H             handle was closed, and reused for a new buffer
+ *
+ * With -g, a synthetic trace is written to stdout instead: "-g sets" lists
+ * of about -b buffers each, drawn from a shared pool, with the given
+ * chance (in 1/1000ths per submission) of each kind of disturbance.
+ */
+#define HANDLES 65536
+#define BUFFERS 1024
+
+struct object {
+	u64 cookie;
+	u64 offset;
+	u64 presumed; /* offset, as userspace last heard */
+	u32 place;
+	u32 seq;
+};
+
+static struct object object[HANDLES];
+static u64 cookies;
+
+static void
+object_new(struct object *obj)
+{
+	obj->cookie = ++cookies;
+	obj->offset = (u64)(rand() % 65536) << 12;
+	obj->presumed = obj->offset;
+	obj->place = 1 + rand() % 2;
+	obj->seq = 0;
+}
+
+static int
+generate(int sets, int buffers, int submits, int moves, int fences,
+	 int closes)
+{
+	const int pool = min(sets * buffers, HANDLES - 1);
+	int *list, *nr, i, j;
+
+	if (!(list = calloc(sets * buffers, sizeof(*list))) ||
+	    !(nr = calloc(sets, sizeof(*nr)))) {
+		free(list);
+		return 1;
+	}
+
+	/* Each list's a mix of buffers private to it, and shared ones. */
+	for (i = 0; i < sets; i++) {
+		nr[i] = max(1, buffers / 2 + rand() % (buffers + 1));
+		nr[i] = min(nr[i], buffers);
+		for (j = 0; j < nr[i]; j++) {
+			if (j < nr[i] / 2)
+				list[i * buffers + j] = 1 + rand() % (pool / 4 + 1);
+			else
+				list[i * buffers + j] = 1 + i * buffers + j;
+		}
+	}
+
+	for (i = 0; i < submits; i++) {
+		const int s = rand() % sets;
+		const int h = list[s * buffers + rand() % nr[s]];
+
+		if (rand() % 1000 < moves)
+			printf("m %d\n", h);
+		if (rand() % 1000 < fences)
+			printf("f %d\n", h);
+		if (rand() % 1000 < closes)
+			printf("c %d\n", h);
+
+		printf("s");
+		for (j = 0; j < nr[s]; j++) {
+			const int b = list[s * buffers + j];
+			printf(" %d%s", b, (b % 7) == 0 ? "w" : "");
+		}
+		printf("\n");
+	}
+
+	free(nr);
+	free(list);
+	return 0;
+}
+
+/* Validation, as far as relocations go: checks for buffers that aren't
+ * where presumed, and updates the submission's copy of the offsets.
+ */
+static bool
+validate_relocs(const struct nvif_bocache_key *key, u64 *presumed, u32 nr)
+{
+	int relocs = 0;
+	u32 i;
+
+	for (i = 0; i < nr; i++) {
+		const struct object *obj = &object[key[i].handle];
+		if (presumed[i] != obj->offset) {
+			presumed[i] = obj->offset;
+			relocs++;
+		}
+	}
+
+	return relocs != 0;
+}
+
+static struct {
+	u64 needed;
+	u64 applied;
+	u64 prefetched;
+	u64 dropped;
+} relocs;
+
+static void
+submit_relocs(struct nvif_bocache_set *set,
+	      const struct nvif_bocache_key *key, u32 nr)
+{
+	u64 presumed[BUFFERS];
+	bool fetched, do_reloc = false, moved = false;
+	u32 i;
+
+	for (i = 0; i < nr; i++) {
+		presumed[i] = object[key[i].handle].presumed;
+		moved |= presumed[i] != object[key[i].handle].offset;
+	}
+
+	fetched = set && set->relocs;
+	if (fetched)
+		relocs.prefetched++;
+
+	do_reloc = nvif_bocache_relocs(set, do_reloc,
+				       validate_relocs(key, presumed, nr));
+	if (do_reloc && !fetched) {
+		/* fetch them, and validate again */
+		do_reloc = nvif_bocache_relocs(set, do_reloc,
+					       validate_relocs(key, presumed,
+							       nr));
+	}
+
+	if (moved)
+		relocs.needed++;
+	if (do_reloc) {
+		relocs.applied++;
+		for (i = 0; i < nr; i++)
+			object[key[i].handle].presumed = presumed[i];
+	} else
+	if (moved) {
+		relocs.dropped++;
+	}
+}
+
+int
+main(int argc, char **argv)
+{
+	struct nvif_bocache_key key[BUFFERS];
+	struct nvif_bocache cache;
+	int sets = 0, buffers = 32, submits = 10000;
+	int moves = 10, fences = 20, closes = 2;
+	int max = 8, lines = 0, ret = 0, c;
+	u64 submitted = 0, time = 0;
+	char *line = NULL;
+	size_t size = 0;
+	FILE *file;
+
+	while ((c = getopt(argc, argv, "n:g:b:s:m:f:c:")) != -1) {
+		switch (c) {
+		case 'n':
+			max = strtol(optarg, NULL, 0);
+			break;
+		case 'g':
+			sets = strtol(optarg, NULL, 0);
+			break;
+		case 'b':
+			buffers = min(strtol(optarg, NULL, 0), (long)BUFFERS);
+			break;
+		case 's':
+			submits = strtol(optarg, NULL, 0);
+			break;
+		case 'm':
+			moves = strtol(optarg, NULL, 0);
+			break;
+		case 'f':
+			fences = strtol(optarg, NULL, 0);
+			break;
+		case 'c':
+			closes = strtol(optarg, NULL, 0);
+			break;
+		default:
+			return 1;
+		}
+	}
+
+	srand(0);
+	if (sets > 0)
+		return generate(sets, max(buffers, 1), submits, moves, fences,
+				closes);
+
+	if (optind < argc) {
+		if (!(file = fopen(argv[optind], "r"))) {
+			fprintf(stderr, "failed to open %s\n", argv[optind]);
+			return 1;
+		}
+	} else {
+		file = stdin;
+	}
+
+	nvif_bocache_init(&cache, max);
+
+	while (getline(&line, &size, file) >= 0) {
+		char *tok = strtok(line, " \t\n");
+		struct nvif_bocache_set *set;
+		struct object *obj;
+		u32 nr = 0, h, i;
+		s64 t;
+
+		lines++;
+		if (!tok)
+			continue;
+
+		if (!strcmp(tok, "s")) {
+			while ((tok = strtok(NULL, " \t\n")) && nr < BUFFERS) {
+				h = strtoul(tok, NULL, 0) % HANDLES;
+				if (!object[h].cookie)
+					object_new(&object[h]);
+				key[nr].handle = h;
+				key[nr].read = 0x6;
+				key[nr].write = strchr(tok, 'w') ? 0x6 : 0;
+				key[nr].valid = 0x6;
+				nr++;
+			}
+			if (!nr)
+				continue;
+
+			t = ktime_to_ns(ktime_get());
+			set = nvif_bocache_get(&cache, key, sizeof(*key), nr);
+			for (i = 0; set && i < nr; i++) {
+				obj = &object[key[i].handle];
+				nvif_bocache_account(&cache,
+					nvif_bocache_skip(&set->bo[i],
+							  obj->cookie,
+							  obj->place,
+							  obj->offset,
+							  obj->seq));
+			}
+			time += ktime_to_ns(ktime_get()) - t;
+
+			submit_relocs(set, key, nr);
+
+			/* The submission's fence goes on every buffer. */
+			for (i = 0; set && i < nr; i++) {
+				obj = &object[key[i].handle];
+				obj->seq++;
+				nvif_bocache_done(&set->bo[i], obj->cookie,
+						  obj->place, obj->offset,
+						  obj->seq);
+			}
+			submitted++;
+			continue;
+		}
+
+		if (!(tok = strtok(NULL, " \t\n"))) {
+			fprintf(stderr, "line %d: no handle\n", lines);
+			ret = 1;
+			break;
+		}
+		obj = &object[strtoul(tok, NULL, 0) % HANDLES];
+
+		switch (line[0]) {
+		case 'm':
+			obj->offset += 1ULL << 20;
+			obj->seq++;
+			break;
+		case 'f':
+			obj->seq++;
+			break;
+		case 'c':
+			object_new(obj);
+			break;
+		default:
+			fprintf(stderr, "line %d: unknown event\n", lines);
+			ret = 1;
+			break;
+		}
+
+		if (ret)
+			break;
+	}
+
+	printf("%lld submissions, %lld hits, %lld misses (%d sets)\n",
+	       submitted, cache.hits, cache.misses, max);
+	printf("validate: %lld done, %lld skipped\n",
+	       cache.validated, cache.skipped_validate);
+	printf("sync    : %lld done, %lld skipped\n",
+	       cache.synced, cache.skipped_sync);
+	printf("relocs  : %lld needed, %lld applied, %lld fetched up front\n",
+	       relocs.needed, relocs.applied, relocs.prefetched);
+	printf("lookup  : %lld ns/submission\n",
+	       submitted ? time / submitted : 0);
+
+	if (relocs.dropped) {
+		fprintf(stderr, "%lld submissions' relocations not applied\n",
+			relocs.dropped);
+		ret = 1;
+	}
+
+	nvif_bocache_fini(&cache);
+	free(line);
+	if (file != stdin)
+		fclose(file);
+	return ret;
+}
@@ -0,0 +1,112 @@
+#include <stdlib.h>
+#include <limits.h>
+#include <unistd.h>
+
+#include <nvif/client.h>
+#include <nvif/device.h>
+#include <nvif/class.h>
+
+#include <core/comptag.h>
+
+#include "util.h"
+
+/* Exercises the comptag allocator against a fake LTC, which only counts
+ * the clears it's asked to do, with a random alloc/free workload.
+ */
+static u64 clr_calls;
+static u64 clr_tags;
+static u32 clr_max;
+
+static void
+fake_ltc_clear(struct nvkm_device *device, u32 first, u32 count)
+{
+	if (WARN_ON(first + count > clr_max))
+		return;
+	clr_calls++;
+	clr_tags += count;
+}
+
+static void
+print_stats(struct nvkm_comptag *ct)
+{
+	struct nvkm_comptag_stats stats;
+
+	nvkm_comptag_stats(ct, &stats);
+	printf("tags    : %d total, %d used, %d dirty, %d cached, %d free\n",
+	       stats.total, stats.used, stats.dirty, stats.cached, stats.free);
+	printf("free    : %d extents, largest %d\n",
+	       stats.free_nodes, stats.free_max);
+	printf("allocs  : %llu, %llu from cache\n", stats.allocs, stats.hits);
+	printf("clears  : %llu in %llu flushes, %llu tags cleared\n",
+	       stats.clears, stats.flushes, clr_tags);
+}
+
+int
+main(int argc, char **argv)
+{
+	struct nvkm_comptag ct = {};
+	struct nvkm_comptag_stats stats;
+	struct nvkm_mm_node **node;
+	u64 calls;
+	int tags = 8192, slots = 512, loops = 100000;
+	int ret, c, i;
+
+	while ((c = getopt(argc, argv, "t:s:n:")) != -1) {
+		switch (c) {
+		case 't':
+			tags = strtol(optarg, NULL, 0);
+			break;
+		case 's':
+			slots = strtol(optarg, NULL, 0);
+			break;
+		case 'n':
+			loops = strtol(optarg, NULL, 0);
+			break;
+		default:
+			return 1;
+		}
+	}
+
+	if (!(node = calloc(slots, sizeof(*node))))
+		return -ENOMEM;
+
+	clr_max = tags;
+	ret = nvkm_comptag_init(&ct, NULL, tags, fake_ltc_clear);
+	if (ret)
+		goto done;
+
+	srand(0);
+	for (i = 0; i < loops; i++) {
+		int slot = rand() % slots;
+		if (node[slot])
+			nvkm_comptag_put(&ct, &node[slot]);
+		else
+			nvkm_comptag_get(&ct, 1 + (rand() % 32), &node[slot]);
+	}
+
+	print_stats(&ct);
+
+	/* As on resume, everything that's free needs clearing before use. */
+	nvkm_comptag_invalidate(&ct);
+	nvkm_comptag_stats(&ct, &stats);
+	if (stats.free || stats.cached ||
+	    stats.dirty != stats.total - stats.used) {
+		fprintf(stderr, "free tags left clean after invalidation\n");
+		ret = -EINVAL;
+	}
+
+	calls = clr_calls;
+	for (i = 0; i < slots && node[i]; i++);
+	if (i < slots && !nvkm_comptag_get(&ct, 1, &node[i]) &&
+	    clr_calls == calls) {
+		fprintf(stderr, "tags allocated without being cleared\n");
+		ret = -EINVAL;
+	}
+
+	for (i = 0; i < slots; i++)
+		nvkm_comptag_put(&ct, &node[i]);
+	nvkm_comptag_fini(&ct);
+done:
+	free(node);
+	return ret;
+}
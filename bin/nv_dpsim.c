@@ -0,0 +1,301 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <core/device.h>
+#include <subdev/i2c/aux.h>
+#include <engine/disp/conn.h>
+#include <engine/disp/dp.h>
+#include <engine/disp/ior.h>
+
+/* Runs DisplayPort link training against a simulated sink, which models
+ * the DPCD registers training goes through: the link configuration the
+ * source sets, and the lock status and drive level adjustments the sink
+ * reports back.  Each lane needs some voltage swing to recover the clock,
+ * and some pre-emphasis to equalise, and the cable can't carry rates over
+ * a limit, whatever the sink claims to support.
+ *
+ * Trains from scratch, retrains the same sink, then retrains once the
+ * cable's got worse, with a different sink plugged in, and with the first
+ * needing more bandwidth than it last trained at, reporting how many AUX
+ * transactions and how much time each took.  Sinks are plugged in through
+ * the HPD handler, and one that last trained below its best rate has to
+ * search again from the top.
+ */
+static struct {
+	u8 dpcd[0x700];
+	u8 max_bw;
+	u8 need_vs[4];
+	u8 need_pe[4];
+	bool trained;
+
+	u8 first_bw;
+	u64 xfers;
+} sink;
+
+static void
+sink_status(void)
+{
+	const u8 nr = sink.dpcd[DPCD_LC01] & DPCD_LC01_LANE_COUNT_SET;
+	const u8 tp = sink.dpcd[DPCD_LC02] & DPCD_LC02_TRAINING_PATTERN_SET;
+	bool align = true;
+	int i;
+
+	memset(&sink.dpcd[DPCD_LS02], 0x00, 6);
+	for (i = 0; i < nr; i++) {
+		const u8 conf = sink.dpcd[DPCD_LC03(i)];
+		u8 vs = conf & DPCD_LC03_VOLTAGE_SWING_SET;
+		u8 pe = (conf & DPCD_LC03_PRE_EMPHASIS_SET) >> 3;
+		const bool cr = sink.dpcd[DPCD_LC00_LINK_BW_SET] <= sink.max_bw &&
+				vs >= sink.need_vs[i];
+		const bool eq = cr && pe >= sink.need_pe[i] &&
+				(tp >= 2 || (tp == 0 && sink.trained));
+		u8 lane = 0;
+
+		if (cr)
+			lane |= DPCD_LS02_LANE0_CR_DONE;
+		if (eq)
+			lane |= DPCD_LS02_LANE0_CHANNEL_EQ_DONE |
+				DPCD_LS02_LANE0_SYMBOL_LOCKED;
+		else
+			align = false;
+		sink.dpcd[DPCD_LS02 + (i >> 1)] |= lane << ((i & 1) * 4);
+
+		/* Ask for more swing until the clock's recovered, and then
+		 * more pre-emphasis until the lane's equalised.
+		 */
+		if (!cr)
+			vs = min(vs + 1, 3);
+		else
+		if (!eq && tp)
+			pe = min(pe + 1, 3 - vs);
+		sink.dpcd[DPCD_LS06 + (i >> 1)] |= ((pe << 2) | vs) << ((i & 1) * 4);
+	}
+
+	if (nr && align) {
+		sink.dpcd[DPCD_LS04] |= DPCD_LS04_INTERLANE_ALIGN_DONE;
+		if (tp >= 2)
+			sink.trained = true;
+	}
+}
+
+static int
+fake_xfer(struct nvkm_i2c_aux *aux, bool retry, u8 type, u32 addr,
+	  u8 *data, u8 *size)
+{
+	int i;
+
+	sink.xfers++;
+	if (!(type & 8) || addr + *size > sizeof(sink.dpcd))
+		return -EIO;
+
+	if (type & 1) {
+		sink_status();
+		memcpy(data, &sink.dpcd[addr], *size);
+		return 0;
+	}
+
+	for (i = 0; i < *size; i++) {
+		switch (addr + i) {
+		case DPCD_LC00_LINK_BW_SET:
+			if (!sink.first_bw)
+				sink.first_bw = data[i];
+			/* fall-through */
+		case DPCD_LC01:
+			sink.trained = false;
+			break;
+		case DPCD_LC02:
+			if ((data[i] & DPCD_LC02_TRAINING_PATTERN_SET) == 1)
+				sink.trained = false;
+			break;
+		default:
+			break;
+		}
+		sink.dpcd[addr + i] = data[i];
+	}
+	return 0;
+}
+
+static const struct nvkm_i2c_aux_func
+fake_aux = {
+	.xfer = fake_xfer,
+};
+
+static const struct nvkm_i2c_pad_func
+fake_pad = {
+};
+
+static int
+fake_links(struct nvkm_ior *ior, struct nvkm_i2c_aux *aux)
+{
+	return 0;
+}
+
+static void
+fake_power(struct nvkm_ior *ior, int nr)
+{
+}
+
+static void
+fake_pattern(struct nvkm_ior *ior, int pattern)
+{
+}
+
+static const struct nvkm_ior_func
+fake_ior = {
+	.dp = {
+		.links = fake_links,
+		.power = fake_power,
+		.pattern = fake_pattern,
+	},
+};
+
+static void
+sink_plug(const char *id, u8 max_bw, u8 vs, u8 pe)
+{
+	int i;
+
+	memset(&sink, 0x00, sizeof(sink));
+	sink.dpcd[DPCD_RC00_DPCD_REV] = 0x12;
+	sink.dpcd[DPCD_RC01_MAX_LINK_RATE] = 0x14;
+	sink.dpcd[DPCD_RC02] = DPCD_RC02_ENHANCED_FRAME_CAP |
+			       DPCD_RC02_TPS3_SUPPORTED | 4;
+	sink.dpcd[DPCD_RC03] = DPCD_RC03_MAX_DOWNSPREAD;
+	sink.dpcd[DPCD_SC00] = DPCD_SC00_SET_POWER_D0;
+	memcpy(&sink.dpcd[DPCD_SD00_IEEE_OUI], "\x00\x04\x4b", 3);
+	strncpy((char *)&sink.dpcd[DPCD_SD03_DEVICE_ID], id, 6);
+	sink.max_bw = max_bw;
+	for (i = 0; i < 4; i++) {
+		sink.need_vs[i] = min(vs + (i & 1), 3);
+		sink.need_pe[i] = min(pe, 3 - sink.need_vs[i]);
+	}
+}
+
+static void
+sink_hpd(struct nvkm_dp *dp, const char *id, u8 max_bw, u8 vs, u8 pe)
+{
+	sink_plug(id, max_bw, vs, pe);
+	nvkm_dp_hpd_send(dp, NVKM_I2C_PLUG);
+}
+
+static void
+sink_cable(u8 max_bw, u8 vs, u8 pe)
+{
+	const u64 xfers = sink.xfers;
+	char id[6];
+
+	memcpy(id, &sink.dpcd[DPCD_SD03_DEVICE_ID], sizeof(id));
+	sink_plug(id, max_bw, vs, pe);
+	sink.xfers = xfers;
+}
+
+static int
+train(struct nvkm_dp *dp, const char *name, u32 dataKBps)
+{
+	struct nvkm_ior *ior = dp->outp.ior;
+	const u64 xfers = sink.xfers;
+	s64 time;
+	int ret;
+
+	sink.first_bw = 0;
+	time = ktime_to_ns(ktime_get());
+	ret = nvkm_dp_train(dp, dataKBps);
+	time = ktime_to_ns(ktime_get()) - time;
+
+	printf("%-10s: %d x %4d MB/s, %4lld aux xfers, %6lld us, levels "
+	       "%02x%02x\n", name, ior->dp.nr, ior->dp.bw * 27,
+	       sink.xfers - xfers, time / 1000, sink.dpcd[DPCD_LS06],
+	       sink.dpcd[DPCD_LS07]);
+	if (ret < 0 || !sink.trained) {
+		fprintf(stderr, "%s: link not trained, %d\n", name, ret);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+	struct device dev = { .name = "fake" };
+	struct nvkm_bios bios = {};
+	struct nvkm_device device = { .dev = &dev, .cfgopt = "",
+				      .chipset = 0xe0, .bios = &bios };
+	struct nvkm_i2c i2c = { .subdev.device = &device };
+	struct nvkm_disp disp = { .engine.subdev.device = &device };
+	struct nvkm_i2c_pad pad = { .func = &fake_pad, .i2c = &i2c,
+				    .mode = NVKM_I2C_PAD_AUX };
+	struct nvkm_i2c_aux aux = { .func = &fake_aux, .pad = &pad,
+				    .enabled = 1 };
+	struct nvkm_ior ior = { .func = &fake_ior, .disp = &disp,
+				.type = SOR, .asy.link = 1 };
+	struct nvkm_conn conn = { .disp = &disp };
+	struct nvkm_dp *dp;
+	int c;
+
+	while ((c = getopt(argc, argv, "v")) != -1) {
+		switch (c) {
+		case 'v':
+			disp.engine.subdev.debug = NV_DBG_TRACE;
+			break;
+		default:
+			return 1;
+		}
+	}
+
+	if (!(dp = calloc(1, sizeof(*dp))))
+		return 1;
+	mutex_init(&pad.mutex);
+	mutex_init(&aux.mutex);
+	dp->outp.disp = &disp;
+	dp->outp.conn = &conn;
+	dp->outp.ior = &ior;
+	dp->outp.info.dpconf.link_nr = 4;
+	dp->outp.info.dpconf.link_bw = 0x14;
+	dp->aux = &aux;
+	mutex_init(&dp->mutex);
+
+	/* Advertises HBR2, but the cable only manages HBR. */
+	sink_hpd(dp, "SIMDP1", 0x0a, 2, 1);
+	if (train(dp, "cold", 270000) ||
+	    train(dp, "retrain", 270000))
+		goto fail;
+
+	/* Cached levels aren't enough anymore, falls back to a search. */
+	sink_cable(0x06, 3, 0);
+	if (train(dp, "degraded", 270000) ||
+	    train(dp, "retrain", 270000))
+		goto fail;
+
+	/* Another sink, and then the first one again. */
+	sink_hpd(dp, "SIMDP2", 0x14, 1, 1);
+	if (train(dp, "other", 270000) ||
+	    train(dp, "retrain", 270000))
+		goto fail;
+
+	/* Last trained at RBR, which is below what it and the source can do,
+	 * so the cached configuration's dropped and it starts back at HBR2.
+	 */
+	sink_hpd(dp, "SIMDP1", 0x06, 3, 0);
+	if (train(dp, "replug", 270000))
+		goto fail;
+	if (sink.first_bw != dp->outp.info.dpconf.link_bw) {
+		fprintf(stderr, "replug: retrained from cache at %d MB/s\n",
+			sink.first_bw * 27);
+		goto fail;
+	}
+
+	/* Needs more bandwidth than the cached configuration has, which a
+	 * better cable can provide.
+	 */
+	sink_cable(0x0a, 2, 1);
+	if (train(dp, "more bw", 1080000))
+		goto fail;
+
+	free(dp);
+	return 0;
+
+fail:
+	free(dp);
+	return 1;
+}
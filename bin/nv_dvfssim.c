@@ -0,0 +1,368 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <core/device.h>
+#include <core/event.h>
+#include <subdev/clk/priv.h>
+#include <subdev/pmu/priv.h>
+
+/* Runs the PMU load governor, nvkm_pmu_dvfs_target(), over synthetic load
+ * traces, against a simulated board with three memory pstates of four core
+ * cstates each, reclocked through nvkm_clk_alevel() as the governor does.
+ *
+ * Each 100ms sample, the trace asks for some amount of work; whatever the
+ * current clocks can't get through is carried over to the next.  Reports,
+ * per trace and tuning, energy relative to sitting at the highest clocks,
+ * the work left waiting on average (in samples' worth at full clocks), and
+ * how often memory (pstate) and core (cstate) clocks were changed.
+ *
+ * Also checks that clocking up is never held off, that clocking down
+ * waits out the hysteresis and hold time, and that replaying a trace gives
+ * the same result.
+ */
+#define SAMPLE 100000000ULL
+#define TOTAL  1000000
+
+static const struct { u32 mem, core[4]; }
+board[] = {
+	{  405, {  300,  405,  540,  640 } },
+	{  810, {  540,  640,  800,  900 } },
+	{ 1620, {  800,  900, 1000, 1100 } },
+};
+
+static struct nvkm_pstate pstates[ARRAY_SIZE(board)];
+static struct nvkm_cstate cstates[ARRAY_SIZE(board)][4];
+
+static struct {
+	struct nvkm_cstate *next;
+	struct nvkm_cstate *cstate;
+	int pstate;
+	u64 pstates;
+	u64 cstates;
+} sim = { .pstate = -1 };
+
+static int
+fake_read(struct nvkm_clk *clk, enum nv_clk_src src)
+{
+	return 0;
+}
+
+static int
+fake_calc(struct nvkm_clk *clk, struct nvkm_cstate *cstate)
+{
+	sim.next = cstate;
+	return 0;
+}
+
+static int
+fake_prog(struct nvkm_clk *clk)
+{
+	if (sim.pstate != clk->pstate) {
+		sim.pstate = clk->pstate;
+		sim.pstates++;
+	} else {
+		sim.cstates++;
+	}
+	sim.cstate = sim.next;
+	return 0;
+}
+
+static void
+fake_tidy(struct nvkm_clk *clk)
+{
+}
+
+static struct nvkm_clk_func
+fake_clk = {
+	.read = fake_read,
+	.calc = fake_calc,
+	.prog = fake_prog,
+	.tidy = fake_tidy,
+	.pstates = pstates,
+	.nr_pstates = ARRAY_SIZE(pstates),
+	.domains = {
+		{ nv_clk_src_crystal, 0xff },
+		{ nv_clk_src_gpc, 0x00, NVKM_CLK_DOM_FLAG_CORE, "core", 1000 },
+		{ nv_clk_src_mem, 0xff, 0, "memory", 1000 },
+		{ nv_clk_src_max }
+	},
+};
+
+static int
+fake_event_ctor(struct nvkm_object *object, void *data, u32 size,
+		struct nvkm_notify *notify)
+{
+	notify->size  = 0;
+	notify->types = 1;
+	notify->index = 0;
+	return 0;
+}
+
+static const struct nvkm_event_func
+fake_event = {
+	.ctor = fake_event_ctor,
+};
+
+/* How much work the clocks get through in a sample, relative to the
+ * highest, and what that costs: leakage, memory, and a core whose voltage
+ * goes up with its clock, mostly when busy.
+ */
+static double
+sim_capacity(struct nvkm_cstate *cstate)
+{
+	const double core = cstate->domain[nv_clk_src_gpc] / 1100000.0;
+	const double mem = cstate->domain[nv_clk_src_mem] / 1620000.0;
+	return core * (0.75 + 0.25 * mem);
+}
+
+static double
+sim_power(struct nvkm_cstate *cstate, double util)
+{
+	const double core = cstate->domain[nv_clk_src_gpc] / 1100000.0;
+	const double mem = cstate->domain[nv_clk_src_mem] / 1620000.0;
+	return 10 + 20 * mem + 70 * core * core * core * (0.2 + 0.8 * util);
+}
+
+struct trace {
+	const char *name;
+	int samples;
+	double (*demand)(int sample);
+};
+
+static double
+trace_idle(int t)
+{
+	return 0.02;
+}
+
+static double
+trace_video(int t)
+{
+	return 0.25 + ((t * 7919) % 11) / 100.0;
+}
+
+static double
+trace_bursty(int t)
+{
+	return (t % 20) < 5 ? 0.9 : 0.05;
+}
+
+static double
+trace_ramp(int t)
+{
+	return t * 1.2 / 600;
+}
+
+static double
+trace_saturated(int t)
+{
+	return 1.5;
+}
+
+static const struct trace
+traces[] = {
+	{ "idle",      600, trace_idle },
+	{ "video",     600, trace_video },
+	{ "bursty",    600, trace_bursty },
+	{ "ramp",      600, trace_ramp },
+	{ "saturated", 600, trace_saturated },
+};
+
+/* gk20a's tuning: no hysteresis, and a change every sample allowed. */
+static const struct nvkm_pmu_dvfs_data
+gk20a_dvfs = {
+	.period = 100000000,
+	.p_load_target = 70,
+	.p_load_max = 90,
+	.down_samples = 1,
+	.p_smooth = 1,
+};
+
+/* Waits for the reclock to finish, not just to have been picked up. */
+static void
+alevel(struct nvkm_clk *clk, int level)
+{
+	nvkm_clk_alevel(clk, level, false);
+	flush_work(&clk->work);
+}
+
+struct result {
+	double energy;
+	double backlog;
+	u64 pstates;
+	u64 cstates;
+};
+
+/* With no tuning, sits at the highest clocks, as without a governor. */
+static void
+run(struct nvkm_clk *clk, const struct nvkm_pmu_dvfs_data *data,
+    const struct trace *trace, struct result *res)
+{
+	struct nvkm_pmu_dvfs dvfs = { .data = data };
+	double backlog = 0;
+	int t;
+
+	alevel(clk, clk->alevel_nr - 1);
+	sim.pstates = sim.cstates = 0;
+	memset(res, 0x00, sizeof(*res));
+
+	for (t = 0; t < trace->samples; t++) {
+		const double capacity = sim_capacity(sim.cstate);
+		const double work = backlog + trace->demand(t);
+		const double done = min(work, capacity);
+		const double util = done / capacity;
+		int level, next;
+
+		backlog = work - done;
+		res->backlog += backlog;
+		res->energy += sim_power(sim.cstate, util);
+
+		if (!data)
+			continue;
+
+		level = nvkm_clk_alevel_get(clk);
+		next = nvkm_pmu_dvfs_target(data, &dvfs, level, clk->alevel_nr,
+					    util * TOTAL, TOTAL, t * SAMPLE);
+		if (next != level)
+			alevel(clk, next);
+	}
+
+	res->backlog /= trace->samples;
+	res->pstates = sim.pstates;
+	res->cstates = sim.cstates;
+}
+
+/* Clock-ups straight away, clock-downs only after the hysteresis band's
+ * been stayed below for long enough, and the last change has been held.
+ */
+static int
+check_hold(const struct nvkm_pmu_dvfs_data *data)
+{
+	struct nvkm_pmu_dvfs dvfs = { .data = data };
+	u64 time = 10 * SAMPLE, changed;
+	int level = 5, next, i;
+
+	/* just changed level, then saturated */
+	dvfs.changes = 1;
+	dvfs.changed = time;
+	dvfs.avg_load = data->p_load_max;
+	next = nvkm_pmu_dvfs_target(data, &dvfs, level, 12, TOTAL, TOTAL, time);
+	if (next <= level) {
+		fprintf(stderr, "clock up held off: %d -> %d\n", level, next);
+		return -EINVAL;
+	}
+
+	/* idle straight after, held until enough samples, and hold time */
+	changed = dvfs.changed;
+	level = next;
+	for (i = 1; ; i++) {
+		time += SAMPLE;
+		next = nvkm_pmu_dvfs_target(data, &dvfs, level, 12, 0, TOTAL,
+					    time);
+		if (next != level)
+			break;
+		if (i > 100) {
+			fprintf(stderr, "never clocked down\n");
+			return -EINVAL;
+		}
+	}
+
+	if (next > level || i < data->down_samples ||
+	    time - changed < data->hold) {
+		fprintf(stderr, "clocked down %d -> %d after %d samples\n",
+			level, next, i);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+	static const struct {
+		const char *name;
+		const struct nvkm_pmu_dvfs_data *data;
+	} tunings[] = {
+		{ "fixed", NULL },
+		{ "gk20a", &gk20a_dvfs },
+		{ "gt215", &gt215_pmu_dvfs },
+	};
+	struct device dev = { .name = "fake" };
+	struct nvkm_device device = { .dev = &dev,
+				      .cfgopt = "NvClkMode=auto" };
+	struct nvkm_subdev *subdev;
+	struct nvkm_clk *clk = NULL;
+	struct result fixed, res, again;
+	int ret, i, j;
+
+	for (i = 0; i < ARRAY_SIZE(board); i++) {
+		INIT_LIST_HEAD(&pstates[i].list);
+		pstates[i].pstate = i;
+		pstates[i].base.domain[nv_clk_src_mem] = board[i].mem * 1000;
+		pstates[i].base.domain[nv_clk_src_gpc] = board[i].core[3] * 1000;
+		for (j = 0; j < ARRAY_SIZE(cstates[i]); j++) {
+			cstates[i][j] = pstates[i].base;
+			cstates[i][j].id = j;
+			cstates[i][j].domain[nv_clk_src_gpc] =
+				board[i].core[j] * 1000;
+			list_add_tail(&cstates[i][j].head, &pstates[i].list);
+		}
+	}
+
+	ret = nvkm_event_init(&fake_event, 1, 1, &device.event);
+	if (ret)
+		return 1;
+
+	ret = nvkm_clk_new_(&fake_clk, &device, NVKM_SUBDEV_CLK, true, &clk);
+	if (ret)
+		goto done;
+
+	clk->subdev.debug = 0;
+	if ((ret = nvkm_subdev_init(&clk->subdev)))
+		goto done;
+
+	for (i = 0; i < clk->alevel_nr; i++) {
+		alevel(clk, i);
+		if (nvkm_clk_alevel_get(clk) != i || !sim.cstate ||
+		    sim.cstate != &cstates[i / 4][i % 4]) {
+			fprintf(stderr, "level %d not programmed\n", i);
+			ret = -EINVAL;
+			goto done;
+		}
+	}
+
+	for (i = 1; i < ARRAY_SIZE(tunings); i++) {
+		if ((ret = check_hold(tunings[i].data)))
+			goto done;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(traces); i++) {
+		run(clk, NULL, &traces[i], &fixed);
+		for (j = 0; j < ARRAY_SIZE(tunings); j++) {
+			run(clk, tunings[j].data, &traces[i], &res);
+			run(clk, tunings[j].data, &traces[i], &again);
+			if (memcmp(&res, &again, sizeof(res))) {
+				fprintf(stderr, "%s/%s: replay differs\n",
+					traces[i].name, tunings[j].name);
+				ret = -EINVAL;
+			}
+
+			printf("%-9s %-5s: %5.1f%% energy, %5.2f backlog, "
+			       "%3lld pstate %3lld cstate changes\n",
+			       traces[i].name, tunings[j].name,
+			       res.energy * 100 / fixed.energy, res.backlog,
+			       res.pstates, res.cstates);
+		}
+	}
+
+	nvkm_subdev_fini(&clk->subdev, false);
+done:
+	if (clk) {
+		subdev = &clk->subdev;
+		nvkm_subdev_del(&subdev);
+	}
+	nvkm_event_fini(&device.event);
+	return ret ? 1 : 0;
+}
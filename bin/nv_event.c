@@ -0,0 +1,106 @@
+#include <stdlib.h>
+#include <limits.h>
+#include <unistd.h>
+
+#include <nvif/client.h>
+#include <nvif/device.h>
+#include <nvif/class.h>
+
+#include <core/event.h>
+#include <core/notify.h>
+
+#include "util.h"
+
+/* Measures the cost of nvkm_event_send() against an event with a varying
+ * number of registered notifies, spread across its indices, of which only
+ * those on the index being signalled are armed.
+ */
+#define INDEX_NR 128
+
+static int
+bench_ctor(struct nvkm_object *object, void *data, u32 size,
+	   struct nvkm_notify *notify)
+{
+	notify->index = *(int *)data;
+	notify->types = 1;
+	notify->size  = 0;
+	return 0;
+}
+
+static const struct nvkm_event_func
+bench_event = {
+	.ctor = bench_ctor,
+};
+
+static int
+bench_func(struct nvkm_notify *notify)
+{
+	return NVKM_NOTIFY_KEEP;
+}
+
+static int
+bench(int nr, int loops)
+{
+	struct nvkm_notify *notify;
+	struct nvkm_event event;
+	s64 time;
+	int ret, i;
+
+	if (!(notify = calloc(nr, sizeof(*notify))))
+		return -ENOMEM;
+
+	ret = nvkm_event_init(&bench_event, 1, INDEX_NR, &event);
+	if (ret)
+		goto done;
+
+	for (i = 0; i < nr; i++) {
+		int index = i % INDEX_NR;
+		ret = nvkm_notify_init(NULL, &event, bench_func, false,
+				       &index, sizeof(index), 0, &notify[i]);
+		if (ret)
+			goto fini;
+		if (index == 0)
+			nvkm_notify_get(&notify[i]);
+	}
+
+	time = ktime_to_ns(ktime_get());
+	for (i = 0; i < loops; i++)
+		nvkm_event_send(&event, 1, 0, NULL, 0);
+	time = ktime_to_ns(ktime_get()) - time;
+
+	printf("%5d notifies: %lld ns/send\n", nr, time / loops);
+
+fini:
+	for (i = 0; i < nr; i++)
+		nvkm_notify_fini(&notify[i]);
+	nvkm_event_fini(&event);
+done:
+	free(notify);
+	return ret;
+}
+
+int
+main(int argc, char **argv)
+{
+	static const int nrs[] = { 1, 100, 1000 };
+	int loops = 100000;
+	int ret, c, i;
+
+	while ((c = getopt(argc, argv, "n:")) != -1) {
+		switch (c) {
+		case 'n':
+			loops = strtol(optarg, NULL, 0);
+			break;
+		default:
+			return 1;
+		}
+	}
+
+	for (i = 0; i < ARRAY_SIZE(nrs); i++) {
+		ret = bench(nrs[i], loops);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
@@ -0,0 +1,135 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <nvif/extent.h>
+
+/* Builds synthetic source page (and destination VRAM page) arrays, with
+ * the given chance of each page breaking contiguity or not migrating,
+ * and plans them into extents the way device memory migration does,
+ * checking the plan is exact and maximal.
+ */
+static int
+check(const char *name, const u64 *src, const u64 *dst, u32 nr, u32 count_max,
+      struct nvif_extent *extent, int loops)
+{
+	u32 covered = 0, expect = 0, i, j;
+	int ret;
+
+	ret = nvif_extent_plan(src, dst, nr, 4096, count_max, extent, nr);
+	if (ret < 0)
+		return ret;
+
+	for (j = 0; j < ret; j++) {
+		const struct nvif_extent *e = &extent[j];
+		u32 end = e->first + e->count;
+
+		if (!e->count || e->count > count_max || end > nr ||
+		    (j && e->first < extent[j - 1].first + extent[j - 1].count))
+			goto bad;
+
+		for (i = e->first; i < end; i++) {
+			if (src[i] == NVIF_EXTENT_SKIP ||
+			    (i > e->first && (src[i] != src[i - 1] + 4096 ||
+			     (dst && dst[i] != dst[i - 1] + 4096))))
+				goto bad;
+		}
+
+		/* The next page must not have been able to join it. */
+		if (end < nr && e->count < count_max &&
+		    src[end] != NVIF_EXTENT_SKIP && src[end] == src[end - 1] + 4096 &&
+		    (!dst || dst[end] == dst[end - 1] + 4096))
+			goto bad;
+
+		covered += e->count;
+	}
+
+	for (i = 0; i < nr; i++) {
+		if (src[i] != NVIF_EXTENT_SKIP)
+			expect++;
+	}
+
+	if (covered != expect) {
+		fprintf(stderr, "%s: %d of %d pages covered\n", name, covered,
+			expect);
+		return -EINVAL;
+	}
+
+	printf("%-5s: %6d pages in %6d extents (%d.%02d pages each)\n", name,
+	       expect, ret, ret ? expect / ret : 0,
+	       ret ? (expect * 100 / ret) % 100 : 0);
+
+	if (loops > 0) {
+		s64 time = ktime_to_ns(ktime_get());
+		for (i = 0; i < loops; i++)
+			nvif_extent_plan(src, dst, nr, 4096, count_max, extent, nr);
+		time = ktime_to_ns(ktime_get()) - time;
+		printf("%-5s: %lld ns per plan\n", name, time / loops);
+	}
+
+	return 0;
+bad:
+	fprintf(stderr, "%s: extent %d (%d+%d) is wrong\n", name, j,
+		extent[j].first, extent[j].count);
+	return -EINVAL;
+}
+
+int
+main(int argc, char **argv)
+{
+	u32 nr = 512, count_max = ~0U, i;
+	int frag = 5, skip = 1, dfrag = 2, loops = 0, seed = 0;
+	struct nvif_extent *extent;
+	u64 *src, *dst, addr = 0x100000000ULL, vram = 0;
+	int ret, c;
+
+	while ((c = getopt(argc, argv, "n:f:s:d:m:r:t:")) != -1) {
+		switch (c) {
+		case 'n': nr = strtoul(optarg, NULL, 0); break;
+		case 'f': frag = strtol(optarg, NULL, 0); break;
+		case 's': skip = strtol(optarg, NULL, 0); break;
+		case 'd': dfrag = strtol(optarg, NULL, 0); break;
+		case 'm': count_max = strtoul(optarg, NULL, 0); break;
+		case 'r': seed = strtol(optarg, NULL, 0); break;
+		case 't': loops = strtol(optarg, NULL, 0); break;
+		default:
+			fprintf(stderr, "usage: %s [-n pages] [-f src%%] "
+					"[-s skip%%] [-d dst%%] [-m max] "
+					"[-r seed] [-t loops]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	src = calloc(nr + 1, sizeof(*src));
+	dst = calloc(nr + 1, sizeof(*dst));
+	extent = calloc(nr + 1, sizeof(*extent));
+	if (!src || !dst || !extent)
+		return 1;
+
+	/* Anonymous memory is mostly scattered, with the odd run where
+	 * the page allocator handed out neighbours (or a THP was split).
+	 */
+	srand(seed);
+	for (i = 0; i < nr; i++) {
+		if (rand() % 100 < frag)
+			addr = (u64)(rand() % 0x100000) << 12;
+		else
+			addr += 4096;
+		if (rand() % 100 < dfrag)
+			vram += (1 + rand() % 16) * 4096ULL;
+		else
+			vram += 4096;
+
+		src[i] = rand() % 100 < skip ? NVIF_EXTENT_SKIP : addr;
+		dst[i] = vram;
+	}
+
+	ret = check("map", src, NULL, nr, count_max, extent, loops);
+	if (ret == 0)
+		ret = check("copy", src, dst, nr, count_max, extent, loops);
+
+	free(extent);
+	free(dst);
+	free(src);
+	return ret ? 1 : 0;
+}
@@ -0,0 +1,346 @@
+#define _GNU_SOURCE
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include <core/device.h>
+#include <core/falcon.h>
+#include <core/memory.h>
+#include <engine/falcon.h>
+#include <subdev/timer/priv.h>
+
+/* Uploads a synthetic falcon image, by PIO and by DMA, to a simulated
+ * falcon whose registers trap every access the driver makes to them, as
+ * mmiotrace does: the page is kept inaccessible, and each faulting access
+ * is single-stepped with it mapped, then handed to the simulation.  That
+ * models the IMEM/DMEM ports, and a DMA engine which copies from a fake
+ * VRAM buffer.
+ *
+ * Checks that both paths leave the same code, tags and data behind, and
+ * reports the register writes and reads each took, and the time the
+ * falcon's own upload stats (falcon->xfer) recorded.  Those times are
+ * mostly the trapping's, which as with real MMIO scales with the number
+ * of accesses, rather than what a board would take.
+ *
+ * x86-64 only, the simulation decodes which accesses are writes.
+ */
+#ifndef __x86_64__
+int
+main(int argc, char **argv)
+{
+	fprintf(stderr, "only supported on x86-64\n");
+	return 1;
+}
+#else
+#define FALCON 0x840000
+#define FBIF   0x600
+#define VRAM   0x10000000ULL
+
+static struct {
+	u32 *page;
+
+	u32 regs[1024];
+	u32 imem[0x10000 / 4];
+	u16 tags[0x10000 / 256];
+	u32 imem_addr;
+	u16 imem_tag;
+	u32 dmem[0x10000 / 4];
+	u32 dmem_addr;
+	u8 *vram;
+
+	u32 addr;
+	bool write;
+	u64 writes;
+	u64 reads;
+} sim;
+
+static u32
+sim_rd32(u32 addr)
+{
+	switch (addr) {
+	case 0x118: return 0x00000002; /* idle, queue not full */
+	default:
+		return sim.regs[addr / 4];
+	}
+}
+
+static void
+sim_wr32(u32 addr, u32 data)
+{
+	u32 base, offs, src;
+
+	sim.regs[addr / 4] = data;
+
+	switch (addr) {
+	case 0x180:
+		sim.imem_addr = data & 0x0000fffc;
+		break;
+	case 0x184:
+		if (!(sim.imem_addr & 0xff))
+			sim.tags[sim.imem_addr >> 8] = sim.imem_tag;
+		sim.imem[sim.imem_addr / 4] = data;
+		sim.imem_addr = (sim.imem_addr + 4) & 0xfffc;
+		break;
+	case 0x188:
+		sim.imem_tag = data;
+		break;
+	case 0x1c0:
+		sim.dmem_addr = data & 0x0000fffc;
+		break;
+	case 0x1c4:
+		sim.dmem[sim.dmem_addr / 4] = data;
+		sim.dmem_addr = (sim.dmem_addr + 4) & 0xfffc;
+		break;
+	case 0x118:
+		/* a 256-byte transfer, from the physical VRAM aperture */
+		src = sim.regs[(FBIF + 4 * FALCON_DMAIDX_PHYS_VID) / 4];
+		if (((data >> 8) & 7) != 6 || (src & 7) != 4 ||
+		    ((data >> 12) & 7) != FALCON_DMAIDX_PHYS_VID) {
+			fprintf(stderr, "unexpected transfer %08x\n", data);
+			abort();
+		}
+
+		base = sim.regs[0x110 / 4] << 8;
+		offs = sim.regs[0x114 / 4] & 0xff00;
+		src = sim.regs[0x11c / 4];
+		if (data & 0x00000010) {
+			memcpy(&sim.imem[offs / 4],
+			       &sim.vram[base + src - VRAM], 256);
+			sim.tags[offs >> 8] = src >> 8;
+		} else {
+			memcpy(&sim.dmem[offs / 4],
+			       &sim.vram[base + src - VRAM], 256);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+static void
+sim_segv(int sig, siginfo_t *info, void *data)
+{
+	ucontext_t *uc = data;
+	const u8 *insn = (void *)uc->uc_mcontext.gregs[REG_RIP];
+	const u8 *addr = info->si_addr;
+
+	if (addr < (u8 *)sim.page || addr >= (u8 *)sim.page + 0x1000)
+		abort();
+
+	while (*insn == 0x66 || (*insn & 0xf0) == 0x40)
+		insn++;
+
+	sim.addr = addr - (u8 *)sim.page;
+	switch (*insn) {
+	case 0x89: /* mov %reg, (mem) */
+	case 0xc7: /* mov $imm, (mem) */
+		sim.write = true;
+		break;
+	case 0x8b: /* mov (mem), %reg */
+		sim.write = false;
+		break;
+	default:
+		abort();
+	}
+
+	mprotect(sim.page, 0x1000, PROT_READ | PROT_WRITE);
+	if (!sim.write)
+		sim.page[sim.addr / 4] = sim_rd32(sim.addr);
+	uc->uc_mcontext.gregs[REG_EFL] |= 0x100; /* single-step */
+}
+
+static void
+sim_trap(int sig, siginfo_t *info, void *data)
+{
+	ucontext_t *uc = data;
+
+	if (sim.write) {
+		sim_wr32(sim.addr, sim.page[sim.addr / 4]);
+		sim.writes++;
+	} else {
+		sim.reads++;
+	}
+
+	mprotect(sim.page, 0x1000, PROT_NONE);
+	uc->uc_mcontext.gregs[REG_EFL] &= ~0x100;
+}
+
+static u64
+fake_read(struct nvkm_timer *tmr)
+{
+	static u64 time;
+	return time += 1000;
+}
+
+static const struct nvkm_timer_func
+fake_timer = {
+	.read = fake_read,
+};
+
+static enum nvkm_memory_target
+fake_memory_target(struct nvkm_memory *memory)
+{
+	return NVKM_MEM_TARGET_VRAM;
+}
+
+static u64
+fake_memory_addr(struct nvkm_memory *memory)
+{
+	return VRAM;
+}
+
+static const struct nvkm_memory_func
+fake_memory = {
+	.target = fake_memory_target,
+	.addr = fake_memory_addr,
+};
+
+static const struct nvkm_falcon_func
+fake_falcon = {
+	.fbif = FBIF,
+	.load_imem = nvkm_falcon_v1_load_imem,
+	.load_dmem = nvkm_falcon_v1_load_dmem,
+	.load_dma = nvkm_falcon_v1_load_dma,
+};
+
+static const struct nvkm_subdev_func
+fake_subdev = {
+};
+
+static void
+sim_reset(void)
+{
+	memset(sim.regs, 0x00, sizeof(sim.regs));
+	memset(sim.imem, 0x00, sizeof(sim.imem));
+	memset(sim.tags, 0x00, sizeof(sim.tags));
+	memset(sim.dmem, 0x00, sizeof(sim.dmem));
+	sim.writes = sim.reads = 0;
+}
+
+static int
+sim_check(const char *name, const u32 *code, u32 code_size,
+	  const u32 *data, u32 data_size)
+{
+	int i;
+
+	if (memcmp(sim.imem, code, code_size) ||
+	    memcmp(sim.dmem, data, data_size)) {
+		fprintf(stderr, "%s: IMEM/DMEM contents differ\n", name);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < code_size / 256; i++) {
+		if (sim.tags[i] != i) {
+			fprintf(stderr, "%s: IMEM page %d tagged %d\n",
+				name, i, sim.tags[i]);
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
+static void
+sim_stats(const char *name, u64 bytes, u64 time)
+{
+	printf("%-3s: %6lld bytes, %6lld writes, %5lld reads, "
+	       "%6.2f accesses/KiB, %8lld ns\n", name, bytes, sim.writes,
+	       sim.reads, (sim.writes + sim.reads) * 1024.0 / bytes, time);
+}
+
+int
+main(int argc, char **argv)
+{
+	struct device dev = { .name = "fake" };
+	struct nvkm_device device = { .dev = &dev, .cfgopt = "" };
+	struct nvkm_subdev owner = {}, *subdev;
+	struct nvkm_falcon falcon = {};
+	struct nvkm_memory vram;
+	struct nvkm_timer *tmr;
+	struct sigaction sa = { .sa_flags = SA_SIGINFO };
+	u32 code_size = 0x6000, data_size = 0x1800, *code, *data;
+	int ret, c, i;
+
+	while ((c = getopt(argc, argv, "c:d:")) != -1) {
+		switch (c) {
+		case 'c':
+			code_size = ALIGN(strtol(optarg, NULL, 0), 256);
+			break;
+		case 'd':
+			data_size = ALIGN(strtol(optarg, NULL, 0), 256);
+			break;
+		default:
+			return 1;
+		}
+	}
+
+	code_size = min_t(u32, code_size, sizeof(sim.imem));
+	data_size = min_t(u32, data_size, sizeof(sim.dmem));
+	code = malloc(code_size);
+	data = malloc(data_size);
+	sim.vram = malloc(code_size + data_size);
+	device.pri = mmap(NULL, 0x1000000, PROT_READ | PROT_WRITE,
+			  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (!code || !data || !sim.vram || device.pri == MAP_FAILED)
+		return 1;
+
+	srand(0);
+	for (i = 0; i < code_size / 4; i++)
+		code[i] = rand();
+	for (i = 0; i < data_size / 4; i++)
+		data[i] = rand();
+	memcpy(sim.vram, code, code_size);
+	memcpy(sim.vram + code_size, data, data_size);
+
+	mutex_init(&device.mutex);
+	INIT_LIST_HEAD(&device.falcon);
+	ret = nvkm_timer_new_(&fake_timer, &device, NVKM_SUBDEV_TIMER, &tmr);
+	if (ret)
+		return 1;
+	device.timer = tmr;
+
+	nvkm_subdev_ctor(&fake_subdev, &device, NVKM_ENGINE_SEC2, &owner);
+	nvkm_falcon_ctor(&fake_falcon, &owner, "sim", FALCON, &falcon);
+	nvkm_memory_ctor(&fake_memory, &vram);
+
+	sim.page = device.pri + FALCON;
+	sa.sa_sigaction = sim_segv;
+	sigaction(SIGSEGV, &sa, NULL);
+	sa.sa_sigaction = sim_trap;
+	sigaction(SIGTRAP, &sa, NULL);
+	mprotect(sim.page, 0x1000, PROT_NONE);
+
+	sim_reset();
+	nvkm_falcon_load_dmem(&falcon, data, 0x0, data_size, 0);
+	nvkm_falcon_load_imem(&falcon, code, 0x0, code_size, 0, 0, false);
+	if ((ret = sim_check("pio", code, code_size, data, data_size)))
+		goto done;
+	sim_stats("pio", falcon.xfer.pio_bytes, falcon.xfer.pio_time);
+
+	sim_reset();
+	if ((ret = nvkm_falcon_load_dma(&falcon, &vram, code_size, 0x0,
+					data_size, 0, false, false)) ||
+	    (ret = nvkm_falcon_load_dma(&falcon, &vram, 0, 0x0,
+					code_size, 0, true, false))) {
+		fprintf(stderr, "dma: upload failed, %d\n", ret);
+		goto done;
+	}
+	if ((ret = sim_check("dma", code, code_size, data, data_size)))
+		goto done;
+	sim_stats("dma", falcon.xfer.dma_bytes, falcon.xfer.dma_time);
+
+done:
+	mprotect(sim.page, 0x1000, PROT_READ | PROT_WRITE);
+	nvkm_falcon_dtor(&falcon);
+	if (!list_empty(&device.falcon)) {
+		fprintf(stderr, "falcon still listed\n");
+		ret = -EINVAL;
+	}
+	subdev = &tmr->subdev;
+	nvkm_subdev_del(&subdev);
+	return ret ? 1 : 0;
+}
+#endif
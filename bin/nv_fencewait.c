@@ -0,0 +1,247 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <nvif/latency.h>
+
+/* Simulates waiting on fences whose completion times follow one or more
+ * synthetic distributions (run one after the other, to see how quickly
+ * the estimate follows a change in workload), and compares what each
+ * waiting policy costs in CPU time spent, and in how late the waiter
+ * notices completion.
+ *
+ * Distributions, all times in us:
+ *   fixed:T            always T
+ *   uniform:LO,HI      evenly between LO and HI
+ *   bimodal:S,L,PCT    S, PCT% of the time, otherwise L
+ *   tail:T             T, doubling with probability 1/2 up to 4096T
+ */
+#define DISTS 4
+
+struct dist {
+	char type;
+	u64 a, b, c;
+};
+
+struct policy {
+	const char *name;
+	u64 cpu, late, late_max, spun, slept;
+};
+
+enum {
+	BUSY,
+	POLL,
+	SLEEP,
+	HYBRID,
+	HYBRID_POLL,
+	POLICIES
+};
+
+static u64 wake = 10000, cost = 3000, spin_max = 20000;
+
+static int
+dist_parse(const char *arg, struct dist *dist)
+{
+	unsigned long long a = 0, b = 0, c = 0;
+
+	memset(dist, 0x00, sizeof(*dist));
+	if (sscanf(arg, "fixed:%llu", &a) == 1)
+		dist->type = 'f';
+	else
+	if (sscanf(arg, "uniform:%llu,%llu", &a, &b) == 2 && b >= a)
+		dist->type = 'u';
+	else
+	if (sscanf(arg, "bimodal:%llu,%llu,%llu", &a, &b, &c) == 3)
+		dist->type = 'b';
+	else
+	if (sscanf(arg, "tail:%llu", &a) == 1)
+		dist->type = 't';
+	else
+		return -EINVAL;
+
+	dist->a = a * 1000;
+	dist->b = b * 1000;
+	dist->c = c;
+	return 0;
+}
+
+static u64
+dist_next(const struct dist *dist)
+{
+	u64 time;
+	int i;
+
+	switch (dist->type) {
+	case 'f':
+		return dist->a;
+	case 'u':
+		return dist->a + (u64)rand() % (dist->b - dist->a + 1);
+	case 'b':
+		return (rand() % 100) < dist->c ? dist->a : dist->b;
+	case 't':
+	default:
+		for (time = dist->a, i = 0; i < 12 && (rand() & 1); i++)
+			time *= 2;
+		return time;
+	}
+}
+
+/* Exponential sleeps from 1us, capped at 1ms, as the legacy wait did. */
+static u64
+poll(u64 from, u64 done, u64 *cpu)
+{
+	u64 time = from, sleep = 1000;
+
+	while (time < done) {
+		time += sleep + wake;
+		*cpu += cost;
+		sleep = min(sleep * 2, 1000000ULL);
+	}
+	return time;
+}
+
+static void
+account(struct policy *policy, u64 cpu, u64 noticed, u64 done)
+{
+	const u64 late = noticed > done ? noticed - done : 0;
+
+	policy->cpu += cpu;
+	policy->late += late;
+	policy->late_max = max(policy->late_max, late);
+}
+
+int
+main(int argc, char **argv)
+{
+	struct policy policy[POLICIES] = {
+		[BUSY] = { "busy" },
+		[POLL] = { "poll" },
+		[SLEEP] = { "sleep" },
+		[HYBRID] = { "spin+sleep" },
+		[HYBRID_POLL] = { "spin+poll" },
+	};
+	struct dist dist[DISTS];
+	struct nvif_latency latency;
+	u64 age_max = 0, waits = 0;
+	int fences = 100000, nr = 0, loops = 0;
+	int c, i, j, k;
+
+	while ((c = getopt(argc, argv, "d:n:a:w:c:m:t:")) != -1) {
+		switch (c) {
+		case 'd':
+			if (nr == DISTS || dist_parse(optarg, &dist[nr++])) {
+				fprintf(stderr, "bad distribution %s\n", optarg);
+				return 1;
+			}
+			break;
+		case 'n':
+			fences = strtol(optarg, NULL, 0);
+			break;
+		case 'a':
+			age_max = strtoull(optarg, NULL, 0) * 1000;
+			break;
+		case 'w':
+			wake = strtoull(optarg, NULL, 0) * 1000;
+			break;
+		case 'c':
+			cost = strtoull(optarg, NULL, 0) * 1000;
+			break;
+		case 'm':
+			spin_max = strtoull(optarg, NULL, 0) * 1000;
+			break;
+		case 't':
+			loops = strtol(optarg, NULL, 0);
+			break;
+		default:
+			return 1;
+		}
+	}
+
+	if (!nr) {
+		fprintf(stderr, "usage: %s [-n fences] [-a age] [-w wake] "
+				"[-c cost] [-m spin_max] [-t loops] -d dist...\n",
+			argv[0]);
+		return 1;
+	}
+
+	srand(0);
+	nvif_latency_init(&latency);
+	for (i = 0; i < nr; i++) {
+		for (j = 0; j < fences; j++) {
+			const u64 done = dist_next(&dist[i]);
+			const u64 age = age_max ? rand() % age_max : 0;
+			u64 spin, cpu;
+
+			/* Only fences still outstanding get waited on, the
+			 * rest are sampled as if the completion interrupt
+			 * was armed for them.
+			 */
+			if (done <= age) {
+				nvif_latency_done(&latency, done);
+				continue;
+			}
+			waits++;
+
+			account(&policy[BUSY], done - age, done, done);
+
+			cpu = 0;
+			account(&policy[POLL], 0, poll(age, done, &cpu), done);
+			policy[POLL].cpu += cpu;
+
+			account(&policy[SLEEP], cost, done + wake, done);
+
+			spin = nvif_latency_spin(&latency, age, spin_max);
+			if (spin)
+				policy[HYBRID].spun++;
+			if (done - age <= spin) {
+				account(&policy[HYBRID], done - age, done, done);
+				account(&policy[HYBRID_POLL], done - age, done,
+					done);
+			} else {
+				policy[HYBRID].slept++;
+				account(&policy[HYBRID], spin + cost,
+					done + wake, done);
+				cpu = spin;
+				account(&policy[HYBRID_POLL], 0,
+					poll(age + spin, done, &cpu), done);
+				policy[HYBRID_POLL].cpu += cpu;
+			}
+			nvif_latency_wait(&latency, done - age, spin != 0,
+					  done - age > spin);
+			nvif_latency_done(&latency, done);
+		}
+	}
+
+	printf("%lld waits, %lld spun, %lld slept\n", waits,
+	       policy[HYBRID].spun, policy[HYBRID].slept);
+	for (k = 0; k < POLICIES; k++) {
+		const struct policy *p = &policy[k];
+
+		printf("%-10s: %8lld ns cpu/wait, %8lld ns late/wait, "
+		       "%8lld ns late max\n", p->name,
+		       waits ? p->cpu / waits : 0, waits ? p->late / waits : 0,
+		       p->late_max);
+	}
+
+	printf("outstanding when waited on\n");
+	for (k = 0; k < NVIF_LATENCY_BUCKETS; k++) {
+		if (!latency.wait[k])
+			continue;
+		if (k < NVIF_LATENCY_BUCKETS - 1)
+			printf("  <%6dus", 1 << k);
+		else
+			printf("  >=%5dus", 1 << (k - 1));
+		printf(": %lld\n", latency.wait[k]);
+	}
+
+	if (loops > 0) {
+		s64 time = ktime_to_ns(ktime_get());
+		u64 sum = 0;
+		for (i = 0; i < loops; i++)
+			sum += nvif_latency_spin(&latency, i & 0xffff, spin_max);
+		time = ktime_to_ns(ktime_get()) - time;
+		printf("spin    : %lld ns (%lld)\n", time / loops, sum & 1);
+	}
+
+	return 0;
+}
@@ -0,0 +1,190 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <nvif/os.h>
+
+/* Builds a fake nvidia/<chip>/ firmware tree in a temporary directory,
+ * and loads it through the firmware cache the way repeated device inits
+ * would, checking every image comes back intact.
+ */
+static const char *images[] = {
+	"nvidia/gp102/gr/fecs_bl.bin",
+	"nvidia/gp102/gr/fecs_inst.bin",
+	"nvidia/gp102/gr/fecs_data.bin",
+	"nvidia/gp102/gr/gpccs_bl.bin",
+	"nvidia/gp102/gr/gpccs_inst.bin",
+	"nvidia/gp102/gr/gpccs_data.bin",
+	"nvidia/gp102/acr/bl.bin",
+	"nvidia/gp102/acr/ucode_load.bin",
+	"nvidia/gp102/acr/ucode_unload.bin",
+	"nvidia/gp102/sec2/desc.bin",
+	"nvidia/gp102/sec2/image.bin",
+	"nvidia/gp102/sec2/sig.bin",
+};
+
+static int
+image_make(const char *root, const char *name, int size, u8 seed)
+{
+	char path[512], *dir;
+	u8 *data;
+	int ret, i;
+
+	snprintf(path, sizeof(path), "%s/%s", root, name);
+	for (dir = strchr(path + strlen(root) + 1, '/'); dir;
+	     dir = strchr(dir + 1, '/')) {
+		*dir = '\0';
+		mkdir(path, 0755);
+		*dir = '/';
+	}
+
+	if (!(data = malloc(size)))
+		return -ENOMEM;
+	for (i = 0; i < size; i++)
+		data[i] = seed + i;
+
+	ret = nvos_firmware_store(path, data, size);
+	free(data);
+	return ret;
+}
+
+static int
+image_check(const struct firmware *fw, int size, u8 seed)
+{
+	int i;
+
+	if (fw->size != size)
+		return -EINVAL;
+	for (i = 0; i < size; i++) {
+		if (fw->data[i] != (u8)(seed + i))
+			return -EINVAL;
+	}
+	return 0;
+}
+
+static int
+image_size(int i)
+{
+	return 4096 * (i + 1) + i;
+}
+
+static void
+image_remove(const char *root, const char *name)
+{
+	char path[512], *dir;
+
+	snprintf(path, sizeof(path), "%s/%s", root, name);
+	unlink(path);
+
+	/* and any directories that are left empty */
+	while ((dir = strrchr(path, '/')) && dir > path + strlen(root)) {
+		*dir = '\0';
+		if (rmdir(path))
+			break;
+	}
+}
+
+static void
+print_stats(const char *name)
+{
+	struct nvos_firmware_stats stats;
+
+	nvos_firmware_stats(&stats);
+	printf("%-8s: %d images (%lld bytes), %d users, %lld hits, "
+	       "%lld misses, %lld ns/load\n", name, stats.images, stats.bytes,
+	       stats.users, stats.hits, stats.misses,
+	       stats.misses ? stats.load_ns / stats.misses : 0);
+}
+
+int
+main(int argc, char **argv)
+{
+	const struct firmware *fw[ARRAY_SIZE(images)];
+	char root[] = "/tmp/nv_firmware.XXXXXX", base[64];
+	int loops = 1000, preload = 0;
+	int ret = 0, c, i, j;
+	s64 time;
+
+	while ((c = getopt(argc, argv, "n:p")) != -1) {
+		switch (c) {
+		case 'n':
+			loops = strtol(optarg, NULL, 0);
+			break;
+		case 'p':
+			preload = 1;
+			break;
+		default:
+			return 1;
+		}
+	}
+
+	if (!mkdtemp(root))
+		return 1;
+
+	for (i = 0; i < ARRAY_SIZE(images); i++) {
+		if ((ret = image_make(root, images[i], image_size(i), i)))
+			goto done;
+	}
+
+	snprintf(base, sizeof(base), "%s/", root);
+	nvos_firmware_path(base);
+
+	if (preload) {
+		ret = nvos_firmware_preload("nvidia/gp102");
+		printf("preload : %d images\n", ret);
+		if (ret != ARRAY_SIZE(images)) {
+			ret = -EINVAL;
+			goto done;
+		}
+	}
+
+	/* Each loop's one device init, grabbing every image, and then
+	 * dropping them again once they're uploaded.
+	 */
+	time = ktime_to_ns(ktime_get());
+	for (j = 0; j < loops; j++) {
+		for (i = 0; i < ARRAY_SIZE(images); i++) {
+			if ((ret = request_firmware(&fw[i], images[i], NULL)))
+				goto done;
+		}
+
+		for (i = 0; i < ARRAY_SIZE(images); i++) {
+			if (j == 0 || j == loops - 1) {
+				ret = image_check(fw[i], image_size(i), i);
+				if (ret) {
+					fprintf(stderr, "%s corrupt\n",
+						images[i]);
+					goto done;
+				}
+			}
+			release_firmware(fw[i]);
+		}
+	}
+	time = ktime_to_ns(ktime_get()) - time;
+	print_stats("loaded");
+	printf("request : %lld ns\n",
+	       loops ? time / loops / (s64)ARRAY_SIZE(images) : 0);
+
+	/* An image that's replaced must not be served from the cache. */
+	ret = request_firmware(&fw[0], images[0], NULL);
+	if (ret == 0) {
+		ret = image_make(root, images[0], 100, 0x55);
+		release_firmware(fw[0]);
+	}
+	if (ret == 0 && !(ret = request_firmware(&fw[0], images[0], NULL))) {
+		if ((ret = image_check(fw[0], 100, 0x55)))
+			fprintf(stderr, "stale image served\n");
+		release_firmware(fw[0]);
+	}
+
+	nvos_firmware_flush();
+	print_stats("flushed");
+done:
+	for (i = 0; i < ARRAY_SIZE(images); i++)
+		image_remove(root, images[i]);
+	rmdir(root);
+	if (ret)
+		fprintf(stderr, "failed, %d\n", ret);
+	return ret;
+}
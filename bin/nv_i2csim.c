@@ -0,0 +1,313 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <core/device.h>
+#include <subdev/i2c/bus.h>
+
+/* Runs the internal bit-banging I2C algorithm against a simulated EEPROM
+ * (holding an EDID) behind a fake pad, following every edge the master
+ * drives to act as the slave would, and checks block reads, writes and
+ * probes of absent devices behave.  Reports how many register accesses
+ * and how much time each kind of transfer took.
+ */
+#define EEPROM_ADDR 0x50
+
+static struct {
+	u8 mem[256];
+	u8 offset;
+
+	int scl;
+	int sda_m; /* driven by the master */
+	int sda_s; /* driven by the slave */
+
+	enum {
+		IDLE,
+		RX,	/* shifting in a byte */
+		RX_ACK,	/* acking it */
+		TX,	/* shifting out a byte */
+		TX_ACK,	/* waiting for the master's ack */
+	} state;
+	bool addr;	/* next byte received is an address */
+	bool first;	/* next byte written is the offset */
+	bool nack;
+	int bit;
+	u8 shift;
+
+	u64 writes;
+	u64 reads;
+} eeprom;
+
+static int
+line_sda(void)
+{
+	return eeprom.sda_m && eeprom.sda_s;
+}
+
+static void
+slave_start(void)
+{
+	eeprom.state = RX;
+	eeprom.addr = true;
+	eeprom.bit = 0;
+	eeprom.shift = 0;
+	eeprom.sda_s = 1;
+}
+
+static void
+slave_stop(void)
+{
+	eeprom.state = IDLE;
+	eeprom.sda_s = 1;
+}
+
+static void
+slave_load(void)
+{
+	eeprom.shift = eeprom.mem[eeprom.offset++];
+	eeprom.bit = 0;
+	eeprom.sda_s = !!(eeprom.shift & 0x80);
+	eeprom.state = TX;
+}
+
+static void
+slave_scl_rise(void)
+{
+	switch (eeprom.state) {
+	case RX:
+		eeprom.shift = (eeprom.shift << 1) | line_sda();
+		eeprom.bit++;
+		break;
+	case TX_ACK:
+		eeprom.nack = line_sda();
+		break;
+	default:
+		break;
+	}
+}
+
+static void
+slave_scl_fall(void)
+{
+	switch (eeprom.state) {
+	case RX:
+		if (eeprom.bit < 8)
+			break;
+
+		if (eeprom.addr) {
+			if ((eeprom.shift >> 1) != EEPROM_ADDR) {
+				eeprom.state = IDLE;
+				break;
+			}
+			eeprom.first = !(eeprom.shift & 1);
+		} else
+		if (eeprom.first) {
+			eeprom.offset = eeprom.shift;
+			eeprom.first = false;
+		} else {
+			eeprom.mem[eeprom.offset++] = eeprom.shift;
+		}
+
+		eeprom.sda_s = 0;
+		eeprom.state = RX_ACK;
+		break;
+	case RX_ACK:
+		eeprom.sda_s = 1;
+		if (eeprom.addr && (eeprom.shift & 1)) {
+			eeprom.addr = false;
+			slave_load();
+			break;
+		}
+		eeprom.addr = false;
+		eeprom.state = RX;
+		eeprom.bit = 0;
+		eeprom.shift = 0;
+		break;
+	case TX:
+		if (++eeprom.bit < 8) {
+			eeprom.sda_s = !!(eeprom.shift & (0x80 >> eeprom.bit));
+			break;
+		}
+		eeprom.sda_s = 1;
+		eeprom.state = TX_ACK;
+		break;
+	case TX_ACK:
+		if (!eeprom.nack)
+			slave_load();
+		else
+			eeprom.state = IDLE;
+		break;
+	default:
+		break;
+	}
+}
+
+static void
+fake_drive_scl(struct nvkm_i2c_bus *bus, int state)
+{
+	const int prev = eeprom.scl;
+
+	eeprom.writes++;
+	eeprom.scl = state;
+	if (!prev && state)
+		slave_scl_rise();
+	else
+	if (prev && !state)
+		slave_scl_fall();
+}
+
+static void
+fake_drive_sda(struct nvkm_i2c_bus *bus, int state)
+{
+	const int prev = line_sda();
+
+	eeprom.writes++;
+	eeprom.sda_m = state;
+	if (eeprom.scl && prev != line_sda()) {
+		if (!line_sda())
+			slave_start();
+		else
+			slave_stop();
+	}
+}
+
+static int
+fake_sense_scl(struct nvkm_i2c_bus *bus)
+{
+	eeprom.reads++;
+	return eeprom.scl;
+}
+
+static int
+fake_sense_sda(struct nvkm_i2c_bus *bus)
+{
+	eeprom.reads++;
+	return line_sda();
+}
+
+static const struct nvkm_i2c_bus_func
+fake_bus = {
+	.drive_scl = fake_drive_scl,
+	.drive_sda = fake_drive_sda,
+	.sense_scl = fake_sense_scl,
+	.sense_sda = fake_sense_sda,
+	.xfer = nvkm_i2c_bit_xfer,
+};
+
+static const struct nvkm_i2c_pad_func
+fake_pad = {
+};
+
+static int
+xfer(struct nvkm_i2c_bus *bus, const char *name, struct i2c_msg *msgs,
+     int num, int expect)
+{
+	const u64 writes = eeprom.writes, reads = eeprom.reads;
+	const u64 time = bus->stats.time;
+	int ret, bytes = 0, i;
+
+	for (i = 0; i < num; i++)
+		bytes += msgs[i].len;
+
+	ret = i2c_transfer(&bus->i2c, msgs, num);
+	printf("%-12s: %4d bytes, %6lld writes, %6lld reads, %8lld us\n",
+	       name, bytes, eeprom.writes - writes, eeprom.reads - reads,
+	       (bus->stats.time - time) / 1000);
+	if (ret != expect) {
+		fprintf(stderr, "%s: %d, expected %d\n", name, ret, expect);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+	struct device dev = { .name = "fake" };
+	struct nvkm_device device = { .dev = &dev, .cfgopt = "" };
+	struct nvkm_i2c i2c = { .subdev.device = &device };
+	struct nvkm_i2c_pad pad = { .func = &fake_pad, .i2c = &i2c,
+				    .mode = NVKM_I2C_PAD_I2C };
+	struct nvkm_i2c_bus *bus;
+	u8 offset = 0, edid[256], data[16];
+	u8 wr[1 + sizeof(data)];
+	int loops = 1, ret, i;
+
+	if (argc > 1)
+		loops = strtol(argv[1], NULL, 0);
+
+	/* An EDID header, and a checksummed pattern. */
+	for (i = 0; i < 256; i++)
+		eeprom.mem[i] = i * 7 + 3;
+	memcpy(eeprom.mem, "\x00\xff\xff\xff\xff\xff\xff\x00", 8);
+	eeprom.sda_s = eeprom.sda_m = eeprom.scl = 1;
+
+	INIT_LIST_HEAD(&i2c.bus);
+	mutex_init(&pad.mutex);
+	ret = nvkm_i2c_bus_new_(&fake_bus, &pad, 0, &bus);
+	if (ret)
+		return 1;
+	nvkm_i2c_bus_init(bus);
+
+	for (i = 0; i < loops; i++) {
+		/* A 128-byte EDID block read, as drm_do_probe_ddc_edid()
+		 * does, and then both blocks at once.
+		 */
+		memset(edid, 0x00, sizeof(edid));
+		ret = xfer(bus, "edid block", (struct i2c_msg[]) {
+				{ .addr = EEPROM_ADDR, .len = 1, .buf = &offset },
+				{ .addr = EEPROM_ADDR, .flags = I2C_M_RD,
+				  .len = 128, .buf = edid },
+			   }, 2, 2);
+		if (ret || memcmp(edid, eeprom.mem, 128))
+			goto fail;
+
+		memset(edid, 0x00, sizeof(edid));
+		ret = xfer(bus, "edid full", (struct i2c_msg[]) {
+				{ .addr = EEPROM_ADDR, .len = 1, .buf = &offset },
+				{ .addr = EEPROM_ADDR, .flags = I2C_M_RD,
+				  .len = 255, .buf = edid },
+			   }, 2, 2);
+		if (ret || memcmp(edid, eeprom.mem, 255))
+			goto fail;
+
+		/* A sensor-style register write, and reading it back. */
+		wr[0] = 0x80;
+		for (ret = 0; ret < sizeof(data); ret++)
+			wr[1 + ret] = 0xa5 ^ (ret + i);
+		ret = xfer(bus, "write", (struct i2c_msg[]) {
+				{ .addr = EEPROM_ADDR, .len = sizeof(wr),
+				  .buf = wr },
+			   }, 1, 1);
+		if (ret)
+			goto fail;
+
+		ret = xfer(bus, "read", (struct i2c_msg[]) {
+				{ .addr = EEPROM_ADDR, .len = 1, .buf = wr },
+				{ .addr = EEPROM_ADDR, .flags = I2C_M_RD,
+				  .len = sizeof(data), .buf = data },
+			   }, 2, 2);
+		if (ret || memcmp(data, wr + 1, sizeof(data)))
+			goto fail;
+
+		/* Nothing's there to ack. */
+		ret = xfer(bus, "probe absent", (struct i2c_msg[]) {
+				{ .addr = 0x4c, .len = 1, .buf = &offset },
+			   }, 1, -EIO);
+		if (ret)
+			goto fail;
+	}
+
+	printf("bus: %lld xfers, %lld bytes, %lld errors, %lld us\n",
+	       bus->stats.xfers, bus->stats.bytes, bus->stats.errors,
+	       bus->stats.time / 1000);
+	nvkm_i2c_bus_fini(bus);
+	nvkm_i2c_bus_del(&bus);
+	return 0;
+
+fail:
+	fprintf(stderr, "transfer failed or data mismatch\n");
+	nvkm_i2c_bus_del(&bus);
+	return 1;
+}
@@ -0,0 +1,167 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <core/subdev.h>
+
+#include "../lib/priv.h"
+
+/* Runs the device init graph over stub subdevs that just sleep for about
+ * as long as the real ones take on a Pascal board, checks that nothing
+ * ran before its dependencies were done, and compares the serial and
+ * parallel times.
+ */
+static const struct {
+	int index;
+	int us;
+} delays[] = {
+	{ NVKM_SUBDEV_PCI     ,   100 },
+	{ NVKM_SUBDEV_VBIOS   ,    50 },
+	{ NVKM_SUBDEV_DEVINIT ,  2000 },
+	{ NVKM_SUBDEV_TOP     ,    50 },
+	{ NVKM_SUBDEV_MC      ,   100 },
+	{ NVKM_SUBDEV_BUS     ,    50 },
+	{ NVKM_SUBDEV_TIMER   ,    50 },
+	{ NVKM_SUBDEV_FB      ,  3000 },
+	{ NVKM_SUBDEV_LTC     ,   500 },
+	{ NVKM_SUBDEV_MMU     ,   200 },
+	{ NVKM_SUBDEV_BAR     ,   300 },
+	{ NVKM_SUBDEV_FAULT   ,   100 },
+	{ NVKM_SUBDEV_ACR     ,  8000 },
+	{ NVKM_SUBDEV_PMU     , 10000 },
+	{ NVKM_SUBDEV_VOLT    ,  1000 },
+	{ NVKM_SUBDEV_ICCSENSE,  2000 },
+	{ NVKM_SUBDEV_THERM   ,  4000 },
+	{ NVKM_SUBDEV_CLK     ,  6000 },
+	{ NVKM_ENGINE_CE0     ,   500 },
+	{ NVKM_ENGINE_CE1     ,   500 },
+	{ NVKM_ENGINE_CE2     ,   500 },
+	{ NVKM_ENGINE_CE3     ,   500 },
+	{ NVKM_ENGINE_DISP    ,  9000 },
+	{ NVKM_ENGINE_DMAOBJ  ,    50 },
+	{ NVKM_ENGINE_FIFO    ,  1000 },
+	{ NVKM_ENGINE_GR      , 15000 },
+	{ NVKM_ENGINE_NVENC0  ,  1500 },
+	{ NVKM_ENGINE_NVDEC0  ,  1500 },
+	{ NVKM_ENGINE_PM      ,   200 },
+	{ NVKM_ENGINE_SEC2    ,  3000 },
+	{ NVKM_ENGINE_SW      ,    50 },
+};
+
+static DEFINE_SPINLOCK(lock);
+static DECLARE_BITMAP(mask, NVKM_SUBDEV_NR);
+static DECLARE_BITMAP(done, NVKM_SUBDEV_NR);
+static int delay[NVKM_SUBDEV_NR];
+static int fail = -1;
+static int order;
+
+static int
+stub_init(struct nvkm_device *device, int index)
+{
+	DECLARE_BITMAP(deps, NVKM_SUBDEV_NR);
+	int i;
+
+	nvkm_device_init_deps(index, deps);
+	spin_lock(&lock);
+	for_each_set_bit(i, deps, NVKM_SUBDEV_NR) {
+		if (test_bit(i, mask) && !test_bit(i, done)) {
+			fprintf(stderr, "%s started before %s\n",
+				nvkm_subdev_name[index], nvkm_subdev_name[i]);
+			order++;
+		}
+	}
+	spin_unlock(&lock);
+
+	usleep(delay[index]);
+
+	spin_lock(&lock);
+	__set_bit(index, done);
+	spin_unlock(&lock);
+	return index == fail ? -EIO : 0;
+}
+
+static int
+run(bool parallel, int verbose)
+{
+	struct nvkm_device_init_stats stats;
+	int ret, i;
+
+	bitmap_clear(done, 0, NVKM_SUBDEV_NR);
+	ret = nvkm_device_init_graph(NULL, mask, stub_init, parallel, &stats);
+
+	if (verbose) {
+		for_each_set_bit(i, stats.ran, NVKM_SUBDEV_NR) {
+			printf("  %-8s at %8lldus, took %8lldus\n",
+			       nvkm_subdev_name[i], stats.start[i],
+			       stats.time[i]);
+		}
+	}
+
+	printf("%-8s: %8lldus total, %8lldus serial, %8lldus critical:",
+	       parallel ? "parallel" : "serial", stats.total, stats.serial,
+	       stats.critical);
+	for (i = 0; i < stats.path_nr; i++)
+		printf(" %s", nvkm_subdev_name[stats.path[i]]);
+	printf("\n");
+
+	/* After a failure, nothing that depends on it may have run. */
+	if (ret && fail >= 0) {
+		for_each_set_bit(i, stats.ran, NVKM_SUBDEV_NR) {
+			DECLARE_BITMAP(deps, NVKM_SUBDEV_NR);
+			nvkm_device_init_deps(i, deps);
+			if (test_bit(fail, deps)) {
+				fprintf(stderr, "%s ran after %s failed\n",
+					nvkm_subdev_name[i],
+					nvkm_subdev_name[fail]);
+				order++;
+			}
+		}
+	}
+
+	return ret;
+}
+
+int
+main(int argc, char **argv)
+{
+	int verbose = 0, ret, c, i;
+	int ret_serial;
+
+	while ((c = getopt(argc, argv, "f:v")) != -1) {
+		switch (c) {
+		case 'f':
+			for (i = 0; i < NVKM_SUBDEV_NR; i++) {
+				if (!strcasecmp(optarg, nvkm_subdev_name[i]))
+					fail = i;
+			}
+			if (fail < 0)
+				return 1;
+			break;
+		case 'v':
+			verbose++;
+			break;
+		default:
+			return 1;
+		}
+	}
+
+	for (i = 0; i < ARRAY_SIZE(delays); i++) {
+		delay[delays[i].index] = delays[i].us;
+		__set_bit(delays[i].index, mask);
+	}
+
+	ret_serial = run(false, verbose);
+	ret = run(true, verbose);
+	if (ret != ret_serial) {
+		fprintf(stderr, "serial returned %d, parallel %d\n",
+			ret_serial, ret);
+		return 1;
+	}
+
+	if (order) {
+		fprintf(stderr, "%d ordering violations\n", order);
+		return 1;
+	}
+
+	return fail >= 0 && ret != -EIO;
+}
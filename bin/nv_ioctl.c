@@ -0,0 +1,106 @@
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include <nvif/client.h>
+#include <nvif/device.h>
+#include <nvif/class.h>
+#include <nvif/ioctl.h>
+
+#include "util.h"
+
+/* Hammers a single client with ioctls from several threads at once, to
+ * see how well the requests that may run concurrently (NOPs) scale, with
+ * and without a stream of exclusive ones (device list) mixed in.
+ */
+static struct nvif_client client;
+static int loops = 100000;
+static int writes = 0;
+
+static void *
+worker(void *arg)
+{
+	struct nvif_object *object = &client.object;
+	struct {
+		struct nvif_ioctl_v0 ioctl;
+		struct nvif_ioctl_nop_v0 nop;
+	} nop;
+	long fails = 0;
+	int i;
+
+	for (i = 0; i < loops; i++) {
+		if (writes && (i % writes) == 0) {
+			struct nvif_client_devlist_v0 args = {};
+			if (nvif_object_mthd(object, NVIF_CLIENT_V0_DEVLIST,
+					     &args, sizeof(args)))
+				fails++;
+			continue;
+		}
+
+		memset(&nop, 0x00, sizeof(nop));
+		if (nvif_client_ioctl(&client, &nop, sizeof(nop)))
+			fails++;
+	}
+
+	return (void *)fails;
+}
+
+int
+main(int argc, char **argv)
+{
+	pthread_t *thread;
+	int threads = 4;
+	long fails = 0;
+	s64 time;
+	int ret, c, i;
+
+	while ((c = getopt(argc, argv, U_GETOPT"j:n:w:")) != -1) {
+		switch (c) {
+		case 'j':
+			threads = strtol(optarg, NULL, 0);
+			break;
+		case 'n':
+			loops = strtol(optarg, NULL, 0);
+			break;
+		case 'w':
+			writes = strtol(optarg, NULL, 0);
+			break;
+		default:
+			if (!u_option(c))
+				return 1;
+			break;
+		}
+	}
+
+	if (!(thread = calloc(threads, sizeof(*thread))))
+		return -ENOMEM;
+
+	ret = u_client("null", argv[0], "error", false, false, 0, &client);
+	if (ret)
+		goto done;
+
+	time = ktime_to_ns(ktime_get());
+	for (i = 0; i < threads; i++) {
+		if (pthread_create(&thread[i], NULL, worker, NULL)) {
+			threads = i;
+			break;
+		}
+	}
+
+	for (i = 0; i < threads; i++) {
+		void *result;
+		pthread_join(thread[i], &result);
+		fails += (long)result;
+	}
+	time = ktime_to_ns(ktime_get()) - time;
+
+	printf("%d thread(s), %d ioctls each: %lld ns total, "
+	       "%lld ioctls/s, %ld failed\n", threads, loops, time,
+	       time ? (s64)threads * loops * 1000000000LL / time : 0, fails);
+
+	nvif_client_fini(&client);
+done:
+	free(thread);
+	return ret;
+}
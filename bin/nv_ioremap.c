@@ -0,0 +1,147 @@
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <nvif/client.h>
+#include <nvif/device.h>
+#include <nvif/class.h>
+
+#include "util.h"
+
+/* Churns ioremap()/iounmap() of random ranges of a fake, file-backed,
+ * BAR with the null device loaded, and checks every pointer handed back
+ * reaches the right offset, no matter which mapping served it.
+ */
+#define FAKE_ADDR 0xe0000000ULL
+
+static int fake_fd;
+static u8 *fake_mem;
+static u64 fake_maps;
+
+static int
+fake_map(struct os_iomem *iomem, u64 addr, u64 size, void **ptr)
+{
+	*ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fake_fd,
+		    addr - iomem->addr);
+	if (*ptr == MAP_FAILED)
+		return -errno;
+	fake_maps++;
+	return 0;
+}
+
+static void
+fake_unmap(struct os_iomem *iomem, void *ptr, u64 size)
+{
+	munmap(ptr, size);
+	fake_maps--;
+}
+
+int
+main(int argc, char **argv)
+{
+	struct os_iomem fake = {
+		.addr = FAKE_ADDR,
+		.size = 1ULL << 30,
+		.map = fake_map,
+		.unmap = fake_unmap,
+	};
+	struct os_ioremap_stats stats;
+	struct nvif_client client;
+	FILE *file = NULL;
+	u64 *addr = NULL;
+	void **ptr = NULL;
+	int slots = 1024, loops = 1000000;
+	int ret, c, i;
+	s64 time;
+
+	while ((c = getopt(argc, argv, U_GETOPT"s:n:")) != -1) {
+		switch (c) {
+		case 's':
+			slots = strtol(optarg, NULL, 0);
+			break;
+		case 'n':
+			loops = strtol(optarg, NULL, 0);
+			break;
+		default:
+			if (!u_option(c))
+				return 1;
+			break;
+		}
+	}
+
+	ret = u_client("null", argv[0], "error", false, false, 0, &client);
+	if (ret)
+		return ret;
+
+	ret = -ENOMEM;
+	fake_mem = MAP_FAILED;
+	if (!(file = tmpfile()) || ftruncate(fake_fd = fileno(file), fake.size))
+		goto done;
+	fake_mem = mmap(NULL, fake.size, PROT_READ | PROT_WRITE, MAP_SHARED,
+			fake_fd, 0);
+	if (fake_mem == MAP_FAILED)
+		goto done;
+	addr = calloc(slots, sizeof(*addr));
+	ptr = calloc(slots, sizeof(*ptr));
+	if (!addr || !ptr)
+		goto done;
+
+	if ((ret = os_iomem_add(&fake)))
+		goto done;
+
+	srand(0);
+	time = ktime_to_ns(ktime_get());
+	for (i = 0; i < loops; i++) {
+		int slot = rand() % slots;
+
+		if (ptr[slot]) {
+			iounmap(ptr[slot]);
+			ptr[slot] = NULL;
+			continue;
+		}
+
+		/* Mostly small objects, clustered towards the start of the
+		 * BAR as an allocator would place them.
+		 */
+		addr[slot] = FAKE_ADDR + (u64)(rand() % 4096) * (rand() % 64) *
+					 PAGE_SIZE;
+		ptr[slot] = ioremap(addr[slot], PAGE_SIZE * (1 + rand() % 16));
+		if (ptr[slot])
+			*(volatile u64 *)ptr[slot] = addr[slot] + i;
+		if (!ptr[slot] || *(u64 *)(fake_mem + (addr[slot] - FAKE_ADDR)) !=
+				  addr[slot] + i) {
+			fprintf(stderr, "%016llx mapped incorrectly\n",
+				addr[slot]);
+			ret = -EINVAL;
+			goto del;
+		}
+	}
+	time = ktime_to_ns(ktime_get()) - time;
+
+	os_ioremap_stats(&stats);
+	printf("%lld ioremaps, %lld shared an existing mapping, %lld mapped, "
+	       "%d mappings live\n", stats.ioremaps, stats.hits, stats.maps,
+	       stats.mappings);
+	printf("%lld ns per ioremap/iounmap\n", loops ? time / loops : 0);
+
+	for (i = 0; i < slots; i++)
+		iounmap(ptr[i]);
+
+	os_ioremap_stats(&stats);
+	if (stats.mappings || fake_maps) {
+		fprintf(stderr, "%d mappings left behind\n", stats.mappings);
+		ret = -EINVAL;
+	}
+
+del:
+	os_iomem_del(&fake);
+done:
+	free(ptr);
+	free(addr);
+	if (fake_mem != MAP_FAILED)
+		munmap(fake_mem, fake.size);
+	if (file)
+		fclose(file);
+	nvif_client_fini(&client);
+	return ret;
+}
@@ -0,0 +1,157 @@
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include <nvif/pfnpool.h>
+
+/* Runs the device page allocator over a fake range of pfns from many
+ * threads at once, each mixing single-page faults, larger migrations and
+ * frees, and checks that no page is ever handed out twice, that chunks
+ * are only grown one at a time, and that no more are grown than needed.
+ */
+#define FAKE_PFN 0x1000000UL
+
+static struct nvif_pfnpool pool;
+static u8 *owner;
+static int loops = 100000;
+static int large = 64;
+static int grow_us = 200;
+static int growing, grow_overlap;
+static long failed;
+
+static int
+fake_grow(struct nvif_pfnpool *pool, struct nvif_pfnpool_chunk *chunk)
+{
+	if (__sync_fetch_and_add(&growing, 1))
+		__sync_fetch_and_add(&grow_overlap, 1);
+	usleep(grow_us); /* allocating and pinning the VRAM */
+	__sync_fetch_and_sub(&growing, 1);
+	return 0;
+}
+
+static void
+take(unsigned long pfn, int id)
+{
+	if (!__sync_bool_compare_and_swap(&owner[pfn - FAKE_PFN], 0, id)) {
+		fprintf(stderr, "pfn %lx handed out twice\n", pfn);
+		__sync_fetch_and_add(&failed, 1);
+	}
+}
+
+static void
+give(unsigned long pfn, int id)
+{
+	if (!__sync_bool_compare_and_swap(&owner[pfn - FAKE_PFN], id, 0)) {
+		fprintf(stderr, "pfn %lx freed by non-owner\n", pfn);
+		__sync_fetch_and_add(&failed, 1);
+	}
+	nvif_pfnpool_free(&pool, pfn);
+}
+
+static void *
+worker(void *arg)
+{
+	const int id = (long)arg;
+	unsigned long *held, pfn[NVIF_PFNPOOL_CHUNK_NPAGES];
+	unsigned int seed = id;
+	int nr = 0, max = 1024, i, j, n;
+
+	if (!(held = calloc(max + NVIF_PFNPOOL_CHUNK_NPAGES, sizeof(*held))))
+		return NULL;
+
+	for (i = 0; i < loops; i++) {
+		int op = rand_r(&seed) % 100;
+
+		if (nr && (op < 45 || nr >= max)) {
+			/* Free a random held page, or a whole run of them. */
+			n = op < 5 ? min(nr, large) : 1;
+			while (n--) {
+				j = rand_r(&seed) % nr;
+				give(held[j], id);
+				held[j] = held[--nr];
+			}
+			continue;
+		}
+
+		n = op < 95 ? 1 : 1 + rand_r(&seed) % large;
+		n = nvif_pfnpool_alloc(&pool, n, pfn);
+		for (j = 0; j < n; j++) {
+			take(pfn[j], id);
+			held[nr++] = pfn[j];
+		}
+	}
+
+	while (nr)
+		give(held[--nr], id);
+	free(held);
+	return NULL;
+}
+
+int
+main(int argc, char **argv)
+{
+	struct nvif_pfnpool_stats stats;
+	int threads = 8, chunks = 256;
+	pthread_t *thread;
+	int ret, c, i;
+	s64 time;
+
+	while ((c = getopt(argc, argv, "j:n:c:l:g:")) != -1) {
+		switch (c) {
+		case 'j': threads = strtol(optarg, NULL, 0); break;
+		case 'n': loops = strtol(optarg, NULL, 0); break;
+		case 'c': chunks = strtol(optarg, NULL, 0); break;
+		case 'l': large = max(1, min(strtol(optarg, NULL, 0),
+					     NVIF_PFNPOOL_CHUNK_NPAGES)); break;
+		case 'g': grow_us = strtol(optarg, NULL, 0); break;
+		default:
+			return 1;
+		}
+	}
+
+	threads = max(1, min(threads, 255));
+	owner = calloc(chunks, NVIF_PFNPOOL_CHUNK_NPAGES);
+	thread = calloc(threads, sizeof(*thread));
+	if (!owner || !thread)
+		return 1;
+
+	ret = nvif_pfnpool_init(&pool, FAKE_PFN, chunks, fake_grow);
+	if (ret)
+		return 1;
+
+	time = ktime_to_ns(ktime_get());
+	for (i = 0; i < threads; i++) {
+		if (pthread_create(&thread[i], NULL, worker, (void *)(long)(i + 1))) {
+			threads = i;
+			break;
+		}
+	}
+	for (i = 0; i < threads; i++)
+		pthread_join(thread[i], NULL);
+	time = ktime_to_ns(ktime_get()) - time;
+
+	nvif_pfnpool_stats(&pool, &stats);
+	printf("%d thread(s), %d ops each: %lld ops/s\n", threads, loops,
+	       time ? (s64)threads * loops * 1000000000LL / time : 0);
+	printf("%lld chunks (%lld grows, %lld waited on another's), "
+	       "%lld refills, %lld flushes\n", stats.chunks, stats.grows,
+	       stats.grow_waits, stats.refills, stats.flushes);
+	printf("%lld pages in %lld runs, %lld allocated, %lld cached\n",
+	       stats.run_pages, stats.runs, stats.allocated, stats.cached);
+
+	nvif_pfnpool_drain(&pool);
+	nvif_pfnpool_stats(&pool, &stats);
+	if (stats.allocated) {
+		fprintf(stderr, "%lld pages leaked\n", stats.allocated);
+		failed++;
+	}
+	if (grow_overlap) {
+		fprintf(stderr, "%d concurrent grows\n", grow_overlap);
+		failed++;
+	}
+
+	nvif_pfnpool_fini(&pool);
+	free(thread);
+	free(owner);
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,371 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <core/device.h>
+#include <subdev/bios.h>
+#include <subdev/bios/pll.h>
+#include <subdev/clk/pll.h>
+
+/* Sweeps target frequencies through nv04_pll_calc(), for sets of limits
+ * shaped after the tables nvbios_pll_parse() reads, and checks every result
+ * is identical to what the original exhaustive searches (kept here as a
+ * reference) produce.  Reports the time per solution for the reference, for
+ * the pruned search with nothing remembered, and for targets asked for
+ * again.
+ */
+
+/* The original searches, unmodified. */
+static int
+ref_single(struct nvkm_subdev *subdev, struct nvbios_pll *info, int clk,
+	      int *pN, int *pM, int *pP)
+{
+	/* Find M, N and P for a single stage PLL
+	 *
+	 * Note that some bioses (NV3x) have lookup tables of precomputed MNP
+	 * values, but we're too lazy to use those atm
+	 *
+	 * "clk" parameter in kHz
+	 * returns calculated clock
+	 */
+	struct nvkm_bios *bios = subdev->device->bios;
+	int minvco = info->vco1.min_freq, maxvco = info->vco1.max_freq;
+	int minM = info->vco1.min_m, maxM = info->vco1.max_m;
+	int minN = info->vco1.min_n, maxN = info->vco1.max_n;
+	int minU = info->vco1.min_inputfreq;
+	int maxU = info->vco1.max_inputfreq;
+	int minP = info->min_p;
+	int maxP = info->max_p_usable;
+	int crystal = info->refclk;
+	int M, N, thisP, P;
+	int clkP, calcclk;
+	int delta, bestdelta = INT_MAX;
+	int bestclk = 0;
+
+	/* this division verified for nv20, nv18, nv28 (Haiku), and nv34 */
+	/* possibly correlated with introduction of 27MHz crystal */
+	if (bios->version.major < 0x60) {
+		int cv = bios->version.chip;
+		if (cv < 0x17 || cv == 0x1a || cv == 0x20) {
+			if (clk > 250000)
+				maxM = 6;
+			if (clk > 340000)
+				maxM = 2;
+		} else if (cv < 0x40) {
+			if (clk > 150000)
+				maxM = 6;
+			if (clk > 200000)
+				maxM = 4;
+			if (clk > 340000)
+				maxM = 2;
+		}
+	}
+
+	P = 1 << maxP;
+	if ((clk * P) < minvco) {
+		minvco = clk * maxP;
+		maxvco = minvco * 2;
+	}
+
+	if (clk + clk/200 > maxvco)	/* +0.5% */
+		maxvco = clk + clk/200;
+
+	/* NV34 goes maxlog2P->0, NV20 goes 0->maxlog2P */
+	for (thisP = minP; thisP <= maxP; thisP++) {
+		P = 1 << thisP;
+		clkP = clk * P;
+
+		if (clkP < minvco)
+			continue;
+		if (clkP > maxvco)
+			return bestclk;
+
+		for (M = minM; M <= maxM; M++) {
+			if (crystal/M < minU)
+				return bestclk;
+			if (crystal/M > maxU)
+				continue;
+
+			/* add crystal/2 to round better */
+			N = (clkP * M + crystal/2) / crystal;
+
+			if (N < minN)
+				continue;
+			if (N > maxN)
+				break;
+
+			/* more rounding additions */
+			calcclk = ((N * crystal + P/2) / P + M/2) / M;
+			delta = abs(calcclk - clk);
+			/* we do an exhaustive search rather than terminating
+			 * on an optimality condition...
+			 */
+			if (delta < bestdelta) {
+				bestdelta = delta;
+				bestclk = calcclk;
+				*pN = N;
+				*pM = M;
+				*pP = thisP;
+				if (delta == 0)	/* except this one */
+					return bestclk;
+			}
+		}
+	}
+
+	return bestclk;
+}
+
+static int
+ref_double(struct nvkm_subdev *subdev, struct nvbios_pll *info, int clk,
+	      int *pN1, int *pM1, int *pN2, int *pM2, int *pP)
+{
+	/* Find M, N and P for a two stage PLL
+	 *
+	 * Note that some bioses (NV30+) have lookup tables of precomputed MNP
+	 * values, but we're too lazy to use those atm
+	 *
+	 * "clk" parameter in kHz
+	 * returns calculated clock
+	 */
+	int chip_version = subdev->device->bios->version.chip;
+	int minvco1 = info->vco1.min_freq, maxvco1 = info->vco1.max_freq;
+	int minvco2 = info->vco2.min_freq, maxvco2 = info->vco2.max_freq;
+	int minU1 = info->vco1.min_inputfreq, minU2 = info->vco2.min_inputfreq;
+	int maxU1 = info->vco1.max_inputfreq, maxU2 = info->vco2.max_inputfreq;
+	int minM1 = info->vco1.min_m, maxM1 = info->vco1.max_m;
+	int minN1 = info->vco1.min_n, maxN1 = info->vco1.max_n;
+	int minM2 = info->vco2.min_m, maxM2 = info->vco2.max_m;
+	int minN2 = info->vco2.min_n, maxN2 = info->vco2.max_n;
+	int maxlog2P = info->max_p_usable;
+	int crystal = info->refclk;
+	bool fixedgain2 = (minM2 == maxM2 && minN2 == maxN2);
+	int M1, N1, M2, N2, log2P;
+	int clkP, calcclk1, calcclk2, calcclkout;
+	int delta, bestdelta = INT_MAX;
+	int bestclk = 0;
+
+	int vco2 = (maxvco2 - maxvco2/200) / 2;
+	for (log2P = 0; clk && log2P < maxlog2P && clk <= (vco2 >> log2P); log2P++)
+		;
+	clkP = clk << log2P;
+
+	if (maxvco2 < clk + clk/200)	/* +0.5% */
+		maxvco2 = clk + clk/200;
+
+	for (M1 = minM1; M1 <= maxM1; M1++) {
+		if (crystal/M1 < minU1)
+			return bestclk;
+		if (crystal/M1 > maxU1)
+			continue;
+
+		for (N1 = minN1; N1 <= maxN1; N1++) {
+			calcclk1 = crystal * N1 / M1;
+			if (calcclk1 < minvco1)
+				continue;
+			if (calcclk1 > maxvco1)
+				break;
+
+			for (M2 = minM2; M2 <= maxM2; M2++) {
+				if (calcclk1/M2 < minU2)
+					break;
+				if (calcclk1/M2 > maxU2)
+					continue;
+
+				/* add calcclk1/2 to round better */
+				N2 = (clkP * M2 + calcclk1/2) / calcclk1;
+				if (N2 < minN2)
+					continue;
+				if (N2 > maxN2)
+					break;
+
+				if (!fixedgain2) {
+					if (chip_version < 0x60)
+						if (N2/M2 < 4 || N2/M2 > 10)
+							continue;
+
+					calcclk2 = calcclk1 * N2 / M2;
+					if (calcclk2 < minvco2)
+						break;
+					if (calcclk2 > maxvco2)
+						continue;
+				} else
+					calcclk2 = calcclk1;
+
+				calcclkout = calcclk2 >> log2P;
+				delta = abs(calcclkout - clk);
+				/* we do an exhaustive search rather than terminating
+				 * on an optimality condition...
+				 */
+				if (delta < bestdelta) {
+					bestdelta = delta;
+					bestclk = calcclkout;
+					*pN1 = N1;
+					*pM1 = M1;
+					*pN2 = N2;
+					*pM2 = M2;
+					*pP = log2P;
+					if (delta == 0)	/* except this one */
+						return bestclk;
+				}
+			}
+		}
+	}
+
+	return bestclk;
+}
+
+static int
+ref_nv04(struct nvkm_subdev *subdev, struct nvbios_pll *info, u32 freq,
+	 int *N1, int *M1, int *N2, int *M2, int *P)
+{
+	if (!info->vco2.max_freq || !N2) {
+		int ret = ref_single(subdev, info, freq, N1, M1, P);
+		if (N2) {
+			*N2 = 1;
+			*M2 = 1;
+		}
+		return ret;
+	}
+	return ref_double(subdev, info, freq, N1, M1, N2, M2, P);
+}
+
+
+static const struct pllsim {
+	const char *name;
+	u8 bios_major;
+	u8 bios_chip;
+	u32 lo, hi, step;
+	struct nvbios_pll info;
+} pllsim[] = {
+	/* BMP-era single-stage, using the parser's fallback VCO range. */
+	{ "nv1x vpll", 0x05, 0x11, 20000, 250000, 37,
+	  { .refclk = 14318, .max_p = 4, .max_p_usable = 4,
+	    .vco1 = { 128000, 256000, 0, INT_MAX, 1, 13, 1, 255 } } },
+	/* Table version 0x10/0x11, two stages, with the parser's default
+	 * coefficient ranges.
+	 */
+	{ "nv3x vpll", 0x05, 0x34, 20000, 400000, 37,
+	  { .refclk = 27000, .max_p = 7, .max_p_usable = 6,
+	    .vco1 = { 100000, 400000, 2000, INT_MAX, 1, 13, 1, 255 },
+	    .vco2 = { 400000, 1000000, 5000, INT_MAX, 1, 4, 4, 40 } } },
+	{ "nv4x vpll", 0x05, 0x40, 20000, 400000, 37,
+	  { .refclk = 27000, .max_p = 7, .max_p_usable = 6,
+	    .vco1 = { 100000, 400000, 2000, 50000, 1, 13, 1, 255 },
+	    .vco2 = { 400000, 1000000, 5000, 250000, 1, 4, 4, 31 } } },
+	{ "nv4x core", 0x60, 0x40, 100000, 700000, 131,
+	  { .refclk = 27000, .max_p = 6, .max_p_usable = 6,
+	    .vco1 = { 200000, 600000, 5000, 50000, 1, 14, 4, 255 },
+	    .vco2 = { 400000, 1400000, 25000, 400000, 1, 8, 4, 63 } } },
+	/* Table version 0x30, single-stage NV50 core/shader. */
+	{ "nv50 core", 0x60, 0x50, 100000, 1600000, 211,
+	  { .refclk = 27000, .max_p = 6, .max_p_usable = 6,
+	    .vco1 = { 800000, 1600000, 13500, 27000, 1, 2, 30, 62 } } },
+};
+
+struct result {
+	int ret;
+	int N1, M1, N2, M2, P;
+};
+
+static int
+solve(const struct pllsim *sim, struct nvkm_subdev *subdev, u32 freq,
+      bool ref, struct result *r)
+{
+	struct nvbios_pll info = sim->info;
+
+	memset(r, 0xff, sizeof(*r));
+	if (ref)
+		r->ret = ref_nv04(subdev, &info, freq, &r->N1, &r->M1,
+				  &r->N2, &r->M2, &r->P);
+	else
+		r->ret = nv04_pll_calc(subdev, &info, freq, &r->N1, &r->M1,
+				       &r->N2, &r->M2, &r->P);
+	return r->ret;
+}
+
+int
+main(int argc, char **argv)
+{
+	struct device dev = { .name = "fake" };
+	struct nvkm_bios bios = {};
+	struct nvkm_device device = { .dev = &dev, .cfgopt = "",
+				      .bios = &bios };
+	struct nvkm_subdev subdev = { .device = &device };
+	int loops = 1, bad = 0, c, i, l;
+
+	while ((c = getopt(argc, argv, "n:")) != -1) {
+		switch (c) {
+		case 'n':
+			loops = strtol(optarg, NULL, 0);
+			break;
+		default:
+			return 1;
+		}
+	}
+
+	for (i = 0; i < ARRAY_SIZE(pllsim); i++) {
+		const struct pllsim *sim = &pllsim[i];
+		s64 time[3] = {};
+		int nr = 0, mismatch = 0, failed = 0;
+		struct result a, b;
+		u32 freq;
+
+		bios.version.major = sim->bios_major;
+		bios.version.chip = sim->bios_chip;
+
+		for (freq = sim->lo; freq <= sim->hi; freq += sim->step) {
+			nr++;
+			solve(sim, &subdev, freq, true, &a);
+			nvkm_pll_memo_flush();
+			solve(sim, &subdev, freq, false, &b);
+			if (memcmp(&a, &b, sizeof(a))) {
+				if (!mismatch++)
+					fprintf(stderr, "%s %d: %d %d/%d %d/%d "
+						"%d, expected %d %d/%d %d/%d "
+						"%d\n", sim->name, freq, b.ret,
+						b.N1, b.M1, b.N2, b.M2, b.P,
+						a.ret, a.N1, a.M1, a.N2, a.M2,
+						a.P);
+			}
+			if (a.ret <= 0)
+				failed++;
+		}
+
+		for (l = 0; l < loops; l++) {
+			s64 t = ktime_to_ns(ktime_get());
+			for (freq = sim->lo; freq <= sim->hi; freq += sim->step)
+				solve(sim, &subdev, freq, true, &a);
+			time[0] += ktime_to_ns(ktime_get()) - t;
+
+			nvkm_pll_memo_flush();
+			t = ktime_to_ns(ktime_get());
+			for (freq = sim->lo; freq <= sim->hi; freq += sim->step) {
+				nvkm_pll_memo_flush();
+				solve(sim, &subdev, freq, false, &b);
+			}
+			time[1] += ktime_to_ns(ktime_get()) - t;
+
+			/* Fewer targets than the memo holds, as the clocks
+			 * one board's performance levels use would be, and
+			 * all of them asked for before.
+			 */
+			for (freq = sim->lo; freq < sim->lo + sim->step * 64;
+			     freq += sim->step)
+				solve(sim, &subdev, freq, false, &b);
+			t = ktime_to_ns(ktime_get());
+			for (freq = sim->lo; freq < sim->lo + sim->step * 64;
+			     freq += sim->step)
+				solve(sim, &subdev, freq, false, &b);
+			time[2] += ktime_to_ns(ktime_get()) - t;
+		}
+
+		printf("%-10s: %5d targets, %4d unsolvable, %d mismatched, "
+		       "%7lld ns ref, %7lld ns pruned, %4lld ns remembered\n",
+		       sim->name, nr, failed, mismatch,
+		       time[0] / loops / nr, time[1] / loops / nr,
+		       time[2] / loops / 64);
+		bad += mismatch;
+	}
+
+	return bad ? 1 : 0;
+}
@@ -0,0 +1,283 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <core/device.h>
+#include <subdev/pmu/priv.h>
+
+/* Runs the legacy PMU message interface against a simulated PMU, which
+ * takes packets from an 8-entry command FIFO as gt215's does, and replies
+ * to each of its processes' messages in order, but interleaves replies from
+ * different processes, after a random delay, through a reply FIFO drained
+ * by the receive worker as the interrupt handler would schedule it.
+ *
+ * Several threads (-t) send synchronous requests (-n each), alongside a
+ * stream of asynchronous ones, and every reply is checked to have reached
+ * the request it answers.  Reports how many requests were in flight at
+ * once, which the interface previously limited to one.
+ *
+ * The shim's wait_event() and wait_for_completion() poll, rather than
+ * sleep until woken, so this covers matching replies to requests and the
+ * sequence table's bookkeeping, but a missing wake_up() would go unseen.
+ */
+#define PROCESS_NR 3
+#define FIFO_NR 8
+
+static struct {
+	pthread_mutex_t mutex;
+	struct {
+		u32 process;
+		u32 message;
+		u32 data[2];
+	} cmd[FIFO_NR], msg[64];
+	u32 cmd_get, cmd_put;
+	u32 msg_get, msg_put;
+	bool done;
+
+	u32 flight;
+	u32 flight_max;
+	u64 posted;
+} pmu_sim = { .mutex = PTHREAD_MUTEX_INITIALIZER };
+
+static const u32
+process[PROCESS_NR] = { 0x54534554, 0x53464456, 0x4d454d52 };
+
+/* What the simulated PMU replies with, for a request's data. */
+#define REPLY0(d0,d1) ((d0) ^ 0x5a5a5a5a)
+#define REPLY1(d0,d1) ((d1) + 1)
+
+static int
+fake_send(struct nvkm_pmu *pmu, u32 process, u32 message, u32 data0, u32 data1)
+{
+	/* wait for a free slot in the fifo */
+	pthread_mutex_lock(&pmu_sim.mutex);
+	while (pmu_sim.cmd_put - pmu_sim.cmd_get == FIFO_NR) {
+		pthread_mutex_unlock(&pmu_sim.mutex);
+		sched_yield();
+		pthread_mutex_lock(&pmu_sim.mutex);
+	}
+
+	pmu_sim.cmd[pmu_sim.cmd_put % FIFO_NR].process = process;
+	pmu_sim.cmd[pmu_sim.cmd_put % FIFO_NR].message = message;
+	pmu_sim.cmd[pmu_sim.cmd_put % FIFO_NR].data[0] = data0;
+	pmu_sim.cmd[pmu_sim.cmd_put % FIFO_NR].data[1] = data1;
+	pmu_sim.cmd_put++;
+	pmu_sim.posted++;
+	pmu_sim.flight++;
+	pmu_sim.flight_max = max(pmu_sim.flight_max, pmu_sim.flight);
+	pthread_mutex_unlock(&pmu_sim.mutex);
+	return 0;
+}
+
+static void
+fake_recv(struct nvkm_pmu *pmu)
+{
+	struct nvkm_subdev *subdev = &pmu->subdev;
+	u32 process, message, data0, data1;
+
+	pthread_mutex_lock(&pmu_sim.mutex);
+	while (pmu_sim.msg_get != pmu_sim.msg_put) {
+		process = pmu_sim.msg[pmu_sim.msg_get % 64].process;
+		message = pmu_sim.msg[pmu_sim.msg_get % 64].message;
+		data0   = pmu_sim.msg[pmu_sim.msg_get % 64].data[0];
+		data1   = pmu_sim.msg[pmu_sim.msg_get % 64].data[1];
+		pmu_sim.msg_get++;
+		pmu_sim.flight--;
+		pthread_mutex_unlock(&pmu_sim.mutex);
+
+		if (!nvkm_pmu_reply(pmu, process, message, data0, data1)) {
+			nvkm_error(subdev, "unexpected reply %08x %08x\n",
+				   process, message);
+			abort();
+		}
+
+		pthread_mutex_lock(&pmu_sim.mutex);
+	}
+	pthread_mutex_unlock(&pmu_sim.mutex);
+}
+
+static const struct nvkm_pmu_func
+fake_pmu = {
+	.send = fake_send,
+	.recv = fake_recv,
+};
+
+static const struct nvkm_pmu_fwif
+fake_pmu_fwif[] = {
+	{ -1, gf100_pmu_nofw, &fake_pmu },
+	{}
+};
+
+/* The PMU: takes commands from the FIFO into per-process queues, and
+ * replies to the head of a random process' queue every so often.
+ */
+static void *
+pmu_thread(void *data)
+{
+	struct nvkm_pmu *pmu = data;
+	struct {
+		u32 message;
+		u32 data[2];
+	} queue[PROCESS_NR][FIFO_NR * 64];
+	u32 head[PROCESS_NR] = {}, tail[PROCESS_NR] = {};
+	int i, p;
+
+	while (!READ_ONCE(pmu_sim.done)) {
+		bool pending;
+
+		pthread_mutex_lock(&pmu_sim.mutex);
+		while (pmu_sim.cmd_get != pmu_sim.cmd_put) {
+			typeof(pmu_sim.cmd[0]) *cmd =
+				&pmu_sim.cmd[pmu_sim.cmd_get++ % FIFO_NR];
+			for (p = 0; process[p] != cmd->process; p++);
+			i = tail[p]++ % ARRAY_SIZE(queue[p]);
+			queue[p][i].message = cmd->message;
+			queue[p][i].data[0] = cmd->data[0];
+			queue[p][i].data[1] = cmd->data[1];
+		}
+
+		p = rand() % PROCESS_NR;
+		if (head[p] != tail[p] && pmu_sim.msg_put - pmu_sim.msg_get < 64) {
+			typeof(pmu_sim.msg[0]) *msg =
+				&pmu_sim.msg[pmu_sim.msg_put++ % 64];
+			i = head[p]++ % ARRAY_SIZE(queue[p]);
+			msg->process = process[p];
+			msg->message = queue[p][i].message;
+			msg->data[0] = REPLY0(queue[p][i].data[0],
+					      queue[p][i].data[1]);
+			msg->data[1] = REPLY1(queue[p][i].data[0],
+					      queue[p][i].data[1]);
+		}
+		pending = pmu_sim.msg_get != pmu_sim.msg_put;
+		pthread_mutex_unlock(&pmu_sim.mutex);
+
+		/* let replies queue up, sometimes, before interrupting */
+		if (pending && rand() % 4 == 0)
+			schedule_work(&pmu->recv.work);
+		usleep(rand() % 20);
+	}
+
+	return NULL;
+}
+
+static struct nvkm_pmu *pmu;
+static int loops = 2000;
+static int errors;
+static u64 async_sent, async_done;
+
+static void
+async_reply(void *priv, u32 data0, u32 data1)
+{
+	u32 sent = (unsigned long)priv;
+
+	if (data0 != REPLY0(sent, ~sent) || data1 != REPLY1(sent, ~sent)) {
+		fprintf(stderr, "async %08x got reply %08x %08x\n",
+			sent, data0, data1);
+		__sync_fetch_and_add(&errors, 1);
+	}
+	__sync_fetch_and_add(&async_done, 1);
+}
+
+static void *
+send_thread(void *data)
+{
+	const unsigned long id = (unsigned long)data;
+	u32 reply[2];
+	int i, ret;
+
+	for (i = 0; i < loops; i++) {
+		const int p = (id + i) % PROCESS_NR;
+		const u32 message = i % 2 ? 0x3 : 0x4;
+		const u32 data0 = (id << 24) | i;
+		const u32 data1 = rand();
+
+		ret = nvkm_pmu_send(pmu, reply, process[p], message,
+				    data0, data1);
+		if (ret || reply[0] != REPLY0(data0, data1) ||
+			   reply[1] != REPLY1(data0, data1)) {
+			fprintf(stderr, "send %08x %08x got %d %08x %08x\n",
+				data0, data1, ret, reply[0], reply[1]);
+			__sync_fetch_and_add(&errors, 1);
+		}
+
+		/* every so often, fire off a request without waiting */
+		if (i % 4 == 0) {
+			const u32 sent = 0x80000000 | (id << 24) | i;
+			ret = nvkm_pmu_send_async(pmu, async_reply,
+						  (void *)(unsigned long)sent,
+						  process[(p + 1) % PROCESS_NR],
+						  message, sent, ~sent);
+			if (ret)
+				__sync_fetch_and_add(&errors, 1);
+			else
+				__sync_fetch_and_add(&async_sent, 1);
+		}
+	}
+
+	return NULL;
+}
+
+int
+main(int argc, char **argv)
+{
+	struct device dev = { .name = "fake" };
+	struct nvkm_device device = { .dev = &dev, .cfgopt = "" };
+	struct nvkm_subdev *subdev;
+	pthread_t responder, thread[64];
+	int threads = 8;
+	s64 time;
+	int ret, c, i;
+
+	while ((c = getopt(argc, argv, "t:n:")) != -1) {
+		switch (c) {
+		case 't':
+			threads = min(64, (int)strtol(optarg, NULL, 0));
+			break;
+		case 'n':
+			loops = strtol(optarg, NULL, 0);
+			break;
+		default:
+			return 1;
+		}
+	}
+
+	mutex_init(&device.mutex);
+	INIT_LIST_HEAD(&device.falcon);
+	ret = nvkm_pmu_new_(fake_pmu_fwif, &device, NVKM_SUBDEV_PMU, &pmu);
+	if (ret)
+		return 1;
+
+	srand(0);
+	pthread_create(&responder, NULL, pmu_thread, pmu);
+
+	time = ktime_to_ns(ktime_get());
+	for (i = 0; i < threads; i++)
+		pthread_create(&thread[i], NULL, send_thread, (void *)(long)i);
+	for (i = 0; i < threads; i++)
+		pthread_join(thread[i], NULL);
+	while (READ_ONCE(async_done) != async_sent) {
+		schedule_work(&pmu->recv.work);
+		usleep(10);
+	}
+	time = ktime_to_ns(ktime_get()) - time;
+
+	WRITE_ONCE(pmu_sim.done, true);
+	pthread_join(responder, NULL);
+	flush_work(&pmu->recv.work);
+
+	for (i = 0; i < NVKM_PMU_SEQ_NUM; i++) {
+		if (pmu->recv.seq[i].state != NVKM_PMU_SEQ_FREE ||
+		    test_bit(i, pmu->recv.tbl)) {
+			fprintf(stderr, "sequence %d not released\n", i);
+			errors++;
+		}
+	}
+
+	printf("%lld requests, %lld async, %d errors, %u max in flight, "
+	       "%lld us/request\n", pmu_sim.posted, async_sent, errors,
+	       pmu_sim.flight_max, time / 1000 / max(pmu_sim.posted, 1ULL));
+
+	subdev = &pmu->subdev;
+	nvkm_subdev_del(&subdev);
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,147 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <nvif/push.h>
+
+/* Decodes a captured push buffer (raw 32-bit words), reports how densely
+ * it's encoded, and how it compares to the encoder's output for the same
+ * method stream.
+ */
+static void
+print_stats(const char *name, struct nvif_push_stats *stats)
+{
+	const u32 hdrs = nvif_push_stats_hdrs(stats);
+
+	printf("%-8s: %6d words, %6d mthds, %6d headers "
+	       "(%d inc, %d ninc, %d one, %d imm), %d.%02d mthds/word\n",
+	       name, stats->words, stats->mthds, hdrs,
+	       stats->inc, stats->ninc, stats->one, stats->imm,
+	       stats->words ? stats->mthds / stats->words : 0,
+	       stats->words ? (stats->mthds * 100 / stats->words) % 100 : 0);
+}
+
+static u32 *
+load(const char *path, int *pnr)
+{
+	FILE *file = fopen(path, "rb");
+	u32 *push = NULL;
+	long size;
+
+	if (!file)
+		return NULL;
+
+	if (!fseek(file, 0, SEEK_END) && (size = ftell(file)) >= 0 &&
+	    !fseek(file, 0, SEEK_SET)) {
+		*pnr = size / 4;
+		if ((push = malloc(*pnr * 4 + 4)) &&
+		    fread(push, 4, *pnr, file) != *pnr) {
+			free(push);
+			push = NULL;
+		}
+	}
+
+	fclose(file);
+	return push;
+}
+
+int
+main(int argc, char **argv)
+{
+	enum nvif_push_fmt fmt = NVIF_PUSH_NVC0;
+	struct nvif_push_stats stats;
+	struct nvif_push_mthd *mthds = NULL;
+	u32 *push, *opt = NULL;
+	int verbose = 0, loops = 0;
+	int ret, nr, c, i;
+
+	while ((c = getopt(argc, argv, "f:t:v")) != -1) {
+		switch (c) {
+		case 'f':
+			if (!strcmp(optarg, "nv04"))
+				fmt = NVIF_PUSH_NV04;
+			else
+			if (!strcmp(optarg, "nvc0"))
+				fmt = NVIF_PUSH_NVC0;
+			else
+			if (!strcmp(optarg, "evo"))
+				fmt = NVIF_PUSH_EVO;
+			else
+				return 1;
+			break;
+		case 't':
+			loops = strtol(optarg, NULL, 0);
+			break;
+		case 'v':
+			verbose++;
+			break;
+		default:
+			return 1;
+		}
+	}
+
+	if (optind >= argc) {
+		fprintf(stderr, "usage: %s [-f nv04|nvc0|evo] [-t loops] [-v] "
+				"file\n", argv[0]);
+		return 1;
+	}
+
+	if (!(push = load(argv[optind], &nr))) {
+		fprintf(stderr, "failed to read %s\n", argv[optind]);
+		return 1;
+	}
+
+	ret = nvif_push_decode(fmt, push, nr, NULL, 0, &stats);
+	if (ret < 0) {
+		fprintf(stderr, "malformed push buffer, %d\n", ret);
+		goto done;
+	}
+
+	if (!(mthds = calloc(ret * 2 + 1, sizeof(*mthds))) ||
+	    !(opt = malloc(sizeof(*opt) * (nr + 1)))) {
+		ret = -ENOMEM;
+		goto done;
+	}
+
+	nvif_push_decode(fmt, push, nr, mthds, ret, NULL);
+	if (verbose) {
+		for (i = 0; i < stats.mthds; i++) {
+			printf("%d:%04x %08x\n", mthds[i].subc,
+			       mthds[i].mthd, mthds[i].data);
+		}
+	}
+	print_stats("captured", &stats);
+
+	ret = nvif_push_encode(fmt, mthds, stats.mthds, opt, nr, &stats);
+	if (ret < 0) {
+		fprintf(stderr, "failed to re-encode, %d\n", ret);
+		goto done;
+	}
+	print_stats("encoded", &stats);
+
+	/* check the encoder's output writes exactly the same methods */
+	nr = ret;
+	ret = nvif_push_decode(fmt, opt, nr, mthds + stats.mthds, stats.mthds,
+			       NULL);
+	if (ret != stats.mthds ||
+	    memcmp(mthds, mthds + ret, ret * sizeof(*mthds))) {
+		fprintf(stderr, "re-encoded stream doesn't decode, %d\n", ret);
+		ret = -EINVAL;
+		goto done;
+	}
+
+	if (loops > 0) {
+		s64 time = ktime_to_ns(ktime_get());
+		for (i = 0; i < loops; i++)
+			nvif_push_encode(fmt, mthds, stats.mthds, opt, nr, NULL);
+		time = ktime_to_ns(ktime_get()) - time;
+		printf("encode  : %lld ns\n", time / loops);
+	}
+
+	ret = 0;
+done:
+	free(opt);
+	free(mthds);
+	free(push);
+	return ret;
+}
@@ -0,0 +1,328 @@
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <core/device.h>
+#include <subdev/bios/pll.h>
+#include <subdev/clk/pll.h>
+#include <subdev/fb/ramfuc.h>
+#include <subdev/pmu/priv.h>
+#include <subdev/pmu/fuc/os.h>
+
+/* Times building memory reclock scripts through ramfuc, against replaying
+ * them from the cache ramfuc keeps (NvMemScriptCache), switching back and
+ * forth between a handful of memory clocks as pstate changes would.
+ *
+ * The script generator is shaped after gk104_ram_calc_xits(): it solves a
+ * PLL, reads back the MRs and a couple of hundred other registers, and emits masked
+ * writes, waits and delays depending on the target, leaving coefficients,
+ * a mode and the MRs behind for prog().  Registers are plain memory here,
+ * so the time spent reading them, which building and validating a cached
+ * script do alike, is mostly left out.  The shim's waits for the PMU's
+ * replies sleep, so it's CPU time that's reported, less that of the two
+ * round trips to the PMU that every reclock takes either way.
+ *
+ * Checks that a replay leaves behind exactly what building the script
+ * would have, and that changing a register the script read forces it to
+ * be built again.
+ */
+#define REG_NR 192
+
+static const u32
+freqs[] = { 324000, 648000, 1620000, 3004000 };
+
+struct sim_state {
+	int mode;
+	int N, fN, M, P;
+	u32 mr[16];
+	u32 freq;
+};
+
+static struct {
+	struct ramfuc base;
+	struct nvbios_pll refpll;
+	struct ramfuc_reg r_reg[REG_NR];
+	struct ramfuc_reg r_mr[16];
+	struct ramfuc_reg r_0x1373f4;
+
+	struct sim_state state;
+	int built;
+} fuc;
+
+static int
+sim_calc_xits(struct nvkm_fb *fb, struct nvkm_ram_data *next)
+{
+	struct ramfuc *ram = &fuc.base;
+	struct sim_state *state = &fuc.state;
+	int ret, i;
+
+	ret = ramfuc_init(ram, fb);
+	if (ret)
+		return ret;
+
+	fuc.built++;
+	state->mode = (next->freq > fuc.refpll.vco1.max_freq) ? 2 : 1;
+	ret = gt215_pll_calc(&fb->subdev, &fuc.refpll, next->freq / state->mode,
+			     &state->N, &state->fN, &state->M, &state->P);
+	if (ret <= 0)
+		return -EINVAL;
+
+	if ((ramfuc_rd32(ram, &fuc.r_0x1373f4) & 0xf) != state->mode)
+		ramfuc_mask(ram, &fuc.r_0x1373f4, 0x0000000f, state->mode);
+	ramfuc_block(ram);
+
+	for (i = 0; i < ARRAY_SIZE(fuc.r_mr); i++) {
+		state->mr[i] = ramfuc_rd32(ram, &fuc.r_mr[i]);
+		state->mr[i] &= ~0x0ff;
+		state->mr[i] |= next->bios.timing[i % 11] & 0x0ff;
+	}
+	state->freq = next->freq;
+
+	for (i = 0; i < REG_NR; i++) {
+		const u32 mask = 0x000000ff << ((i % 4) * 8);
+		const u32 data = ((next->freq >> (i % 8)) ^
+				  next->bios.timing[i % 11]) & mask;
+
+		ramfuc_mask(ram, &fuc.r_reg[i], mask, data);
+		if (i % 8 == 7)
+			ramfuc_wait(ram, fuc.r_reg[i].addr, mask, data, 1000);
+		if (i % 16 == 15)
+			ramfuc_nsec(ram, 2000);
+	}
+
+	if (state->mode == 2)
+		ramfuc_train(ram);
+
+	for (i = 0; i < ARRAY_SIZE(fuc.r_mr); i++)
+		ramfuc_wr32(ram, &fuc.r_mr[i], state->mr[i]);
+
+	ramfuc_unblock(ram);
+	return 0;
+}
+
+/* As gk104_ram_calc() does. */
+static int
+sim_calc(struct nvkm_fb *fb, struct nvkm_ram_data *next)
+{
+	struct sim_state state;
+	int ret;
+
+	ret = ramfuc_script_exec(&fuc.base, fb, next, &state, sizeof(state));
+	if (ret != -ENOENT) {
+		if (ret == 0)
+			fuc.state = state;
+		return ret;
+	}
+
+	ramfuc_script_begin(&fuc.base, next);
+	ret = sim_calc_xits(fb, next);
+	state = fuc.state;
+	ramfuc_script_end(&fuc.base, ret, &state, sizeof(state));
+	return ret;
+}
+
+static int
+fake_send(struct nvkm_pmu *pmu, u32 process, u32 message, u32 data0, u32 data1)
+{
+	/* MEMX_MSG_INFO asks where the script goes, in the PMU's memory */
+	if (message == MEMX_MSG_INFO)
+		nvkm_pmu_reply(pmu, process, message, 0x1000, 0x1000);
+	else
+		nvkm_pmu_reply(pmu, process, message, 0, 0);
+	return 0;
+}
+
+static const struct nvkm_pmu_func
+fake_pmu = {
+	.send = fake_send,
+};
+
+static const struct nvkm_pmu_fwif
+fake_pmu_fwif[] = {
+	{ -1, gf100_pmu_nofw, &fake_pmu },
+	{}
+};
+
+static void
+sim_next(struct nvkm_ram_data *next, int i)
+{
+	int j;
+
+	memset(next, 0x00, sizeof(*next));
+	next->freq = freqs[i];
+	for (j = 0; j < ARRAY_SIZE(next->bios.timing); j++)
+		next->bios.timing[j] = (freqs[i] / 1000) * (j + 1);
+}
+
+static s64
+sim_time(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+	return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static s64
+sim_memx(struct nvkm_fb *fb, int loops)
+{
+	struct nvkm_memx *memx;
+	s64 time;
+	int i;
+
+	time = sim_time();
+	for (i = 0; i < loops; i++) {
+		if (nvkm_memx_init(fb->subdev.device->pmu, &memx))
+			return -EINVAL;
+		nvkm_memx_fini(&memx, true);
+	}
+
+	return (sim_time() - time) / loops;
+}
+
+static s64
+sim_run(struct nvkm_fb *fb, int loops, bool cache)
+{
+	struct nvkm_ram_data next;
+	s64 time;
+	int i, ret;
+
+	fuc.base.cache = cache;
+	fuc.built = 0;
+
+	time = sim_time();
+	for (i = 0; i < loops; i++) {
+		sim_next(&next, i % ARRAY_SIZE(freqs));
+		ret = sim_calc(fb, &next);
+		ramfuc_exec(&fuc.base, true);
+		if (ret)
+			return ret;
+	}
+
+	return (sim_time() - time) / loops;
+}
+
+int
+main(int argc, char **argv)
+{
+	struct device dev = { .name = "fake" };
+	struct nvkm_device device = { .dev = &dev, .cfgopt = "" };
+	struct nvkm_fb fb = { .subdev.device = &device };
+	struct nvkm_ram_data next;
+	struct nvkm_subdev *subdev;
+	struct nvkm_pmu *pmu;
+	struct sim_state built;
+	int loops = 10000;
+	s64 cold, warm, memx;
+	int ret, c, i;
+
+	while ((c = getopt(argc, argv, "l:")) != -1) {
+		switch (c) {
+		case 'l':
+			loops = strtol(optarg, NULL, 0);
+			break;
+		default:
+			return 1;
+		}
+	}
+
+	if (!(device.pri = calloc(1, 0x1000000)))
+		return 1;
+
+	mutex_init(&device.mutex);
+	INIT_LIST_HEAD(&device.falcon);
+	ret = nvkm_pmu_new_(fake_pmu_fwif, &device, NVKM_SUBDEV_PMU, &pmu);
+	if (ret)
+		return 1;
+	device.pmu = pmu;
+
+	fuc.refpll.refclk = 27000;
+	fuc.refpll.vco1.min_freq = 800000;
+	fuc.refpll.vco1.max_freq = 1700000;
+	fuc.refpll.vco1.min_inputfreq = 13500;
+	fuc.refpll.vco1.max_inputfreq = 27000;
+	fuc.refpll.vco1.min_m = 1;
+	fuc.refpll.vco1.max_m = 255;
+	fuc.refpll.vco1.min_n = 1;
+	fuc.refpll.vco1.max_n = 255;
+	fuc.refpll.min_p = 1;
+	fuc.refpll.max_p = 31;
+
+	ramfuc_script_ctor(&fuc.base, &fb);
+	for (i = 0; i < REG_NR; i++)
+		fuc.r_reg[i] = ramfuc_reg(0x10f200 + i * 4);
+	for (i = 0; i < ARRAY_SIZE(fuc.r_mr); i++)
+		fuc.r_mr[i] = ramfuc_reg(0x10f800 + i * 4);
+	fuc.r_0x1373f4 = ramfuc_reg(0x1373f4);
+
+	/* Best of a few runs, the PMU round trips' polling is noisy. */
+	cold = warm = memx = LLONG_MAX;
+	for (i = 0; i < 5; i++) {
+		s64 time;
+
+		time = sim_run(&fb, loops, false);
+		if (time < 0 || fuc.built != loops) {
+			ret = -EINVAL;
+			goto done;
+		}
+		cold = min(cold, time);
+
+		time = sim_run(&fb, loops, true);
+		if (time < 0 || fuc.built > ARRAY_SIZE(freqs)) {
+			fprintf(stderr, "%d of %d scripts built\n",
+				fuc.built, loops);
+			ret = -EINVAL;
+			goto done;
+		}
+		warm = min(warm, time);
+
+		time = sim_memx(&fb, loops);
+		if (time < 0) {
+			ret = -EINVAL;
+			goto done;
+		}
+		memx = min(memx, time);
+	}
+
+	printf("%lld ns built, %lld ns replayed, CPU time per reclock\n",
+	       max(cold - memx, 0LL), max(warm - memx, 0LL));
+
+	/* A replay leaves behind what building would have. */
+	for (i = 0; i < ARRAY_SIZE(freqs); i++) {
+		sim_next(&next, i);
+		fuc.base.cache = false;
+		sim_calc(&fb, &next);
+		ramfuc_exec(&fuc.base, false);
+		built = fuc.state;
+
+		memset(&fuc.state, 0xcc, sizeof(fuc.state));
+		fuc.base.cache = true;
+		fuc.built = 0;
+		sim_calc(&fb, &next);
+		ramfuc_exec(&fuc.base, false);
+		if (fuc.built || memcmp(&built, &fuc.state, sizeof(built))) {
+			fprintf(stderr, "%d kHz: replay left different state\n",
+				freqs[i]);
+			ret = -EINVAL;
+		}
+	}
+
+	/* Something it read changed, so the script's built again. */
+	nvkm_wr32(&device, 0x10f804, nvkm_rd32(&device, 0x10f804) ^ 0x100);
+	fuc.built = 0;
+	sim_next(&next, 0);
+	sim_calc(&fb, &next);
+	ramfuc_exec(&fuc.base, false);
+	if (fuc.built != 1) {
+		fprintf(stderr, "stale script replayed\n");
+		ret = -EINVAL;
+	}
+
+done:
+	ramfuc_script_dtor(&fuc.base);
+	subdev = &pmu->subdev;
+	nvkm_subdev_del(&subdev);
+	free(device.pri);
+	return ret ? 1 : 0;
+}
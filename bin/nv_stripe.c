@@ -0,0 +1,127 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <nvif/stripe.h>
+
+/* Plans a striped copy of a buffer across engines of the given relative
+ * throughput (one weight per engine), checks the plan covers the buffer
+ * exactly, and estimates the speedup over using only the first engine.
+ */
+int
+main(int argc, char **argv)
+{
+	u32 weight[NVIF_STRIPE_MAX], pages = 65536, share_min = 256;
+	u32 chunk_max = 8191, expect = 0;
+	u64 busy[NVIF_STRIPE_MAX] = {}, slowest = 0, single;
+	u32 start[NVIF_STRIPE_MAX], next[NVIF_STRIPE_MAX], end = 0;
+	struct nvif_stripe *stripe;
+	int verbose = 0, loops = 0;
+	int ret, nr = 0, c, i;
+
+	while ((c = getopt(argc, argv, "p:m:c:t:v")) != -1) {
+		switch (c) {
+		case 'p':
+			pages = strtoul(optarg, NULL, 0);
+			break;
+		case 'm':
+			share_min = strtoul(optarg, NULL, 0);
+			break;
+		case 'c':
+			chunk_max = strtoul(optarg, NULL, 0);
+			break;
+		case 't':
+			loops = strtol(optarg, NULL, 0);
+			break;
+		case 'v':
+			verbose++;
+			break;
+		default:
+			return 1;
+		}
+	}
+
+	while (optind < argc && nr < NVIF_STRIPE_MAX)
+		weight[nr++] = strtoul(argv[optind++], NULL, 0);
+	if (!nr || !chunk_max) {
+		fprintf(stderr, "usage: %s [-p pages] [-m share_min] "
+				"[-c chunk_max] [-t loops] [-v] weight...\n",
+			argv[0]);
+		return 1;
+	}
+
+	ret = nvif_stripe_plan(pages, weight, nr, share_min, chunk_max,
+			       NULL, 0);
+	if (ret < 0 || !(stripe = calloc(ret + 1, sizeof(*stripe))))
+		return 1;
+
+	ret = nvif_stripe_plan(pages, weight, nr, share_min, chunk_max,
+			       stripe, ret);
+	for (i = 0; i < ret; i++) {
+		const struct nvif_stripe *s = &stripe[i];
+
+		if (verbose) {
+			printf("%4d: engine %2d, pages %08x-%08x (%d)\n",
+			       i, s->engine, s->first, s->first + s->count - 1,
+			       s->count);
+		}
+
+		/* Each engine's chunks must run on from each other. */
+		if (s->engine < nr && !busy[s->engine])
+			start[s->engine] = next[s->engine] = s->first;
+		if (s->engine >= nr || !s->count || s->count > chunk_max ||
+		    s->first != next[s->engine]) {
+			fprintf(stderr, "chunk %d out of place\n", i);
+			ret = -EINVAL;
+			goto done;
+		}
+		next[s->engine] += s->count;
+		busy[s->engine] += s->count;
+		expect += s->count;
+	}
+
+	/* And each engine's range follow on from the previous engine's. */
+	for (i = 0; i < nr; i++) {
+		if (busy[i]) {
+			if (start[i] != end)
+				break;
+			end = next[i];
+		}
+	}
+
+	if (i < nr || end != pages || expect != pages) {
+		fprintf(stderr, "plan doesn't cover %d pages exactly\n", pages);
+		ret = -EINVAL;
+		goto done;
+	}
+
+	/* Time taken by each engine, in units of pages at weight 1. */
+	for (i = 0; i < nr; i++) {
+		if (busy[i]) {
+			u64 time = busy[i] * 1000 / (weight[i] ? weight[i] : 1);
+			slowest = max(slowest, time);
+			printf("engine %2d: %8lld pages\n", i, busy[i]);
+		}
+	}
+
+	/* Compared to doing it all on engine 0. */
+	single = (u64)pages * 1000 * 100 / (weight[0] ? weight[0] : 1);
+	printf("%d chunks, estimated speedup %lld.%02lldx\n", ret,
+	       slowest ? single / slowest / 100 : 1,
+	       slowest ? single / slowest % 100 : 0);
+
+	if (loops > 0) {
+		s64 time = ktime_to_ns(ktime_get());
+		for (i = 0; i < loops; i++) {
+			nvif_stripe_plan(pages, weight, nr, share_min,
+					 chunk_max, stripe, ret);
+		}
+		time = ktime_to_ns(ktime_get()) - time;
+		printf("plan    : %lld ns\n", time / loops);
+	}
+
+	ret = 0;
+done:
+	free(stripe);
+	return ret;
+}
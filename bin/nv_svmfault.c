@@ -0,0 +1,233 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <nvif/fault.h>
+
+/* Replays a GPU access stream (recorded, one hex address per line, or
+ * generated) against the SVM fault window policy, and the fixed 16-page
+ * window it replaced, counting the fault/replay round-trips each needs.
+ *
+ * Faults are taken in batches, as the GPU would report them while the
+ * first is outstanding.
+ */
+struct policy {
+	const char *name;
+	struct nvif_fault_window window;
+	unsigned long *mapped;
+	u64 replays;
+};
+
+static u64 *trace;
+static u64 trace_nr;
+static u64 pages = 1ULL << 18;
+
+static int
+load(const char *path)
+{
+	FILE *file = fopen(path, "r");
+	u64 size = 0, base = ~0ULL, i;
+	char line[64];
+
+	if (!file)
+		return -ENOENT;
+
+	while (fgets(line, sizeof(line), file)) {
+		if (line[0] == '#' || line[0] == '\n')
+			continue;
+		if (trace_nr == size) {
+			u64 *temp = realloc(trace, (size = size * 2 + 4096) *
+					    sizeof(*trace));
+			if (!temp) {
+				fclose(file);
+				return -ENOMEM;
+			}
+			trace = temp;
+		}
+		trace[trace_nr] = strtoull(line, NULL, 16) >> 12;
+		base = min(base, trace[trace_nr]);
+		trace_nr++;
+	}
+	fclose(file);
+
+	/* Only the span of the trace is treated as the VMA. */
+	for (i = 0, pages = 1; i < trace_nr; i++) {
+		trace[i] -= base;
+		pages = max(pages, trace[i] + 1);
+	}
+
+	return 0;
+}
+
+static int
+generate(const char *type, u64 nr)
+{
+	u64 i, run = 0, page = 0;
+	int stride = 1;
+
+	if (!(trace = malloc(nr * sizeof(*trace))))
+		return -ENOMEM;
+
+	if (!strncmp(type, "stride:", 7))
+		stride = strtol(type + 7, NULL, 0);
+	else
+	if (strcmp(type, "seq") && strcmp(type, "rand") && strcmp(type, "runs"))
+		return -EINVAL;
+
+	for (i = 0; i < nr; i++) {
+		if (!strcmp(type, "rand")) {
+			page = (u64)rand() * rand() % pages;
+		} else
+		if (!strcmp(type, "runs")) {
+			/* Streams of up to 4MiB from random places. */
+			if (!run--) {
+				run = rand() % 1024;
+				page = (u64)rand() * rand() % pages;
+			} else {
+				page = (page + 1) % pages;
+			}
+		} else {
+			page = (i * stride) % pages;
+		}
+		trace[trace_nr++] = page;
+	}
+
+	return 0;
+}
+
+static int
+cmp(const void *a, const void *b)
+{
+	const u64 *x = a, *y = b;
+	return *x < *y ? -1 : *x > *y;
+}
+
+static void
+handle(struct policy *p, u64 *fault, int nr)
+{
+	int fi, fn;
+	u64 page;
+
+	qsort(fault, nr, sizeof(*fault), cmp);
+
+	for (fi = 0; fi < nr; fi = fn) {
+		u64 start = fault[fi], limit;
+		bool prefetch;
+
+		limit = start + nvif_fault_window(&p->window, start, &prefetch);
+		limit = min(limit, pages);
+
+		for (fn = fi; fn < nr && fault[fn] < limit; fn++) {
+			if (fn > fi && fault[fn] == fault[fn - 1])
+				continue;
+			__set_bit(fault[fn], p->mapped);
+		}
+
+		if (prefetch) {
+			for (page = start; page < limit; page++)
+				__set_bit(page, p->mapped);
+		} else {
+			limit = fault[fn - 1] + 1;
+		}
+
+		nvif_fault_window_done(&p->window, start, limit - start, fn - fi,
+				       prefetch ? limit - start - (fn - fi) : 0);
+	}
+
+	p->replays++;
+}
+
+static void
+run(struct policy *p, int batch, u64 *fault)
+{
+	u64 pos = 0, i;
+	int nr;
+
+	while (pos < trace_nr) {
+		/* Everything up to the point the batch fills is mapped once
+		 * it's been handled, so carry on from there.
+		 */
+		for (i = pos, nr = 0; i < trace_nr && nr < batch; i++) {
+			if (!test_bit(trace[i], p->mapped))
+				fault[nr++] = trace[i];
+		}
+
+		if (nr)
+			handle(p, fault, nr);
+		pos = i;
+	}
+}
+
+static void
+print(struct policy *p)
+{
+	const struct nvif_fault_window_stats *stats = &p->window.stats;
+
+	printf("%-8s: %8lld replays, %8lld windows, %9lld faults, "
+	       "%9lld pages (%lld prefetched), grew %lld, shrank %lld\n",
+	       p->name, p->replays, stats->windows, stats->faults,
+	       stats->pages, stats->prefetch, stats->grow, stats->shrink);
+}
+
+int
+main(int argc, char **argv)
+{
+	struct policy policy[] = {
+		{ .name = "fixed" },
+		{ .name = "adaptive" },
+	};
+	const char *type = "seq";
+	int batch = 32, min = 16, max = 512;
+	u64 nr = 1 << 20, *fault;
+	int ret, c, i;
+
+	while ((c = getopt(argc, argv, "b:g:m:M:n:p:")) != -1) {
+		switch (c) {
+		case 'b': batch = strtol(optarg, NULL, 0); break;
+		case 'g': type = optarg; break;
+		case 'm': min = strtol(optarg, NULL, 0); break;
+		case 'M': max = strtol(optarg, NULL, 0); break;
+		case 'n': nr = strtoull(optarg, NULL, 0); break;
+		case 'p': pages = strtoull(optarg, NULL, 0); break;
+		default:
+			return 1;
+		}
+	}
+
+	if (optind < argc)
+		ret = load(argv[optind]);
+	else
+		ret = generate(type, nr);
+	if (ret || batch <= 0 || !pages) {
+		fprintf(stderr, "usage: %s [-g seq|rand|runs|stride:N] [-n accesses] "
+				"[-p pages] [-b batch] [-m min] [-M max] [trace]\n",
+			argv[0]);
+		return 1;
+	}
+
+	if (!(fault = malloc(batch * sizeof(*fault))))
+		return 1;
+
+	nvif_fault_window_init(&policy[0].window, 16, 16);
+	nvif_fault_window_init(&policy[1].window, min, max);
+	for (i = 0; i < ARRAY_SIZE(policy); i++) {
+		policy[i].mapped = calloc(BITS_TO_LONGS(pages), sizeof(long));
+		if (!policy[i].mapped) {
+			fprintf(stderr, "trace spans too many pages\n");
+			return 1;
+		}
+		run(&policy[i], batch, fault);
+		print(&policy[i]);
+	}
+
+	printf("%lld accesses, %lld replays saved (%lld%%)\n", trace_nr,
+	       policy[0].replays - policy[1].replays, policy[0].replays ?
+	       (s64)(policy[0].replays - policy[1].replays) * 100 /
+	       (s64)policy[0].replays : 0);
+
+	for (i = 0; i < ARRAY_SIZE(policy); i++)
+		free(policy[i].mapped);
+	free(fault);
+	free(trace);
+	return 0;
+}
@@ -0,0 +1,376 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <core/device.h>
+#include <subdev/gpio.h>
+#include <subdev/i2c.h>
+#include <subdev/therm/priv.h>
+#include <subdev/timer/priv.h>
+
+/* Runs thermal management against a simulated sensor and fan, with time
+ * provided by a simulated PTIMER, through a workload's phases: idling,
+ * heating up under load, a sensor that flickers between two readings,
+ * overheating past the fan boost threshold, and cooling down again.
+ *
+ * Reports how many times per minute each phase woke the CPU, and read
+ * the sensor, and checks that crossing the fan boost threshold is acted
+ * upon in time.  With -i, the thresholds are handled by (simulated)
+ * hardware interrupts rather than polled.
+ *
+ * Also checks, at a steady temperature, that changing the fan's duty
+ * limits is acted upon, and that a fan boost doesn't outlast the next poll
+ * or two once fan management can take over again.
+ */
+#define STEP 100000000ULL
+
+static struct {
+	u64 time;
+	u64 due;
+	bool armed;
+
+	u64 intrs;
+} ptimer;
+
+static struct {
+	int temp;
+	u64 reads;
+
+	int duty;
+	u64 changes;
+
+	u64 intrs;
+} sensor;
+
+static u64
+fake_read(struct nvkm_timer *tmr)
+{
+	return ptimer.time;
+}
+
+static void
+fake_time(struct nvkm_timer *tmr, u64 time)
+{
+	ptimer.time = time;
+}
+
+static void
+fake_alarm_init(struct nvkm_timer *tmr, u32 time)
+{
+	ptimer.due = (ptimer.time & ~0xffffffffULL) | time;
+	if (ptimer.due <= ptimer.time)
+		ptimer.due += 1ULL << 32;
+	ptimer.armed = true;
+}
+
+static void
+fake_alarm_fini(struct nvkm_timer *tmr)
+{
+	ptimer.armed = false;
+}
+
+static const struct nvkm_timer_func
+fake_timer = {
+	.read = fake_read,
+	.time = fake_time,
+	.alarm_init = fake_alarm_init,
+	.alarm_fini = fake_alarm_fini,
+};
+
+static void
+ptimer_run(struct nvkm_timer *tmr, u64 end)
+{
+	while (ptimer.armed && ptimer.due <= end) {
+		ptimer.time = ptimer.due;
+		ptimer.due += 1ULL << 32;
+		ptimer.intrs++;
+		nvkm_timer_alarm_trigger(tmr);
+	}
+
+	ptimer.time = end;
+}
+
+static int
+fake_temp_get(struct nvkm_therm *therm)
+{
+	sensor.reads++;
+	return sensor.temp;
+}
+
+static void
+fake_program_alarms(struct nvkm_therm *therm)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&therm->sensor.alarm_program_lock, flags);
+	therm->sensor.poll_thrs = false;
+	spin_unlock_irqrestore(&therm->sensor.alarm_program_lock, flags);
+}
+
+static const struct nvkm_therm_func
+fake_therm_poll = {
+	.temp_get = fake_temp_get,
+	.program_alarms = nvkm_therm_program_alarms_polling,
+};
+
+static const struct nvkm_therm_func
+fake_therm_intr = {
+	.temp_get = fake_temp_get,
+	.program_alarms = fake_program_alarms,
+};
+
+/* Raises a threshold's interrupt if the temperature's crossed it, as the
+ * hardware would, and handles it as g84_therm_intr() does.
+ */
+static void
+sensor_intr(struct nvkm_therm *therm, enum nvkm_therm_thrs thrs_name,
+	    const struct nvbios_therm_threshold *thrs)
+{
+	enum nvkm_therm_thrs_state state;
+	unsigned long flags;
+
+	spin_lock_irqsave(&therm->sensor.alarm_program_lock, flags);
+	state = nvkm_therm_sensor_get_threshold_state(therm, thrs_name);
+	if (state == NVKM_THERM_THRS_LOWER && sensor.temp >= thrs->temp) {
+		nvkm_therm_sensor_set_threshold_state(therm, thrs_name,
+						      NVKM_THERM_THRS_HIGHER);
+		nvkm_therm_sensor_event(therm, thrs_name,
+					NVKM_THERM_THRS_RISING);
+		sensor.intrs++;
+	} else
+	if (state == NVKM_THERM_THRS_HIGHER &&
+	    sensor.temp <= thrs->temp - thrs->hysteresis) {
+		nvkm_therm_sensor_set_threshold_state(therm, thrs_name,
+						      NVKM_THERM_THRS_LOWER);
+		nvkm_therm_sensor_event(therm, thrs_name,
+					NVKM_THERM_THRS_FALLING);
+		sensor.intrs++;
+	}
+	spin_unlock_irqrestore(&therm->sensor.alarm_program_lock, flags);
+}
+
+static int
+fake_fan_get(struct nvkm_therm *therm)
+{
+	return sensor.duty;
+}
+
+static int
+fake_fan_set(struct nvkm_therm *therm, int percent)
+{
+	sensor.duty = percent;
+	sensor.changes++;
+	return 0;
+}
+
+struct phase {
+	const char *name;
+	int seconds;
+	int from;
+	int to;
+	int flicker; /* seconds between readings changing, if flickering */
+};
+
+static int
+phase_run(struct nvkm_therm *therm, struct nvkm_timer *tmr, bool intr,
+	  const struct phase *phase)
+{
+	const struct nvbios_therm_threshold *boost =
+		&therm->bios_sensor.thrs_fan_boost;
+	const u64 intrs = ptimer.intrs + sensor.intrs, reads = sensor.reads;
+	const u64 changes = sensor.changes;
+	const u64 steps = phase->seconds * 1000000000ULL / STEP;
+	u64 crossed = 0, step;
+	int ret = 0;
+
+	for (step = 1; step <= steps; step++) {
+		const u64 secs = step * STEP / 1000000000ULL;
+
+		if (phase->flicker)
+			sensor.temp = phase->from + (secs / phase->flicker) % 2;
+		else
+			sensor.temp = phase->from + (phase->to - phase->from) *
+						    (s64)step / (s64)steps;
+
+		if (intr)
+			sensor_intr(therm, NVKM_THERM_THRS_FANBOOST, boost);
+		ptimer_run(tmr, ptimer.time + STEP);
+
+		/* The fan should be boosted within a couple of polls. */
+		if (sensor.temp < boost->temp)
+			crossed = 0;
+		else
+		if (!crossed)
+			crossed = step;
+		if (crossed && step - crossed > 2000000000ULL / STEP &&
+		    therm->sensor.alarm_state[NVKM_THERM_THRS_FANBOOST] !=
+		    NVKM_THERM_THRS_HIGHER) {
+			fprintf(stderr, "%s: fan boost threshold missed\n",
+				phase->name);
+			ret = -EINVAL;
+			break;
+		}
+	}
+
+	printf("%-8s: %3d C, %5lld wakeups/min, %5lld sensor reads/min, "
+	       "%3lld fan changes, %3d%% duty\n", phase->name, sensor.temp,
+	       (ptimer.intrs + sensor.intrs - intrs) * 60 / phase->seconds,
+	       (sensor.reads - reads) * 60 / phase->seconds,
+	       sensor.changes - changes, sensor.duty);
+	return ret;
+}
+
+/* Runs for some seconds at the current temperature, returns the lowest
+ * duty seen.
+ */
+static int
+steady_run(struct nvkm_therm *therm, struct nvkm_timer *tmr, bool intr,
+	   int seconds)
+{
+	int duty = sensor.duty;
+	u64 step;
+
+	for (step = 0; step < seconds * 1000000000ULL / STEP; step++) {
+		if (intr) {
+			sensor_intr(therm, NVKM_THERM_THRS_FANBOOST,
+				    &therm->bios_sensor.thrs_fan_boost);
+		}
+		ptimer_run(tmr, ptimer.time + STEP);
+		duty = min(duty, sensor.duty);
+	}
+
+	return duty;
+}
+
+static int
+steady_check(struct nvkm_therm *therm, struct nvkm_timer *tmr, bool intr)
+{
+	const int boost = therm->bios_sensor.thrs_fan_boost.temp;
+	const int max_duty = therm->fan->bios.max_duty;
+	int duty, ret = 0;
+
+	sensor.temp = 60;
+	steady_run(therm, tmr, intr, 60);
+	duty = sensor.duty;
+
+	/* New duty limits apply straight away, not at the next change. */
+	nvkm_therm_attr_set(therm, NVKM_THERM_ATTR_FAN_MAX_DUTY, duty - 10);
+	if (sensor.duty >= duty) {
+		fprintf(stderr, "steady: max duty %d ignored, at %d%%\n",
+			duty - 10, sensor.duty);
+		ret = -EINVAL;
+	}
+	nvkm_therm_attr_set(therm, NVKM_THERM_ATTR_FAN_MAX_DUTY, max_duty);
+	if (sensor.duty != duty) {
+		fprintf(stderr, "steady: max duty %d ignored, at %d%%\n",
+			max_duty, sensor.duty);
+		ret = -EINVAL;
+	}
+
+	/* Boosted by a threshold it's now above, then released. */
+	nvkm_therm_attr_set(therm, NVKM_THERM_ATTR_THRS_FAN_BOOST,
+			    sensor.temp - 5);
+	steady_run(therm, tmr, intr, 2);
+	if (therm->sensor.alarm_state[NVKM_THERM_THRS_FANBOOST] !=
+	    NVKM_THERM_THRS_HIGHER) {
+		fprintf(stderr, "steady: fan boost threshold missed\n");
+		ret = -EINVAL;
+	}
+	if (steady_run(therm, tmr, intr, 60) != duty || sensor.duty != duty) {
+		fprintf(stderr, "steady: fan boost held, at %d%%\n",
+			sensor.duty);
+		ret = -EINVAL;
+	}
+
+	nvkm_therm_attr_set(therm, NVKM_THERM_ATTR_THRS_FAN_BOOST, boost);
+	steady_run(therm, tmr, intr, 10);
+
+	printf("steady  : %3d C, %3d%% duty, after duty limit and fan boost "
+	       "changes\n", sensor.temp, sensor.duty);
+	return ret;
+}
+
+int
+main(int argc, char **argv)
+{
+	static const struct phase phases[] = {
+		{ "idle",    600, 40, 40 },
+		{ "heat",    120, 40, 80 },
+		{ "load",    600, 80, 80 },
+		{ "flicker", 600, 80, 81, 7 },
+		{ "overheat", 60, 81, 93 },
+		{ "cool",    180, 93, 45 },
+		{ "idle",    600, 45, 45 },
+	};
+	struct device dev = { .name = "fake" };
+	struct nvkm_bios bios = {};
+	struct nvkm_device device = { .dev = &dev, .cfgopt = "",
+				      .bios = &bios };
+	struct nvkm_gpio gpio = { .subdev.device = &device };
+	struct nvkm_i2c i2c = { .subdev.device = &device };
+	struct nvkm_subdev *subdev;
+	struct nvkm_therm *therm;
+	struct nvkm_timer *tmr;
+	bool intr = false;
+	int ret, c, i;
+
+	while ((c = getopt(argc, argv, "i")) != -1) {
+		switch (c) {
+		case 'i':
+			intr = true;
+			break;
+		default:
+			return 1;
+		}
+	}
+
+	INIT_LIST_HEAD(&i2c.bus);
+	bios.subdev.device = &device;
+	device.gpio = &gpio;
+	device.i2c = &i2c;
+
+	ret = nvkm_timer_new_(&fake_timer, &device, NVKM_SUBDEV_TIMER, &tmr);
+	if (ret)
+		return 1;
+	device.timer = tmr;
+	tmr->func->time(tmr, 0);
+
+	ret = nvkm_therm_new_(intr ? &fake_therm_intr : &fake_therm_poll,
+			      &device, NVKM_SUBDEV_THERM, &therm);
+	if (ret)
+		goto done;
+
+	/* Quietly, there's no VBIOS for the tables to be found in. */
+	therm->subdev.debug = 0;
+	sensor.temp = phases[0].from;
+	if ((ret = nvkm_subdev_init(&therm->subdev)))
+		goto done;
+
+	/* A fan the driver controls, with a linear response. */
+	therm->fan->get = fake_fan_get;
+	therm->fan->set = fake_fan_set;
+	therm->fan->bios.fan_mode = NVBIOS_THERM_FAN_LINEAR;
+	nvkm_therm_update(therm, -1);
+
+	for (i = 0; i < ARRAY_SIZE(phases); i++) {
+		if ((ret = phase_run(therm, tmr, intr, &phases[i])))
+			break;
+	}
+
+	if (!ret && therm->sensor.alarm_state[NVKM_THERM_THRS_FANBOOST] !=
+		    NVKM_THERM_THRS_LOWER) {
+		fprintf(stderr, "fan boost threshold still active\n");
+		ret = -EINVAL;
+	}
+
+	if (!ret)
+		ret = steady_check(therm, tmr, intr);
+
+	nvkm_subdev_fini(&therm->subdev, false);
+done:
+	subdev = &therm->subdev;
+	nvkm_subdev_del(&subdev);
+	subdev = &tmr->subdev;
+	nvkm_subdev_del(&subdev);
+	return ret ? 1 : 0;
+}
@@ -0,0 +1,326 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <core/device.h>
+#include <subdev/timer/priv.h>
+
+/* Runs nvkm_timer's alarm scheduling against a simulated PTIMER, which
+ * only moves forward when it's read (by -t ns), or when the simulation
+ * skips ahead to the next alarm interrupt.  As the hardware does, the
+ * interrupt's raised once time passes the low 32 bits of the alarm, so
+ * setting one in the past means waiting for the counter to wrap.
+ *
+ * Checks that one-shot alarms, some cancelled or rescheduled along the
+ * way, go off once each, never early, and no later than their slack,
+ * then runs a mix of periodic alarms like the driver's (fan, thermal,
+ * dvfs polling) and reports how many interrupts and PTIMER reads they
+ * took.  Lastly, times scheduling and cancelling an alarm with -n others
+ * pending.
+ */
+static struct {
+	u64 time;
+	u64 tick;
+	u64 due;
+	bool armed;
+
+	u64 reads;
+	u64 arms;
+	u64 intrs;
+} ptimer;
+
+static void
+fake_time(struct nvkm_timer *tmr, u64 time)
+{
+	ptimer.time = time;
+}
+
+static u64
+fake_read(struct nvkm_timer *tmr)
+{
+	ptimer.reads++;
+	ptimer.time += ptimer.tick;
+	return ptimer.time;
+}
+
+static void
+fake_alarm_init(struct nvkm_timer *tmr, u32 time)
+{
+	ptimer.arms++;
+	ptimer.due = (ptimer.time & ~0xffffffffULL) | time;
+	if (ptimer.due <= ptimer.time)
+		ptimer.due += 1ULL << 32;
+	ptimer.armed = true;
+}
+
+static void
+fake_alarm_fini(struct nvkm_timer *tmr)
+{
+	ptimer.armed = false;
+}
+
+static const struct nvkm_timer_func
+fake_timer = {
+	.read = fake_read,
+	.time = fake_time,
+	.alarm_init = fake_alarm_init,
+	.alarm_fini = fake_alarm_fini,
+};
+
+/* Advances time to "end", raising every alarm interrupt on the way, and
+ * any that time passed while being read.
+ */
+static void
+ptimer_run(struct nvkm_timer *tmr, u64 end)
+{
+	while (ptimer.armed && ptimer.due <= end) {
+		ptimer.time = max(ptimer.time, ptimer.due);
+		ptimer.due += 1ULL << 32;
+		ptimer.intrs++;
+		nvkm_timer_alarm_trigger(tmr);
+	}
+
+	ptimer.time = max(ptimer.time, end);
+}
+
+struct sim_alarm {
+	struct nvkm_alarm base;
+	struct nvkm_timer *tmr;
+	u32 period;
+	int fired;
+	int expect;
+};
+
+static u64 alarm_late, alarm_late_max, alarm_fired;
+static int alarm_bad;
+
+static void
+sim_alarm(struct nvkm_alarm *base)
+{
+	struct sim_alarm *alarm = container_of(base, typeof(*alarm), base);
+	const u64 slack = min(alarm->period >> 6, 1000000U);
+	u64 late;
+
+	/* A few PTIMER reads' worth of leeway, for time they take. */
+	if (ptimer.time < base->timestamp ||
+	    ptimer.time > base->timestamp + slack + ptimer.tick * 8) {
+		fprintf(stderr, "alarm due at %lld went off at %lld\n",
+			base->timestamp, ptimer.time);
+		alarm_bad++;
+	}
+
+	late = ptimer.time - min(ptimer.time, base->timestamp);
+	alarm_late += late;
+	alarm_late_max = max(alarm_late_max, late);
+	alarm_fired++;
+	alarm->fired++;
+}
+
+static void
+sim_periodic(struct nvkm_alarm *base)
+{
+	struct sim_alarm *alarm = container_of(base, typeof(*alarm), base);
+	sim_alarm(base);
+	nvkm_timer_alarm(alarm->tmr, alarm->period, base);
+}
+
+static void
+stats(const char *name, u64 reads, u64 arms, u64 intrs, u64 fired)
+{
+	printf("%-8s: %6lld alarms, %6lld interrupts, %6lld rearms, %7lld "
+	       "reads, %6lld ns late avg, %7lld ns max\n", name, fired,
+	       ptimer.intrs - intrs, ptimer.arms - arms, ptimer.reads - reads,
+	       fired ? alarm_late / fired : 0, alarm_late_max);
+}
+
+static int
+oneshot(struct nvkm_timer *tmr, int nr)
+{
+	const u64 reads = ptimer.reads, arms = ptimer.arms;
+	const u64 intrs = ptimer.intrs;
+	struct sim_alarm *alarm;
+	int i, ret = 0;
+
+	if (!(alarm = calloc(nr, sizeof(*alarm))))
+		return -ENOMEM;
+	alarm_late = alarm_late_max = alarm_fired = 0;
+
+	for (i = 0; i < nr; i++) {
+		nvkm_alarm_init(&alarm[i].base, sim_alarm);
+		alarm[i].tmr = tmr;
+		alarm[i].period = 100000 + rand() % 100000000;
+		alarm[i].expect = 1;
+		nvkm_timer_alarm(tmr, alarm[i].period, &alarm[i].base);
+		ptimer_run(tmr, ptimer.time);
+	}
+
+	/* Cancel a quarter, and reschedule another quarter, some of which
+	 * will have gone off already.
+	 */
+	for (i = 0; i < nr; i++) {
+		switch (rand() % 4) {
+		case 0:
+			alarm[i].expect = alarm[i].fired;
+			nvkm_timer_alarm(tmr, 0, &alarm[i].base);
+			break;
+		case 1:
+			alarm[i].period = 100000 + rand() % 100000000;
+			alarm[i].expect = alarm[i].fired + 1;
+			nvkm_timer_alarm(tmr, alarm[i].period, &alarm[i].base);
+			break;
+		default:
+			break;
+		}
+		ptimer_run(tmr, ptimer.time + rand() % 10000);
+	}
+
+	ptimer_run(tmr, ptimer.time + 200000000);
+
+	for (i = 0; i < nr; i++) {
+		if (alarm[i].fired != alarm[i].expect) {
+			fprintf(stderr, "alarm %d went off %d times, not %d\n",
+				i, alarm[i].fired, alarm[i].expect);
+			ret = -EINVAL;
+		}
+	}
+
+	if (tmr->alarms || tmr->alarms_nr || ptimer.armed) {
+		fprintf(stderr, "alarms left pending\n");
+		ret = -EINVAL;
+	}
+
+	stats("oneshot", reads, arms, intrs, alarm_fired);
+	free(alarm);
+	return alarm_bad ? -EINVAL : ret;
+}
+
+static int
+periodic(struct nvkm_timer *tmr, u64 duration)
+{
+	const u64 reads = ptimer.reads, arms = ptimer.arms;
+	const u64 intrs = ptimer.intrs;
+	static const u32 period[] = {
+		1000000000, /* thermal polling */
+		1000000000, /* temperature sensor */
+		2000000000, /* fan speed update */
+		100000000, /* dvfs */
+		10000000, /* fan toggling, and other short timers */
+		10100000,
+		10200000,
+		15000000,
+		15000000,
+		16000000,
+	};
+	struct sim_alarm alarm[ARRAY_SIZE(period)] = {};
+	int i;
+
+	alarm_late = alarm_late_max = alarm_fired = 0;
+	for (i = 0; i < ARRAY_SIZE(period); i++) {
+		nvkm_alarm_init(&alarm[i].base, sim_periodic);
+		alarm[i].tmr = tmr;
+		alarm[i].period = period[i];
+		nvkm_timer_alarm(tmr, period[i], &alarm[i].base);
+		ptimer_run(tmr, ptimer.time);
+	}
+
+	ptimer_run(tmr, ptimer.time + duration);
+
+	for (i = 0; i < ARRAY_SIZE(period); i++) {
+		alarm[i].period = 0;
+		nvkm_timer_alarm(tmr, 0, &alarm[i].base);
+	}
+
+	ptimer_run(tmr, ptimer.time + 10000000000ULL);
+	stats("periodic", reads, arms, intrs, alarm_fired);
+	return alarm_bad ? -EINVAL : 0;
+}
+
+static int
+scale(struct nvkm_timer *tmr, int nr, int loops)
+{
+	struct sim_alarm *alarm;
+	s64 time;
+	int i;
+
+	if (!(alarm = calloc(nr + 1, sizeof(*alarm))))
+		return -ENOMEM;
+
+	for (i = 0; i <= nr; i++) {
+		nvkm_alarm_init(&alarm[i].base, sim_alarm);
+		alarm[i].tmr = tmr;
+	}
+
+	for (i = 0; i < nr; i++)
+		nvkm_timer_alarm(tmr, 1000000 + rand() % 1000000000,
+				 &alarm[i].base);
+
+	time = ktime_to_ns(ktime_get());
+	for (i = 0; i < loops; i++) {
+		nvkm_timer_alarm(tmr, 1000000 + (i * 7919) % 1000000000,
+				 &alarm[nr].base);
+		nvkm_timer_alarm(tmr, 0, &alarm[nr].base);
+	}
+	time = ktime_to_ns(ktime_get()) - time;
+
+	printf("%6d pending: %5lld ns schedule+cancel\n", nr,
+	       loops ? time / loops : 0);
+
+	for (i = 0; i < nr; i++)
+		nvkm_timer_alarm(tmr, 0, &alarm[i].base);
+	free(alarm);
+	return tmr->alarms_nr ? -EINVAL : 0;
+}
+
+int
+main(int argc, char **argv)
+{
+	struct device dev = { .name = "fake" };
+	struct nvkm_device device = { .dev = &dev, .cfgopt = "" };
+	struct nvkm_subdev *subdev;
+	struct nvkm_timer *tmr;
+	int nr = 1000, pending = 4096, loops = 100000;
+	int ret, c, i;
+
+	ptimer.tick = 100;
+	while ((c = getopt(argc, argv, "o:n:l:t:")) != -1) {
+		switch (c) {
+		case 'o':
+			nr = strtol(optarg, NULL, 0);
+			break;
+		case 'n':
+			pending = strtol(optarg, NULL, 0);
+			break;
+		case 'l':
+			loops = strtol(optarg, NULL, 0);
+			break;
+		case 't':
+			ptimer.tick = strtoull(optarg, NULL, 0);
+			break;
+		default:
+			return 1;
+		}
+	}
+
+	ret = nvkm_timer_new_(&fake_timer, &device, NVKM_SUBDEV_TIMER, &tmr);
+	if (ret)
+		return 1;
+
+	/* As nvkm_timer_init() does, starting close to a 32-bit wrap. */
+	tmr->func->time(tmr, 0xfff00000ULL);
+	nvkm_timer_alarm_trigger(tmr);
+
+	srand(0);
+	if ((ret = oneshot(tmr, nr)) ||
+	    (ret = periodic(tmr, 60000000000ULL)))
+		goto done;
+
+	for (i = 16; i <= pending; i *= 16) {
+		if ((ret = scale(tmr, i, loops)))
+			goto done;
+	}
+
+done:
+	subdev = &tmr->subdev;
+	nvkm_subdev_del(&subdev);
+	return ret ? 1 : 0;
+}
@@ -161,6 +161,7 @@ nv50_dmac_create(struct nvif_device *device, struct nvif_object *disp,
 		return ret;
 
 	dmac->ptr = dmac->push.object.map.ptr;
+	dmac->max = (PAGE_SIZE / 4) - 8;
 
 	args->pushbuf = nvif_handle(&dmac->push.object);
 
@@ -169,6 +170,8 @@ nv50_dmac_create(struct nvif_device *device, struct nvif_object *disp,
 	if (ret)
 		return ret;
 
+	dmac->cur = dmac->put = nvif_rd32(&dmac->base.user, 0x0000) / 4;
+
 	if (!syncbuf)
 		return 0;
 
@@ -216,32 +219,64 @@ evo_flush(struct nv50_dmac *dmac)
 	}
 }
 
+static void
+evo_put(struct nv50_dmac *dmac)
+{
+	if (dmac->put != dmac->cur) {
+		evo_flush(dmac);
+		nvif_wr32(&dmac->base.user, 0x0000, dmac->cur << 2);
+		dmac->put = dmac->cur;
+	}
+}
+
+static int
+evo_space(struct nv50_dmac *dmac, int nr)
+{
+	struct nvif_device *device = dmac->base.device;
+
+	/* After a wrap, GET keeps pointing into the previous pass until HW
+	 * reaches the jump, and we may only reuse what it's already fetched.
+	 *
+	 * Reservations always stop short of GET, so it'll only be at or
+	 * behind "cur" once HW has followed the jump, and then the rest of
+	 * the ring is free.  There's no need to wait for it to catch up.
+	 */
+	if (nvif_msec(device, 2000,
+		u32 get = nvif_rd32(&dmac->base.user, 0x0004) / 4;
+		if (get <= dmac->cur) {
+			dmac->wrap = false;
+			break;
+		}
+		if (get > dmac->cur + nr)
+			break;
+	) < 0)
+		return -EBUSY;
+
+	return 0;
+}
+
 u32 *
 evo_wait(struct nv50_dmac *evoc, int nr)
 {
 	struct nv50_dmac *dmac = evoc;
-	struct nvif_device *device = dmac->base.device;
-	u32 put = nvif_rd32(&dmac->base.user, 0x0000) / 4;
 
 	mutex_lock(&dmac->lock);
-	if (put + nr >= (PAGE_SIZE / 4) - 8) {
-		dmac->ptr[put] = 0x20000000;
+	if (dmac->cur + nr >= dmac->max) {
+		dmac->ptr[dmac->cur] = 0x20000000;
 		evo_flush(dmac);
 
 		nvif_wr32(&dmac->base.user, 0x0000, 0x00000000);
-		if (nvif_msec(device, 2000,
-			if (!nvif_rd32(&dmac->base.user, 0x0004))
-				break;
-		) < 0) {
-			mutex_unlock(&dmac->lock);
-			pr_err("nouveau: evo channel stalled\n");
-			return NULL;
-		}
+		dmac->cur = dmac->put = 0;
+		dmac->wrap = true;
+	}
 
-		put = 0;
+	if (dmac->wrap && evo_space(dmac, nr)) {
+		mutex_unlock(&dmac->lock);
+		pr_err("nouveau: evo channel stalled\n");
+		return NULL;
 	}
 
-	return dmac->ptr + put;
+	return dmac->ptr + dmac->cur;
 }
 
 void
@@ -249,9 +284,50 @@ evo_kick(u32 *push, struct nv50_dmac *evoc)
 {
 	struct nv50_dmac *dmac = evoc;
 
-	evo_flush(dmac);
+	dmac->cur = push - dmac->ptr;
+	if (dmac->defer != current)
+		evo_put(dmac);
+	mutex_unlock(&dmac->lock);
+}
 
-	nvif_wr32(&dmac->base.user, 0x0000, (push - dmac->ptr) << 2);
+/* Several back-to-back submissions (ie. an atomic commit's head/output
+ * updates to the core channel) only need one flush and one PUT write, as
+ * none of it takes effect until the UPDATE method anyway.
+ */
+void
+nv50_dmac_kick(struct nv50_dmac *dmac)
+{
+	mutex_lock(&dmac->lock);
+	evo_put(dmac);
+	mutex_unlock(&dmac->lock);
+}
+
+void
+nv50_dmac_defer(struct nv50_dmac *dmac, bool defer)
+{
+	mutex_lock(&dmac->lock);
+	if (defer) {
+		dmac->defer = current;
+	} else {
+		dmac->defer = NULL;
+		evo_put(dmac);
+	}
+	mutex_unlock(&dmac->lock);
+}
+
+/* The channel's been (re)initialised behind our back, on resume, and HW's
+ * PUT reset, so anything before it would be executed again.  Pick up from
+ * wherever HW is now.
+ */
+void
+nv50_dmac_init(struct nv50_dmac *dmac)
+{
+	if (!dmac->ptr)
+		return;
+
+	mutex_lock(&dmac->lock);
+	dmac->cur = dmac->put = nvif_rd32(&dmac->base.user, 0x0000) / 4;
+	dmac->wrap = false;
 	mutex_unlock(&dmac->lock);
 }
 
@@ -1890,6 +1966,7 @@ nv50_disp_atomic_commit_core(struct drm_atomic_state *state, u32 *interlock)
 
 	core->func->ntfy_init(disp->sync, NV50_DISP_CORE_NTFY);
 	core->func->update(core, interlock, true);
+	nv50_dmac_kick(&core->chan);
 	if (core->func->ntfy_wait_done(disp->sync, NV50_DISP_CORE_NTFY,
 				       disp->core->chan.base.device))
 		NV_ERROR(drm, "core notifier timeout\n");
@@ -1942,6 +2019,7 @@ nv50_disp_atomic_commit_tail(struct drm_atomic_state *state)
 
 	if (atom->lock_core)
 		mutex_lock(&disp->mutex);
+	nv50_dmac_defer(&core->chan, true);
 
 	/* Disable head(s). */
 	for_each_oldnew_crtc_in_state(state, crtc, old_crtc_state, new_crtc_state, i) {
@@ -2060,6 +2138,7 @@ nv50_disp_atomic_commit_tail(struct drm_atomic_state *state)
 	if (core->assign_windows) {
 		core->func->wndw.owner(core);
 		core->func->update(core, interlock, false);
+		nv50_dmac_kick(&core->chan);
 		core->assign_windows = false;
 		interlock[NV50_DISP_INTERLOCK_CORE] = 0;
 	}
@@ -2091,6 +2170,7 @@ nv50_disp_atomic_commit_tail(struct drm_atomic_state *state)
 			disp->core->func->update(disp->core, interlock, false);
 	}
 
+	nv50_dmac_defer(&core->chan, false);
 	if (atom->lock_core)
 		mutex_unlock(&disp->mutex);
 
@@ -2391,8 +2471,18 @@ nv50_display_init(struct drm_device *dev, bool resume, bool runtime)
 	struct drm_encoder *encoder;
 	struct drm_plane *plane;
 
-	if (resume || runtime)
+	if (resume || runtime) {
+		nv50_dmac_init(&core->chan);
+		drm_for_each_plane(plane, dev) {
+			struct nv50_wndw *wndw = nv50_wndw(plane);
+			if (plane->funcs != &nv50_wndw)
+				continue;
+			nv50_dmac_init(&wndw->wndw);
+			nv50_dmac_init(&wndw->wimm);
+		}
+
 		core->func->init(core);
+	}
 
 	list_for_each_entry(encoder, &dev->mode_config.encoder_list, head) {
 		if (encoder->encoder_type != DRM_MODE_ENCODER_DPMST) {
@@ -62,6 +62,17 @@ struct nv50_dmac {
 	struct nvif_mem push;
 	u32 *ptr;
 
+	/* Pushbuf state is tracked here, rather than read back from PUT on
+	 * every reservation.  All in dwords.
+	 */
+	u32 cur; /* end of the last submission */
+	u32 put; /* last value written to PUT */
+	u32 max; /* end of usable space, leaving room for the jump */
+	bool wrap; /* HW may still be fetching from before the last wrap */
+
+	/* Task whose kicks only advance "cur", until nv50_dmac_kick(). */
+	struct task_struct *defer;
+
 	struct nvif_object sync;
 	struct nvif_object vram;
 
@@ -75,6 +86,9 @@ int nv50_dmac_create(struct nvif_device *device, struct nvif_object *disp,
 		     const s32 *oclass, u8 head, void *data, u32 size,
 		     u64 syncbuf, struct nv50_dmac *dmac);
 void nv50_dmac_destroy(struct nv50_dmac *);
+void nv50_dmac_defer(struct nv50_dmac *, bool defer);
+void nv50_dmac_kick(struct nv50_dmac *);
+void nv50_dmac_init(struct nv50_dmac *);
 
 u32 *evo_wait(struct nv50_dmac *, int nr);
 void evo_kick(u32 *, struct nv50_dmac *);
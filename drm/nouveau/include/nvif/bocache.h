@@ -0,0 +1,99 @@
+#ifndef __NVIF_BOCACHE_H__
+#define __NVIF_BOCACHE_H__
+#include <nvif/os.h>
+
+/* Remembers the buffer lists recently submitted on a channel, and what
+ * each buffer looked like once the submission was done, so that the same
+ * list submitted again needn't repeat work for buffers nothing else has
+ * touched since.
+ *
+ * A list is keyed on its handles and domains (laid out "stride" apart,
+ * so they can be read straight out of the submission), and each buffer
+ * records:
+ *
+ *   cookie - identity of the object the handle resolved to, never 0
+ *   place  - memory type it was in, and "offset" within it
+ *   seq    - state of its fences, after the submission's were added
+ *
+ * If nothing's moved the buffer since, it needn't be validated again,
+ * and if no-one else has added fences either, it needn't be synced.
+ */
+struct nvif_bocache_key {
+	u32 handle;
+	u32 read;
+	u32 write;
+	u32 valid;
+};
+
+struct nvif_bocache_bo {
+	u64 cookie;
+	u64 offset;
+	u32 place;
+	u32 seq;
+};
+
+struct nvif_bocache_set {
+	struct list_head head;
+	u32 hash;
+	u32 nr;
+	bool relocs;	/* last submission needed relocations */
+	struct nvif_bocache_key *key;
+	struct nvif_bocache_bo bo[];
+};
+
+struct nvif_bocache {
+	struct list_head sets;	/* most recently used first */
+	int nr, max;
+
+	u64 hits, misses;
+	u64 validated, synced, skipped_validate, skipped_sync;
+};
+
+#define NVIF_BOCACHE_VALIDATE 0x1
+#define NVIF_BOCACHE_SYNC     0x2
+
+/* What can be skipped for a buffer that now looks like this. */
+static inline int
+nvif_bocache_skip(const struct nvif_bocache_bo *bo, u64 cookie, u32 place,
+		  u64 offset, u32 seq)
+{
+	if (!bo || bo->cookie != cookie || bo->place != place ||
+	    bo->offset != offset)
+		return 0;
+	if (bo->seq != seq)
+		return NVIF_BOCACHE_VALIDATE;
+	return NVIF_BOCACHE_VALIDATE | NVIF_BOCACHE_SYNC;
+}
+
+static inline void
+nvif_bocache_done(struct nvif_bocache_bo *bo, u64 cookie, u32 place,
+		  u64 offset, u32 seq)
+{
+	bo->cookie = cookie;
+	bo->place = place;
+	bo->offset = offset;
+	bo->seq = seq;
+}
+
+/* Whether a submission's relocations are to be applied, given whether
+ * they were already, and validating just now found presumed offsets that
+ * needed fixing up.  It stays so across revalidating after fetching them,
+ * which finds the offsets already fixed up, and is what the list's next
+ * submission will go by to fetch them up front.
+ */
+static inline bool
+nvif_bocache_relocs(struct nvif_bocache_set *set, bool relocs, bool needed)
+{
+	relocs |= needed;
+	if (set)
+		set->relocs = relocs;
+	return relocs;
+}
+
+void nvif_bocache_init(struct nvif_bocache *, int max);
+void nvif_bocache_fini(struct nvif_bocache *);
+struct nvif_bocache_set *
+nvif_bocache_get(struct nvif_bocache *, const void *key, size_t stride,
+		 u32 nr);
+void nvif_bocache_account(struct nvif_bocache *, int skip);
+#endif
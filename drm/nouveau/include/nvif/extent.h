@@ -0,0 +1,24 @@
+#ifndef __NVIF_EXTENT_H__
+#define __NVIF_EXTENT_H__
+#include <nvif/os.h>
+
+#define NVIF_EXTENT_SKIP ~0ULL
+
+struct nvif_extent {
+	u32 first; /* index of the first entry */
+	u32 count; /* entries */
+};
+
+/* Merge per-page addresses into extents that can be handled with one
+ * operation each, where both the "src" address and (if given) the "dst"
+ * address of an entry are "stride" on from the previous entry's.
+ *
+ * Entries with a "src" of NVIF_EXTENT_SKIP aren't covered by any extent,
+ * and end the one before them.  Extents are at most "count_max" entries.
+ *
+ * Returns the number of extents, or -ENOSPC if there's more than "max".
+ * "extent" may be NULL to only count them.
+ */
+int nvif_extent_plan(const u64 *src, const u64 *dst, u32 nr, u64 stride,
+		     u32 count_max, struct nvif_extent *extent, int max);
+#endif
@@ -0,0 +1,35 @@
+#ifndef __NVIF_FAULT_H__
+#define __NVIF_FAULT_H__
+#include <nvif/os.h>
+
+struct nvif_fault_window_stats {
+	u64 windows;  /* fault windows handled */
+	u64 faults;   /* faults covered by them */
+	u64 pages;    /* pages in them */
+	u64 prefetch; /* pages requested that hadn't faulted */
+	u64 grow;
+	u64 shrink;
+};
+
+/* Sizes the window of pages handled together with a replayable fault,
+ * from the history of previous windows.  Sequential faults double the
+ * window, up to "max" pages, and have the pages ahead of the fault
+ * fetched too.  Faults elsewhere halve it again, down to "min" pages,
+ * where only pages that actually faulted are fetched.
+ *
+ * Addresses are in pages.
+ */
+struct nvif_fault_window {
+	u32 min;
+	u32 max;
+	u32 size;
+	u64 prev; /* first page of the last window */
+	u64 next; /* page following the last window */
+	struct nvif_fault_window_stats stats;
+};
+
+void nvif_fault_window_init(struct nvif_fault_window *, u32 min, u32 max);
+u32  nvif_fault_window(struct nvif_fault_window *, u64 page, bool *prefetch);
+void nvif_fault_window_done(struct nvif_fault_window *, u64 page, u32 pages,
+			    u32 faults, u32 prefetched);
+#endif
@@ -5,6 +5,7 @@
 #define NVIF_CONTROL_PSTATE_INFO                                           0x00
 #define NVIF_CONTROL_PSTATE_ATTR                                           0x01
 #define NVIF_CONTROL_PSTATE_USER                                           0x02
+#define NVIF_CONTROL_FALCON_XFER                                           0x03
 
 struct nvif_control_pstate_info_v0 {
 	__u8  version;
@@ -44,4 +45,17 @@ struct nvif_control_pstate_user_v0 {
 	__s8  pwrsrc; /*  in: target power source */
 	__u8  pad03[5];
 };
+
+struct nvif_control_falcon_xfer_v0 {
+	__u8  version;
+	__u8  index; /*  in: index of falcon to query
+		      * out: index of next falcon, or 0 if no more
+		      */
+	__u8  pad02[6];
+	__u64 pio_bytes; /* out: uploaded to IMEM/DMEM by PIO */
+	__u64 pio_time; /* out: ns */
+	__u64 dma_bytes; /* out: uploaded to IMEM/DMEM by DMA */
+	__u64 dma_time; /* out: ns */
+	char  name[32]; /* out: owner and falcon name */
+};
 #endif
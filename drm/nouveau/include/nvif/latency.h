@@ -0,0 +1,52 @@
+#ifndef __NVIF_LATENCY_H__
+#define __NVIF_LATENCY_H__
+#include <nvif/os.h>
+
+/* Buckets are powers of two from 1us, the last catches everything longer
+ * than 16ms.
+ */
+#define NVIF_LATENCY_BUCKETS 16
+
+/* Tracks how long work on a fence context takes to complete, to decide
+ * how long a waiter should spin before it's better off sleeping.
+ *
+ * Completion latencies (emit to signal, where the signal isn't deferred)
+ * go into a histogram that decays over time, so it follows changes in the
+ * workload.  A waiter spins only when most of the work still outstanding
+ * at its fence's age has historically completed within "max" more, and
+ * then only as long as it takes to cover most of that, otherwise it sleeps
+ * immediately.
+ */
+struct nvif_latency {
+	u32 done[NVIF_LATENCY_BUCKETS]; /* decaying completion latencies */
+	u32 samples;
+
+	/* What waiters actually did, and how long they waited. */
+	u64 wait[NVIF_LATENCY_BUCKETS];
+	u64 spins;    /* waits that spun */
+	u64 spun;     /* ... and completed while spinning */
+	u64 sleeps;   /* waits that had to sleep */
+};
+
+static inline int
+nvif_latency_bucket(u64 ns)
+{
+	int i = 0;
+	while (i < NVIF_LATENCY_BUCKETS - 1 && ns >= (1000ULL << i))
+		i++;
+	return i;
+}
+
+/* Upper bound of a bucket, in ns. */
+static inline u64
+nvif_latency_bound(int i)
+{
+	return i < NVIF_LATENCY_BUCKETS - 1 ? 1000ULL << i : ~0ULL;
+}
+
+void nvif_latency_init(struct nvif_latency *);
+void nvif_latency_done(struct nvif_latency *, u64 latency);
+u64  nvif_latency_spin(const struct nvif_latency *, u64 age, u64 max);
+void nvif_latency_wait(struct nvif_latency *, u64 waited, bool spun,
+		       bool slept);
+#endif
@@ -0,0 +1,79 @@
+#ifndef __NVIF_PFNPOOL_H__
+#define __NVIF_PFNPOOL_H__
+#include <nvif/os.h>
+
+/* Allocator for a fixed range of page frames that's backed with memory
+ * a chunk at a time, as it's needed.
+ *
+ * Single pages come from (and are freed to) a small per-CPU cache that
+ * only touches the shared state when it runs dry or fills up.  Larger
+ * requests are given as few contiguous runs as possible, from otherwise
+ * unused chunks where there are any, so that they can be mapped with
+ * large pages.  Only one thread at a time backs a new chunk, others
+ * wait for it to be done instead of each backing their own.
+ */
+#define NVIF_PFNPOOL_CHUNK_NPAGES 512
+#define NVIF_PFNPOOL_CACHE 64
+
+struct nvif_pfnpool_chunk {
+	struct list_head head;
+	unsigned long pfn; /* first page */
+	u32 free;
+	void *priv;
+	DECLARE_BITMAP(used, NVIF_PFNPOOL_CHUNK_NPAGES);
+};
+
+struct nvif_pfnpool_stats {
+	u64 chunks;     /* backed with memory */
+	u64 allocated;  /* pages, including those in per-CPU caches */
+	u64 cached;
+	u64 grows;
+	u64 grow_waits; /* times a thread waited for another's grow */
+	u64 refills;    /* per-CPU cache refills, and flushes */
+	u64 flushes;
+	u64 runs;       /* contiguous runs given out, and their pages */
+	u64 run_pages;
+};
+
+struct nvif_pfnpool {
+	/* Back "chunk" with memory, called without any locks held. */
+	int (*grow)(struct nvif_pfnpool *, struct nvif_pfnpool_chunk *);
+
+	spinlock_t lock;
+	struct list_head empty;   /* backed, with no pages in use */
+	struct list_head partial; /* backed, some pages in use */
+	struct nvif_pfnpool_chunk *chunk;
+	unsigned long pfn;
+	u32 chunk_nr;
+	u32 chunk_next;           /* next chunk to be backed */
+
+	bool growing;
+	int grow_ret;
+	u64 grow_seq;
+	wait_queue_head_t wait;
+
+	struct nvif_pfnpool_cache {
+		spinlock_t lock;
+		int nr;
+		unsigned long pfn[NVIF_PFNPOOL_CACHE];
+	} *cache;
+	int cache_nr;
+
+	struct nvif_pfnpool_stats stats;
+};
+
+int  nvif_pfnpool_init(struct nvif_pfnpool *, unsigned long pfn, u32 chunks,
+		       int (*grow)(struct nvif_pfnpool *,
+				   struct nvif_pfnpool_chunk *));
+void nvif_pfnpool_fini(struct nvif_pfnpool *);
+int  nvif_pfnpool_alloc(struct nvif_pfnpool *, u32 npages, unsigned long *pfn);
+void nvif_pfnpool_free(struct nvif_pfnpool *, unsigned long pfn);
+void nvif_pfnpool_drain(struct nvif_pfnpool *);
+void nvif_pfnpool_stats(struct nvif_pfnpool *, struct nvif_pfnpool_stats *);
+
+static inline struct nvif_pfnpool_chunk *
+nvif_pfnpool_chunk(struct nvif_pfnpool *pool, unsigned long pfn)
+{
+	return &pool->chunk[(pfn - pool->pfn) / NVIF_PFNPOOL_CHUNK_NPAGES];
+}
+#endif
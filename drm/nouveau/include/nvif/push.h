@@ -0,0 +1,52 @@
+#ifndef __NVIF_PUSH_H__
+#define __NVIF_PUSH_H__
+#include <nvif/os.h>
+
+/* Method stream encodings. */
+enum nvif_push_fmt {
+	NVIF_PUSH_NV04, /* pre-Fermi FIFO */
+	NVIF_PUSH_NVC0, /* Fermi and newer FIFO */
+	NVIF_PUSH_EVO,  /* display (dispnv50) channels */
+};
+
+struct nvif_push_mthd {
+	u8  subc;
+	u32 mthd;
+	u32 data;
+};
+
+struct nvif_push_stats {
+	u32 words;
+	u32 mthds;
+
+	u32 inc;  /* incrementing headers */
+	u32 ninc; /* non-incrementing headers */
+	u32 one;  /* increment-once headers */
+	u32 imm;  /* immediate-data headers */
+};
+
+static inline u32
+nvif_push_stats_hdrs(const struct nvif_push_stats *stats)
+{
+	return stats->inc + stats->ninc + stats->one + stats->imm;
+}
+
+/* Emit the smallest stream that writes "mthds", in order.
+ *
+ * Returns the number of words written to "push", or -ENOSPC if it
+ * doesn't fit in "max" words.  "push" may be NULL to only size it.
+ */
+int nvif_push_encode(enum nvif_push_fmt, const struct nvif_push_mthd *,
+		     int nr, u32 *push, int max, struct nvif_push_stats *);
+
+/* Expand "push" back into the methods it writes.
+ *
+ * Returns the number of methods, -ENOSPC if there's more than "max", or
+ * -EINVAL if the stream is malformed or contains anything other than
+ * method headers (ie. jumps, calls).  "mthds" may be NULL to only count
+ * them.
+ */
+int nvif_push_decode(enum nvif_push_fmt, const u32 *push, int nr,
+		     struct nvif_push_mthd *, int max,
+		     struct nvif_push_stats *);
+#endif
@@ -0,0 +1,27 @@
+#ifndef __NVIF_STRIPE_H__
+#define __NVIF_STRIPE_H__
+#include <nvif/os.h>
+
+#define NVIF_STRIPE_MAX 32
+
+struct nvif_stripe {
+	u8  engine;
+	u32 first; /* page offset */
+	u32 count; /* pages */
+};
+
+/* Split a copy of "pages" pages between up to "nr" engines, in proportion
+ * to their "weight", with each engine given one contiguous range cut into
+ * chunks of at most "chunk_max" pages.  Engines that would be given less
+ * than "share_min" pages are left idle, the lightest first, but engine 0
+ * is always used.
+ *
+ * Chunks are returned round-robin across engines, which is the order they
+ * should be submitted in so every engine is busy as early as possible.
+ *
+ * Returns the number of chunks, or -ENOSPC if there's more than "max".
+ * "stripe" may be NULL to only count them.
+ */
+int nvif_stripe_plan(u32 pages, const u32 *weight, int nr, u32 share_min,
+		     u32 chunk_max, struct nvif_stripe *stripe, int max);
+#endif
@@ -12,6 +12,11 @@ struct nvkm_client {
 
 	struct nvkm_client_notify *notify[32];
 	struct rb_root objroot;
+	struct rw_semaphore objlock;
+	/* Also held to change objroot and notify[], as NTFY_GET/PUT come
+	 * from atomic context and look them up without objlock.
+	 */
+	spinlock_t ntfy_lock;
 
 	bool super;
 	void *data;
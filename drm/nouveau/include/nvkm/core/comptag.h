@@ -0,0 +1,58 @@
+/* SPDX-License-Identifier: MIT */
+#ifndef __NVKM_COMPTAG_H__
+#define __NVKM_COMPTAG_H__
+#include <core/mm.h>
+struct nvkm_device;
+
+#define NVKM_COMPTAG_TYPE_USED  0x01
+#define NVKM_COMPTAG_TYPE_DIRTY 0x02
+#define NVKM_COMPTAG_TYPE_CACHE 0x03
+
+#define NVKM_COMPTAG_CACHE_SIZES 16
+#define NVKM_COMPTAG_CACHE_DEPTH 8
+
+struct nvkm_comptag {
+	struct mutex mutex;
+	struct nvkm_mm mm;
+
+	struct nvkm_device *device;
+	void (*clr)(struct nvkm_device *, u32 first, u32 count);
+
+	/* Released tags that still need clearing before they can be reused,
+	 * and small, already clean, allocations kept aside per size.
+	 */
+	struct list_head dirty;
+	struct list_head cache[NVKM_COMPTAG_CACHE_SIZES];
+	u8 cache_nr[NVKM_COMPTAG_CACHE_SIZES];
+
+	u64 allocs;
+	u64 hits;
+	u64 flushes;
+	u64 clears;
+};
+
+struct nvkm_comptag_stats {
+	u32 total;
+	u32 used;
+	u32 dirty;
+	u32 cached;
+	u32 free;
+	u32 free_nodes;
+	u32 free_max;
+
+	u64 allocs;
+	u64 hits;
+	u64 flushes;
+	u64 clears;
+};
+
+int  nvkm_comptag_init(struct nvkm_comptag *, struct nvkm_device *, u32 nr,
+		       void (*clr)(struct nvkm_device *, u32, u32));
+void nvkm_comptag_fini(struct nvkm_comptag *);
+void nvkm_comptag_invalidate(struct nvkm_comptag *);
+int  __nvkm_comptag_get(struct nvkm_comptag *, u32 nr, struct nvkm_mm_node **);
+void __nvkm_comptag_put(struct nvkm_comptag *, struct nvkm_mm_node **);
+int  nvkm_comptag_get(struct nvkm_comptag *, u32 nr, struct nvkm_mm_node **);
+void nvkm_comptag_put(struct nvkm_comptag *, struct nvkm_mm_node **);
+void nvkm_comptag_stats(struct nvkm_comptag *, struct nvkm_comptag_stats *);
+#endif
@@ -98,6 +98,8 @@ struct nvkm_device {
 	struct mutex mutex;
 	int refcount;
 
+	struct list_head falcon; /* protected by mutex */
+
 	void __iomem *pri;
 
 	struct nvkm_event event;
@@ -182,6 +184,25 @@ struct nvkm_device {
 struct nvkm_subdev *nvkm_device_subdev(struct nvkm_device *, int index);
 struct nvkm_engine *nvkm_device_engine(struct nvkm_device *, int index);
 
+/* Subdevs are initialised in dependency order, with those that don't
+ * depend on each other run concurrently.
+ */
+struct nvkm_device_init_stats {
+	DECLARE_BITMAP(ran, NVKM_SUBDEV_NR);
+	s64 start[NVKM_SUBDEV_NR]; /* us, relative to the start of init */
+	s64 time[NVKM_SUBDEV_NR];  /* us */
+	s64 total;    /* wall-clock time */
+	s64 serial;   /* sum of all node times */
+	s64 critical; /* longest chain of dependent nodes */
+	u8  path[NVKM_SUBDEV_NR];
+	int path_nr;
+};
+
+void nvkm_device_init_deps(int index, unsigned long *deps);
+int  nvkm_device_init_graph(struct nvkm_device *, const unsigned long *mask,
+			    int (*init)(struct nvkm_device *, int index),
+			    bool parallel, struct nvkm_device_init_stats *);
+
 struct nvkm_device_func {
 	struct nvkm_device_pci *(*pci)(struct nvkm_device *);
 	struct nvkm_device_tegra *(*tegra)(struct nvkm_device *);
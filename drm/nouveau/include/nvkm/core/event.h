@@ -12,8 +12,9 @@ struct nvkm_event {
 	int index_nr;
 
 	spinlock_t refs_lock;
-	spinlock_t list_lock;
-	struct list_head list;
+	rwlock_t list_lock;
+	struct list_head *list;
+	u32 *mask;
 	int *refs;
 };
 
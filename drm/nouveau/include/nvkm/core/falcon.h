@@ -10,6 +10,8 @@ void nvkm_falcon_v1_load_imem(struct nvkm_falcon *,
 			      void *, u32, u32, u16, u8, bool);
 void nvkm_falcon_v1_load_dmem(struct nvkm_falcon *, void *, u32, u32, u8);
 void nvkm_falcon_v1_read_dmem(struct nvkm_falcon *, u32, u32, u8, void *);
+int nvkm_falcon_v1_load_dma(struct nvkm_falcon *, struct nvkm_memory *, u64,
+			    u32, u32, u16, bool, bool);
 void nvkm_falcon_v1_bind_context(struct nvkm_falcon *, struct nvkm_memory *);
 int nvkm_falcon_v1_wait_for_halt(struct nvkm_falcon *, u32);
 int nvkm_falcon_v1_clear_interrupt(struct nvkm_falcon *, u32);
@@ -20,6 +20,7 @@ struct nvkm_falcon {
 	const struct nvkm_subdev *owner;
 	const char *name;
 	u32 addr;
+	struct list_head head; /* nvkm_device.falcon */
 
 	struct mutex mutex;
 	struct mutex dmem_mutex;
@@ -48,6 +49,14 @@ struct nvkm_falcon {
 		u8 ports;
 	} data;
 
+	/* time spent uploading code/data, in ns, by transfer method */
+	struct {
+		u64 pio_bytes;
+		u64 pio_time;
+		u64 dma_bytes;
+		u64 dma_time;
+	} xfer;
+
 	struct nvkm_engine engine;
 };
 
@@ -84,6 +93,8 @@ struct nvkm_falcon_func {
 	void (*load_imem)(struct nvkm_falcon *, void *, u32, u32, u16, u8, bool);
 	void (*load_dmem)(struct nvkm_falcon *, void *, u32, u32, u8);
 	void (*read_dmem)(struct nvkm_falcon *, u32, u32, u8, void *);
+	int (*load_dma)(struct nvkm_falcon *, struct nvkm_memory *, u64 offset,
+			u32 start, u32 size, u16 tag, bool imem, bool secure);
 	u32 emem_addr;
 	void (*bind_context)(struct nvkm_falcon *, struct nvkm_memory *);
 	int (*wait_for_halt)(struct nvkm_falcon *, u32);
@@ -115,6 +126,15 @@ nvkm_falcon_wr32(struct nvkm_falcon *falcon, u32 addr, u32 data)
 	nvkm_wr32(falcon->owner->device, falcon->addr + addr, data);
 }
 
+static inline void
+nvkm_falcon_wr32_rep(struct nvkm_falcon *falcon, u32 addr, const u32 *data,
+		     u32 count)
+{
+	struct nvkm_device *device = falcon->owner->device;
+
+	iowrite32_rep(device->pri + falcon->addr + addr, data, count);
+}
+
 static inline u32
 nvkm_falcon_mask(struct nvkm_falcon *falcon, u32 addr, u32 mask, u32 val)
 {
@@ -127,6 +147,8 @@ void nvkm_falcon_load_imem(struct nvkm_falcon *, void *, u32, u32, u16, u8,
 			   bool);
 void nvkm_falcon_load_dmem(struct nvkm_falcon *, void *, u32, u32, u8);
 void nvkm_falcon_read_dmem(struct nvkm_falcon *, u32, u32, u8, void *);
+int nvkm_falcon_load_dma(struct nvkm_falcon *, struct nvkm_memory *, u64,
+			 u32, u32, u16, bool imem, bool secure);
 void nvkm_falcon_bind_context(struct nvkm_falcon *, struct nvkm_memory *);
 void nvkm_falcon_set_start_addr(struct nvkm_falcon *, u32);
 void nvkm_falcon_start(struct nvkm_falcon *);
@@ -14,6 +14,8 @@ struct nvkm_bios {
 	u32 bmp_offset;
 	u32 bit_offset;
 
+	struct nvbios_index *index;
+
 	struct {
 		u8 major;
 		u8 chip;
@@ -100,7 +100,10 @@ struct nvkm_clk {
 	int ustate_ac; /* user-requested (-1 disabled, -2 perfmon) */
 	int ustate_dc; /* user-requested (-1 disabled, -2 perfmon) */
 	int astate; /* perfmon adjustment (base) */
+	int acstate; /* perfmon adjustment (cstate within astate) */
+	int alevel_nr; /* perfmon levels, see nvkm_clk_alevel() */
 	int dstate; /* display adjustment (min+) */
+	int cstate; /* current, within pstate */
 	u8  temp;
 
 	bool allow_reclock;
@@ -122,6 +125,8 @@ struct nvkm_clk {
 int nvkm_clk_read(struct nvkm_clk *, enum nv_clk_src);
 int nvkm_clk_ustate(struct nvkm_clk *, int req, int pwr);
 int nvkm_clk_astate(struct nvkm_clk *, int req, int rel, bool wait);
+int nvkm_clk_alevel(struct nvkm_clk *, int req, bool wait);
+int nvkm_clk_alevel_get(struct nvkm_clk *);
 int nvkm_clk_dstate(struct nvkm_clk *, int req, int rel);
 int nvkm_clk_tstate(struct nvkm_clk *, u8 temperature);
 
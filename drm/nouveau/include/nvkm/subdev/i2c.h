@@ -39,6 +39,20 @@ struct nvkm_i2c_bus {
 	struct list_head head;
 	struct i2c_adapter i2c;
 	u8 enabled;
+
+	/* Last state driven onto the lines by the internal bit-banging
+	 * algorithm, or -1 if unknown.
+	 */
+	int scl;
+	int sda;
+
+	/* Transfers made through the adapter, protected by "mutex". */
+	struct {
+		u64 xfers;
+		u64 bytes;
+		u64 errors;
+		u64 time; /* ns */
+	} stats;
 };
 
 int nvkm_i2c_bus_acquire(struct nvkm_i2c_bus *);
@@ -6,6 +6,7 @@
 struct nvkm_mc {
 	const struct nvkm_mc_func *func;
 	struct nvkm_subdev subdev;
+	spinlock_t lock; /* PMC_ENABLE, subdevs may init concurrently */
 };
 
 void nvkm_mc_enable(struct nvkm_device *, enum nvkm_devidx);
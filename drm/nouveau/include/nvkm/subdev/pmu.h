@@ -4,6 +4,39 @@
 #include <core/subdev.h>
 #include <core/falcon.h>
 
+typedef void (*nvkm_pmu_callback)(void *priv, u32 data0, u32 data1);
+
+/**
+ * struct nvkm_pmu_seq - keep track of a message awaiting a reply
+ *
+ * The legacy PMU interface has no sequence field in its packets, but each
+ * PMU process handles its messages in order, so a reply is matched to the
+ * oldest outstanding request with the same process and message.
+ *
+ * @id:		index into the sequence table
+ * @state:	current state
+ * @serial:	submission order, assigned when the packet is posted
+ * @callback:	called upon receiving the reply (async requests only)
+ * @done:	signaled upon receiving the reply (sync requests only)
+ */
+struct nvkm_pmu_seq {
+	u16 id;
+	enum {
+		NVKM_PMU_SEQ_FREE = 0,
+		NVKM_PMU_SEQ_PENDING,
+		NVKM_PMU_SEQ_USED,
+	} state;
+	u32 serial;
+	u32 process;
+	u32 message;
+	u32 data[2];
+	nvkm_pmu_callback callback;
+	void *priv;
+	struct completion done;
+};
+
+#define NVKM_PMU_SEQ_NUM 16
+
 struct nvkm_pmu {
 	const struct nvkm_pmu_func *func;
 	struct nvkm_subdev subdev;
@@ -17,9 +50,12 @@ struct nvkm_pmu {
 
 	struct completion wpr_ready;
 
+	struct nvkm_pmu_dvfs *dvfs;
+
 	struct {
 		u32 base;
 		u32 size;
+		struct mutex mutex;
 	} send;
 
 	struct {
@@ -28,14 +64,18 @@ struct nvkm_pmu {
 
 		struct work_struct work;
 		wait_queue_head_t wait;
-		u32 process;
-		u32 message;
-		u32 data[2];
+
+		struct mutex mutex;
+		struct nvkm_pmu_seq seq[NVKM_PMU_SEQ_NUM];
+		unsigned long tbl[BITS_TO_LONGS(NVKM_PMU_SEQ_NUM)];
+		u32 serial;
 	} recv;
 };
 
 int nvkm_pmu_send(struct nvkm_pmu *, u32 reply[2], u32 process,
 		  u32 message, u32 data0, u32 data1);
+int nvkm_pmu_send_async(struct nvkm_pmu *, nvkm_pmu_callback, void *priv,
+			u32 process, u32 message, u32 data0, u32 data1);
 void nvkm_pmu_pgob(struct nvkm_pmu *, bool enable);
 bool nvkm_pmu_fan_controlled(struct nvkm_device *);
 
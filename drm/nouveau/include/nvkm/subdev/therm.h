@@ -61,7 +61,6 @@ struct nvkm_therm {
 	struct nvkm_subdev subdev;
 
 	/* automatic thermal management */
-	struct nvkm_alarm alarm;
 	spinlock_t lock;
 	struct nvbios_therm_trip_point *last_trip;
 	int mode;
@@ -79,6 +78,16 @@ struct nvkm_therm {
 		spinlock_t alarm_program_lock;
 		struct nvkm_alarm therm_poll_alarm;
 		enum nvkm_therm_thrs_state alarm_state[NVKM_THERM_THRS_NR];
+
+		/* use the thresholds' interrupts, where the chipset has them */
+		bool intr;
+
+		/* what the poll is for, and how often it's been running */
+		bool poll_thrs;
+		bool poll_fan;
+		bool poll_update; /* fan management's due, whatever the temp */
+		int poll_temp;
+		u32 poll_interval;
 	} sensor;
 
 	/* what should be done if the card overheats */
@@ -4,16 +4,19 @@
 #include <core/subdev.h>
 
 struct nvkm_alarm {
-	struct list_head head;
+	struct nvkm_alarm *parent;
+	struct nvkm_alarm *child[2];
+	bool pending;
 	struct list_head exec;
 	u64 timestamp;
+	u64 deadline;
 	void (*func)(struct nvkm_alarm *);
 };
 
 static inline void
 nvkm_alarm_init(struct nvkm_alarm *alarm, void (*func)(struct nvkm_alarm *))
 {
-	INIT_LIST_HEAD(&alarm->head);
+	alarm->pending = false;
 	alarm->func = func;
 }
 
@@ -21,7 +24,10 @@ struct nvkm_timer {
 	const struct nvkm_timer_func *func;
 	struct nvkm_subdev subdev;
 
-	struct list_head alarms;
+	/* Pending alarms, as a binary min-heap on timestamp. */
+	struct nvkm_alarm *alarms;
+	u32 alarms_nr;
+	u64 armed;
 	spinlock_t lock;
 };
 
@@ -145,6 +145,8 @@ nouveau_abi16_chan_fini(struct nouveau_abi16 *abi16,
 	if (chan->heap.block_size)
 		nvkm_mm_fini(&chan->heap);
 
+	nvif_bocache_fini(&chan->bocache);
+
 	/* destroy channel object, all children will be killed too */
 	if (chan->chan) {
 		nouveau_channel_idle(chan->chan);
@@ -297,6 +299,7 @@ nouveau_abi16_ioctl_channel_alloc(ABI16_IOCTL_ARGS)
 		return nouveau_abi16_put(abi16, -ENOMEM);
 
 	INIT_LIST_HEAD(&chan->notifiers);
+	nvif_bocache_init(&chan->bocache, NOUVEAU_ABI16_BOCACHE_SETS);
 	list_add(&chan->head, &abi16->channels);
 
 	/* create channel object and initialise dma and fence management */
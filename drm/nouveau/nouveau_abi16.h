@@ -2,6 +2,8 @@
 #ifndef __NOUVEAU_ABI16_H__
 #define __NOUVEAU_ABI16_H__
 
+#include <nvif/bocache.h>
+
 #define ABI16_IOCTL_ARGS                                                       \
 	struct drm_device *dev, void *data, struct drm_file *file_priv
 
@@ -25,8 +27,11 @@ struct nouveau_abi16_chan {
 	struct nouveau_bo *ntfy;
 	struct nouveau_vma *ntfy_vma;
 	struct nvkm_mm  heap;
+	struct nvif_bocache bocache; /* recently submitted buffer lists */
 };
 
+#define NOUVEAU_ABI16_BOCACHE_SETS 8
+
 struct nouveau_abi16 {
 	struct nvif_device device;
 	struct list_head channels;
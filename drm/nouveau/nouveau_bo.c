@@ -191,6 +191,8 @@ nouveau_bo_fixup_align(struct nouveau_bo *nvbo, u32 flags,
 	*size = roundup_64(*size, PAGE_SIZE);
 }
 
+static atomic64_t nouveau_bo_serial = ATOMIC64_INIT(0);
+
 struct nouveau_bo *
 nouveau_bo_alloc(struct nouveau_cli *cli, u64 *size, int *align, u32 flags,
 		 u32 tile_mode, u32 tile_flags)
@@ -213,6 +215,7 @@ nouveau_bo_alloc(struct nouveau_cli *cli, u64 *size, int *align, u32 flags,
 	INIT_LIST_HEAD(&nvbo->entry);
 	INIT_LIST_HEAD(&nvbo->vma_list);
 	nvbo->bo.bdev = &drm->ttm.bdev;
+	nvbo->serial = atomic64_inc_return(&nouveau_bo_serial);
 
 	/* This is confusing, and doesn't actually mean we want an uncached
 	 * mapping, but is what NOUVEAU_GEM_DOMAIN_COHERENT gets translated
@@ -741,26 +744,34 @@ nve0_bo_move_init(struct nouveau_channel *chan, u32 handle)
 }
 
 static int
-nve0_bo_move_copy(struct nouveau_channel *chan, struct ttm_buffer_object *bo,
-		  struct ttm_mem_reg *old_reg, struct ttm_mem_reg *new_reg)
+nve0_bo_move_pages(struct nouveau_channel *chan, u64 src_offset,
+		   u64 dst_offset, u32 page_count)
 {
-	struct nouveau_mem *mem = nouveau_mem(old_reg);
 	int ret = RING_SPACE(chan, 10);
 	if (ret == 0) {
 		BEGIN_NVC0(chan, NvSubCopy, 0x0400, 8);
-		OUT_RING  (chan, upper_32_bits(mem->vma[0].addr));
-		OUT_RING  (chan, lower_32_bits(mem->vma[0].addr));
-		OUT_RING  (chan, upper_32_bits(mem->vma[1].addr));
-		OUT_RING  (chan, lower_32_bits(mem->vma[1].addr));
+		OUT_RING  (chan, upper_32_bits(src_offset));
+		OUT_RING  (chan, lower_32_bits(src_offset));
+		OUT_RING  (chan, upper_32_bits(dst_offset));
+		OUT_RING  (chan, lower_32_bits(dst_offset));
 		OUT_RING  (chan, PAGE_SIZE);
 		OUT_RING  (chan, PAGE_SIZE);
 		OUT_RING  (chan, PAGE_SIZE);
-		OUT_RING  (chan, new_reg->num_pages);
+		OUT_RING  (chan, page_count);
 		BEGIN_IMC0(chan, NvSubCopy, 0x0300, 0x0386);
 	}
 	return ret;
 }
 
+static int
+nve0_bo_move_copy(struct nouveau_channel *chan, struct ttm_buffer_object *bo,
+		  struct ttm_mem_reg *old_reg, struct ttm_mem_reg *new_reg)
+{
+	struct nouveau_mem *mem = nouveau_mem(old_reg);
+	return nve0_bo_move_pages(chan, mem->vma[0].addr, mem->vma[1].addr,
+				  new_reg->num_pages);
+}
+
 static int
 nvc0_bo_move_init(struct nouveau_channel *chan, u32 handle)
 {
@@ -1113,6 +1124,92 @@ done:
 	return 0;
 }
 
+/* Moves are only split across copy engines when each of them would get
+ * at least this many pages, and each engine's range is submitted in chunks
+ * of at most STRIPE_CHUNK pages so they all start early.
+ */
+#define NOUVEAU_BO_STRIPE_MIN   1024
+#define NOUVEAU_BO_STRIPE_CHUNK 8191
+
+static int
+nouveau_bo_move_stripe(struct nouveau_drm *drm, struct ttm_buffer_object *bo,
+		       int evict, bool intr, struct ttm_mem_reg *new_reg)
+{
+	struct nouveau_mem *mem = nouveau_mem(&bo->mem);
+	struct nouveau_channel *chan[NVIF_STRIPE_MAX];
+	struct nouveau_fence *fence[NVIF_STRIPE_MAX] = {};
+	struct nvif_stripe *stripe;
+	u32 weight[NVIF_STRIPE_MAX];
+	unsigned long used = 0;
+	int ret, nr, n, i;
+
+	chan[0] = drm->ttm.chan;
+	weight[0] = 1;
+	for (i = 0; i < drm->ttm.stripe_nr; i++) {
+		chan[i + 1] = drm->ttm.stripe[i].chan;
+		weight[i + 1] = drm->ttm.stripe[i].weight;
+	}
+	nr = i + 1;
+
+	n = nvif_stripe_plan(new_reg->num_pages, weight, nr,
+			     NOUVEAU_BO_STRIPE_MIN, NOUVEAU_BO_STRIPE_CHUNK,
+			     NULL, 0);
+	if (n < 0)
+		return n;
+
+	if (!(stripe = kmalloc_array(n, sizeof(*stripe), GFP_KERNEL)))
+		return -ENOMEM;
+	nvif_stripe_plan(new_reg->num_pages, weight, nr,
+			 NOUVEAU_BO_STRIPE_MIN, NOUVEAU_BO_STRIPE_CHUNK,
+			 stripe, n);
+
+	for (i = 0; i < n; i++)
+		used |= BIT(stripe[i].engine);
+
+	for_each_set_bit(i, &used, nr) {
+		ret = nouveau_fence_sync(nouveau_bo(bo), chan[i], true, intr);
+		if (ret)
+			goto done;
+	}
+
+	/* Kick each chunk as it's written, so the engines are copying
+	 * while the rest are still being queued.
+	 */
+	for (i = 0; i < n; i++) {
+		const u64 offset = (u64)stripe[i].first << PAGE_SHIFT;
+		struct nouveau_channel *c = chan[stripe[i].engine];
+
+		ret = nve0_bo_move_pages(c, mem->vma[0].addr + offset,
+					 mem->vma[1].addr + offset,
+					 stripe[i].count);
+		if (ret)
+			goto done;
+		FIRE_RING(c);
+	}
+
+	/* Join everything back onto the main copy channel, which signals
+	 * the single fence the move completes on.
+	 */
+	used &= ~BIT(0);
+	for_each_set_bit(i, &used, nr) {
+		ret = nouveau_fence_new(chan[i], false, &fence[i]);
+		if (ret == 0)
+			ret = nouveau_fence_join(fence[i], chan[0], intr);
+		if (ret)
+			goto done;
+	}
+
+	ret = nouveau_fence_new(chan[0], false, &fence[0]);
+	if (ret == 0)
+		ret = ttm_bo_move_accel_cleanup(bo, &fence[0]->base, evict,
+						new_reg);
+done:
+	for (i = 0; i < nr; i++)
+		nouveau_fence_unref(&fence[i]);
+	kfree(stripe);
+	return ret;
+}
+
 static int
 nouveau_bo_move_m2mf(struct ttm_buffer_object *bo, int evict, bool intr,
 		     bool no_wait_gpu, struct ttm_mem_reg *new_reg)
@@ -1134,6 +1231,13 @@ nouveau_bo_move_m2mf(struct ttm_buffer_object *bo, int evict, bool intr,
 	}
 
 	mutex_lock_nested(&cli->mutex, SINGLE_DEPTH_NESTING);
+	if (drm->ttm.stripe_nr &&
+	    new_reg->num_pages >= NOUVEAU_BO_STRIPE_MIN * 2) {
+		ret = nouveau_bo_move_stripe(drm, bo, evict, intr, new_reg);
+		mutex_unlock(&cli->mutex);
+		return ret;
+	}
+
 	ret = nouveau_fence_sync(nouveau_bo(bo), chan, true, intr);
 	if (ret == 0) {
 		ret = drm->ttm.move(chan, bo, &bo->mem, new_reg);
@@ -1188,7 +1292,7 @@ nouveau_bo_move_init(struct nouveau_drm *drm)
 	};
 	const struct _method_table *mthd = _methods;
 	const char *name = "CPU";
-	int ret;
+	int ret, i;
 
 	do {
 		struct nouveau_channel *chan;
@@ -1219,6 +1323,40 @@ nouveau_bo_move_init(struct nouveau_drm *drm)
 	} while ((++mthd)->exec);
 
 	NV_INFO(drm, "MM: using %s for buffer copies\n", name);
+
+	/* Only the async copy engines are used for striping, which all
+	 * expose the same class as the one found above.
+	 */
+	if (drm->ttm.move != nve0_bo_move_copy || drm->ttm.chan != drm->cechan)
+		return;
+
+	for (i = 0; i < ARRAY_SIZE(drm->ttm.stripe); i++) {
+		struct nouveau_channel *chan = drm->ttm.stripe[i].chan;
+		struct nvif_object *copy = &drm->ttm.stripe[i].copy;
+
+		if (!chan)
+			break;
+
+		ret = nvif_object_init(&chan->user,
+				       mthd->oclass | (mthd->engine << 16),
+				       mthd->oclass, NULL, 0, copy);
+		if (ret == 0) {
+			ret = mthd->init(chan, copy->handle);
+			if (ret)
+				nvif_object_fini(copy);
+		}
+
+		if (ret)
+			break;
+
+		drm->ttm.stripe[i].weight = 1;
+		drm->ttm.stripe_nr++;
+	}
+
+	if (drm->ttm.stripe_nr) {
+		NV_INFO(drm, "MM: splitting buffer copies across %d engines\n",
+			drm->ttm.stripe_nr + 1);
+	}
 }
 
 static int
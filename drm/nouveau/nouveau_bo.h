@@ -17,6 +17,7 @@ struct nouveau_bo {
 	bool force_coherent;
 	struct ttm_bo_kmap_obj kmap;
 	struct list_head head;
+	u64 serial; /* identifies the object to caches without a reference */
 
 	/* protected by ttm_bo_reserve() */
 	struct drm_file *reserved_by;
@@ -33,6 +33,7 @@
 #include <nvif/if0001.h>
 #include "nouveau_debugfs.h"
 #include "nouveau_drv.h"
+#include "nouveau_svm.h"
 
 static int
 nouveau_debugfs_vbios_image(struct seq_file *m, void *data)
@@ -66,6 +67,52 @@ nouveau_debugfs_strap_peek(struct seq_file *m, void *data)
 	return 0;
 }
 
+static int
+nouveau_debugfs_svm_faults(struct seq_file *m, void *data)
+{
+	struct drm_info_node *node = m->private;
+	struct nouveau_drm *drm = nouveau_drm(node->minor->dev);
+
+	nouveau_svm_fault_stats(drm, m);
+	return 0;
+}
+
+static int
+nouveau_debugfs_fence_waits(struct seq_file *m, void *data)
+{
+	struct drm_info_node *node = m->private;
+	struct nouveau_drm *drm = nouveau_drm(node->minor->dev);
+
+	nouveau_fence_stats(drm, m);
+	return 0;
+}
+
+static int
+nouveau_debugfs_falcon_xfer(struct seq_file *m, void *data)
+{
+	struct drm_info_node *node = m->private;
+	struct nouveau_debugfs *debugfs = nouveau_debugfs(node->minor->dev);
+	struct nvif_control_falcon_xfer_v0 args = {};
+	int ret;
+
+	if (!debugfs)
+		return -ENODEV;
+
+	do {
+		ret = nvif_mthd(&debugfs->ctrl, NVIF_CONTROL_FALCON_XFER,
+				&args, sizeof(args));
+		if (ret)
+			return ret == -EINVAL ? 0 : ret;
+
+		seq_printf(m, "%s: pio %llu bytes %llu ns, "
+			      "dma %llu bytes %llu ns\n", args.name,
+			   args.pio_bytes, args.pio_time,
+			   args.dma_bytes, args.dma_time);
+	} while (args.index);
+
+	return 0;
+}
+
 static int
 nouveau_debugfs_pstate_get(struct seq_file *m, void *data)
 {
@@ -207,6 +254,9 @@ static const struct file_operations nouveau_pstate_fops = {
 static struct drm_info_list nouveau_debugfs_list[] = {
 	{ "vbios.rom",  nouveau_debugfs_vbios_image, 0, NULL },
 	{ "strap_peek", nouveau_debugfs_strap_peek, 0, NULL },
+	{ "svm_faults", nouveau_debugfs_svm_faults, 0, NULL },
+	{ "fence_waits", nouveau_debugfs_fence_waits, 0, NULL },
+	{ "falcon_xfer", nouveau_debugfs_falcon_xfer, 0, NULL },
 };
 #define NOUVEAU_DEBUGFS_ENTRIES ARRAY_SIZE(nouveau_debugfs_list)
 
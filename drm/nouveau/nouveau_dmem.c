@@ -28,7 +28,9 @@
 #include "nouveau_svm.h"
 
 #include <nvif/class.h>
+#include <nvif/extent.h>
 #include <nvif/object.h>
+#include <nvif/pfnpool.h>
 #include <nvif/if500b.h>
 #include <nvif/if900b.h>
 #include <nvif/if000c.h>
@@ -43,8 +45,8 @@
  * bigger page size) at lowest level and have some shim layer on top that would
  * provide the same functionality as TTM.
  */
-#define DMEM_CHUNK_SIZE (2UL << 20)
-#define DMEM_CHUNK_NPAGES (DMEM_CHUNK_SIZE >> PAGE_SHIFT)
+#define DMEM_CHUNK_NPAGES NVIF_PFNPOOL_CHUNK_NPAGES
+#define DMEM_CHUNK_SIZE (DMEM_CHUNK_NPAGES << PAGE_SHIFT)
 
 enum nouveau_aper {
 	NOUVEAU_APER_VIRT,
@@ -61,9 +63,6 @@ struct nouveau_dmem_chunk {
 	struct nouveau_bo *bo;
 	struct nouveau_drm *drm;
 	unsigned long pfn_first;
-	unsigned long callocated;
-	unsigned long bitmap[BITS_TO_LONGS(DMEM_CHUNK_NPAGES)];
-	spinlock_t lock;
 };
 
 struct nouveau_dmem_migrate {
@@ -75,9 +74,8 @@ struct nouveau_dmem {
 	struct nouveau_drm *drm;
 	struct dev_pagemap pagemap;
 	struct nouveau_dmem_migrate migrate;
-	struct list_head chunk_free;
-	struct list_head chunk_full;
-	struct list_head chunk_empty;
+	struct nvif_pfnpool pool;
+	struct list_head chunks; /* backed with VRAM, protected by mutex */
 	struct mutex mutex;
 };
 
@@ -96,25 +94,7 @@ static unsigned long nouveau_dmem_page_addr(struct page *page)
 
 static void nouveau_dmem_page_free(struct page *page)
 {
-	struct nouveau_dmem_chunk *chunk = page->zone_device_data;
-	unsigned long idx = page_to_pfn(page) - chunk->pfn_first;
-
-	/*
-	 * FIXME:
-	 *
-	 * This is really a bad example, we need to overhaul nouveau memory
-	 * management to be more page focus and allow lighter locking scheme
-	 * to be use in the process.
-	 */
-	spin_lock(&chunk->lock);
-	clear_bit(idx, chunk->bitmap);
-	WARN_ON(!chunk->callocated);
-	chunk->callocated--;
-	/*
-	 * FIXME when chunk->callocated reach 0 we should add the chunk to
-	 * a reclaim list so that it can be freed in case of memory pressure.
-	 */
-	spin_unlock(&chunk->lock);
+	nvif_pfnpool_free(&page_to_dmem(page)->pool, page_to_pfn(page));
 }
 
 static void nouveau_dmem_fence_done(struct nouveau_fence **fence)
@@ -208,137 +188,71 @@ static const struct dev_pagemap_ops nouveau_dmem_pagemap_ops = {
 	.migrate_to_ram		= nouveau_dmem_migrate_to_ram,
 };
 
+/* Back another chunk of device-private pages with VRAM, only ever called
+ * by one thread at a time.
+ */
 static int
-nouveau_dmem_chunk_alloc(struct nouveau_drm *drm)
+nouveau_dmem_chunk_grow(struct nvif_pfnpool *pool,
+			struct nvif_pfnpool_chunk *pchunk)
 {
+	struct nouveau_dmem *dmem = container_of(pool, typeof(*dmem), pool);
+	struct nouveau_drm *drm = dmem->drm;
 	struct nouveau_dmem_chunk *chunk;
+	struct page *page;
+	unsigned long i;
 	int ret;
 
-	if (drm->dmem == NULL)
-		return -EINVAL;
-
-	mutex_lock(&drm->dmem->mutex);
-	chunk = list_first_entry_or_null(&drm->dmem->chunk_empty,
-					 struct nouveau_dmem_chunk,
-					 list);
-	if (chunk == NULL) {
-		mutex_unlock(&drm->dmem->mutex);
+	if (!(chunk = kzalloc(sizeof(*chunk), GFP_KERNEL)))
 		return -ENOMEM;
-	}
-
-	list_del(&chunk->list);
-	mutex_unlock(&drm->dmem->mutex);
+	chunk->drm = drm;
+	chunk->pfn_first = pchunk->pfn;
 
 	ret = nouveau_bo_new(&drm->client, DMEM_CHUNK_SIZE, 0,
 			     TTM_PL_FLAG_VRAM, 0, 0, NULL, NULL,
 			     &chunk->bo);
 	if (ret)
-		goto out;
+		goto out_free;
 
 	ret = nouveau_bo_pin(chunk->bo, TTM_PL_FLAG_VRAM, false);
-	if (ret) {
-		nouveau_bo_ref(NULL, &chunk->bo);
-		goto out;
-	}
+	if (ret)
+		goto out_bo;
 
-	bitmap_zero(chunk->bitmap, DMEM_CHUNK_NPAGES);
-	spin_lock_init(&chunk->lock);
+	page = pfn_to_page(chunk->pfn_first);
+	for (i = 0; i < DMEM_CHUNK_NPAGES; ++i, ++page)
+		page->zone_device_data = chunk;
+	pchunk->priv = chunk;
 
-out:
-	mutex_lock(&drm->dmem->mutex);
-	if (chunk->bo)
-		list_add(&chunk->list, &drm->dmem->chunk_empty);
-	else
-		list_add_tail(&chunk->list, &drm->dmem->chunk_empty);
-	mutex_unlock(&drm->dmem->mutex);
+	mutex_lock(&dmem->mutex);
+	list_add_tail(&chunk->list, &dmem->chunks);
+	mutex_unlock(&dmem->mutex);
+	return 0;
 
+out_bo:
+	nouveau_bo_ref(NULL, &chunk->bo);
+out_free:
+	kfree(chunk);
 	return ret;
 }
 
-static struct nouveau_dmem_chunk *
-nouveau_dmem_chunk_first_free_locked(struct nouveau_drm *drm)
-{
-	struct nouveau_dmem_chunk *chunk;
-
-	chunk = list_first_entry_or_null(&drm->dmem->chunk_free,
-					 struct nouveau_dmem_chunk,
-					 list);
-	if (chunk)
-		return chunk;
-
-	chunk = list_first_entry_or_null(&drm->dmem->chunk_empty,
-					 struct nouveau_dmem_chunk,
-					 list);
-	if (chunk->bo)
-		return chunk;
-
-	return NULL;
-}
-
+/* Fills "pages" with device-private pfns, as contiguous as possible, and
+ * ~0UL for any that couldn't be allocated.
+ */
 static int
 nouveau_dmem_pages_alloc(struct nouveau_drm *drm,
 			 unsigned long npages,
 			 unsigned long *pages)
 {
-	struct nouveau_dmem_chunk *chunk;
-	unsigned long c;
 	int ret;
 
 	memset(pages, 0xff, npages * sizeof(*pages));
 
-	mutex_lock(&drm->dmem->mutex);
-	for (c = 0; c < npages;) {
-		unsigned long i;
-
-		chunk = nouveau_dmem_chunk_first_free_locked(drm);
-		if (chunk == NULL) {
-			mutex_unlock(&drm->dmem->mutex);
-			ret = nouveau_dmem_chunk_alloc(drm);
-			if (ret) {
-				if (c)
-					return 0;
-				return ret;
-			}
-			mutex_lock(&drm->dmem->mutex);
-			continue;
-		}
-
-		spin_lock(&chunk->lock);
-		i = find_first_zero_bit(chunk->bitmap, DMEM_CHUNK_NPAGES);
-		while (i < DMEM_CHUNK_NPAGES && c < npages) {
-			pages[c] = chunk->pfn_first + i;
-			set_bit(i, chunk->bitmap);
-			chunk->callocated++;
-			c++;
-
-			i = find_next_zero_bit(chunk->bitmap,
-					DMEM_CHUNK_NPAGES, i);
-		}
-		spin_unlock(&chunk->lock);
-	}
-	mutex_unlock(&drm->dmem->mutex);
+	ret = nvif_pfnpool_alloc(&drm->dmem->pool, npages, pages);
+	if (ret < 0)
+		return ret;
 
 	return 0;
 }
 
-static struct page *
-nouveau_dmem_page_alloc_locked(struct nouveau_drm *drm)
-{
-	unsigned long pfns[1];
-	struct page *page;
-	int ret;
-
-	/* FIXME stop all the miss-match API ... */
-	ret = nouveau_dmem_pages_alloc(drm, 1, pfns);
-	if (ret)
-		return NULL;
-
-	page = pfn_to_page(pfns[0]);
-	get_page(page);
-	lock_page(page);
-	return page;
-}
-
 static void
 nouveau_dmem_page_free_locked(struct nouveau_drm *drm, struct page *page)
 {
@@ -356,12 +270,7 @@ nouveau_dmem_resume(struct nouveau_drm *drm)
 		return;
 
 	mutex_lock(&drm->dmem->mutex);
-	list_for_each_entry (chunk, &drm->dmem->chunk_free, list) {
-		ret = nouveau_bo_pin(chunk->bo, TTM_PL_FLAG_VRAM, false);
-		/* FIXME handle pin failure */
-		WARN_ON(ret);
-	}
-	list_for_each_entry (chunk, &drm->dmem->chunk_full, list) {
+	list_for_each_entry (chunk, &drm->dmem->chunks, list) {
 		ret = nouveau_bo_pin(chunk->bo, TTM_PL_FLAG_VRAM, false);
 		/* FIXME handle pin failure */
 		WARN_ON(ret);
@@ -378,10 +287,7 @@ nouveau_dmem_suspend(struct nouveau_drm *drm)
 		return;
 
 	mutex_lock(&drm->dmem->mutex);
-	list_for_each_entry (chunk, &drm->dmem->chunk_free, list) {
-		nouveau_bo_unpin(chunk->bo);
-	}
-	list_for_each_entry (chunk, &drm->dmem->chunk_full, list) {
+	list_for_each_entry (chunk, &drm->dmem->chunks, list) {
 		nouveau_bo_unpin(chunk->bo);
 	}
 	mutex_unlock(&drm->dmem->mutex);
@@ -395,20 +301,15 @@ nouveau_dmem_fini(struct nouveau_drm *drm)
 	if (drm->dmem == NULL)
 		return;
 
-	mutex_lock(&drm->dmem->mutex);
-
-	WARN_ON(!list_empty(&drm->dmem->chunk_free));
-	WARN_ON(!list_empty(&drm->dmem->chunk_full));
+	nvif_pfnpool_fini(&drm->dmem->pool);
 
-	list_for_each_entry_safe (chunk, tmp, &drm->dmem->chunk_empty, list) {
-		if (chunk->bo) {
-			nouveau_bo_unpin(chunk->bo);
-			nouveau_bo_ref(NULL, &chunk->bo);
-		}
+	mutex_lock(&drm->dmem->mutex);
+	list_for_each_entry_safe (chunk, tmp, &drm->dmem->chunks, list) {
+		nouveau_bo_unpin(chunk->bo);
+		nouveau_bo_ref(NULL, &chunk->bo);
 		list_del(&chunk->list);
 		kfree(chunk);
 	}
-
 	mutex_unlock(&drm->dmem->mutex);
 }
 
@@ -493,7 +394,7 @@ nouveau_dmem_init(struct nouveau_drm *drm)
 {
 	struct device *device = drm->dev->dev;
 	struct resource *res;
-	unsigned long i, size, pfn_first;
+	unsigned long size;
 	int ret;
 
 	/* This only make sense on PASCAL or newer */
@@ -505,9 +406,7 @@ nouveau_dmem_init(struct nouveau_drm *drm)
 
 	drm->dmem->drm = drm;
 	mutex_init(&drm->dmem->mutex);
-	INIT_LIST_HEAD(&drm->dmem->chunk_free);
-	INIT_LIST_HEAD(&drm->dmem->chunk_full);
-	INIT_LIST_HEAD(&drm->dmem->chunk_empty);
+	INIT_LIST_HEAD(&drm->dmem->chunks);
 
 	size = ALIGN(drm->client.device.info.ram_user, DMEM_CHUNK_SIZE);
 
@@ -531,26 +430,11 @@ nouveau_dmem_init(struct nouveau_drm *drm)
 	if (IS_ERR(devm_memremap_pages(device, &drm->dmem->pagemap)))
 		goto out_free;
 
-	pfn_first = res->start >> PAGE_SHIFT;
-	for (i = 0; i < (size / DMEM_CHUNK_SIZE); ++i) {
-		struct nouveau_dmem_chunk *chunk;
-		struct page *page;
-		unsigned long j;
-
-		chunk = kzalloc(sizeof(*chunk), GFP_KERNEL);
-		if (chunk == NULL) {
-			nouveau_dmem_fini(drm);
-			return;
-		}
-
-		chunk->drm = drm;
-		chunk->pfn_first = pfn_first + (i * DMEM_CHUNK_NPAGES);
-		list_add_tail(&chunk->list, &drm->dmem->chunk_empty);
-
-		page = pfn_to_page(chunk->pfn_first);
-		for (j = 0; j < DMEM_CHUNK_NPAGES; ++j, ++page)
-			page->zone_device_data = chunk;
-	}
+	/* Chunks are backed with VRAM as they're first needed. */
+	ret = nvif_pfnpool_init(&drm->dmem->pool, res->start >> PAGE_SHIFT,
+				size / DMEM_CHUNK_SIZE, nouveau_dmem_chunk_grow);
+	if (ret)
+		goto out_free;
 
 	NV_INFO(drm, "DMEM: registered %ldMB of device memory\n", size >> 20);
 	return;
@@ -559,70 +443,212 @@ out_free:
 	drm->dmem = NULL;
 }
 
-static unsigned long nouveau_dmem_migrate_copy_one(struct nouveau_drm *drm,
-		unsigned long src, dma_addr_t *dma_addr, u64 *pfn)
-{
-	struct device *dev = drm->dev->dev;
-	struct page *dpage, *spage;
-	unsigned long paddr;
+/* Pages are migrated to VRAM in batches of one chunk, with the copies for
+ * one batch in flight while the previous one is being finalised.
+ */
+#define NOUVEAU_DMEM_MIGRATE_BATCH DMEM_CHUNK_NPAGES
+
+struct nouveau_dmem_batch {
+	struct migrate_vma args;
+	unsigned long npages;
+	unsigned long *dpfn;
+	u64 *src;	/* host physical address, then DMA address, per page */
+	u64 *dst;	/* VRAM address, per page */
+	u64 *pfns;
 
-	spage = migrate_pfn_to_page(src);
-	if (!spage || !(src & MIGRATE_PFN_MIGRATE))
-		goto out;
+	struct nvif_extent *extent;
+	dma_addr_t *dma_addr;	/* per DMA-mapped extent */
+	u32 *dma_size;
+	int dma_nr;
 
-	dpage = nouveau_dmem_page_alloc_locked(drm);
-	if (!dpage)
-		goto out;
+	struct nouveau_fence *fence;
+};
 
-	*dma_addr = dma_map_page(dev, spage, 0, PAGE_SIZE, DMA_BIDIRECTIONAL);
-	if (dma_mapping_error(dev, *dma_addr))
-		goto out_free_page;
+static void
+nouveau_dmem_batch_fini(struct nouveau_dmem_batch *batch)
+{
+	if (batch->pfns)
+		nouveau_pfns_free(batch->pfns);
+	kvfree(batch->dma_size);
+	kvfree(batch->dma_addr);
+	kvfree(batch->extent);
+	kvfree(batch->dst);
+	kvfree(batch->src);
+	kvfree(batch->dpfn);
+	kvfree(batch->args.dst);
+	kvfree(batch->args.src);
+}
 
-	paddr = nouveau_dmem_page_addr(dpage);
-	if (drm->dmem->migrate.copy_func(drm, 1, NOUVEAU_APER_VRAM,
-			paddr, NOUVEAU_APER_HOST, *dma_addr))
-		goto out_dma_unmap;
+static int
+nouveau_dmem_batch_init(struct nouveau_dmem_batch *batch,
+			struct vm_area_struct *vma, unsigned long max)
+{
+	memset(batch, 0x00, sizeof(*batch));
+	batch->args.vma = vma;
+	batch->args.src = kvcalloc(max, sizeof(*batch->args.src), GFP_KERNEL);
+	batch->args.dst = kvcalloc(max, sizeof(*batch->args.dst), GFP_KERNEL);
+	batch->dpfn = kvcalloc(max, sizeof(*batch->dpfn), GFP_KERNEL);
+	batch->src = kvcalloc(max, sizeof(*batch->src), GFP_KERNEL);
+	batch->dst = kvcalloc(max, sizeof(*batch->dst), GFP_KERNEL);
+	batch->extent = kvcalloc(max, sizeof(*batch->extent), GFP_KERNEL);
+	batch->dma_addr = kvcalloc(max, sizeof(*batch->dma_addr), GFP_KERNEL);
+	batch->dma_size = kvcalloc(max, sizeof(*batch->dma_size), GFP_KERNEL);
+	batch->pfns = nouveau_pfns_alloc(max);
+	if (!batch->args.src || !batch->args.dst || !batch->dpfn ||
+	    !batch->src || !batch->dst || !batch->extent ||
+	    !batch->dma_addr || !batch->dma_size || !batch->pfns) {
+		nouveau_dmem_batch_fini(batch);
+		return -ENOMEM;
+	}
+	return 0;
+}
+
+/* Drop a page that was going to be migrated, but won't be. */
+static void
+nouveau_dmem_batch_skip(struct nouveau_drm *drm,
+			struct nouveau_dmem_batch *batch, unsigned long i)
+{
+	if (batch->args.dst[i]) {
+		nouveau_dmem_page_free_locked(drm,
+			migrate_pfn_to_page(batch->args.dst[i]));
+		batch->args.dst[i] = 0;
+	}
+	batch->src[i] = NVIF_EXTENT_SKIP;
+	batch->pfns[i] = NVIF_VMM_PFNMAP_V0_NONE;
+}
 
-	*pfn = NVIF_VMM_PFNMAP_V0_V | NVIF_VMM_PFNMAP_V0_VRAM |
-		((paddr >> PAGE_SHIFT) << NVIF_VMM_PFNMAP_V0_ADDR_SHIFT);
-	if (src & MIGRATE_PFN_WRITE)
-		*pfn |= NVIF_VMM_PFNMAP_V0_W;
-	return migrate_pfn(page_to_pfn(dpage)) | MIGRATE_PFN_LOCKED;
+/* DMA map the source pages, a physically contiguous run at a time. */
+static void
+nouveau_dmem_batch_map(struct nouveau_drm *drm,
+		       struct nouveau_dmem_batch *batch)
+{
+	struct device *dev = drm->dev->dev;
+	unsigned long i, j;
+	int nr;
+
+	nr = nvif_extent_plan(batch->src, NULL, batch->npages, PAGE_SIZE,
+			      U32_MAX >> PAGE_SHIFT, batch->extent,
+			      batch->npages);
+	for (j = 0, batch->dma_nr = 0; j < nr; j++) {
+		const struct nvif_extent *extent = &batch->extent[j];
+		struct page *spage =
+			migrate_pfn_to_page(batch->args.src[extent->first]);
+		u32 size = extent->count << PAGE_SHIFT;
+		dma_addr_t addr;
+
+		addr = dma_map_page(dev, spage, 0, size, DMA_BIDIRECTIONAL);
+		if (dma_mapping_error(dev, addr)) {
+			for (i = 0; i < extent->count; i++)
+				nouveau_dmem_batch_skip(drm, batch,
+							extent->first + i);
+			continue;
+		}
 
-out_dma_unmap:
-	dma_unmap_page(dev, *dma_addr, PAGE_SIZE, DMA_BIDIRECTIONAL);
-out_free_page:
-	nouveau_dmem_page_free_locked(drm, dpage);
-out:
-	*pfn = NVIF_VMM_PFNMAP_V0_NONE;
-	return 0;
+		batch->dma_addr[batch->dma_nr] = addr;
+		batch->dma_size[batch->dma_nr++] = size;
+		for (i = 0; i < extent->count; i++)
+			batch->src[extent->first + i] = addr + (i << PAGE_SHIFT);
+	}
 }
 
-static void nouveau_dmem_migrate_chunk(struct nouveau_drm *drm,
-		struct nouveau_svmm *svmm, struct migrate_vma *args,
-		dma_addr_t *dma_addrs, u64 *pfns)
+static void
+nouveau_dmem_batch_unmap(struct nouveau_drm *drm,
+			 struct nouveau_dmem_batch *batch)
 {
-	struct nouveau_fence *fence;
-	unsigned long addr = args->start, nr_dma = 0, i;
-
-	for (i = 0; addr < args->end; i++) {
-		args->dst[i] = nouveau_dmem_migrate_copy_one(drm, args->src[i],
-				dma_addrs + nr_dma, pfns + i);
-		if (args->dst[i])
-			nr_dma++;
-		addr += PAGE_SIZE;
+	while (batch->dma_nr--) {
+		dma_unmap_page(drm->dev->dev, batch->dma_addr[batch->dma_nr],
+			       batch->dma_size[batch->dma_nr],
+			       DMA_BIDIRECTIONAL);
 	}
+}
 
-	nouveau_fence_new(drm->dmem->migrate.chan, false, &fence);
-	migrate_vma_pages(args);
-	nouveau_dmem_fence_done(&fence);
-	nouveau_pfns_map(svmm, args->vma->vm_mm, args->start, pfns, i);
+/* Allocate VRAM for, and start copying, every page in the batch that can
+ * be migrated.  One copy is issued for each run of pages that's
+ * contiguous on both sides.
+ */
+static void
+nouveau_dmem_batch_copy(struct nouveau_drm *drm,
+			struct nouveau_dmem_batch *batch)
+{
+	struct migrate_vma *args = &batch->args;
+	unsigned long i, c, nr;
+	int ret, j;
+
+	for (i = 0, nr = 0; i < batch->npages; i++) {
+		struct page *spage = migrate_pfn_to_page(args->src[i]);
+		args->dst[i] = 0;
+		batch->pfns[i] = NVIF_VMM_PFNMAP_V0_NONE;
+		if (spage && (args->src[i] & MIGRATE_PFN_MIGRATE)) {
+			batch->src[i] = page_to_phys(spage);
+			nr++;
+		} else {
+			batch->src[i] = NVIF_EXTENT_SKIP;
+		}
+	}
+
+	if (!nr || nouveau_dmem_pages_alloc(drm, nr, batch->dpfn))
+		return;
+
+	for (i = 0, c = 0; i < batch->npages; i++) {
+		struct page *dpage;
+
+		if (batch->src[i] == NVIF_EXTENT_SKIP)
+			continue;
 
-	while (nr_dma--) {
-		dma_unmap_page(drm->dev->dev, dma_addrs[nr_dma], PAGE_SIZE,
-				DMA_BIDIRECTIONAL);
+		/* The allocator may have come up short. */
+		if (c == nr || batch->dpfn[c] == ~0UL) {
+			nouveau_dmem_batch_skip(drm, batch, i);
+			continue;
+		}
+
+		dpage = pfn_to_page(batch->dpfn[c++]);
+		get_page(dpage);
+		lock_page(dpage);
+		args->dst[i] = migrate_pfn(page_to_pfn(dpage)) |
+			       MIGRATE_PFN_LOCKED;
+		batch->dst[i] = nouveau_dmem_page_addr(dpage);
 	}
-	migrate_vma_finalize(args);
+
+	nouveau_dmem_batch_map(drm, batch);
+
+	nr = nvif_extent_plan(batch->src, batch->dst, batch->npages,
+			      PAGE_SIZE, U32_MAX, batch->extent,
+			      batch->npages);
+	for (j = 0; j < nr; j++) {
+		const struct nvif_extent *extent = &batch->extent[j];
+
+		ret = drm->dmem->migrate.copy_func(drm, extent->count,
+				NOUVEAU_APER_VRAM, batch->dst[extent->first],
+				NOUVEAU_APER_HOST, batch->src[extent->first]);
+		for (i = extent->first; i < extent->first + extent->count; i++) {
+			if (ret) {
+				nouveau_dmem_batch_skip(drm, batch, i);
+				continue;
+			}
+
+			batch->pfns[i] = NVIF_VMM_PFNMAP_V0_V |
+					 NVIF_VMM_PFNMAP_V0_VRAM |
+					 ((batch->dst[i] >> PAGE_SHIFT) <<
+					  NVIF_VMM_PFNMAP_V0_ADDR_SHIFT);
+			if (args->src[i] & MIGRATE_PFN_WRITE)
+				batch->pfns[i] |= NVIF_VMM_PFNMAP_V0_W;
+		}
+	}
+
+	nouveau_fence_new(drm->dmem->migrate.chan, false, &batch->fence);
+}
+
+static void
+nouveau_dmem_batch_done(struct nouveau_drm *drm, struct nouveau_svmm *svmm,
+			struct nouveau_dmem_batch *batch)
+{
+	migrate_vma_pages(&batch->args);
+	if (batch->fence)
+		nouveau_dmem_fence_done(&batch->fence);
+	nouveau_pfns_map(svmm, batch->args.vma->vm_mm, batch->args.start,
+			 batch->pfns, batch->npages);
+	nouveau_dmem_batch_unmap(drm, batch);
+	migrate_vma_finalize(&batch->args);
 }
 
 int
@@ -633,53 +659,47 @@ nouveau_dmem_migrate_vma(struct nouveau_drm *drm,
 			 unsigned long end)
 {
 	unsigned long npages = (end - start) >> PAGE_SHIFT;
-	unsigned long max = min(SG_MAX_SINGLE_ALLOC, npages);
-	dma_addr_t *dma_addrs;
-	struct migrate_vma args = {
-		.vma		= vma,
-		.start		= start,
-	};
-	unsigned long i;
-	u64 *pfns;
-	int ret = -ENOMEM;
-
-	args.src = kcalloc(max, sizeof(*args.src), GFP_KERNEL);
-	if (!args.src)
-		goto out;
-	args.dst = kcalloc(max, sizeof(*args.dst), GFP_KERNEL);
-	if (!args.dst)
-		goto out_free_src;
-
-	dma_addrs = kmalloc_array(max, sizeof(*dma_addrs), GFP_KERNEL);
-	if (!dma_addrs)
-		goto out_free_dst;
-
-	pfns = nouveau_pfns_alloc(max);
-	if (!pfns)
-		goto out_free_dma;
-
-	for (i = 0; i < npages; i += max) {
-		args.end = start + (max << PAGE_SHIFT);
-		ret = migrate_vma_setup(&args);
+	unsigned long max = min(NOUVEAU_DMEM_MIGRATE_BATCH, npages);
+	struct nouveau_dmem_batch batch[2], *prev = NULL, *next;
+	unsigned long addr;
+	int ret, i;
+
+	ret = nouveau_dmem_batch_init(&batch[0], vma, max);
+	if (ret)
+		return ret;
+	ret = nouveau_dmem_batch_init(&batch[1], vma, max);
+	if (ret) {
+		nouveau_dmem_batch_fini(&batch[0]);
+		return ret;
+	}
+
+	/* The copies for each batch are queued before the previous batch
+	 * is waited on and finalised, keeping the copy engine busy while
+	 * the CPU side of the migration is being done.
+	 */
+	for (addr = start, i = 0; addr < end; addr = next->args.end, i ^= 1) {
+		next = &batch[i];
+		next->args.start = addr;
+		next->args.end = min(end, addr + (max << PAGE_SHIFT));
+		next->npages = (next->args.end - addr) >> PAGE_SHIFT;
+
+		ret = migrate_vma_setup(&next->args);
 		if (ret)
-			goto out_free_pfns;
+			break;
 
-		if (args.cpages)
-			nouveau_dmem_migrate_chunk(drm, svmm, &args, dma_addrs,
-						   pfns);
-		args.start = args.end;
+		if (next->args.cpages)
+			nouveau_dmem_batch_copy(drm, next);
+
+		if (prev)
+			nouveau_dmem_batch_done(drm, svmm, prev);
+		prev = next->args.cpages ? next : NULL;
 	}
 
-	ret = 0;
-out_free_pfns:
-	nouveau_pfns_free(pfns);
-out_free_dma:
-	kfree(dma_addrs);
-out_free_dst:
-	kfree(args.dst);
-out_free_src:
-	kfree(args.src);
-out:
+	if (prev)
+		nouveau_dmem_batch_done(drm, svmm, prev);
+
+	nouveau_dmem_batch_fini(&batch[1]);
+	nouveau_dmem_batch_fini(&batch[0]);
 	return ret;
 }
 
@@ -289,6 +289,15 @@ done:
 static void
 nouveau_accel_ce_fini(struct nouveau_drm *drm)
 {
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(drm->ttm.stripe); i++) {
+		nouveau_channel_idle(drm->ttm.stripe[i].chan);
+		nvif_object_fini(&drm->ttm.stripe[i].copy);
+		nouveau_channel_del(&drm->ttm.stripe[i].chan);
+	}
+	drm->ttm.stripe_nr = 0;
+
 	nouveau_channel_idle(drm->cechan);
 	nvif_object_fini(&drm->ttm.copy);
 	nouveau_channel_del(&drm->cechan);
@@ -320,8 +329,33 @@ nouveau_accel_ce_init(struct nouveau_drm *drm)
 					  &drm->cechan);
 	}
 
-	if (ret)
+	if (ret) {
 		NV_ERROR(drm, "failed to create ce channel, %d\n", ret);
+		return;
+	}
+
+	/* Also grab a channel on each of the remaining async copy engines,
+	 * buffer moves will be split across them if they get a copy class.
+	 */
+	if (device->info.family >= NV_DEVICE_INFO_V0_KEPLER) {
+		u64 runm = nvif_fifo_runlist_ce(device);
+		int i;
+
+		/* cechan is always placed on the lowest runlist. */
+		runm &= runm - 1;
+		for (i = 0; runm && i < ARRAY_SIZE(drm->ttm.stripe); i++) {
+			ret = nouveau_channel_new(drm, device,
+						  BIT_ULL(__ffs64(runm)), 0,
+						  true, &drm->ttm.stripe[i].chan);
+			if (ret) {
+				NV_DEBUG(drm, "failed to create ce channel "
+					      "on runlists %016llx, %d\n",
+					 runm, ret);
+				break;
+			}
+			runm &= runm - 1;
+		}
+	}
 }
 
 static void
@@ -521,6 +555,8 @@ nouveau_drm_device_init(struct drm_device *dev)
 
 	INIT_LIST_HEAD(&drm->clients);
 	spin_lock_init(&drm->tile.lock);
+	mutex_init(&drm->chan.mutex);
+	INIT_LIST_HEAD(&drm->chan.fctx);
 
 	/* workaround an odd issue on nvc1 by disabling the device's
 	 * nosnoop capability.  hopefully won't cause issues until a
@@ -781,7 +817,7 @@ static int
 nouveau_do_suspend(struct drm_device *dev, bool runtime)
 {
 	struct nouveau_drm *drm = nouveau_drm(dev);
-	int ret;
+	int ret, i;
 
 	nouveau_svm_suspend(drm);
 	nouveau_dmem_suspend(drm);
@@ -806,6 +842,12 @@ nouveau_do_suspend(struct drm_device *dev, bool runtime)
 			goto fail_display;
 	}
 
+	for (i = 0; i < drm->ttm.stripe_nr; i++) {
+		ret = nouveau_channel_idle(drm->ttm.stripe[i].chan);
+		if (ret)
+			goto fail_display;
+	}
+
 	if (drm->channel) {
 		ret = nouveau_channel_idle(drm->channel);
 		if (ret)
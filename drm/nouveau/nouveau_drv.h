@@ -44,6 +44,7 @@
 #include <nvif/device.h>
 #include <nvif/ioctl.h>
 #include <nvif/mmu.h>
+#include <nvif/stripe.h>
 #include <nvif/vmm.h>
 
 #include <drm/drm_connector.h>
@@ -106,6 +107,7 @@ struct nouveau_cli {
 	void *abi16;
 	struct list_head objects;
 	struct list_head notifys;
+	struct rw_semaphore lock; /* usif objects/notifys, vs. lookups */
 	char name[32];
 
 	struct work_struct work;
@@ -158,6 +160,13 @@ struct nouveau_drm {
 			    struct ttm_mem_reg *, struct ttm_mem_reg *);
 		struct nouveau_channel *chan;
 		struct nvif_object copy;
+		/* more copy engines, that large moves are split across */
+		struct {
+			struct nouveau_channel *chan;
+			struct nvif_object copy;
+			u32 weight;
+		} stripe[NVIF_STRIPE_MAX - 1];
+		int stripe_nr;
 		int mtrr;
 		int type_vram;
 		int type_host[2];
@@ -177,6 +186,9 @@ struct nouveau_drm {
 	struct {
 		int nr;
 		u64 context_base;
+		/* fence contexts of live channels, for debugfs */
+		struct mutex mutex;
+		struct list_head fctx;
 	} chan;
 
 	/* context for accelerated drm-internal operations */
@@ -27,6 +27,7 @@
 #include <linux/ktime.h>
 #include <linux/hrtimer.h>
 #include <linux/sched/signal.h>
+#include <linux/seq_file.h>
 #include <trace/events/dma_fence.h>
 
 #include <nvif/cl826e.h>
@@ -40,6 +41,12 @@
 static const struct dma_fence_ops nouveau_fence_ops_uevent;
 static const struct dma_fence_ops nouveau_fence_ops_legacy;
 
+/* Longest a waiter will spin before sleeping, roughly what it costs to
+ * sleep and be woken again.  Callers of nouveau_fence_wait() that aren't
+ * lazy will spin a few times longer.
+ */
+#define NOUVEAU_FENCE_SPIN_MAX (20 * NSEC_PER_USEC)
+
 static inline struct nouveau_fence *
 from_fence(struct dma_fence *fence)
 {
@@ -55,15 +62,26 @@ nouveau_fctx(struct nouveau_fence *fence)
 static int
 nouveau_fence_signal(struct nouveau_fence *fence)
 {
+	struct nouveau_fence_chan *fctx = nouveau_fctx(fence);
 	int drop = 0;
 
+	/* The fence is only signalled as it completes when a waiter's
+	 * spinning on it, or the completion interrupt's armed for it,
+	 * otherwise it's whenever the next emit or poll happens along.
+	 */
+	if ((fence->waited ||
+	     test_bit(DMA_FENCE_FLAG_USER_BITS, &fence->base.flags)) &&
+	    !fence->base.error) {
+		nvif_latency_done(&fctx->latency,
+				  ktime_to_ns(ktime_sub(ktime_get(),
+							fence->emitted)));
+	}
+
 	dma_fence_signal_locked(&fence->base);
 	list_del(&fence->head);
 	rcu_assign_pointer(fence->channel, NULL);
 
 	if (test_bit(DMA_FENCE_FLAG_USER_BITS, &fence->base.flags)) {
-		struct nouveau_fence_chan *fctx = nouveau_fctx(fence);
-
 		if (!--fctx->notify_ref)
 			drop = 1;
 	}
@@ -111,6 +129,10 @@ nouveau_fence_context_del(struct nouveau_fence_chan *fctx)
 	nvif_notify_fini(&fctx->notify);
 	fctx->dead = 1;
 
+	mutex_lock(&fctx->drm->chan.mutex);
+	list_del(&fctx->head);
+	mutex_unlock(&fctx->drm->chan.mutex);
+
 	/*
 	 * Ensure that all accesses to fence->channel complete before freeing
 	 * the channel.
@@ -183,6 +205,8 @@ nouveau_fence_context_new(struct nouveau_channel *chan, struct nouveau_fence_cha
 	INIT_LIST_HEAD(&fctx->pending);
 	spin_lock_init(&fctx->lock);
 	fctx->context = chan->drm->chan.context_base + chan->chid;
+	nvif_latency_init(&fctx->latency);
+	fctx->drm = chan->drm;
 
 	if (chan == chan->drm->cechan)
 		strcpy(fctx->name, "copy engine channel");
@@ -191,6 +215,10 @@ nouveau_fence_context_new(struct nouveau_channel *chan, struct nouveau_fence_cha
 	else
 		strcpy(fctx->name, nvxx_client(&cli->base)->name);
 
+	mutex_lock(&fctx->drm->chan.mutex);
+	list_add_tail(&fctx->head, &fctx->drm->chan.fctx);
+	mutex_unlock(&fctx->drm->chan.mutex);
+
 	kref_init(&fctx->fence_ref);
 	if (!priv->uevent)
 		return;
@@ -214,6 +242,7 @@ nouveau_fence_emit(struct nouveau_fence *fence, struct nouveau_channel *chan)
 
 	fence->channel  = chan;
 	fence->timeout  = jiffies + (15 * HZ);
+	fence->emitted  = ktime_get();
 
 	if (priv->uevent)
 		dma_fence_init(&fence->base, &nouveau_fence_ops_uevent,
@@ -260,10 +289,10 @@ nouveau_fence_done(struct nouveau_fence *fence)
 	return dma_fence_is_signaled(&fence->base);
 }
 
+/* Fallback for when there's no completion interrupt to sleep on. */
 static long
-nouveau_fence_wait_legacy(struct dma_fence *f, bool intr, long wait)
+nouveau_fence_wait_poll(struct nouveau_fence *fence, bool intr, long wait)
 {
-	struct nouveau_fence *fence = from_fence(f);
 	unsigned long sleep_time = NSEC_PER_MSEC / 1000;
 	unsigned long t = jiffies, timeout = t + wait;
 
@@ -292,43 +321,109 @@ nouveau_fence_wait_legacy(struct dma_fence *f, bool intr, long wait)
 
 	__set_current_state(TASK_RUNNING);
 
-	return timeout - t;
+	/* Signalled, even if only just in time. */
+	return max_t(long, timeout - t, 1);
 }
 
-static int
-nouveau_fence_wait_busy(struct nouveau_fence *fence, bool intr)
+/* Spin for as long as the channel's recent history says the fence is
+ * likely to take to complete, returns true if it did.
+ */
+static bool
+nouveau_fence_spin(struct nouveau_fence *fence, u64 max, bool *spun)
 {
-	int ret = 0;
+	struct nouveau_fence_chan *fctx = nouveau_fctx(fence);
+	unsigned long flags;
+	u64 time, spin;
 
+	time = ktime_get_ns();
+	spin_lock_irqsave(&fctx->lock, flags);
+	spin = nvif_latency_spin(&fctx->latency,
+				 time - ktime_to_ns(fence->emitted), max);
+	spin_unlock_irqrestore(&fctx->lock, flags);
+
+	*spun = spin != 0;
+	time += spin;
 	while (!nouveau_fence_done(fence)) {
-		if (time_after_eq(jiffies, fence->timeout)) {
-			ret = -EBUSY;
-			break;
-		}
+		if (ktime_get_ns() >= time)
+			return false;
+		cpu_relax();
+	}
 
-		__set_current_state(intr ?
-				    TASK_INTERRUPTIBLE :
-				    TASK_UNINTERRUPTIBLE);
+	return true;
+}
 
-		if (intr && signal_pending(current)) {
-			ret = -ERESTARTSYS;
-			break;
-		}
+/* What's left of a timeout of "wait" jiffies, started at "start". */
+static long
+nouveau_fence_wait_left(long wait, unsigned long start)
+{
+	if (wait == MAX_SCHEDULE_TIMEOUT)
+		return wait;
+	return max(wait - (long)(jiffies - start), 0L);
+}
+
+static long
+nouveau_fence_wait_hybrid(struct nouveau_fence *fence, bool intr, long wait,
+			  u64 max)
+{
+	struct nouveau_fence_chan *fctx = nouveau_fctx(fence);
+	unsigned long start = jiffies;
+	u64 time = ktime_get_ns();
+	bool spun, slept = false;
+	unsigned long flags;
+	long ret;
+
+	/* Only asking whether it's signalled. */
+	if (!wait)
+		return nouveau_fence_done(fence);
+
+	/* Signals it if it completed before anyone waited on it, there's no
+	 * telling when that was, so it's not sampled.
+	 */
+	if (!nouveau_fence_done(fence)) {
+		spin_lock_irqsave(&fctx->lock, flags);
+		fence->waited = true;
+		spin_unlock_irqrestore(&fctx->lock, flags);
 	}
 
-	__set_current_state(TASK_RUNNING);
+	if (wait != MAX_SCHEDULE_TIMEOUT)
+		max = min_t(u64, max, jiffies_to_nsecs(wait));
+
+	if (nouveau_fence_spin(fence, max, &spun)) {
+		ret = max(nouveau_fence_wait_left(wait, start), 1L);
+	} else {
+		/* Too long to be worth spinning for, sleep until the
+		 * completion interrupt if there is one, for the rest
+		 * of the timeout.
+		 */
+		wait = nouveau_fence_wait_left(wait, start);
+		if (fence->base.ops == &nouveau_fence_ops_uevent)
+			ret = dma_fence_default_wait(&fence->base, intr, wait);
+		else
+			ret = nouveau_fence_wait_poll(fence, intr, wait);
+		slept = true;
+	}
+
+	spin_lock_irqsave(&fctx->lock, flags);
+	nvif_latency_wait(&fctx->latency, ktime_get_ns() - time, spun, slept);
+	spin_unlock_irqrestore(&fctx->lock, flags);
 	return ret;
 }
 
+static long
+nouveau_fence_wait_ops(struct dma_fence *f, bool intr, long wait)
+{
+	return nouveau_fence_wait_hybrid(from_fence(f), intr, wait,
+					 NOUVEAU_FENCE_SPIN_MAX);
+}
+
 int
 nouveau_fence_wait(struct nouveau_fence *fence, bool lazy, bool intr)
 {
 	long ret;
 
-	if (!lazy)
-		return nouveau_fence_wait_busy(fence, intr);
-
-	ret = dma_fence_wait_timeout(&fence->base, intr, 15 * HZ);
+	ret = nouveau_fence_wait_hybrid(fence, intr, 15 * HZ, lazy ?
+					NOUVEAU_FENCE_SPIN_MAX :
+					NOUVEAU_FENCE_SPIN_MAX * 4);
 	if (ret < 0)
 		return ret;
 	else if (!ret)
@@ -337,10 +432,69 @@ nouveau_fence_wait(struct nouveau_fence *fence, bool lazy, bool intr)
 		return 0;
 }
 
+void
+nouveau_fence_stats(struct nouveau_drm *drm, struct seq_file *m)
+{
+	struct nouveau_fence_chan *fctx;
+	struct nvif_latency latency;
+	unsigned long flags;
+	u64 waits;
+	int i;
+
+	mutex_lock(&drm->chan.mutex);
+	list_for_each_entry(fctx, &drm->chan.fctx, head) {
+		spin_lock_irqsave(&fctx->lock, flags);
+		latency = fctx->latency;
+		spin_unlock_irqrestore(&fctx->lock, flags);
+
+		for (waits = 0, i = 0; i < NVIF_LATENCY_BUCKETS; i++)
+			waits += latency.wait[i];
+
+		seq_printf(m, "%s (context %u): %llu waits, %llu spun "
+			      "(%llu completed), %llu slept, spin %llu ns\n",
+			   fctx->name, fctx->context, waits, latency.spins,
+			   latency.spun, latency.sleeps,
+			   nvif_latency_spin(&latency, 0,
+					     NOUVEAU_FENCE_SPIN_MAX));
+
+		for (i = 0; i < NVIF_LATENCY_BUCKETS; i++) {
+			if (!latency.wait[i])
+				continue;
+			if (i < NVIF_LATENCY_BUCKETS - 1)
+				seq_printf(m, "  <%6uus", 1 << i);
+			else
+				seq_printf(m, "  >=%5uus", 1 << (i - 1));
+			seq_printf(m, ": %llu\n", latency.wait[i]);
+		}
+	}
+	mutex_unlock(&drm->chan.mutex);
+}
+
+/* Have "chan" wait for "fence" before executing anything submitted after
+ * this, on the GPU if possible, otherwise by waiting for it here.
+ */
 int
-nouveau_fence_sync(struct nouveau_bo *nvbo, struct nouveau_channel *chan, bool exclusive, bool intr)
+nouveau_fence_join(struct nouveau_fence *fence, struct nouveau_channel *chan,
+		   bool intr)
 {
 	struct nouveau_fence_chan *fctx = chan->fence;
+	struct nouveau_channel *prev;
+	bool must_wait = true;
+
+	rcu_read_lock();
+	prev = rcu_dereference(fence->channel);
+	if (prev && (prev == chan || fctx->sync(fence, prev, chan) == 0))
+		must_wait = false;
+	rcu_read_unlock();
+
+	if (must_wait)
+		return dma_fence_wait(&fence->base, intr);
+	return 0;
+}
+
+int
+nouveau_fence_sync(struct nouveau_bo *nvbo, struct nouveau_channel *chan, bool exclusive, bool intr)
+{
 	struct dma_fence *fence;
 	struct dma_resv *resv = nvbo->bo.base.resv;
 	struct dma_resv_list *fobj;
@@ -358,44 +512,23 @@ nouveau_fence_sync(struct nouveau_bo *nvbo, struct nouveau_channel *chan, bool e
 	fence = dma_resv_get_excl(resv);
 
 	if (fence && (!exclusive || !fobj || !fobj->shared_count)) {
-		struct nouveau_channel *prev = NULL;
-		bool must_wait = true;
-
 		f = nouveau_local_fence(fence, chan->drm);
-		if (f) {
-			rcu_read_lock();
-			prev = rcu_dereference(f->channel);
-			if (prev && (prev == chan || fctx->sync(f, prev, chan) == 0))
-				must_wait = false;
-			rcu_read_unlock();
-		}
-
-		if (must_wait)
-			ret = dma_fence_wait(fence, intr);
-
-		return ret;
+		if (f)
+			return nouveau_fence_join(f, chan, intr);
+		return dma_fence_wait(fence, intr);
 	}
 
 	if (!exclusive || !fobj)
 		return ret;
 
 	for (i = 0; i < fobj->shared_count && !ret; ++i) {
-		struct nouveau_channel *prev = NULL;
-		bool must_wait = true;
-
 		fence = rcu_dereference_protected(fobj->shared[i],
 						dma_resv_held(resv));
 
 		f = nouveau_local_fence(fence, chan->drm);
-		if (f) {
-			rcu_read_lock();
-			prev = rcu_dereference(f->channel);
-			if (prev && (prev == chan || fctx->sync(f, prev, chan) == 0))
-				must_wait = false;
-			rcu_read_unlock();
-		}
-
-		if (must_wait)
+		if (f)
+			ret = nouveau_fence_join(f, chan, intr);
+		else
 			ret = dma_fence_wait(fence, intr);
 	}
 
@@ -506,7 +639,7 @@ static const struct dma_fence_ops nouveau_fence_ops_legacy = {
 	.get_timeline_name = nouveau_fence_get_timeline_name,
 	.enable_signaling = nouveau_fence_no_signaling,
 	.signaled = nouveau_fence_is_signaled,
-	.wait = nouveau_fence_wait_legacy,
+	.wait = nouveau_fence_wait_ops,
 	.release = nouveau_fence_release
 };
 
@@ -533,5 +666,6 @@ static const struct dma_fence_ops nouveau_fence_ops_uevent = {
 	.get_timeline_name = nouveau_fence_get_timeline_name,
 	.enable_signaling = nouveau_fence_enable_signaling,
 	.signaled = nouveau_fence_is_signaled,
+	.wait = nouveau_fence_wait_ops,
 	.release = nouveau_fence_release
 };
@@ -4,9 +4,11 @@
 
 #include <linux/dma-fence.h>
 #include <nvif/notify.h>
+#include <nvif/latency.h>
 
 struct nouveau_drm;
 struct nouveau_bo;
+struct seq_file;
 
 struct nouveau_fence {
 	struct dma_fence base;
@@ -15,6 +17,8 @@ struct nouveau_fence {
 
 	struct nouveau_channel __rcu *channel;
 	unsigned long timeout;
+	ktime_t emitted;
+	bool waited;
 };
 
 int  nouveau_fence_new(struct nouveau_channel *, bool sysmem,
@@ -25,6 +29,8 @@ int  nouveau_fence_emit(struct nouveau_fence *, struct nouveau_channel *);
 bool nouveau_fence_done(struct nouveau_fence *);
 int  nouveau_fence_wait(struct nouveau_fence *, bool lazy, bool intr);
 int  nouveau_fence_sync(struct nouveau_bo *, struct nouveau_channel *, bool exclusive, bool intr);
+int  nouveau_fence_join(struct nouveau_fence *, struct nouveau_channel *, bool intr);
+void nouveau_fence_stats(struct nouveau_drm *, struct seq_file *);
 
 struct nouveau_fence_chan {
 	spinlock_t lock;
@@ -46,6 +52,13 @@ struct nouveau_fence_chan {
 
 	struct nvif_notify notify;
 	int notify_ref, dead;
+
+	/* Completion latencies, and how waiters have fared, protected by
+	 * "lock".
+	 */
+	struct nvif_latency latency;
+	struct nouveau_drm *drm;
+	struct list_head head;
 };
 
 struct nouveau_fence_priv {
@@ -324,8 +324,16 @@ nouveau_gem_set_domain(struct drm_gem_object *gem, uint32_t read_domains,
 struct validate_op {
 	struct list_head list;
 	struct ww_acquire_ctx ticket;
+	struct nvif_bocache *cache;
+	struct nvif_bocache_set *set;
 };
 
+static inline u32
+validate_seq(struct nouveau_bo *nvbo)
+{
+	return raw_read_seqcount(&nvbo->bo.base.resv->seq);
+}
+
 static void
 validate_fini_no_ticket(struct validate_op *op, struct nouveau_channel *chan,
 			struct nouveau_fence *fence,
@@ -341,6 +349,17 @@ validate_fini_no_ticket(struct validate_op *op, struct nouveau_channel *chan,
 		if (likely(fence)) {
 			nouveau_bo_fence(nvbo, fence, !!b->write_domains);
 
+			/* Remember the buffer as it's left, with this
+			 * submission's fence added.
+			 */
+			if (op->set) {
+				nvif_bocache_done(&op->set->bo[nvbo->pbbo_index],
+						  nvbo->serial,
+						  nvbo->bo.mem.mem_type,
+						  nvbo->bo.offset,
+						  validate_seq(nvbo));
+			}
+
 			if (chan->vmm->vmm.object.oclass >= NVIF_CLASS_VMM_NV50) {
 				struct nouveau_vma *vma =
 					(void *)(unsigned long)b->user_priv;
@@ -371,12 +390,43 @@ validate_fini(struct validate_op *op, struct nouveau_channel *chan,
 	ww_acquire_fini(&op->ticket);
 }
 
+/* Look up every handle under a single hold of the table lock, rather than
+ * taking it again for each one.
+ */
+static int
+validate_lookup(struct drm_file *file_priv,
+		struct drm_nouveau_gem_pushbuf_bo *pbbo, int nr_buffers,
+		struct drm_gem_object **gem)
+{
+	struct nouveau_cli *cli = nouveau_cli(file_priv);
+	int i;
+
+	spin_lock(&file_priv->table_lock);
+	for (i = 0; i < nr_buffers; i++) {
+		gem[i] = idr_find(&file_priv->object_idr, pbbo[i].handle);
+		if (!gem[i])
+			break;
+		drm_gem_object_get(gem[i]);
+	}
+	spin_unlock(&file_priv->table_lock);
+
+	if (i < nr_buffers) {
+		NV_PRINTK(err, cli, "Unknown handle 0x%08x\n", pbbo[i].handle);
+		while (i--)
+			drm_gem_object_put_unlocked(gem[i]);
+		return -ENOENT;
+	}
+
+	return 0;
+}
+
 static int
 validate_init(struct nouveau_channel *chan, struct drm_file *file_priv,
 	      struct drm_nouveau_gem_pushbuf_bo *pbbo,
 	      int nr_buffers, struct validate_op *op)
 {
 	struct nouveau_cli *cli = nouveau_cli(file_priv);
+	struct drm_gem_object **objs;
 	int trycnt = 0;
 	int ret = -EINVAL, i;
 	struct nouveau_bo *res_bo = NULL;
@@ -384,24 +434,30 @@ validate_init(struct nouveau_channel *chan, struct drm_file *file_priv,
 	LIST_HEAD(vram_list);
 	LIST_HEAD(both_list);
 
+	objs = kvmalloc_array(nr_buffers, sizeof(*objs), GFP_KERNEL);
+	if (!objs)
+		return -ENOMEM;
+
+	ret = validate_lookup(file_priv, pbbo, nr_buffers, objs);
+	if (ret) {
+		kvfree(objs);
+		return ret;
+	}
+
 	ww_acquire_init(&op->ticket, &reservation_ww_class);
 retry:
 	if (++trycnt > 100000) {
 		NV_PRINTK(err, cli, "%s failed and gave up.\n", __func__);
-		return -EINVAL;
+		ret = -EINVAL;
+		goto done;
 	}
 
 	for (i = 0; i < nr_buffers; i++) {
 		struct drm_nouveau_gem_pushbuf_bo *b = &pbbo[i];
-		struct drm_gem_object *gem;
+		struct drm_gem_object *gem = objs[i];
 		struct nouveau_bo *nvbo;
 
-		gem = drm_gem_object_lookup(file_priv, b->handle);
-		if (!gem) {
-			NV_PRINTK(err, cli, "Unknown handle 0x%08x\n", b->handle);
-			ret = -ENOENT;
-			break;
-		}
+		drm_gem_object_get(gem);
 		nvbo = nouveau_gem_object(gem);
 		if (nvbo == res_bo) {
 			res_bo = NULL;
@@ -478,41 +534,72 @@ retry:
 	list_splice_tail(&both_list, &op->list);
 	if (ret)
 		validate_fini(op, chan, NULL, NULL);
+done:
+	for (i = 0; i < nr_buffers; i++)
+		drm_gem_object_put_unlocked(objs[i]);
+	kvfree(objs);
 	return ret;
-
 }
 
 static int
 validate_list(struct nouveau_channel *chan, struct nouveau_cli *cli,
-	      struct list_head *list, struct drm_nouveau_gem_pushbuf_bo *pbbo)
+	      struct validate_op *op, struct drm_nouveau_gem_pushbuf_bo *pbbo)
 {
 	struct nouveau_drm *drm = chan->drm;
 	struct nouveau_bo *nvbo;
 	int ret, relocs = 0;
 
-	list_for_each_entry(nvbo, list, entry) {
+	list_for_each_entry(nvbo, &op->list, entry) {
 		struct drm_nouveau_gem_pushbuf_bo *b = &pbbo[nvbo->pbbo_index];
-
-		ret = nouveau_gem_set_domain(&nvbo->bo.base, b->read_domains,
-					     b->write_domains,
-					     b->valid_domains);
-		if (unlikely(ret)) {
-			NV_PRINTK(err, cli, "fail set_domain\n");
-			return ret;
+		int skip = 0;
+
+		/* If this channel last submitted the same list, and nothing
+		 * has moved or fenced the buffer since, it's still where it
+		 * was validated to, and its only fences are our own.
+		 */
+		if (op->set) {
+			skip = nvif_bocache_skip(&op->set->bo[nvbo->pbbo_index],
+						 nvbo->serial,
+						 nvbo->bo.mem.mem_type,
+						 nvbo->bo.offset,
+						 validate_seq(nvbo));
+			nvif_bocache_account(op->cache, skip);
 		}
 
-		ret = nouveau_bo_validate(nvbo, true, false);
-		if (unlikely(ret)) {
-			if (ret != -ERESTARTSYS)
-				NV_PRINTK(err, cli, "fail ttm_validate\n");
-			return ret;
+		if (!(skip & NVIF_BOCACHE_VALIDATE)) {
+			ret = nouveau_gem_set_domain(&nvbo->bo.base,
+						     b->read_domains,
+						     b->write_domains,
+						     b->valid_domains);
+			if (unlikely(ret)) {
+				NV_PRINTK(err, cli, "fail set_domain\n");
+				return ret;
+			}
+
+			ret = nouveau_bo_validate(nvbo, true, false);
+			if (unlikely(ret)) {
+				if (ret != -ERESTARTSYS)
+					NV_PRINTK(err, cli, "fail ttm_validate\n");
+				return ret;
+			}
+		} else {
+			nouveau_bo_sync_for_device(nvbo);
 		}
 
-		ret = nouveau_fence_sync(nvbo, chan, !!b->write_domains, true);
-		if (unlikely(ret)) {
-			if (ret != -ERESTARTSYS)
-				NV_PRINTK(err, cli, "fail post-validate sync\n");
-			return ret;
+		if (!(skip & NVIF_BOCACHE_SYNC)) {
+			ret = nouveau_fence_sync(nvbo, chan, !!b->write_domains,
+						 true);
+			if (unlikely(ret)) {
+				if (ret != -ERESTARTSYS)
+					NV_PRINTK(err, cli, "fail post-validate sync\n");
+				return ret;
+			}
+		} else
+		if (!b->write_domains) {
+			/* Still need room for our fence. */
+			ret = dma_resv_reserve_shared(nvbo->bo.base.resv, 1);
+			if (unlikely(ret))
+				return ret;
 		}
 
 		if (drm->client.device.info.family < NV_DEVICE_INFO_V0_TESLA) {
@@ -540,13 +627,16 @@ static int
 nouveau_gem_pushbuf_validate(struct nouveau_channel *chan,
 			     struct drm_file *file_priv,
 			     struct drm_nouveau_gem_pushbuf_bo *pbbo,
-			     int nr_buffers,
+			     int nr_buffers, struct nvif_bocache *cache,
+			     struct nvif_bocache_set *set,
 			     struct validate_op *op, bool *apply_relocs)
 {
 	struct nouveau_cli *cli = nouveau_cli(file_priv);
 	int ret;
 
 	INIT_LIST_HEAD(&op->list);
+	op->cache = cache;
+	op->set = set;
 
 	if (nr_buffers == 0)
 		return 0;
@@ -558,7 +648,7 @@ nouveau_gem_pushbuf_validate(struct nouveau_channel *chan,
 		return ret;
 	}
 
-	ret = validate_list(chan, cli, &op->list, pbbo);
+	ret = validate_list(chan, cli, op, pbbo);
 	if (unlikely(ret < 0)) {
 		if (ret != -ERESTARTSYS)
 			NV_PRINTK(err, cli, "validating bo list\n");
@@ -668,7 +758,6 @@ nouveau_gem_pushbuf_reloc_apply(struct nouveau_cli *cli,
 		nouveau_bo_wr32(nvbo, r->reloc_bo_offset >> 2, data);
 	}
 
-	u_free(reloc);
 	return ret;
 }
 
@@ -678,23 +767,25 @@ nouveau_gem_ioctl_pushbuf(struct drm_device *dev, void *data,
 {
 	struct nouveau_abi16 *abi16 = nouveau_abi16_get(file_priv);
 	struct nouveau_cli *cli = nouveau_cli(file_priv);
-	struct nouveau_abi16_chan *temp;
+	struct nouveau_abi16_chan *temp, *achan = NULL;
 	struct nouveau_drm *drm = nouveau_drm(dev);
 	struct drm_nouveau_gem_pushbuf *req = data;
 	struct drm_nouveau_gem_pushbuf_push *push;
 	struct drm_nouveau_gem_pushbuf_reloc *reloc = NULL;
 	struct drm_nouveau_gem_pushbuf_bo *bo;
 	struct nouveau_channel *chan = NULL;
+	struct nvif_bocache_set *set = NULL;
 	struct validate_op op;
 	struct nouveau_fence *fence = NULL;
 	int i, j, ret = 0;
-	bool do_reloc = false, sync = false;
+	bool do_reloc = false, relocs, sync = false;
 
 	if (unlikely(!abi16))
 		return -ENOMEM;
 
 	list_for_each_entry(temp, &abi16->channels, head) {
 		if (temp->chan->chid == req->channel) {
+			achan = temp;
 			chan = temp->chan;
 			break;
 		}
@@ -749,16 +840,37 @@ nouveau_gem_ioctl_pushbuf(struct drm_device *dev, void *data,
 		}
 	}
 
+	/* Look for the buffer list in the ones recently submitted on this
+	 * channel.  If it needed relocations last time, it probably will
+	 * again, so fetch them now instead of validating everything twice.
+	 */
+	BUILD_BUG_ON(offsetof(typeof(*bo), valid_domains) -
+		     offsetof(typeof(*bo), handle) !=
+		     offsetof(struct nvif_bocache_key, valid));
+	if (req->nr_buffers) {
+		set = nvif_bocache_get(&achan->bocache, &bo->handle,
+				       sizeof(*bo), req->nr_buffers);
+	}
+
+	if (set && set->relocs && req->nr_relocs) {
+		reloc = u_memcpya(req->relocs, req->nr_relocs, sizeof(*reloc));
+		if (IS_ERR(reloc))
+			reloc = NULL;
+	}
+
 	/* Validate buffer list */
 revalidate:
 	ret = nouveau_gem_pushbuf_validate(chan, file_priv, bo,
-					   req->nr_buffers, &op, &do_reloc);
+					   req->nr_buffers, &achan->bocache,
+					   set, &op, &relocs);
 	if (ret) {
 		if (ret != -ERESTARTSYS)
 			NV_PRINTK(err, cli, "validate: %d\n", ret);
 		goto out_prevalid;
 	}
 
+	do_reloc = nvif_bocache_relocs(set, do_reloc, relocs);
+
 	/* Apply any relocations that are required */
 	if (do_reloc) {
 		if (!reloc) {
@@ -766,6 +878,7 @@ revalidate:
 			reloc = u_memcpya(req->relocs, req->nr_relocs, sizeof(*reloc));
 			if (IS_ERR(reloc)) {
 				ret = PTR_ERR(reloc);
+				reloc = NULL;
 				goto out_prevalid;
 			}
 
@@ -879,9 +992,9 @@ out:
 				break;
 			}
 		}
-		u_free(reloc);
 	}
 out_prevalid:
+	u_free(reloc);
 	u_free(bo);
 	u_free(push);
 
@@ -24,6 +24,7 @@
 #include "nouveau_chan.h"
 #include "nouveau_dmem.h"
 
+#include <nvif/fault.h>
 #include <nvif/notify.h>
 #include <nvif/object.h>
 #include <nvif/vmm.h>
@@ -33,6 +34,7 @@
 #include <nvif/ifc00d.h>
 
 #include <linux/sched/mm.h>
+#include <linux/seq_file.h>
 #include <linux/sort.h>
 #include <linux/hmm.h>
 
@@ -64,6 +66,8 @@ struct nouveau_svm {
 			struct nouveau_svmm *svmm;
 		} **fault;
 		int fault_nr;
+
+		struct nouveau_svm_fault_args *args;
 	} buffer[1];
 };
 
@@ -76,6 +80,17 @@ struct nouveau_pfnmap_args {
 	struct nvif_vmm_pfnmap_v0 p;
 };
 
+/* Faults are handled in windows of between 64KiB and one large page,
+ * depending on how sequential they've been.
+ */
+#define NOUVEAU_SVM_FAULT_WINDOW_MIN 16
+#define NOUVEAU_SVM_FAULT_WINDOW_MAX 512
+
+struct nouveau_svm_fault_args {
+	struct nouveau_pfnmap_args i;
+	u64 phys[NOUVEAU_SVM_FAULT_WINDOW_MAX];
+};
+
 struct nouveau_ivmm {
 	struct nouveau_svmm *svmm;
 	u64 inst;
@@ -102,6 +117,9 @@ struct nouveau_svmm {
 	} unmanaged;
 
 	struct mutex mutex;
+
+	/* Only touched by the fault handler. */
+	struct nvif_fault_window window;
 };
 
 #define SVMM_DBG(s,f,a...)                                                     \
@@ -333,6 +351,8 @@ nouveau_svmm_init(struct drm_device *dev, void *data,
 	svmm->unmanaged.start = args->unmanaged_addr;
 	svmm->unmanaged.limit = args->unmanaged_addr + args->unmanaged_size;
 	mutex_init(&svmm->mutex);
+	nvif_fault_window_init(&svmm->window, NOUVEAU_SVM_FAULT_WINDOW_MIN,
+			       NOUVEAU_SVM_FAULT_WINDOW_MAX);
 
 	/* Check that SVM isn't already enabled for the client. */
 	mutex_lock(&cli->mutex);
@@ -589,19 +609,13 @@ nouveau_svm_fault(struct nvif_notify *notify)
 	struct nouveau_svm *svm =
 		container_of(buffer, typeof(*svm), buffer[buffer->id]);
 	struct nvif_object *device = &svm->drm->client.device.object;
+	struct nouveau_svm_fault_args *args = buffer->args;
 	struct nouveau_svmm *svmm;
-	struct {
-		struct {
-			struct nvif_ioctl_v0 i;
-			struct nvif_ioctl_mthd_v0 m;
-			struct nvif_vmm_pfnmap_v0 p;
-		} i;
-		u64 phys[16];
-	} args;
 	struct vm_area_struct *vma;
 	u64 inst, start, limit;
-	int fi, fn, pi, fill;
+	int fi, fn, pi, fill, faults;
 	int replay = 0, ret;
+	bool prefetch;
 
 	/* Parse available fault buffer entries into a cache, and update
 	 * the GET pointer so HW can reuse the entries.
@@ -646,11 +660,11 @@ nouveau_svm_fault(struct nvif_notify *notify)
 	mutex_unlock(&svm->mutex);
 
 	/* Process list of faults. */
-	args.i.i.version = 0;
-	args.i.i.type = NVIF_IOCTL_V0_MTHD;
-	args.i.m.version = 0;
-	args.i.m.method = NVIF_VMM_V0_PFNMAP;
-	args.i.p.version = 0;
+	args->i.i.version = 0;
+	args->i.i.type = NVIF_IOCTL_V0_MTHD;
+	args->i.m.version = 0;
+	args->i.m.method = NVIF_VMM_V0_PFNMAP;
+	args->i.p.version = 0;
 
 	for (fi = 0; fn = fi + 1, fi < buffer->fault_nr; fi = fn) {
 		struct svm_notifier notifier;
@@ -663,11 +677,14 @@ nouveau_svm_fault(struct nvif_notify *notify)
 		}
 		SVMM_DBG(svmm, "addr %016llx", buffer->fault[fi]->addr);
 
-		/* We try and group handling of faults within a small
-		 * window into a single update.
+		/* We try and group handling of faults within a window
+		 * into a single update, sized from the SVMM's recent
+		 * fault pattern.
 		 */
 		start = buffer->fault[fi]->addr;
-		limit = start + (ARRAY_SIZE(args.phys) << PAGE_SHIFT);
+		limit = start + ((u64)nvif_fault_window(&svmm->window,
+							start >> PAGE_SHIFT,
+							&prefetch) << PAGE_SHIFT);
 		if (start < svmm->unmanaged.limit)
 			limit = min_t(u64, limit, svmm->unmanaged.start);
 		SVMM_DBG(svmm, "wndw %016llx-%016llx", start, limit);
@@ -706,21 +723,22 @@ nouveau_svm_fault(struct nvif_notify *notify)
 		 * fault window, determining required pages and access
 		 * permissions based on pending faults.
 		 */
-		args.i.p.page = PAGE_SHIFT;
-		args.i.p.addr = start;
-		for (fn = fi, pi = 0;;) {
+again:
+		args->i.p.page = PAGE_SHIFT;
+		args->i.p.addr = start;
+		for (fn = fi, pi = 0, faults = 0;;) {
 			/* Determine required permissions based on GPU fault
 			 * access flags.
 			 *XXX: atomic?
 			 */
 			if (buffer->fault[fn]->access != 0 /* READ. */ &&
 			    buffer->fault[fn]->access != 3 /* PREFETCH. */) {
-				args.phys[pi++] = NVIF_VMM_PFNMAP_V0_V |
-						  NVIF_VMM_PFNMAP_V0_W;
+				args->phys[pi++] = NVIF_VMM_PFNMAP_V0_V |
+						   NVIF_VMM_PFNMAP_V0_W;
 			} else {
-				args.phys[pi++] = NVIF_VMM_PFNMAP_V0_V;
+				args->phys[pi++] = NVIF_VMM_PFNMAP_V0_V;
 			}
-			args.i.p.size = pi << PAGE_SHIFT;
+			faults++;
 
 			/* It's okay to skip over duplicate addresses from the
 			 * same SVMM as faults are ordered by access type such
@@ -742,31 +760,54 @@ nouveau_svm_fault(struct nvif_notify *notify)
 			    buffer->fault[fn]->addr >= limit)
 				break;
 
-			/* Fill in the gap between this fault and the next. */
+			/* Fill in the gap between this fault and the next,
+			 * fetching the pages in it too when streaming.
+			 */
 			fill = (buffer->fault[fn    ]->addr -
 				buffer->fault[fn - 1]->addr) >> PAGE_SHIFT;
-			while (--fill)
-				args.phys[pi++] = NVIF_VMM_PFNMAP_V0_NONE;
+			while (--fill) {
+				args->phys[pi++] = prefetch ?
+						   NVIF_VMM_PFNMAP_V0_V :
+						   NVIF_VMM_PFNMAP_V0_NONE;
+			}
 		}
 
+		/* Fetch ahead to the end of the window (and VMA). */
+		while (prefetch && start + ((u64)pi << PAGE_SHIFT) < limit)
+			args->phys[pi++] = NVIF_VMM_PFNMAP_V0_V;
+		args->i.p.size = (u64)pi << PAGE_SHIFT;
+
 		SVMM_DBG(svmm, "wndw %016llx-%016llx covering %d fault(s)",
-			 args.i.p.addr,
-			 args.i.p.addr + args.i.p.size, fn - fi);
+			 args->i.p.addr,
+			 args->i.p.addr + args->i.p.size, fn - fi);
 
 		notifier.svmm = svmm;
 		ret = mmu_interval_notifier_insert(&notifier.notifier,
 						   svmm->notifier.mm,
-						   args.i.p.addr, args.i.p.size,
+						   args->i.p.addr, args->i.p.size,
 						   &nouveau_svm_mni_ops);
 		if (!ret) {
 			ret = nouveau_range_fault(
-				svmm, svm->drm, &args,
-				sizeof(args.i) + pi * sizeof(args.phys[0]),
-				args.phys, &notifier);
+				svmm, svm->drm, args,
+				sizeof(args->i) + pi * sizeof(args->phys[0]),
+				args->phys, &notifier);
 			mmu_interval_notifier_remove(&notifier.notifier);
 		}
+
+		/* Pages that were only prefetched may not be faultable
+		 * (eg. beyond the end of a file), don't let them take the
+		 * real faults down with them.
+		 */
+		if (ret && prefetch) {
+			SVMM_DBG(svmm, "prefetch failed %d, retrying", ret);
+			prefetch = false;
+			goto again;
+		}
 		mmput(mm);
 
+		nvif_fault_window_done(&svmm->window, start >> PAGE_SHIFT, pi,
+				       fn - fi, prefetch ? pi - faults : 0);
+
 		/* Cancel any faults in the window whose pages didn't manage
 		 * to keep their valid bit, or stay writeable when required.
 		 *
@@ -774,10 +815,10 @@ nouveau_svm_fault(struct nvif_notify *notify)
 		 */
 		while (fi < fn) {
 			struct nouveau_svm_fault *fault = buffer->fault[fi++];
-			pi = (fault->addr - args.i.p.addr) >> PAGE_SHIFT;
+			pi = (fault->addr - args->i.p.addr) >> PAGE_SHIFT;
 			if (ret ||
-			     !(args.phys[pi] & NVIF_VMM_PFNMAP_V0_V) ||
-			    (!(args.phys[pi] & NVIF_VMM_PFNMAP_V0_W) &&
+			     !(args->phys[pi] & NVIF_VMM_PFNMAP_V0_V) ||
+			    (!(args->phys[pi] & NVIF_VMM_PFNMAP_V0_W) &&
 			     fault->access != 0 && fault->access != 3)) {
 				nouveau_svm_fault_cancel_fault(svm, fault);
 				continue;
@@ -871,6 +912,7 @@ nouveau_svm_fault_buffer_dtor(struct nouveau_svm *svm, int id)
 			kfree(buffer->fault[i]);
 		kvfree(buffer->fault);
 	}
+	kvfree(buffer->args);
 
 	nouveau_svm_fault_buffer_fini(svm, id);
 
@@ -911,9 +953,45 @@ nouveau_svm_fault_buffer_ctor(struct nouveau_svm *svm, s32 oclass, int id)
 	if (!buffer->fault)
 		return -ENOMEM;
 
+	buffer->args = kvmalloc(sizeof(*buffer->args), GFP_KERNEL);
+	if (!buffer->args)
+		return -ENOMEM;
+
 	return nouveau_svm_fault_buffer_init(svm, id);
 }
 
+void
+nouveau_svm_fault_stats(struct nouveau_drm *drm, struct seq_file *m)
+{
+	struct nouveau_svm *svm = drm->svm;
+	struct nouveau_ivmm *ivmm, *prev;
+
+	if (!svm)
+		return;
+
+	/* An SVMM's listed once, against the first of its channels. */
+	mutex_lock(&svm->mutex);
+	list_for_each_entry(ivmm, &svm->inst, head) {
+		const struct nvif_fault_window *window = &ivmm->svmm->window;
+
+		list_for_each_entry(prev, &svm->inst, head) {
+			if (prev == ivmm || prev->svmm == ivmm->svmm)
+				break;
+		}
+		if (prev != ivmm)
+			continue;
+
+		seq_printf(m, "inst %016llx: window %u pages, %llu windows, "
+			      "%llu faults, %llu pages (%llu prefetched), "
+			      "grew %llu, shrank %llu\n",
+			   ivmm->inst, window->size, window->stats.windows,
+			   window->stats.faults, window->stats.pages,
+			   window->stats.prefetch, window->stats.grow,
+			   window->stats.shrink);
+	}
+	mutex_unlock(&svm->mutex);
+}
+
 void
 nouveau_svm_resume(struct nouveau_drm *drm)
 {
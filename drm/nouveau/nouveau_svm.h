@@ -4,6 +4,7 @@
 struct drm_device;
 struct drm_file;
 struct nouveau_drm;
+struct seq_file;
 
 struct nouveau_svmm;
 
@@ -12,6 +13,7 @@ void nouveau_svm_init(struct nouveau_drm *);
 void nouveau_svm_fini(struct nouveau_drm *);
 void nouveau_svm_suspend(struct nouveau_drm *);
 void nouveau_svm_resume(struct nouveau_drm *);
+void nouveau_svm_fault_stats(struct nouveau_drm *, struct seq_file *);
 
 int nouveau_svmm_init(struct drm_device *, void *, struct drm_file *);
 void nouveau_svmm_fini(struct nouveau_svmm **);
@@ -28,6 +30,8 @@ static inline void nouveau_svm_init(struct nouveau_drm *drm) {}
 static inline void nouveau_svm_fini(struct nouveau_drm *drm) {}
 static inline void nouveau_svm_suspend(struct nouveau_drm *drm) {}
 static inline void nouveau_svm_resume(struct nouveau_drm *drm) {}
+static inline void nouveau_svm_fault_stats(struct nouveau_drm *drm,
+					   struct seq_file *m) {}
 
 static inline int nouveau_svmm_init(struct drm_device *device, void *p,
 				    struct drm_file *file)
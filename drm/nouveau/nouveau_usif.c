@@ -290,17 +290,38 @@ usif_object_new(struct drm_file *f, void *data, u32 size, void *argv, u32 argc)
 	return ret;
 }
 
+/* Requests that only look at existing objects, and don't need to be
+ * serialised against each other.  Class queries depend on whether the
+ * client's acting as supervisor, which is only stable under cli->mutex.
+ */
+static bool
+usif_ioctl_shared(struct nvif_ioctl_v0 *args)
+{
+	if (args->route)
+		return false;
+
+	switch (args->type) {
+	case NVIF_IOCTL_V0_NOP:
+	case NVIF_IOCTL_V0_RD:
+		return true;
+	default:
+		return false;
+	}
+}
+
 int
 usif_ioctl(struct drm_file *filp, void __user *user, u32 argc)
 {
 	struct nouveau_cli *cli = nouveau_cli(filp);
 	struct nvif_client *client = &cli->base;
-	void *data = kmalloc(argc, GFP_KERNEL);
+	u8    stack[128];
+	void *data = argc <= sizeof(stack) ? stack : kmalloc(argc, GFP_KERNEL);
 	u32   size = argc;
 	union {
 		struct nvif_ioctl_v0 v0;
 	} *argv = data;
 	struct usif_object *object;
+	bool shared;
 	u8 owner;
 	int ret;
 
@@ -320,14 +341,24 @@ usif_ioctl(struct drm_file *filp, void __user *user, u32 argc)
 	} else
 		goto done;
 
+	/* Reads only need usif objects to stay alive while the request is
+	 * in flight, and may skip the client mutex.
+	 */
+	if ((shared = usif_ioctl_shared(&argv->v0))) {
+		down_read(&cli->lock);
+	} else {
+		mutex_lock(&cli->mutex);
+		down_write(&cli->lock);
+	}
+
 	/* USIF slightly abuses some return-only ioctl members in order
 	 * to provide interoperability with the older ABI16 objects
 	 */
-	mutex_lock(&cli->mutex);
 	if (argv->v0.route) {
 		if (ret = -EINVAL, argv->v0.route == 0xff)
 			ret = nouveau_abi16_usif(filp, argv, argc);
 		if (ret) {
+			up_write(&cli->lock);
 			mutex_unlock(&cli->mutex);
 			goto done;
 		}
@@ -366,12 +397,18 @@ usif_ioctl(struct drm_file *filp, void __user *user, u32 argc)
 		argv->v0.token = 0;
 	}
 	argv->v0.owner = owner;
-	mutex_unlock(&cli->mutex);
+	if (shared) {
+		up_read(&cli->lock);
+	} else {
+		up_write(&cli->lock);
+		mutex_unlock(&cli->mutex);
+	}
 
 	if (copy_to_user(user, argv, argc))
 		ret = -EFAULT;
 done:
-	kfree(argv);
+	if ((void *)argv != stack)
+		kfree(argv);
 	return ret;
 }
 
@@ -395,4 +432,5 @@ usif_client_init(struct nouveau_cli *cli)
 {
 	INIT_LIST_HEAD(&cli->objects);
 	INIT_LIST_HEAD(&cli->notifys);
+	init_rwsem(&cli->lock);
 }
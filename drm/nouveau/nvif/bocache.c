@@ -0,0 +1,142 @@
+/*
+ * Copyright 2020 Red Hat Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER(S) OR AUTHOR(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <nvif/bocache.h>
+
+static inline const struct nvif_bocache_key *
+nvif_bocache_key(const void *key, size_t stride, u32 i)
+{
+	return (const void *)((const u8 *)key + i * stride);
+}
+
+static u32
+nvif_bocache_hash(const void *key, size_t stride, u32 nr)
+{
+	u32 hash = 2166136261u ^ nr;
+	u32 i;
+
+	for (i = 0; i < nr; i++) {
+		const struct nvif_bocache_key *k =
+			nvif_bocache_key(key, stride, i);
+
+		hash = (hash ^ k->handle) * 16777619u;
+		hash = (hash ^ (k->read | k->write << 8 | k->valid << 16)) *
+		       16777619u;
+	}
+
+	return hash;
+}
+
+static bool
+nvif_bocache_match(const struct nvif_bocache_set *set, const void *key,
+		   size_t stride, u32 nr, u32 hash)
+{
+	u32 i;
+
+	if (set->hash != hash || set->nr != nr)
+		return false;
+
+	for (i = 0; i < nr; i++) {
+		if (memcmp(&set->key[i], nvif_bocache_key(key, stride, i),
+			   sizeof(set->key[i])))
+			return false;
+	}
+
+	return true;
+}
+
+void
+nvif_bocache_account(struct nvif_bocache *cache, int skip)
+{
+	if (skip & NVIF_BOCACHE_VALIDATE)
+		cache->skipped_validate++;
+	else
+		cache->validated++;
+
+	if (skip & NVIF_BOCACHE_SYNC)
+		cache->skipped_sync++;
+	else
+		cache->synced++;
+}
+
+/* Looks up the set for a buffer list, making it most recently used.  On
+ * a miss, a fresh set (whose buffers match nothing) replaces the least
+ * recently used one, NULL is only returned if that can't be allocated.
+ */
+struct nvif_bocache_set *
+nvif_bocache_get(struct nvif_bocache *cache, const void *key, size_t stride,
+		 u32 nr)
+{
+	const u32 hash = nvif_bocache_hash(key, stride, nr);
+	struct nvif_bocache_set *set;
+	u32 i;
+
+	list_for_each_entry(set, &cache->sets, head) {
+		if (nvif_bocache_match(set, key, stride, nr, hash)) {
+			list_move(&set->head, &cache->sets);
+			cache->hits++;
+			return set;
+		}
+	}
+
+	cache->misses++;
+	if (cache->nr == cache->max) {
+		set = list_last_entry(&cache->sets, typeof(*set), head);
+		list_del(&set->head);
+		kvfree(set);
+		cache->nr--;
+	}
+
+	set = kvzalloc(struct_size(set, bo, nr) + nr * sizeof(*set->key),
+		       GFP_KERNEL);
+	if (!set)
+		return NULL;
+
+	set->hash = hash;
+	set->nr = nr;
+	set->key = (void *)&set->bo[nr];
+	for (i = 0; i < nr; i++)
+		set->key[i] = *nvif_bocache_key(key, stride, i);
+
+	list_add(&set->head, &cache->sets);
+	cache->nr++;
+	return set;
+}
+
+void
+nvif_bocache_fini(struct nvif_bocache *cache)
+{
+	struct nvif_bocache_set *set, *temp;
+
+	list_for_each_entry_safe(set, temp, &cache->sets, head) {
+		list_del(&set->head);
+		kvfree(set);
+	}
+	cache->nr = 0;
+}
+
+void
+nvif_bocache_init(struct nvif_bocache *cache, int max)
+{
+	memset(cache, 0x00, sizeof(*cache));
+	INIT_LIST_HEAD(&cache->sets);
+	cache->max = max;
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2020 Red Hat Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER(S) OR AUTHOR(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <nvif/extent.h>
+
+static inline bool
+nvif_extent_next(const u64 *src, const u64 *dst, u32 prev, u32 i, u64 stride)
+{
+	if (src[i] != src[prev] + stride)
+		return false;
+	return !dst || dst[i] == dst[prev] + stride;
+}
+
+int
+nvif_extent_plan(const u64 *src, const u64 *dst, u32 nr, u64 stride,
+		 u32 count_max, struct nvif_extent *extent, int max)
+{
+	u32 first, i;
+	int n = 0;
+
+	for (first = 0; first < nr; first = i) {
+		if (src[first] == NVIF_EXTENT_SKIP) {
+			i = first + 1;
+			continue;
+		}
+
+		for (i = first + 1; i < nr && i - first < count_max; i++) {
+			if (src[i] == NVIF_EXTENT_SKIP ||
+			    !nvif_extent_next(src, dst, i - 1, i, stride))
+				break;
+		}
+
+		if (extent) {
+			if (n == max)
+				return -ENOSPC;
+			extent[n].first = first;
+			extent[n].count = i - first;
+		}
+		n++;
+	}
+
+	return n;
+}
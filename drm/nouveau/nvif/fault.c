@@ -0,0 +1,74 @@
+/*
+ * Copyright 2020 Red Hat Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER(S) OR AUTHOR(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <nvif/fault.h>
+
+void
+nvif_fault_window_init(struct nvif_fault_window *window, u32 min, u32 max)
+{
+	memset(window, 0x00, sizeof(*window));
+	window->min = max_t(u32, min, 1);
+	window->max = max_t(u32, max, window->min);
+	window->size = window->min;
+}
+
+u32
+nvif_fault_window(struct nvif_fault_window *window, u64 page, bool *prefetch)
+{
+	const u32 size = window->size;
+
+	if (page >= window->next && page - window->next < size) {
+		/* Picking up at, or just beyond, where the last window
+		 * ended: a stream, so fetch further ahead next time.
+		 */
+		if (window->size < window->max) {
+			window->size = min(window->size * 2, window->max);
+			window->stats.grow++;
+		}
+	} else
+	if (page < window->prev || page >= window->next) {
+		/* Somewhere unrelated, back off towards only mapping what
+		 * actually faulted.
+		 */
+		if (window->size > window->min) {
+			window->size = max(window->size / 2, window->min);
+			window->stats.shrink++;
+		}
+	}
+
+	/* A fault back inside the last window leaves the size alone, the
+	 * GPU's still working through what it's been given.
+	 */
+	*prefetch = window->size > window->min;
+	return window->size;
+}
+
+void
+nvif_fault_window_done(struct nvif_fault_window *window, u64 page, u32 pages,
+		       u32 faults, u32 prefetched)
+{
+	window->prev = page;
+	window->next = page + pages;
+	window->stats.windows++;
+	window->stats.faults += faults;
+	window->stats.pages += pages;
+	window->stats.prefetch += prefetched;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2020 Red Hat Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER(S) OR AUTHOR(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <nvif/latency.h>
+
+/* Each sample adds this much, and the histogram halves every so many. */
+#define NVIF_LATENCY_WEIGHT 16
+#define NVIF_LATENCY_DECAY 64
+
+void
+nvif_latency_init(struct nvif_latency *latency)
+{
+	memset(latency, 0x00, sizeof(*latency));
+}
+
+void
+nvif_latency_done(struct nvif_latency *latency, u64 ns)
+{
+	int i;
+
+	latency->done[nvif_latency_bucket(ns)] += NVIF_LATENCY_WEIGHT;
+	if (++latency->samples % NVIF_LATENCY_DECAY == 0) {
+		for (i = 0; i < NVIF_LATENCY_BUCKETS; i++)
+			latency->done[i] /= 2;
+	}
+}
+
+u64
+nvif_latency_spin(const struct nvif_latency *latency, u64 age, u64 max)
+{
+	u64 after = 0, within = 0, covered = 0;
+	int i, first = nvif_latency_bucket(age);
+
+	/* Work that was still outstanding at this age, and how much of it
+	 * completed within "max" of it.
+	 */
+	for (i = first; i < NVIF_LATENCY_BUCKETS; i++) {
+		after += latency->done[i];
+		if (nvif_latency_bound(i) <= age + max)
+			within += latency->done[i];
+	}
+
+	if (!after || within * 2 < after)
+		return 0;
+
+	/* Spin just long enough to cover 90% of what's expected to finish
+	 * within the limit.
+	 */
+	for (i = first; i < NVIF_LATENCY_BUCKETS; i++) {
+		covered += latency->done[i];
+		if (covered * 10 >= within * 9)
+			break;
+	}
+
+	return min(nvif_latency_bound(i) - age, max);
+}
+
+void
+nvif_latency_wait(struct nvif_latency *latency, u64 waited, bool spun,
+		  bool slept)
+{
+	latency->wait[nvif_latency_bucket(waited)]++;
+	if (spun)
+		latency->spins++;
+	if (spun && !slept)
+		latency->spun++;
+	if (slept)
+		latency->sleeps++;
+}
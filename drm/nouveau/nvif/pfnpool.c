@@ -0,0 +1,327 @@
+/*
+ * Copyright 2020 Red Hat Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER(S) OR AUTHOR(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <nvif/pfnpool.h>
+
+/* All called with pool->lock held, unless noted otherwise. */
+static void
+nvif_pfnpool_chunk_link(struct nvif_pfnpool *pool,
+			struct nvif_pfnpool_chunk *chunk)
+{
+	list_del_init(&chunk->head);
+	if (chunk->free == NVIF_PFNPOOL_CHUNK_NPAGES)
+		list_add_tail(&chunk->head, &pool->empty);
+	else
+	if (chunk->free)
+		list_add(&chunk->head, &pool->partial);
+}
+
+static u32
+nvif_pfnpool_chunk_take(struct nvif_pfnpool *pool,
+			struct nvif_pfnpool_chunk *chunk, u32 npages,
+			unsigned long *pfn)
+{
+	const bool was_empty = chunk->free == NVIF_PFNPOOL_CHUNK_NPAGES;
+	u32 c = 0, i = 0, j, n;
+
+	while (c < npages) {
+		i = find_next_zero_bit(chunk->used, NVIF_PFNPOOL_CHUNK_NPAGES, i);
+		if (i == NVIF_PFNPOOL_CHUNK_NPAGES)
+			break;
+		j = find_next_bit(chunk->used, NVIF_PFNPOOL_CHUNK_NPAGES, i);
+		n = min(j - i, npages - c);
+
+		bitmap_set(chunk->used, i, n);
+		pool->stats.runs++;
+		pool->stats.run_pages += n;
+		for (j = i + n; i < j; i++)
+			pfn[c++] = chunk->pfn + i;
+	}
+
+	chunk->free -= c;
+	if (was_empty || !chunk->free)
+		nvif_pfnpool_chunk_link(pool, chunk);
+	return c;
+}
+
+static void
+nvif_pfnpool_chunk_put(struct nvif_pfnpool *pool, unsigned long pfn)
+{
+	struct nvif_pfnpool_chunk *chunk = nvif_pfnpool_chunk(pool, pfn);
+	const u32 i = pfn - chunk->pfn;
+
+	if (WARN_ON(!test_bit(i, chunk->used)))
+		return;
+
+	__clear_bit(i, chunk->used);
+	if (!chunk->free++ || chunk->free == NVIF_PFNPOOL_CHUNK_NPAGES)
+		nvif_pfnpool_chunk_link(pool, chunk);
+}
+
+/* Small requests fill in the gaps in chunks that are already in use,
+ * keeping unused chunks whole for large requests, which want a chunk to
+ * themselves where possible.
+ */
+static struct nvif_pfnpool_chunk *
+nvif_pfnpool_chunk_pick(struct nvif_pfnpool *pool, u32 npages)
+{
+	struct nvif_pfnpool_chunk *chunk;
+	int scan = 8;
+
+	if (npages < NVIF_PFNPOOL_CHUNK_NPAGES / 2) {
+		list_for_each_entry(chunk, &pool->partial, head) {
+			if (chunk->free >= npages || !--scan)
+				return chunk;
+		}
+	}
+
+	chunk = list_first_entry_or_null(&pool->empty, typeof(*chunk), head);
+	if (!chunk)
+		chunk = list_first_entry_or_null(&pool->partial, typeof(*chunk), head);
+	return chunk;
+}
+
+/* Drops pool->lock while the new chunk's being backed. */
+static int
+nvif_pfnpool_grow(struct nvif_pfnpool *pool)
+{
+	struct nvif_pfnpool_chunk *chunk;
+	u64 seq = pool->grow_seq;
+	int ret;
+
+	if (pool->growing) {
+		pool->stats.grow_waits++;
+		spin_unlock(&pool->lock);
+		wait_event(pool->wait, READ_ONCE(pool->grow_seq) != seq);
+		spin_lock(&pool->lock);
+		return pool->grow_ret;
+	}
+
+	if (pool->chunk_next == pool->chunk_nr)
+		return -ENOMEM;
+
+	chunk = &pool->chunk[pool->chunk_next];
+	pool->growing = true;
+	spin_unlock(&pool->lock);
+
+	ret = pool->grow(pool, chunk);
+
+	spin_lock(&pool->lock);
+	if (ret == 0) {
+		pool->chunk_next++;
+		pool->stats.chunks++;
+		pool->stats.grows++;
+		nvif_pfnpool_chunk_link(pool, chunk);
+	}
+
+	pool->grow_ret = ret;
+	pool->growing = false;
+	WRITE_ONCE(pool->grow_seq, seq + 1);
+	wake_up_all(&pool->wait);
+	return ret;
+}
+
+/* Called with cache->lock held, moves "nr" pages between the pool and a
+ * per-CPU cache in one trip to the pool lock.
+ */
+static void
+nvif_pfnpool_cache_refill(struct nvif_pfnpool *pool,
+			  struct nvif_pfnpool_cache *cache, int nr)
+{
+	struct nvif_pfnpool_chunk *chunk;
+
+	spin_lock(&pool->lock);
+	while (cache->nr < nr &&
+	       (chunk = nvif_pfnpool_chunk_pick(pool, nr - cache->nr))) {
+		cache->nr += nvif_pfnpool_chunk_take(pool, chunk, nr - cache->nr,
+						     cache->pfn + cache->nr);
+	}
+	pool->stats.refills++;
+	spin_unlock(&pool->lock);
+}
+
+static void
+nvif_pfnpool_cache_flush(struct nvif_pfnpool *pool,
+			 struct nvif_pfnpool_cache *cache, int nr)
+{
+	spin_lock(&pool->lock);
+	while (cache->nr > nr)
+		nvif_pfnpool_chunk_put(pool, cache->pfn[--cache->nr]);
+	pool->stats.flushes++;
+	spin_unlock(&pool->lock);
+}
+
+static inline struct nvif_pfnpool_cache *
+nvif_pfnpool_cache(struct nvif_pfnpool *pool)
+{
+	return &pool->cache[raw_smp_processor_id() % pool->cache_nr];
+}
+
+/* Called without locks held. */
+static bool
+nvif_pfnpool_cache_get(struct nvif_pfnpool *pool, unsigned long *pfn)
+{
+	struct nvif_pfnpool_cache *cache = nvif_pfnpool_cache(pool);
+	bool ret = false;
+
+	spin_lock(&cache->lock);
+	if (!cache->nr)
+		nvif_pfnpool_cache_refill(pool, cache, NVIF_PFNPOOL_CACHE / 2);
+	if (cache->nr) {
+		*pfn = cache->pfn[--cache->nr];
+		ret = true;
+	}
+	spin_unlock(&cache->lock);
+	return ret;
+}
+
+void
+nvif_pfnpool_free(struct nvif_pfnpool *pool, unsigned long pfn)
+{
+	struct nvif_pfnpool_cache *cache = nvif_pfnpool_cache(pool);
+
+	spin_lock(&cache->lock);
+	if (cache->nr == NVIF_PFNPOOL_CACHE)
+		nvif_pfnpool_cache_flush(pool, cache, NVIF_PFNPOOL_CACHE / 2);
+	cache->pfn[cache->nr++] = pfn;
+	spin_unlock(&cache->lock);
+}
+
+/* Returns the number of pages allocated, which is less than asked for
+ * only if the pool ran out part way, or an error if there were none.
+ */
+int
+nvif_pfnpool_alloc(struct nvif_pfnpool *pool, u32 npages, unsigned long *pfn)
+{
+	struct nvif_pfnpool_chunk *chunk;
+	bool drained = false;
+	int ret = 0;
+	u32 c = 0;
+
+	if (npages == 1 && nvif_pfnpool_cache_get(pool, pfn))
+		return 1;
+
+	spin_lock(&pool->lock);
+	while (c < npages) {
+		if ((chunk = nvif_pfnpool_chunk_pick(pool, npages - c))) {
+			c += nvif_pfnpool_chunk_take(pool, chunk, npages - c,
+						     pfn + c);
+			continue;
+		}
+
+		if (!(ret = nvif_pfnpool_grow(pool)))
+			continue;
+
+		/* Out of chunks, take back what the per-CPU caches hold
+		 * before giving up.
+		 */
+		if (ret != -ENOMEM || drained)
+			break;
+
+		spin_unlock(&pool->lock);
+		nvif_pfnpool_drain(pool);
+		spin_lock(&pool->lock);
+		drained = true;
+	}
+	spin_unlock(&pool->lock);
+
+	return c ? c : ret;
+}
+
+/* Called without locks held. */
+void
+nvif_pfnpool_drain(struct nvif_pfnpool *pool)
+{
+	int i;
+
+	for (i = 0; i < pool->cache_nr; i++) {
+		struct nvif_pfnpool_cache *cache = &pool->cache[i];
+		spin_lock(&cache->lock);
+		if (cache->nr)
+			nvif_pfnpool_cache_flush(pool, cache, 0);
+		spin_unlock(&cache->lock);
+	}
+}
+
+void
+nvif_pfnpool_stats(struct nvif_pfnpool *pool, struct nvif_pfnpool_stats *stats)
+{
+	u64 cached = 0;
+	u32 i;
+
+	for (i = 0; i < pool->cache_nr; i++)
+		cached += READ_ONCE(pool->cache[i].nr);
+
+	spin_lock(&pool->lock);
+	*stats = pool->stats;
+	stats->cached = cached;
+	stats->allocated = 0;
+	for (i = 0; i < pool->chunk_next; i++)
+		stats->allocated += NVIF_PFNPOOL_CHUNK_NPAGES - pool->chunk[i].free;
+	spin_unlock(&pool->lock);
+}
+
+void
+nvif_pfnpool_fini(struct nvif_pfnpool *pool)
+{
+	if (pool->cache)
+		nvif_pfnpool_drain(pool);
+	kvfree(pool->cache);
+	kvfree(pool->chunk);
+	pool->cache = NULL;
+	pool->chunk = NULL;
+}
+
+int
+nvif_pfnpool_init(struct nvif_pfnpool *pool, unsigned long pfn, u32 chunks,
+		  int (*grow)(struct nvif_pfnpool *, struct nvif_pfnpool_chunk *))
+{
+	u32 i;
+
+	memset(pool, 0x00, sizeof(*pool));
+	pool->grow = grow;
+	pool->pfn = pfn;
+	pool->chunk_nr = chunks;
+	spin_lock_init(&pool->lock);
+	INIT_LIST_HEAD(&pool->empty);
+	INIT_LIST_HEAD(&pool->partial);
+	init_waitqueue_head(&pool->wait);
+
+	pool->cache_nr = nr_cpu_ids;
+	pool->cache = kvcalloc(pool->cache_nr, sizeof(*pool->cache), GFP_KERNEL);
+	pool->chunk = kvcalloc(chunks, sizeof(*pool->chunk), GFP_KERNEL);
+	if (!pool->cache || !pool->chunk) {
+		nvif_pfnpool_fini(pool);
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < pool->cache_nr; i++)
+		spin_lock_init(&pool->cache[i].lock);
+
+	for (i = 0; i < chunks; i++) {
+		struct nvif_pfnpool_chunk *chunk = &pool->chunk[i];
+		INIT_LIST_HEAD(&chunk->head);
+		chunk->pfn = pfn + i * NVIF_PFNPOOL_CHUNK_NPAGES;
+		chunk->free = NVIF_PFNPOOL_CHUNK_NPAGES;
+	}
+
+	return 0;
+}
@@ -0,0 +1,328 @@
+/*
+ * Copyright 2020 Red Hat Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER(S) OR AUTHOR(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <nvif/push.h>
+
+enum nvif_push_type {
+	NVIF_PUSH_INC,
+	NVIF_PUSH_NINC,
+	NVIF_PUSH_ONE,
+	NVIF_PUSH_IMM,
+};
+
+static const struct nvif_push_func {
+	u32 mthd_max;
+	u32 size_max;
+	u8  subc_nr;
+	bool one;
+	bool imm;
+} nvif_push_func[] = {
+	[NVIF_PUSH_NV04] = { 0x00002000, 0x07ff, 8 },
+	[NVIF_PUSH_NVC0] = { 0x00008000, 0x1fff, 8, true, true },
+	[NVIF_PUSH_EVO ] = { 0x00040000, 0x07ff, 1 },
+};
+
+static u32
+nvif_push_hdr(enum nvif_push_fmt fmt, enum nvif_push_type type,
+	      const struct nvif_push_mthd *mthd, u32 size)
+{
+	const u32 subc = mthd->subc, addr = mthd->mthd;
+
+	switch (fmt) {
+	case NVIF_PUSH_NV04:
+	case NVIF_PUSH_EVO:
+		return (type == NVIF_PUSH_NINC ? 0x40000000 : 0x00000000) |
+		       (size << 18) | (subc << 13) | addr;
+	case NVIF_PUSH_NVC0:
+		switch (type) {
+		case NVIF_PUSH_INC : size |= 0x2000; break;
+		case NVIF_PUSH_NINC: size |= 0x6000; break;
+		case NVIF_PUSH_ONE : size |= 0xa000; break;
+		case NVIF_PUSH_IMM :
+			size = 0x8000 | mthd->data;
+			break;
+		}
+		return (size << 16) | (subc << 13) | (addr >> 2);
+	default:
+		WARN_ON(1);
+		return 0;
+	}
+}
+
+/* Encoding is planned back-to-front, where for each method we know the
+ * cheapest way to encode everything after it, and the runs of methods
+ * that could share a header with it.
+ *
+ * A header covering i..k-1 costs 1 + (k - i) + cost[k] words, so the best
+ * end point for a run is the k with the lowest k + cost[k], which we track
+ * as the runs are extended backwards.
+ */
+struct nvif_push_plan {
+	u32 cost;
+	u32 next;
+	u8  type;
+
+	u32 inc;     /* end of the incrementing run starting here */
+	u32 inc_min; /* best end point within it */
+	u32 ninc;
+	u32 ninc_min;
+};
+
+#define F(k) ((k) + plan[(k)].cost)
+
+static u32
+nvif_push_scan(struct nvif_push_plan *plan, u32 first, u32 last)
+{
+	u32 best = first, k;
+	for (k = first + 1; k <= last; k++) {
+		if (F(k) < F(best))
+			best = k;
+	}
+	return best;
+}
+
+static void
+nvif_push_plan(const struct nvif_push_func *func,
+	       const struct nvif_push_mthd *mthds, int nr,
+	       struct nvif_push_plan *plan)
+{
+	int i;
+
+	plan[nr].cost = 0;
+
+	for (i = nr - 1; i >= 0; i--) {
+		const struct nvif_push_mthd *mthd = &mthds[i];
+		const struct nvif_push_mthd *next = NULL;
+		struct nvif_push_plan *this = &plan[i];
+		bool inc = false, ninc = false;
+		u32 k, cost;
+
+		if (i + 1 < nr && mthds[i + 1].subc == mthd->subc) {
+			next = &mthds[i + 1];
+			inc  = next->mthd == mthd->mthd + 4;
+			ninc = next->mthd == mthd->mthd;
+		}
+
+		this->inc = inc ? plan[i + 1].inc : i + 1;
+		this->inc_min = i + 1;
+		if (inc && F(plan[i + 1].inc_min) < F(i + 1))
+			this->inc_min = plan[i + 1].inc_min;
+
+		this->ninc = ninc ? plan[i + 1].ninc : i + 1;
+		this->ninc_min = i + 1;
+		if (ninc && F(plan[i + 1].ninc_min) < F(i + 1))
+			this->ninc_min = plan[i + 1].ninc_min;
+
+		/* Incrementing. */
+		k = this->inc_min;
+		if (this->inc - i > func->size_max)
+			k = nvif_push_scan(plan, i + 1, i + func->size_max);
+		this->cost = 1 + F(k) - i;
+		this->next = k;
+		this->type = NVIF_PUSH_INC;
+
+		/* Non-incrementing. */
+		k = this->ninc_min;
+		if (this->ninc - i > func->size_max)
+			k = nvif_push_scan(plan, i + 1, i + func->size_max);
+		if ((cost = 1 + F(k) - i) < this->cost) {
+			this->cost = cost;
+			this->next = k;
+			this->type = NVIF_PUSH_NINC;
+		}
+
+		/* Increment once: the first method, then the next one
+		 * repeatedly.
+		 */
+		if (func->one && inc) {
+			const u32 end = plan[i + 1].ninc;
+			k = i + 1;
+			if (end - i > func->size_max)
+				k = nvif_push_scan(plan, i + 1, i + func->size_max);
+			else
+			if (F(plan[i + 1].ninc_min) < F(k))
+				k = plan[i + 1].ninc_min;
+			if ((cost = 1 + F(k) - i) < this->cost) {
+				this->cost = cost;
+				this->next = k;
+				this->type = NVIF_PUSH_ONE;
+			}
+		}
+
+		/* Immediate data, packed into the header. */
+		if (func->imm && mthd->data < 0x2000) {
+			if ((cost = 1 + plan[i + 1].cost) < this->cost) {
+				this->cost = cost;
+				this->next = i + 1;
+				this->type = NVIF_PUSH_IMM;
+			}
+		}
+	}
+}
+
+int
+nvif_push_encode(enum nvif_push_fmt fmt, const struct nvif_push_mthd *mthds,
+		 int nr, u32 *push, int max, struct nvif_push_stats *stats)
+{
+	const struct nvif_push_func *func = &nvif_push_func[fmt];
+	struct nvif_push_plan *plan;
+	int i, j, words = 0;
+
+	for (i = 0; i < nr; i++) {
+		if ((mthds[i].mthd & 3) || mthds[i].mthd >= func->mthd_max ||
+		    mthds[i].subc >= func->subc_nr)
+			return -EINVAL;
+	}
+
+	if (!(plan = kvmalloc_array(nr + 1, sizeof(*plan), GFP_KERNEL)))
+		return -ENOMEM;
+
+	nvif_push_plan(func, mthds, nr, plan);
+	if (push && plan[0].cost > max) {
+		kvfree(plan);
+		return -ENOSPC;
+	}
+
+	if (stats)
+		memset(stats, 0x00, sizeof(*stats));
+
+	for (i = 0; i < nr; i = plan[i].next) {
+		const enum nvif_push_type type = plan[i].type;
+		const u32 size = plan[i].next - i;
+
+		if (push) {
+			push[words] = nvif_push_hdr(fmt, type, &mthds[i], size);
+			if (type != NVIF_PUSH_IMM) {
+				for (j = 0; j < size; j++)
+					push[words + 1 + j] = mthds[i + j].data;
+			}
+		}
+		words += 1 + (type != NVIF_PUSH_IMM ? size : 0);
+
+		if (stats) {
+			switch (type) {
+			case NVIF_PUSH_INC : stats->inc++; break;
+			case NVIF_PUSH_NINC: stats->ninc++; break;
+			case NVIF_PUSH_ONE : stats->one++; break;
+			case NVIF_PUSH_IMM : stats->imm++; break;
+			}
+			stats->mthds += size;
+		}
+	}
+
+	if (stats)
+		stats->words = words;
+	kvfree(plan);
+	return words;
+}
+
+int
+nvif_push_decode(enum nvif_push_fmt fmt, const u32 *push, int nr,
+		 struct nvif_push_mthd *mthds, int max,
+		 struct nvif_push_stats *stats)
+{
+	struct nvif_push_stats temp = {};
+	int i = 0, j, n = 0;
+
+	while (i < nr) {
+		const u32 hdr = push[i++];
+		enum nvif_push_type type;
+		u32 subc, mthd, size, data = 0;
+
+		switch (fmt) {
+		case NVIF_PUSH_NV04:
+		case NVIF_PUSH_EVO:
+			/* Old-style jumps, jumps/calls, and returns. */
+			if (hdr & 0xa0000003)
+				return -EINVAL;
+			if (fmt == NVIF_PUSH_NV04) {
+				if (hdr & 0x00020000)
+					return -EINVAL;
+				subc = (hdr & 0x0000e000) >> 13;
+				mthd = (hdr & 0x00001ffc);
+			} else {
+				subc = 0;
+				mthd = (hdr & 0x0003fffc);
+			}
+			size = (hdr & 0x1ffc0000) >> 18;
+			type = (hdr & 0x40000000) ? NVIF_PUSH_NINC :
+						    NVIF_PUSH_INC;
+			break;
+		case NVIF_PUSH_NVC0:
+			size = (hdr & 0x1fff0000) >> 16;
+			subc = (hdr & 0x0000e000) >> 13;
+			mthd = (hdr & 0x00001fff) << 2;
+			switch (hdr >> 29) {
+			case 0:
+				if (hdr)
+					return -EINVAL;
+				continue;
+			case 1: type = NVIF_PUSH_INC; break;
+			case 3: type = NVIF_PUSH_NINC; break;
+			case 5: type = NVIF_PUSH_ONE; break;
+			case 4:
+				type = NVIF_PUSH_IMM;
+				data = size;
+				size = 1;
+				break;
+			default:
+				return -EINVAL;
+			}
+			break;
+		default:
+			return -EINVAL;
+		}
+
+		if (type != NVIF_PUSH_IMM && size > nr - i)
+			return -EINVAL;
+
+		switch (type) {
+		case NVIF_PUSH_INC : temp.inc++; break;
+		case NVIF_PUSH_NINC: temp.ninc++; break;
+		case NVIF_PUSH_ONE : temp.one++; break;
+		case NVIF_PUSH_IMM : temp.imm++; break;
+		}
+
+		for (j = 0; j < size; j++, n++) {
+			if (mthds) {
+				if (n >= max)
+					return -ENOSPC;
+				mthds[n].subc = subc;
+				mthds[n].mthd = mthd;
+				mthds[n].data = type == NVIF_PUSH_IMM ? data :
+						push[i + j];
+			}
+
+			if (type == NVIF_PUSH_INC ||
+			    (type == NVIF_PUSH_ONE && j == 0))
+				mthd += 4;
+		}
+
+		if (type != NVIF_PUSH_IMM)
+			i += size;
+		temp.mthds += size;
+	}
+
+	temp.words = nr;
+	if (stats)
+		*stats = temp;
+	return n;
+}
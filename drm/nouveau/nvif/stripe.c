@@ -0,0 +1,119 @@
+/*
+ * Copyright 2020 Red Hat Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER(S) OR AUTHOR(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <nvif/stripe.h>
+
+static void
+nvif_stripe_share(u32 pages, const u32 *weight, int nr, u32 used, u32 *share)
+{
+	u64 total = 0;
+	u32 given = 0;
+	int i;
+
+	for (i = 0; i < nr; i++) {
+		if (used & BIT(i))
+			total += weight[i];
+	}
+
+	for (i = 0; i < nr; i++) {
+		share[i] = 0;
+		if ((used & BIT(i)) && total) {
+			share[i] = div_u64((u64)pages * weight[i], total);
+			given += share[i];
+		}
+	}
+
+	/* Rounding leaves less than one page per engine unassigned. */
+	for (i = 0; given < pages; i = (i + 1) % nr) {
+		if (used & BIT(i)) {
+			share[i]++;
+			given++;
+		}
+	}
+}
+
+int
+nvif_stripe_plan(u32 pages, const u32 *weight, int nr, u32 share_min,
+		 u32 chunk_max, struct nvif_stripe *stripe, int max)
+{
+	u32 share[NVIF_STRIPE_MAX], first[NVIF_STRIPE_MAX];
+	u32 chunks[NVIF_STRIPE_MAX], size[NVIF_STRIPE_MAX];
+	u32 used = 0, rounds = 0;
+	int i, n = 0;
+
+	if (WARN_ON(nr < 1 || nr > NVIF_STRIPE_MAX || !chunk_max))
+		return -EINVAL;
+	if (!pages)
+		return 0;
+
+	for (i = 0; i < nr; i++) {
+		if (i == 0 || weight[i])
+			used |= BIT(i);
+	}
+
+	/* Drop the lightest engine until every share is worth the cost of
+	 * another channel, and the fence to join it back.
+	 */
+	for (;;) {
+		int drop = -1;
+
+		nvif_stripe_share(pages, weight, nr, used, share);
+		for (i = 1; i < nr; i++) {
+			if (!(used & BIT(i)) || share[i] >= share_min)
+				continue;
+			if (drop < 0 || weight[i] <= weight[drop])
+				drop = i;
+		}
+
+		if (drop < 0)
+			break;
+		used &= ~BIT(drop);
+	}
+
+	for (i = 0; i < nr; i++) {
+		first[i] = i ? first[i - 1] + share[i - 1] : 0;
+		chunks[i] = DIV_ROUND_UP(share[i], chunk_max);
+		size[i] = chunks[i] ? DIV_ROUND_UP(share[i], chunks[i]) : 0;
+		rounds = max(rounds, chunks[i]);
+	}
+
+	while (rounds--) {
+		for (i = 0; i < nr; i++) {
+			u32 count = min(share[i], size[i]);
+			if (!count)
+				continue;
+
+			if (stripe) {
+				if (n >= max)
+					return -ENOSPC;
+				stripe[n].engine = i;
+				stripe[n].first = first[i];
+				stripe[n].count = count;
+			}
+
+			first[i] += count;
+			share[i] -= count;
+			n++;
+		}
+	}
+
+	return n;
+}
@@ -113,13 +113,20 @@ nvkm_client_notify_get(struct nvkm_client *client, int index)
 int
 nvkm_client_notify_del(struct nvkm_client *client, int index)
 {
+	struct nvkm_client_notify *notify = NULL;
+	unsigned long flags;
+
 	if (index < ARRAY_SIZE(client->notify)) {
-		if (client->notify[index]) {
-			nvkm_notify_fini(&client->notify[index]->n);
-			kfree(client->notify[index]);
-			client->notify[index] = NULL;
-			return 0;
-		}
+		spin_lock_irqsave(&client->ntfy_lock, flags);
+		notify = client->notify[index];
+		client->notify[index] = NULL;
+		spin_unlock_irqrestore(&client->ntfy_lock, flags);
+	}
+
+	if (notify) {
+		nvkm_notify_fini(&notify->n);
+		kfree(notify);
+		return 0;
 	}
 	return -ENOENT;
 }
@@ -133,6 +140,7 @@ nvkm_client_notify_new(struct nvkm_object *object,
 	union {
 		struct nvif_notify_req_v0 v0;
 	} *req = data;
+	unsigned long flags;
 	u8  index, reply;
 	int ret = -ENOSYS;
 
@@ -165,8 +173,10 @@ nvkm_client_notify_new(struct nvkm_object *object,
 		ret = nvkm_notify_init(object, event, nvkm_client_notify,
 				       false, data, size, reply, &notify->n);
 		if (ret == 0) {
-			client->notify[index] = notify;
 			notify->client = client;
+			spin_lock_irqsave(&client->ntfy_lock, flags);
+			client->notify[index] = notify;
+			spin_unlock_irqrestore(&client->ntfy_lock, flags);
 			return index;
 		}
 	}
@@ -300,6 +310,8 @@ nvkm_client_new(const char *name, u64 device, const char *cfg,
 	client->device = device;
 	client->debug = nvkm_dbgopt(dbg, "CLIENT");
 	client->objroot = RB_ROOT;
+	init_rwsem(&client->objlock);
+	spin_lock_init(&client->ntfy_lock);
 	client->ntfy = ntfy;
 	INIT_LIST_HEAD(&client->umem);
 	spin_lock_init(&client->lock);
@@ -0,0 +1,314 @@
+/*
+ * Copyright 2012 Red Hat Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER(S) OR AUTHOR(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <core/comptag.h>
+
+/* Comptags are kept in an nvkm_mm, where every tag that's free in the mm is
+ * also known to be clear.  Released tags stay allocated, as DIRTY, until
+ * they're needed again, at which point all of them are cleared in as few
+ * operations as possible and handed back to the mm.  Whenever the LTC may
+ * have lost their state, every free tag is marked DIRTY again.
+ *
+ * Nodes owned by the allocator (DIRTY/CACHE) aren't on the mm's free list,
+ * so their fl_entry is used to track them here instead.
+ */
+
+/* Largest run of already-clear tags that'll be cleared again to avoid
+ * splitting a batch into separate clears.
+ */
+#define COMPTAG_BRIDGE 64
+
+static bool
+nvkm_comptag_cache(struct nvkm_comptag *ct, struct nvkm_mm_node *node)
+{
+	const u32 size = node->length - 1;
+
+	if (size >= NVKM_COMPTAG_CACHE_SIZES ||
+	    ct->cache_nr[size] >= NVKM_COMPTAG_CACHE_DEPTH)
+		return false;
+
+	node->type = NVKM_COMPTAG_TYPE_CACHE;
+	list_add(&node->fl_entry, &ct->cache[size]);
+	ct->cache_nr[size]++;
+	return true;
+}
+
+static void
+nvkm_comptag_drain(struct nvkm_comptag *ct)
+{
+	struct nvkm_mm_node *node, *temp;
+	int i;
+
+	for (i = 0; i < NVKM_COMPTAG_CACHE_SIZES; i++) {
+		list_for_each_entry_safe(node, temp, &ct->cache[i], fl_entry) {
+			list_del(&node->fl_entry);
+			nvkm_mm_free(&ct->mm, &node);
+		}
+		ct->cache_nr[i] = 0;
+	}
+}
+
+static void
+nvkm_comptag_clear(struct nvkm_comptag *ct, u32 first, u32 limit)
+{
+	ct->clr(ct->device, first, limit - first);
+	ct->clears++;
+}
+
+static void
+nvkm_comptag_reclaim(struct nvkm_comptag *ct, bool cache)
+{
+	struct nvkm_mm_node *node, *temp;
+	u32 first = 0, limit = 0;
+	bool run = false;
+
+	if (list_empty(&ct->dirty))
+		return;
+
+	/* The mm's node list is ordered by offset, so a single pass is
+	 * enough to merge everything that's been released into runs.
+	 */
+	list_for_each_entry(node, &ct->mm.nodes, nl_entry) {
+		switch (node->type) {
+		case NVKM_COMPTAG_TYPE_DIRTY:
+			if (!run)
+				first = node->offset;
+			limit = node->offset + node->length;
+			run = true;
+			continue;
+		case NVKM_MM_TYPE_NONE:
+		case NVKM_COMPTAG_TYPE_CACHE:
+			if (run && node->offset + node->length - limit <=
+				   COMPTAG_BRIDGE)
+				continue;
+			break;
+		default:
+			break;
+		}
+
+		if (run) {
+			nvkm_comptag_clear(ct, first, limit);
+			run = false;
+		}
+	}
+
+	if (run)
+		nvkm_comptag_clear(ct, first, limit);
+
+	list_for_each_entry_safe(node, temp, &ct->dirty, fl_entry) {
+		list_del(&node->fl_entry);
+		if (!cache || !nvkm_comptag_cache(ct, node))
+			nvkm_mm_free(&ct->mm, &node);
+	}
+
+	ct->flushes++;
+}
+
+static int
+nvkm_comptag_head(struct nvkm_comptag *ct, u32 nr, struct nvkm_mm_node **pnode)
+{
+	struct nvkm_mm_node *node;
+
+	if (nr && nr <= NVKM_COMPTAG_CACHE_SIZES && ct->cache_nr[nr - 1]) {
+		node = list_first_entry(&ct->cache[nr - 1], typeof(*node),
+					fl_entry);
+		list_del(&node->fl_entry);
+		ct->cache_nr[nr - 1]--;
+		ct->hits++;
+		*pnode = node;
+		return 0;
+	}
+
+	return nvkm_mm_head(&ct->mm, 0, NVKM_COMPTAG_TYPE_USED, nr, nr, 1,
+			    pnode);
+}
+
+int
+__nvkm_comptag_get(struct nvkm_comptag *ct, u32 nr, struct nvkm_mm_node **pnode)
+{
+	struct nvkm_mm_node *node;
+	int ret;
+
+	/* Out of clean tags, clear everything that's been released since
+	 * the last time and try again, then give up on the caches.
+	 */
+	if ((ret = nvkm_comptag_head(ct, nr, &node))) {
+		if (!list_empty(&ct->dirty)) {
+			nvkm_comptag_reclaim(ct, true);
+			ret = nvkm_comptag_head(ct, nr, &node);
+		}
+
+		if (ret) {
+			nvkm_comptag_drain(ct);
+			ret = nvkm_comptag_head(ct, nr, &node);
+			if (ret)
+				return ret;
+		}
+	}
+
+	node->type = NVKM_COMPTAG_TYPE_USED;
+	ct->allocs++;
+	*pnode = node;
+	return 0;
+}
+
+void
+__nvkm_comptag_put(struct nvkm_comptag *ct, struct nvkm_mm_node **pnode)
+{
+	struct nvkm_mm_node *node = *pnode;
+
+	if (node) {
+		if (ct->clr) {
+			node->type = NVKM_COMPTAG_TYPE_DIRTY;
+			list_add_tail(&node->fl_entry, &ct->dirty);
+		} else
+		if (!nvkm_comptag_cache(ct, node)) {
+			nvkm_mm_free(&ct->mm, &node);
+		}
+		*pnode = NULL;
+	}
+}
+
+int
+nvkm_comptag_get(struct nvkm_comptag *ct, u32 nr, struct nvkm_mm_node **pnode)
+{
+	int ret;
+	mutex_lock(&ct->mutex);
+	ret = __nvkm_comptag_get(ct, nr, pnode);
+	mutex_unlock(&ct->mutex);
+	return ret;
+}
+
+void
+nvkm_comptag_put(struct nvkm_comptag *ct, struct nvkm_mm_node **pnode)
+{
+	mutex_lock(&ct->mutex);
+	__nvkm_comptag_put(ct, pnode);
+	mutex_unlock(&ct->mutex);
+}
+
+void
+nvkm_comptag_stats(struct nvkm_comptag *ct, struct nvkm_comptag_stats *stats)
+{
+	struct nvkm_mm_node *node;
+
+	memset(stats, 0x00, sizeof(*stats));
+
+	mutex_lock(&ct->mutex);
+	if (nvkm_mm_initialised(&ct->mm)) {
+		list_for_each_entry(node, &ct->mm.nodes, nl_entry) {
+			switch (node->type) {
+			case NVKM_MM_TYPE_NONE:
+				stats->free += node->length;
+				stats->free_max = max(stats->free_max,
+						      node->length);
+				stats->free_nodes++;
+				break;
+			case NVKM_COMPTAG_TYPE_DIRTY:
+				stats->dirty += node->length;
+				break;
+			case NVKM_COMPTAG_TYPE_CACHE:
+				stats->cached += node->length;
+				break;
+			case NVKM_MM_TYPE_HOLE:
+				continue;
+			default:
+				stats->used += node->length;
+				break;
+			}
+			stats->total += node->length;
+		}
+	}
+
+	stats->allocs = ct->allocs;
+	stats->hits = ct->hits;
+	stats->flushes = ct->flushes;
+	stats->clears = ct->clears;
+	mutex_unlock(&ct->mutex);
+}
+
+/* The LTC's been (re)initialised, ie. on resume, so nothing that's free can
+ * be assumed to be clear any more.
+ */
+void
+nvkm_comptag_invalidate(struct nvkm_comptag *ct)
+{
+	struct nvkm_mm_node *node;
+
+	mutex_lock(&ct->mutex);
+	if (ct->clr && nvkm_mm_initialised(&ct->mm)) {
+		nvkm_comptag_drain(ct);
+		while (!nvkm_mm_head(&ct->mm, 0, NVKM_COMPTAG_TYPE_DIRTY, ~0,
+				     1, 1, &node))
+			list_add_tail(&node->fl_entry, &ct->dirty);
+	}
+	mutex_unlock(&ct->mutex);
+}
+
+void
+nvkm_comptag_fini(struct nvkm_comptag *ct)
+{
+	struct nvkm_mm_node *node, *temp;
+
+	if (!nvkm_mm_initialised(&ct->mm))
+		return;
+
+	/* Nothing will use the tags again, so there's no need to clear. */
+	list_for_each_entry_safe(node, temp, &ct->dirty, fl_entry) {
+		list_del(&node->fl_entry);
+		nvkm_mm_free(&ct->mm, &node);
+	}
+
+	nvkm_comptag_drain(ct);
+	nvkm_mm_fini(&ct->mm);
+}
+
+int
+nvkm_comptag_init(struct nvkm_comptag *ct, struct nvkm_device *device, u32 nr,
+		  void (*clr)(struct nvkm_device *, u32, u32))
+{
+	struct nvkm_mm_node *node;
+	int ret, i;
+
+	mutex_init(&ct->mutex);
+	ct->device = device;
+	ct->clr = clr;
+	INIT_LIST_HEAD(&ct->dirty);
+	for (i = 0; i < NVKM_COMPTAG_CACHE_SIZES; i++) {
+		INIT_LIST_HEAD(&ct->cache[i]);
+		ct->cache_nr[i] = 0;
+	}
+
+	ret = nvkm_mm_init(&ct->mm, 0, 0, nr, 1);
+	if (ret || !clr || !nr)
+		return ret;
+
+	/* Nothing is known about the initial state of the tags, treat them
+	 * all as released, so they're cleared in one go when first needed.
+	 */
+	ret = nvkm_mm_head(&ct->mm, 0, NVKM_COMPTAG_TYPE_DIRTY, nr, nr, 1,
+			   &node);
+	if (ret)
+		return ret;
+
+	list_add_tail(&node->fl_entry, &ct->dirty);
+	return 0;
+}
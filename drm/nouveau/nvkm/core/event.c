@@ -29,6 +29,7 @@ nvkm_event_put(struct nvkm_event *event, u32 types, int index)
 	while (types) {
 		int type = __ffs(types); types &= ~(1 << type);
 		if (--event->refs[index * event->types_nr + type] == 0) {
+			event->mask[index] &= ~(1 << type);
 			if (event->func->fini)
 				event->func->fini(event, 1 << type, index);
 		}
@@ -42,6 +43,7 @@ nvkm_event_get(struct nvkm_event *event, u32 types, int index)
 	while (types) {
 		int type = __ffs(types); types &= ~(1 << type);
 		if (++event->refs[index * event->types_nr + type] == 1) {
+			event->mask[index] |= (1 << type);
 			if (event->func->init)
 				event->func->init(event, 1 << type, index);
 		}
@@ -58,9 +60,15 @@ nvkm_event_send(struct nvkm_event *event, u32 types, int index,
 	if (!event->refs || WARN_ON(index >= event->index_nr))
 		return;
 
-	spin_lock_irqsave(&event->list_lock, flags);
-	list_for_each_entry(notify, &event->list, head) {
-		if (notify->index == index && (notify->types & types)) {
+	/* nothing to do if no notify is armed for any of the types, the
+	 * mask is only a hint, nvkm_notify_send() checks under refs_lock
+	 */
+	if (!(READ_ONCE(event->mask[index]) & types))
+		return;
+
+	read_lock_irqsave(&event->list_lock, flags);
+	list_for_each_entry(notify, &event->list[index], head) {
+		if (notify->types & types) {
 			if (event->func->send) {
 				event->func->send(data, size, notify);
 				continue;
@@ -68,7 +76,7 @@ nvkm_event_send(struct nvkm_event *event, u32 types, int index,
 			nvkm_notify_send(notify, data, size);
 		}
 	}
-	spin_unlock_irqrestore(&event->list_lock, flags);
+	read_unlock_irqrestore(&event->list_lock, flags);
 }
 
 void
@@ -78,23 +86,34 @@ nvkm_event_fini(struct nvkm_event *event)
 		kfree(event->refs);
 		event->refs = NULL;
 	}
+	kfree(event->mask);
+	event->mask = NULL;
+	kfree(event->list);
+	event->list = NULL;
 }
 
 int
 nvkm_event_init(const struct nvkm_event_func *func, int types_nr, int index_nr,
 		struct nvkm_event *event)
 {
+	int i;
+
 	event->refs = kzalloc(array3_size(index_nr, types_nr,
 					  sizeof(*event->refs)),
 			      GFP_KERNEL);
-	if (!event->refs)
+	event->mask = kcalloc(index_nr, sizeof(*event->mask), GFP_KERNEL);
+	event->list = kcalloc(index_nr, sizeof(*event->list), GFP_KERNEL);
+	if (!event->refs || !event->mask || !event->list) {
+		nvkm_event_fini(event);
 		return -ENOMEM;
+	}
 
 	event->func = func;
 	event->types_nr = types_nr;
 	event->index_nr = index_nr;
 	spin_lock_init(&event->refs_lock);
-	spin_lock_init(&event->list_lock);
-	INIT_LIST_HEAD(&event->list);
+	rwlock_init(&event->list_lock);
+	for (i = 0; i < index_nr; i++)
+		INIT_LIST_HEAD(&event->list[i]);
 	return 0;
 }
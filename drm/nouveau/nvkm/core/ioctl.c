@@ -425,6 +425,35 @@ nvkm_ioctl_path(struct nvkm_client *client, u64 handle, u32 type,
 	return ret;
 }
 
+/* Only these may run alongside each other on the same client, as they
+ * neither change the client's object tree nor any per-call client state,
+ * nor look at it.  SCLASS isn't one of them, as what's listed depends on
+ * client->super (ie. nvkm_ummu_sclass()).
+ */
+static bool
+nvkm_ioctl_shared(u8 type)
+{
+	switch (type) {
+	case NVIF_IOCTL_V0_NOP:
+	case NVIF_IOCTL_V0_RD:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/* NTFY_GET/PUT come from atomic context (fence signalling, and the notify
+ * callbacks re-arming themselves), so may not sleep on objlock.  Everything
+ * they look at, the object tree and the client's notifies, is only changed
+ * with ntfy_lock held as well.
+ */
+static bool
+nvkm_ioctl_atomic(u8 type)
+{
+	return type == NVIF_IOCTL_V0_NTFY_GET ||
+	       type == NVIF_IOCTL_V0_NTFY_PUT;
+}
+
 int
 nvkm_ioctl(struct nvkm_client *client, bool supervisor,
 	   void *data, u32 size, void **hack)
@@ -433,21 +462,45 @@ nvkm_ioctl(struct nvkm_client *client, bool supervisor,
 	union {
 		struct nvif_ioctl_v0 v0;
 	} *args = data;
+	unsigned long flags;
+	bool shared;
 	int ret = -ENOSYS;
 
-	client->super = supervisor;
 	nvif_ioctl(object, "size %d\n", size);
 
-	if (!(ret = nvif_unpack(ret, &data, &size, args->v0, 0, 0, true))) {
-		nvif_ioctl(object,
-			   "vers %d type %02x object %016llx owner %02x\n",
-			   args->v0.version, args->v0.type, args->v0.object,
-			   args->v0.owner);
+	if ((ret = nvif_unpack(ret, &data, &size, args->v0, 0, 0, true))) {
+		nvif_ioctl(object, "return %d\n", ret);
+		if (hack)
+			*hack = NULL;
+		return ret;
+	}
+
+	if (nvkm_ioctl_atomic(args->v0.type)) {
+		spin_lock_irqsave(&client->ntfy_lock, flags);
 		ret = nvkm_ioctl_path(client, args->v0.object, args->v0.type,
 				      data, size, args->v0.owner,
 				      &args->v0.route, &args->v0.token);
+		spin_unlock_irqrestore(&client->ntfy_lock, flags);
+		nvif_ioctl(object, "return %d\n", ret);
+		if (hack)
+			*hack = NULL;
+		return ret;
 	}
 
+	if ((shared = nvkm_ioctl_shared(args->v0.type))) {
+		down_read(&client->objlock);
+	} else {
+		down_write(&client->objlock);
+		client->super = supervisor;
+	}
+
+	nvif_ioctl(object, "vers %d type %02x object %016llx owner %02x\n",
+		   args->v0.version, args->v0.type, args->v0.object,
+		   args->v0.owner);
+	ret = nvkm_ioctl_path(client, args->v0.object, args->v0.type,
+			      data, size, args->v0.owner,
+			      &args->v0.route, &args->v0.token);
+
 	if (ret != 1) {
 		nvif_ioctl(object, "return %d\n", ret);
 		if (hack) {
@@ -456,5 +509,9 @@ nvkm_ioctl(struct nvkm_client *client, bool supervisor,
 		}
 	}
 
+	if (shared)
+		up_read(&client->objlock);
+	else
+		up_write(&client->objlock);
 	return ret;
 }
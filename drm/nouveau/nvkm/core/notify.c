@@ -93,7 +93,7 @@ nvkm_notify_send(struct nvkm_notify *notify, void *data, u32 size)
 	struct nvkm_event *event = notify->event;
 	unsigned long flags;
 
-	assert_spin_locked(&event->list_lock);
+	lockdep_assert_held(&event->list_lock);
 	BUG_ON(size != notify->size);
 
 	spin_lock_irqsave(&event->refs_lock, flags);
@@ -120,9 +120,9 @@ nvkm_notify_fini(struct nvkm_notify *notify)
 	unsigned long flags;
 	if (notify->event) {
 		nvkm_notify_put(notify);
-		spin_lock_irqsave(&notify->event->list_lock, flags);
+		write_lock_irqsave(&notify->event->list_lock, flags);
 		list_del(&notify->head);
-		spin_unlock_irqrestore(&notify->event->list_lock, flags);
+		write_unlock_irqrestore(&notify->event->list_lock, flags);
 		kfree((void *)notify->data);
 		notify->event = NULL;
 	}
@@ -138,6 +138,9 @@ nvkm_notify_init(struct nvkm_object *object, struct nvkm_event *event,
 	int ret = -ENODEV;
 	if ((notify->event = event), event->refs) {
 		ret = event->func->ctor(object, data, size, notify);
+		if (ret == 0 && WARN_ON(notify->index < 0 ||
+					notify->index >= event->index_nr))
+			ret = -EINVAL;
 		if (ret == 0 && (ret = -EINVAL, notify->size == reply)) {
 			notify->flags = 0;
 			notify->block = 1;
@@ -152,9 +155,10 @@ nvkm_notify_init(struct nvkm_object *object, struct nvkm_event *event,
 			}
 		}
 		if (ret == 0) {
-			spin_lock_irqsave(&event->list_lock, flags);
-			list_add_tail(&notify->head, &event->list);
-			spin_unlock_irqrestore(&event->list_lock, flags);
+			write_lock_irqsave(&event->list_lock, flags);
+			list_add_tail(&notify->head,
+				      &event->list[notify->index]);
+			write_unlock_irqrestore(&event->list_lock, flags);
 		}
 	}
 	if (ret)
@@ -57,16 +57,25 @@ done:
 void
 nvkm_object_remove(struct nvkm_object *object)
 {
-	if (!RB_EMPTY_NODE(&object->node))
-		rb_erase(&object->node, &object->client->objroot);
+	struct nvkm_client *client = object->client;
+	unsigned long flags;
+
+	if (!RB_EMPTY_NODE(&object->node)) {
+		spin_lock_irqsave(&client->ntfy_lock, flags);
+		rb_erase(&object->node, &client->objroot);
+		spin_unlock_irqrestore(&client->ntfy_lock, flags);
+	}
 }
 
 bool
 nvkm_object_insert(struct nvkm_object *object)
 {
-	struct rb_node **ptr = &object->client->objroot.rb_node;
+	struct nvkm_client *client = object->client;
+	struct rb_node **ptr = &client->objroot.rb_node;
 	struct rb_node *parent = NULL;
+	unsigned long flags;
 
+	spin_lock_irqsave(&client->ntfy_lock, flags);
 	while (*ptr) {
 		struct nvkm_object *this = rb_entry(*ptr, typeof(*this), node);
 		parent = *ptr;
@@ -75,12 +84,15 @@ nvkm_object_insert(struct nvkm_object *object)
 		else
 		if (object->object > this->object)
 			ptr = &parent->rb_right;
-		else
+		else {
+			spin_unlock_irqrestore(&client->ntfy_lock, flags);
 			return false;
+		}
 	}
 
 	rb_link_node(&object->node, parent, ptr);
-	rb_insert_color(&object->node, &object->client->objroot);
+	rb_insert_color(&object->node, &client->objroot);
+	spin_unlock_irqrestore(&client->ntfy_lock, flags);
 	return true;
 }
 
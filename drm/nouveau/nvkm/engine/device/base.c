@@ -2845,10 +2845,41 @@ fail:
 	return ret;
 }
 
+static int
+nvkm_device_init_subdev(struct nvkm_device *device, int index)
+{
+	return nvkm_subdev_init(nvkm_device_subdev(device, index));
+}
+
+static void
+nvkm_device_init_report(struct nvkm_device *device,
+			struct nvkm_device_init_stats *stats)
+{
+	char path[256];
+	int i, len = 0;
+
+	for_each_set_bit(i, stats->ran, NVKM_SUBDEV_NR) {
+		nvdev_trace(device, "init %-8s at %8lldus, took %8lldus\n",
+			    nvkm_subdev_name[i], stats->start[i], stats->time[i]);
+	}
+
+	path[0] = '\0';
+	for (i = 0; i < stats->path_nr && len < sizeof(path); i++) {
+		len += snprintf(path + len, sizeof(path) - len, "%s%s",
+				i ? " -> " : "", nvkm_subdev_name[stats->path[i]]);
+	}
+
+	nvdev_debug(device, "init took %lldus, %lldus serially, critical path "
+			    "%lldus: %s\n", stats->total, stats->serial,
+		    stats->critical, path);
+}
+
 int
 nvkm_device_init(struct nvkm_device *device)
 {
-	struct nvkm_subdev *subdev;
+	struct nvkm_device_init_stats *stats;
+	DECLARE_BITMAP(mask, NVKM_SUBDEV_NR);
+	bool parallel;
 	int ret, i;
 	s64 time;
 
@@ -2861,34 +2892,49 @@ nvkm_device_init(struct nvkm_device *device)
 	nvdev_trace(device, "init running...\n");
 	time = ktime_to_us(ktime_get());
 
+	if (!(stats = kmalloc(sizeof(*stats), GFP_KERNEL))) {
+		ret = -ENOMEM;
+		goto fail;
+	}
+
 	if (device->func->init) {
 		ret = device->func->init(device);
 		if (ret)
 			goto fail;
 	}
 
+	bitmap_clear(mask, 0, NVKM_SUBDEV_NR);
 	for (i = 0; i < NVKM_SUBDEV_NR; i++) {
-		if ((subdev = nvkm_device_subdev(device, i))) {
-			ret = nvkm_subdev_init(subdev);
-			if (ret)
-				goto fail_subdev;
-		}
+		if (nvkm_device_subdev(device, i))
+			__set_bit(i, mask);
 	}
 
+	/* Subdevs that don't depend on each other are initialised on
+	 * separate workers, NvParallelInit=0 restores strict index order.
+	 */
+	parallel = nvkm_boolopt(device->cfgopt, "NvParallelInit", true);
+	ret = nvkm_device_init_graph(device, mask, nvkm_device_init_subdev,
+				     parallel, stats);
+	nvkm_device_init_report(device, stats);
+	if (ret)
+		goto fail_subdev;
+
 	nvkm_acpi_init(device);
 	nvkm_therm_clkgate_enable(device->therm);
 
+	kfree(stats);
 	time = ktime_to_us(ktime_get()) - time;
 	nvdev_trace(device, "init completed in %lldus\n", time);
 	return 0;
 
 fail_subdev:
-	do {
-		if ((subdev = nvkm_device_subdev(device, i)))
-			nvkm_subdev_fini(subdev, false);
-	} while (--i >= 0);
+	for (i = NVKM_SUBDEV_NR - 1; i >= 0; i--) {
+		if (test_bit(i, stats->ran))
+			nvkm_subdev_fini(nvkm_device_subdev(device, i), false);
+	}
 
 fail:
+	kfree(stats);
 	nvkm_device_fini(device, false);
 
 	nvdev_error(device, "init failed with %d\n", ret);
@@ -3187,6 +3233,7 @@ nvkm_device_ctor(const struct nvkm_device_func *func,
 		device->name = device->chip->name;
 
 	mutex_init(&device->mutex);
+	INIT_LIST_HEAD(&device->falcon);
 
 	for (i = 0; i < NVKM_SUBDEV_NR; i++) {
 #define _(s,m) case s:                                                         \
@@ -24,6 +24,7 @@
 #include "ctrl.h"
 
 #include <core/client.h>
+#include <engine/falcon.h>
 #include <subdev/clk.h>
 
 #include <nvif/class.h>
@@ -166,6 +167,45 @@ nvkm_control_mthd_pstate_user(struct nvkm_control *ctrl, void *data, u32 size)
 	return ret;
 }
 
+static int
+nvkm_control_mthd_falcon_xfer(struct nvkm_control *ctrl, void *data, u32 size)
+{
+	union {
+		struct nvif_control_falcon_xfer_v0 v0;
+	} *args = data;
+	struct nvkm_device *device = ctrl->device;
+	struct nvkm_falcon *falcon;
+	int ret = -ENOSYS, i = 0;
+
+	nvif_ioctl(&ctrl->object, "control falcon xfer size %d\n", size);
+	if (!(ret = nvif_unpack(ret, &data, &size, args->v0, 0, 0, false))) {
+		nvif_ioctl(&ctrl->object,
+			   "control falcon xfer vers %d index %d\n",
+			   args->v0.version, args->v0.index);
+	} else
+		return ret;
+
+	ret = -EINVAL;
+	mutex_lock(&device->mutex);
+	list_for_each_entry(falcon, &device->falcon, head) {
+		if (i++ != args->v0.index)
+			continue;
+
+		snprintf(args->v0.name, sizeof(args->v0.name), "%s/%s",
+			 nvkm_subdev_name[falcon->owner->index], falcon->name);
+		args->v0.pio_bytes = falcon->xfer.pio_bytes;
+		args->v0.pio_time = falcon->xfer.pio_time;
+		args->v0.dma_bytes = falcon->xfer.dma_bytes;
+		args->v0.dma_time = falcon->xfer.dma_time;
+		args->v0.index = list_is_last(&falcon->head, &device->falcon) ?
+				 0 : i;
+		ret = 0;
+		break;
+	}
+	mutex_unlock(&device->mutex);
+	return ret;
+}
+
 static int
 nvkm_control_mthd(struct nvkm_object *object, u32 mthd, void *data, u32 size)
 {
@@ -177,6 +217,8 @@ nvkm_control_mthd(struct nvkm_object *object, u32 mthd, void *data, u32 size)
 		return nvkm_control_mthd_pstate_attr(ctrl, data, size);
 	case NVIF_CONTROL_PSTATE_USER:
 		return nvkm_control_mthd_pstate_user(ctrl, data, size);
+	case NVIF_CONTROL_FALCON_XFER:
+		return nvkm_control_mthd_falcon_xfer(ctrl, data, size);
 	default:
 		break;
 	}
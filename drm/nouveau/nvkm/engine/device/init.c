@@ -0,0 +1,286 @@
+/*
+ * Copyright 2020 Red Hat Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER(S) OR AUTHOR(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <core/device.h>
+
+static void
+nvkm_device_init_dep_range(unsigned long *deps, int first, int last)
+{
+	while (first < last)
+		__set_bit(first++, deps);
+}
+
+/* Dependencies are always a subset of the subdevs with a lower index, so
+ * the serial order stays a valid order.  Everything up to, and including,
+ * PMU is still initialised strictly in order.  The remaining subdevs only
+ * need those before PMU, other than CLK, which needs PMU, VOLT and THERM.
+ */
+void
+nvkm_device_init_deps(int index, unsigned long *deps)
+{
+	bitmap_clear(deps, 0, NVKM_SUBDEV_NR);
+
+	if (index <= NVKM_SUBDEV_PMU) {
+		nvkm_device_init_dep_range(deps, 0, index);
+		return;
+	}
+
+	if (index < NVKM_ENGINE_BSP) {
+		nvkm_device_init_dep_range(deps, 0, NVKM_SUBDEV_PMU);
+		switch (index) {
+		case NVKM_SUBDEV_CLK:
+			/* Reclocking to the boot pstate uses all of these. */
+			__set_bit(NVKM_SUBDEV_PMU, deps);
+			__set_bit(NVKM_SUBDEV_VOLT, deps);
+			__set_bit(NVKM_SUBDEV_THERM, deps);
+			break;
+		default:
+			break;
+		}
+		return;
+	}
+
+	/* Engines need every subdev, and all but the ones before FIFO
+	 * need FIFO.  Beyond that, they're independent of each other.
+	 */
+	nvkm_device_init_dep_range(deps, 0, NVKM_ENGINE_BSP);
+	if (index == NVKM_ENGINE_FIFO)
+		nvkm_device_init_dep_range(deps, NVKM_ENGINE_BSP, index);
+	else
+	if (index > NVKM_ENGINE_FIFO)
+		__set_bit(NVKM_ENGINE_FIFO, deps);
+}
+
+struct nvkm_device_init {
+	struct nvkm_device *device;
+	int (*func)(struct nvkm_device *, int index);
+	s64 epoch;
+
+	spinlock_t lock;
+	wait_queue_head_t wait;
+	int running;
+	bool failed;
+
+	DECLARE_BITMAP(deps[NVKM_SUBDEV_NR], NVKM_SUBDEV_NR);
+	struct nvkm_device_init_node {
+		struct nvkm_device_init *init;
+		struct work_struct work;
+		bool queued;
+		bool ran;
+		int ret;
+		int index;
+		int pending; /* dependencies not yet initialised */
+		s64 start;
+		s64 time;
+	} node[NVKM_SUBDEV_NR];
+};
+
+static void
+nvkm_device_init_run(struct nvkm_device_init *init,
+		     struct nvkm_device_init_node *node)
+{
+	node->start = ktime_to_us(ktime_get());
+	node->ret = init->func(init->device, node->index);
+	node->time = ktime_to_us(ktime_get()) - node->start;
+	node->start -= init->epoch;
+	node->ran = true;
+}
+
+/* Called with init->lock held, the first node that becomes ready is
+ * handed back to run on the current worker, the rest get their own.
+ */
+static void
+nvkm_device_init_ready(struct nvkm_device_init *init,
+		       struct nvkm_device_init_node *node,
+		       struct nvkm_device_init_node **next)
+{
+	init->running++;
+	if (!*next) {
+		*next = node;
+		return;
+	}
+
+	node->queued = true;
+	schedule_work(&node->work);
+}
+
+static void
+nvkm_device_init_work(struct work_struct *work)
+{
+	struct nvkm_device_init_node *node =
+		container_of(work, typeof(*node), work);
+	struct nvkm_device_init *init = node->init;
+	struct nvkm_device_init_node *next;
+	unsigned long flags;
+	int i;
+
+	do {
+		nvkm_device_init_run(init, node);
+
+		next = NULL;
+		spin_lock_irqsave(&init->lock, flags);
+		if (node->ret)
+			init->failed = true;
+
+		for (i = node->index + 1; i < NVKM_SUBDEV_NR; i++) {
+			struct nvkm_device_init_node *dep = &init->node[i];
+			if (!dep->pending || !test_bit(node->index, init->deps[i]))
+				continue;
+
+			/* Nothing new starts once something has failed. */
+			if (--dep->pending == 0 && !init->failed)
+				nvkm_device_init_ready(init, dep, &next);
+		}
+		init->running--;
+		spin_unlock_irqrestore(&init->lock, flags);
+	} while ((node = next));
+
+	wake_up(&init->wait);
+}
+
+static void
+nvkm_device_init_report(struct nvkm_device_init *init,
+			const unsigned long *mask,
+			struct nvkm_device_init_stats *stats)
+{
+	s64 finish[NVKM_SUBDEV_NR] = {};
+	u8 from[NVKM_SUBDEV_NR];
+	int i, j, last = -1;
+
+	/* Longest chain of node times through the graph, to each node. */
+	for_each_set_bit(i, mask, NVKM_SUBDEV_NR) {
+		struct nvkm_device_init_node *node = &init->node[i];
+		if (!node->ran)
+			continue;
+
+		__set_bit(i, stats->ran);
+		stats->start[i] = node->start;
+		stats->time[i] = node->time;
+		stats->serial += node->time;
+
+		from[i] = i;
+		for_each_set_bit(j, init->deps[i], i) {
+			if (test_bit(j, stats->ran) && finish[j] > finish[i]) {
+				finish[i] = finish[j];
+				from[i] = j;
+			}
+		}
+		finish[i] += node->time;
+
+		if (last < 0 || finish[i] > finish[last])
+			last = i;
+	}
+
+	if (last >= 0) {
+		stats->critical = finish[last];
+		for (i = last; ; i = from[i]) {
+			stats->path[stats->path_nr++] = i;
+			if (from[i] == i)
+				break;
+		}
+
+		/* Reverse it into first-to-last order. */
+		for (i = 0, j = stats->path_nr - 1; i < j; i++, j--) {
+			u8 temp = stats->path[i];
+			stats->path[i] = stats->path[j];
+			stats->path[j] = temp;
+		}
+	}
+}
+
+int
+nvkm_device_init_graph(struct nvkm_device *device, const unsigned long *mask,
+		       int (*func)(struct nvkm_device *, int index),
+		       bool parallel, struct nvkm_device_init_stats *stats)
+{
+	struct nvkm_device_init *init;
+	struct nvkm_device_init_node *next = NULL;
+	unsigned long flags;
+	int ret, i, j;
+
+	if (!(init = kzalloc(sizeof(*init), GFP_KERNEL)))
+		return -ENOMEM;
+
+	init->device = device;
+	init->func = func;
+	init->epoch = ktime_to_us(ktime_get());
+	spin_lock_init(&init->lock);
+	init_waitqueue_head(&init->wait);
+
+	for_each_set_bit(i, mask, NVKM_SUBDEV_NR) {
+		struct nvkm_device_init_node *node = &init->node[i];
+
+		nvkm_device_init_deps(i, init->deps[i]);
+		for_each_set_bit(j, init->deps[i], i) {
+			if (test_bit(j, mask))
+				node->pending++;
+		}
+
+		node->init = init;
+		node->index = i;
+		INIT_WORK(&node->work, nvkm_device_init_work);
+	}
+
+	if (!parallel) {
+		/* Index order is always a valid order for the graph. */
+		for_each_set_bit(i, mask, NVKM_SUBDEV_NR) {
+			nvkm_device_init_run(init, &init->node[i]);
+			if (init->node[i].ret)
+				break;
+		}
+	} else {
+		spin_lock_irqsave(&init->lock, flags);
+		for_each_set_bit(i, mask, NVKM_SUBDEV_NR) {
+			if (!init->node[i].pending)
+				nvkm_device_init_ready(init, &init->node[i], &next);
+		}
+		spin_unlock_irqrestore(&init->lock, flags);
+
+		/* The caller's thread does the work of the first worker. */
+		if (next)
+			nvkm_device_init_work(&next->work);
+
+		wait_event(init->wait, READ_ONCE(init->running) == 0);
+
+		for_each_set_bit(i, mask, NVKM_SUBDEV_NR) {
+			if (init->node[i].queued)
+				flush_work(&init->node[i].work);
+		}
+	}
+
+	/* The nodes' results are only collected once all workers are done,
+	 * and it's the first failure in the serial order that's returned.
+	 */
+	ret = 0;
+	for_each_set_bit(i, mask, NVKM_SUBDEV_NR) {
+		if ((ret = init->node[i].ret))
+			break;
+	}
+
+	if (stats) {
+		memset(stats, 0x00, sizeof(*stats));
+		nvkm_device_init_report(init, mask, stats);
+		stats->total = ktime_to_us(ktime_get()) - init->epoch;
+	}
+
+	kfree(init);
+	return ret;
+}
@@ -82,6 +82,9 @@ nvkm_dp_train_drive(struct lt_state *lt, bool pc)
 	u32 data;
 	int ret, i;
 
+	/* Built up a lane at a time, from this pass' requests only. */
+	lt->pc2conf[0] = lt->pc2conf[1] = 0x00;
+
 	for (i = 0; i < ior->dp.nr; i++) {
 		u8 lane = (lt->stat[4 + (i >> 1)] >> ((i & 1) * 4)) & 0xf;
 		u8 lpc2 = (lt->pc2stat >> (i * 2)) & 0x3;
@@ -216,16 +219,16 @@ nvkm_dp_train_cr(struct lt_state *lt)
 	return cr_done ? 0 : -1;
 }
 
+/* Drive levels in 'lt' start from those requested in its stat[4-5] and
+ * pc2stat, normally zero, or whatever a previous training settled on.
+ */
 static int
-nvkm_dp_train_links(struct nvkm_dp *dp)
+nvkm_dp_train_links(struct nvkm_dp *dp, struct lt_state *lt)
 {
 	struct nvkm_ior *ior = dp->outp.ior;
 	struct nvkm_disp *disp = dp->outp.disp;
 	struct nvkm_subdev *subdev = &disp->engine.subdev;
 	struct nvkm_bios *bios = subdev->device->bios;
-	struct lt_state lt = {
-		.dp = dp,
-	};
 	u32 lnkcmp;
 	u8 sink[2];
 	int ret;
@@ -233,13 +236,10 @@ nvkm_dp_train_links(struct nvkm_dp *dp)
 	OUTP_DBG(&dp->outp, "training %d x %d MB/s",
 		 ior->dp.nr, ior->dp.bw * 27);
 
-	/* Intersect misc. capabilities of the OR and sink. */
-	if (disp->engine.subdev.device->chipset < 0xd0)
-		dp->dpcd[DPCD_RC02] &= ~DPCD_RC02_TPS3_SUPPORTED;
-	lt.pc2 = dp->dpcd[DPCD_RC02] & DPCD_RC02_TPS3_SUPPORTED;
+	lt->pc2 = dp->dpcd[DPCD_RC02] & DPCD_RC02_TPS3_SUPPORTED;
 
 	/* Set desired link configuration on the source. */
-	if ((lnkcmp = lt.dp->info.lnkcmp)) {
+	if ((lnkcmp = dp->info.lnkcmp)) {
 		if (dp->version < 0x30) {
 			while ((ior->dp.bw * 2700) < nvbios_rd16(bios, lnkcmp))
 				lnkcmp += 4;
@@ -279,11 +279,10 @@ nvkm_dp_train_links(struct nvkm_dp *dp)
 		return ret;
 
 	/* Attempt to train the link in this configuration. */
-	memset(lt.stat, 0x00, sizeof(lt.stat));
-	ret = nvkm_dp_train_cr(&lt);
+	ret = nvkm_dp_train_cr(lt);
 	if (ret == 0)
-		ret = nvkm_dp_train_eq(&lt);
-	nvkm_dp_train_pattern(&lt, 0);
+		ret = nvkm_dp_train_eq(lt);
+	nvkm_dp_train_pattern(lt, 0);
 	return ret;
 }
 
@@ -341,7 +340,129 @@ static const struct dp_rates {
 	{}
 };
 
+static struct nvkm_dp_lt_cache *
+nvkm_dp_lt_cache_find(struct nvkm_dp *dp)
+{
+	struct nvkm_dp_lt_cache *cache = dp->lt_cache;
+
+	for (; cache < dp->lt_cache + NVKM_DP_LT_CACHE; cache++) {
+		if (cache->used && cache->mst == dp->lt.mst &&
+		    !memcmp(cache->dpcd, dp->dpcd, sizeof(cache->dpcd)) &&
+		    !memcmp(cache->sink, dp->sink, sizeof(cache->sink)))
+			return cache;
+	}
+
+	return NULL;
+}
+
+static void
+nvkm_dp_lt_cache_store(struct nvkm_dp *dp, const struct lt_state *lt)
+{
+	struct nvkm_ior *ior = dp->outp.ior;
+	struct nvkm_dp_lt_cache *cache = nvkm_dp_lt_cache_find(dp);
+	const u8 sink_nr = dp->dpcd[DPCD_RC02] & DPCD_RC02_MAX_LANE_COUNT;
+	const u8 sink_bw = dp->dpcd[DPCD_RC01_MAX_LINK_RATE];
+	const struct dp_rates *cfg;
+	int i;
+
+	/* Replace the least recently trained sink's entry. */
+	if (!cache) {
+		cache = dp->lt_cache;
+		for (i = 1; i < NVKM_DP_LT_CACHE; i++) {
+			if (dp->lt_cache[i].used < cache->used)
+				cache = &dp->lt_cache[i];
+		}
+	}
+
+	memcpy(cache->dpcd, dp->dpcd, sizeof(cache->dpcd));
+	memcpy(cache->sink, dp->sink, sizeof(cache->sink));
+	cache->mst = dp->lt.mst;
+	for (cfg = nvkm_dp_rates; cfg->rate; cfg++) {
+		if (cfg->nr <= dp->outp.info.dpconf.link_nr &&
+		    cfg->bw <= dp->outp.info.dpconf.link_bw &&
+		    cfg->nr <= sink_nr && cfg->bw <= sink_bw)
+			break;
+	}
+	cache->best = cfg->bw == ior->dp.bw && cfg->nr == ior->dp.nr;
+	cache->bw = ior->dp.bw;
+	cache->nr = ior->dp.nr;
+	cache->lane[0] = cache->lane[1] = 0x00;
+	cache->pc2 = 0x00;
+	for (i = 0; i < ior->dp.nr; i++) {
+		u8 lpre = (lt->conf[i] & DPCD_LC03_PRE_EMPHASIS_SET) >> 3;
+		u8 lvsw = (lt->conf[i] & DPCD_LC03_VOLTAGE_SWING_SET);
+		u8 lpc2 = (lt->pc2conf[i >> 1] >> ((i & 1) * 4)) & 0x3;
+
+		cache->lane[i >> 1] |= ((lpre << 2) | lvsw) << ((i & 1) * 4);
+		cache->pc2 |= lpc2 << (i * 2);
+	}
+	cache->used = ++dp->lt_cache_used;
+}
+
+static void
+nvkm_dp_lt_cache_plug(struct nvkm_dp *dp)
+{
+	int i;
+
+	/* A sink that last trained below the best configuration both ends
+	 * support may be on a different cable now, search for it again.
+	 */
+	mutex_lock(&dp->mutex);
+	for (i = 0; i < NVKM_DP_LT_CACHE; i++) {
+		if (!dp->lt_cache[i].best)
+			dp->lt_cache[i].used = 0;
+	}
+	mutex_unlock(&dp->mutex);
+}
+
+/* Retrain straight into the configuration that last worked for this sink,
+ * starting from the drive levels it settled on, which normally trains in
+ * one pass of each phase instead of walking down through every rate that
+ * doesn't work and every drive level leading up to one that does.
+ */
 static int
+nvkm_dp_train_fast(struct nvkm_dp *dp, const struct dp_rates *failsafe,
+		   struct lt_state *lt)
+{
+	struct nvkm_ior *ior = dp->outp.ior;
+	struct nvkm_dp_lt_cache *cache = nvkm_dp_lt_cache_find(dp);
+	const struct dp_rates *cfg;
+	int ret;
+
+	if (!cache)
+		return -ENOENT;
+
+	/* The cached configuration must still meet the requirements. */
+	for (cfg = nvkm_dp_rates; cfg <= failsafe; cfg++) {
+		if (cfg->bw == cache->bw && cfg->nr == cache->nr)
+			break;
+	}
+
+	if (cfg > failsafe || cfg->nr > dp->outp.info.dpconf.link_nr ||
+			      cfg->bw > dp->outp.info.dpconf.link_bw)
+		return -ENOENT;
+
+	OUTP_DBG(&dp->outp, "retraining from cache, levels %02x%02x %02x",
+		 cache->lane[0], cache->lane[1], cache->pc2);
+	ior->dp.mst = dp->lt.mst;
+	ior->dp.ef = dp->dpcd[DPCD_RC02] & DPCD_RC02_ENHANCED_FRAME_CAP;
+	ior->dp.bw = cfg->bw;
+	ior->dp.nr = cfg->nr;
+
+	*lt = (struct lt_state) { .dp = dp };
+	lt->stat[4] = cache->lane[0];
+	lt->stat[5] = cache->lane[1];
+	lt->pc2stat = cache->pc2;
+	ret = nvkm_dp_train_links(dp, lt);
+	if (ret < 0) {
+		OUTP_DBG(&dp->outp, "cached configuration failed");
+		cache->used = 0;
+	}
+
+	return ret;
+}
+
+int
 nvkm_dp_train(struct nvkm_dp *dp, u32 dataKBps)
 {
 	struct nvkm_ior *ior = dp->outp.ior;
@@ -350,6 +471,7 @@ nvkm_dp_train(struct nvkm_dp *dp, u32 dataKBps)
 	const u8 outp_nr = dp->outp.info.dpconf.link_nr;
 	const u8 outp_bw = dp->outp.info.dpconf.link_bw;
 	const struct dp_rates *failsafe = NULL, *cfg;
+	struct lt_state lt;
 	int ret = -EINVAL;
 	u8  pwr;
 
@@ -394,6 +516,7 @@ nvkm_dp_train(struct nvkm_dp *dp, u32 dataKBps)
 	OUTP_DBG(&dp->outp, "training (min: %d x %d MB/s)",
 		 failsafe->nr, failsafe->bw * 27);
 	nvkm_dp_train_init(dp);
+	ret = nvkm_dp_train_fast(dp, failsafe, &lt);
 	for (cfg = nvkm_dp_rates; ret < 0 && cfg <= failsafe; cfg++) {
 		/* Skip configurations not supported by both OR and sink. */
 		if ((cfg->nr > outp_nr || cfg->bw > outp_bw ||
@@ -408,13 +531,16 @@ nvkm_dp_train(struct nvkm_dp *dp, u32 dataKBps)
 		ior->dp.nr = cfg->nr;
 
 		/* Program selected link configuration. */
-		ret = nvkm_dp_train_links(dp);
+		lt = (struct lt_state) { .dp = dp };
+		ret = nvkm_dp_train_links(dp, &lt);
 	}
 	nvkm_dp_train_fini(dp);
-	if (ret < 0)
+	if (ret < 0) {
 		OUTP_ERR(&dp->outp, "training failed");
-	else
+	} else {
 		OUTP_DBG(&dp->outp, "training done");
+		nvkm_dp_lt_cache_store(dp, &lt);
+	}
 	atomic_set(&dp->lt.done, 1);
 	return ret;
 }
@@ -518,8 +644,20 @@ nvkm_dp_enable(struct nvkm_dp *dp, bool enable)
 		}
 
 		if (!nvkm_rdaux(aux, DPCD_RC00_DPCD_REV, dp->dpcd,
-				sizeof(dp->dpcd)))
+				sizeof(dp->dpcd))) {
+			/* Intersect misc. capabilities of the OR and sink. */
+			if (dp->outp.disp->engine.subdev.device->chipset < 0xd0)
+				dp->dpcd[DPCD_RC02] &= ~DPCD_RC02_TPS3_SUPPORTED;
+
+			/* Identifies the sink for the link training cache,
+			 * along with its capabilities.  Not all sinks have
+			 * these, they're left zeroed if so.
+			 */
+			if (nvkm_rdaux(aux, DPCD_SD00_IEEE_OUI, dp->sink,
+				       sizeof(dp->sink)))
+				memset(dp->sink, 0x00, sizeof(dp->sink));
 			return true;
+		}
 	}
 
 	if (dp->present) {
@@ -552,13 +690,29 @@ nvkm_dp_hpd(struct nvkm_notify *notify)
 
 	if (line->mask & NVKM_I2C_UNPLUG)
 		rep.mask |= NVIF_NOTIFY_CONN_V0_UNPLUG;
-	if (line->mask & NVKM_I2C_PLUG)
+	if (line->mask & NVKM_I2C_PLUG) {
+		nvkm_dp_lt_cache_plug(dp);
 		rep.mask |= NVIF_NOTIFY_CONN_V0_PLUG;
+	}
 
 	nvkm_event_send(&disp->hpd, rep.mask, conn->index, &rep, sizeof(rep));
 	return NVKM_NOTIFY_KEEP;
 }
 
+#ifndef __KERNEL__
+/* There's no i2c event to deliver hotplug through in bin/nv_dpsim, this
+ * hands it a line state as one would.
+ */
+void
+nvkm_dp_hpd_send(struct nvkm_dp *dp, u8 mask)
+{
+	const struct nvkm_i2c_ntfy_rep line = { .mask = mask };
+	dp->hpd.data = &line;
+	nvkm_dp_hpd(&dp->hpd);
+	dp->hpd.data = NULL;
+}
+#endif
+
 static void
 nvkm_dp_fini(struct nvkm_outp *outp)
 {
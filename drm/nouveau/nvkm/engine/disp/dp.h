@@ -22,16 +22,38 @@ struct nvkm_dp {
 	struct nvkm_notify hpd;
 	bool present;
 	u8 dpcd[16];
+	u8 sink[12];
 
 	struct mutex mutex;
 	struct {
 		atomic_t done;
 		bool mst;
 	} lt;
+
+	/* Link configurations that last trained successfully, per sink, so
+	 * a retrain can start from them instead of searching from scratch.
+	 */
+#define NVKM_DP_LT_CACHE 4
+	struct nvkm_dp_lt_cache {
+		u8 dpcd[16];
+		u8 sink[12];
+		bool mst;
+		bool best; /* highest configuration OR and sink support */
+		u8 bw;
+		u8 nr;
+		u8 lane[2]; /* drive levels, as DPCD_LS06/DPCD_LS07 */
+		u8 pc2; /* post-cursor2 levels, as DPCD_LS0C */
+		u32 used;
+	} lt_cache[NVKM_DP_LT_CACHE];
+	u32 lt_cache_used;
 };
 
 int nvkm_dp_new(struct nvkm_disp *, int index, struct dcb_output *,
 		struct nvkm_outp **);
+int nvkm_dp_train(struct nvkm_dp *, u32 dataKBps);
+#ifndef __KERNEL__
+void nvkm_dp_hpd_send(struct nvkm_dp *, u8 mask);
+#endif
 
 /* DPCD Receiver Capabilities */
 #define DPCD_RC00_DPCD_REV                                              0x00000
@@ -102,6 +124,12 @@ int nvkm_dp_new(struct nvkm_disp *, int index, struct dcb_output *,
 #define DPCD_LS0C_LANE1_POST_CURSOR2                                       0x0c
 #define DPCD_LS0C_LANE0_POST_CURSOR2                                       0x03
 
+/* DPCD Sink Device-Specific */
+#define DPCD_SD00_IEEE_OUI                                              0x00400
+#define DPCD_SD03_DEVICE_ID                                             0x00403
+#define DPCD_SD09_HW_REV                                                0x00409
+#define DPCD_SD0A_SW_REV                                                0x0040a
+
 /* DPCD Sink Control */
 #define DPCD_SC00                                                       0x00600
 #define DPCD_SC00_SET_POWER                                                0x03
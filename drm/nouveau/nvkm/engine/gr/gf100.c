@@ -1635,9 +1635,22 @@ gf100_gr_intr(struct nvkm_gr *base)
 }
 
 static void
-gf100_gr_init_fw(struct nvkm_falcon *falcon,
+gf100_gr_init_fw(struct nvkm_falcon *falcon, struct nvkm_memory *ucode,
 		 struct nvkm_blob *code, struct nvkm_blob *data)
 {
+	const u32 code_size = ALIGN(code->size, 256);
+	const u32 data_size = ALIGN(data->size, 256);
+
+	/* DMA from the copy made at oneinit() time, if there is one */
+	if (ucode && code_size <= falcon->code.limit &&
+	    data_size <= falcon->data.limit) {
+		if (!nvkm_falcon_load_dma(falcon, ucode, code_size, 0x0,
+					  data_size, 0, false, false) &&
+		    !nvkm_falcon_load_dma(falcon, ucode, 0, 0x0,
+					  code_size, 0, true, false))
+			return;
+	}
+
 	nvkm_falcon_load_dmem(falcon, data->data, 0x0, data->size, 0);
 	nvkm_falcon_load_imem(falcon, code->data, 0x0, code->size, 0, 0, false);
 }
@@ -1699,15 +1712,15 @@ gf100_gr_init_ctxctl_ext(struct gf100_gr *gr)
 	/* securely-managed falcons must be reset using secure boot */
 
 	if (!nvkm_acr_managed_falcon(device, NVKM_ACR_LSF_FECS)) {
-		gf100_gr_init_fw(&gr->fecs.falcon, &gr->fecs.inst,
-						   &gr->fecs.data);
+		gf100_gr_init_fw(&gr->fecs.falcon, gr->fecs.ucode,
+				 &gr->fecs.inst, &gr->fecs.data);
 	} else {
 		lsf_mask |= BIT(NVKM_ACR_LSF_FECS);
 	}
 
 	if (!nvkm_acr_managed_falcon(device, NVKM_ACR_LSF_GPCCS)) {
-		gf100_gr_init_fw(&gr->gpccs.falcon, &gr->gpccs.inst,
-						    &gr->gpccs.data);
+		gf100_gr_init_fw(&gr->gpccs.falcon, gr->gpccs.ucode,
+				 &gr->gpccs.inst, &gr->gpccs.data);
 	} else {
 		lsf_mask |= BIT(NVKM_ACR_LSF_GPCCS);
 	}
@@ -1938,6 +1951,29 @@ gf100_gr_oneinit_tiles(struct gf100_gr *gr)
 	}
 }
 
+static void
+gf100_gr_oneinit_ucode(struct gf100_gr *gr, struct nvkm_blob *code,
+		       struct nvkm_blob *data, struct nvkm_memory **pucode)
+{
+	struct nvkm_subdev *subdev = &gr->base.engine.subdev;
+	const u32 offset = ALIGN(code->size, 256);
+	int ret;
+
+	ret = nvkm_memory_new(subdev->device, NVKM_MEM_TARGET_INST,
+			      offset + ALIGN(data->size, 256), 256, true,
+			      pucode);
+	if (ret) {
+		nvkm_warn(subdev, "ucode dma buffer allocation failed, %d\n",
+			  ret);
+		return;
+	}
+
+	nvkm_kmap(*pucode);
+	nvkm_wobj(*pucode, 0, code->data, code->size);
+	nvkm_wobj(*pucode, offset, data->data, data->size);
+	nvkm_done(*pucode);
+}
+
 static int
 gf100_gr_oneinit(struct nvkm_gr *base)
 {
@@ -1973,6 +2009,17 @@ gf100_gr_oneinit(struct nvkm_gr *base)
 	memset(gr->tile, 0xff, sizeof(gr->tile));
 	gr->func->oneinit_tiles(gr);
 	gr->func->oneinit_sm_id(gr);
+
+	/* keep a copy of external firmware in memory the falcons can DMA
+	 * from, rather than pushing it through IMEM/DMEM ports every init
+	 */
+	if (gr->firmware &&
+	    nvkm_boolopt(device->cfgopt, "NvFalconDMA", false)) {
+		gf100_gr_oneinit_ucode(gr, &gr->fecs.inst, &gr->fecs.data,
+				       &gr->fecs.ucode);
+		gf100_gr_oneinit_ucode(gr, &gr->gpccs.inst, &gr->gpccs.data,
+				       &gr->gpccs.ucode);
+	}
 	return 0;
 }
 
@@ -2042,6 +2089,9 @@ gf100_gr_dtor(struct nvkm_gr *base)
 	nvkm_falcon_dtor(&gr->gpccs.falcon);
 	nvkm_falcon_dtor(&gr->fecs.falcon);
 
+	nvkm_memory_unref(&gr->gpccs.ucode);
+	nvkm_memory_unref(&gr->fecs.ucode);
+
 	nvkm_blob_dtor(&gr->fecs.inst);
 	nvkm_blob_dtor(&gr->fecs.data);
 	nvkm_blob_dtor(&gr->gpccs.inst);
@@ -2077,6 +2127,7 @@ gf100_gr_flcn = {
 	.load_imem = nvkm_falcon_v1_load_imem,
 	.load_dmem = nvkm_falcon_v1_load_dmem,
 	.read_dmem = nvkm_falcon_v1_read_dmem,
+	.load_dma = nvkm_falcon_v1_load_dma,
 	.bind_context = nvkm_falcon_v1_bind_context,
 	.wait_for_halt = nvkm_falcon_v1_wait_for_halt,
 	.clear_interrupt = nvkm_falcon_v1_clear_interrupt,
@@ -83,6 +83,7 @@ struct gf100_gr {
 		struct nvkm_falcon falcon;
 		struct nvkm_blob inst;
 		struct nvkm_blob data;
+		struct nvkm_memory *ucode;
 
 		struct mutex mutex;
 		u32 disable;
@@ -92,6 +93,7 @@ struct gf100_gr {
 		struct nvkm_falcon falcon;
 		struct nvkm_blob inst;
 		struct nvkm_blob data;
+		struct nvkm_memory *ucode;
 	} gpccs;
 
 	bool firmware;
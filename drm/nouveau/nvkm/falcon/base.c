@@ -24,29 +24,82 @@
 #include <subdev/mc.h>
 #include <subdev/top.h>
 
+static void
+nvkm_falcon_xfer_pio(struct nvkm_falcon *falcon, u32 size, s64 time)
+{
+	time = ktime_to_ns(ktime_get()) - time;
+	falcon->xfer.pio_bytes += size;
+	falcon->xfer.pio_time += time;
+	FLCN_DBG(falcon, "pio %d bytes in %lld ns", size, time);
+}
+
 void
 nvkm_falcon_load_imem(struct nvkm_falcon *falcon, void *data, u32 start,
 		      u32 size, u16 tag, u8 port, bool secure)
 {
+	s64 time;
+
 	if (secure && !falcon->secret) {
 		nvkm_warn(falcon->user,
 			  "writing with secure tag on a non-secure falcon!\n");
 		return;
 	}
 
+	time = ktime_to_ns(ktime_get());
 	falcon->func->load_imem(falcon, data, start, size, tag, port,
 				secure);
+	nvkm_falcon_xfer_pio(falcon, size, time);
 }
 
 void
 nvkm_falcon_load_dmem(struct nvkm_falcon *falcon, void *data, u32 start,
 		      u32 size, u8 port)
 {
+	s64 time;
+
 	mutex_lock(&falcon->dmem_mutex);
 
+	time = ktime_to_ns(ktime_get());
 	falcon->func->load_dmem(falcon, data, start, size, port);
+	nvkm_falcon_xfer_pio(falcon, size, time);
+
+	mutex_unlock(&falcon->dmem_mutex);
+}
+
+/* Upload code/data from memory already visible to the GPU.  Returns an
+ * error if the falcon (or memory) doesn't support this, in which case the
+ * caller is expected to fall back to nvkm_falcon_load_imem()/dmem().
+ */
+int
+nvkm_falcon_load_dma(struct nvkm_falcon *falcon, struct nvkm_memory *mem,
+		     u64 offset, u32 start, u32 size, u16 tag, bool imem,
+		     bool secure)
+{
+	s64 time;
+	int ret;
 
+	if (!falcon->func->load_dma)
+		return -ENOSYS;
+
+	if (secure && !falcon->secret) {
+		nvkm_warn(falcon->user,
+			  "writing with secure tag on a non-secure falcon!\n");
+		return -EINVAL;
+	}
+
+	mutex_lock(&falcon->dmem_mutex);
+	time = ktime_to_ns(ktime_get());
+	ret = falcon->func->load_dma(falcon, mem, offset, start, size, tag,
+				     imem, secure);
+	if (ret == 0) {
+		time = ktime_to_ns(ktime_get()) - time;
+		falcon->xfer.dma_bytes += size;
+		falcon->xfer.dma_time += time;
+		FLCN_DBG(falcon, "dma %s %d bytes in %lld ns",
+			 imem ? "imem" : "dmem", size, time);
+	}
 	mutex_unlock(&falcon->dmem_mutex);
+	return ret;
 }
 
 void
@@ -204,6 +257,16 @@ nvkm_falcon_get(struct nvkm_falcon *falcon, const struct nvkm_subdev *user)
 void
 nvkm_falcon_dtor(struct nvkm_falcon *falcon)
 {
+	struct nvkm_device *device;
+
+	/* owner's ctor may have failed before getting to ours */
+	if (!falcon->owner)
+		return;
+
+	device = falcon->owner->device;
+	mutex_lock(&device->mutex);
+	list_del(&falcon->head);
+	mutex_unlock(&device->mutex);
 }
 
 int
@@ -217,6 +280,10 @@ nvkm_falcon_ctor(const struct nvkm_falcon_func *func,
 	falcon->addr = addr;
 	mutex_init(&falcon->mutex);
 	mutex_init(&falcon->dmem_mutex);
+
+	mutex_lock(&subdev->device->mutex);
+	list_add_tail(&falcon->head, &subdev->device->falcon);
+	mutex_unlock(&subdev->device->mutex);
 	return 0;
 }
 
@@ -37,12 +37,14 @@ nvkm_falcon_v1_load_imem(struct nvkm_falcon *falcon, void *data, u32 start,
 
 	reg = start | BIT(24) | (secure ? BIT(28) : 0);
 	nvkm_falcon_wr32(falcon, 0x180 + (port * 16), reg);
-	for (i = 0; i < size / 4; i++) {
-		/* write new tag every 256B */
-		if ((i & 0x3f) == 0)
-			nvkm_falcon_wr32(falcon, 0x188 + (port * 16), tag++);
-		nvkm_falcon_wr32(falcon, 0x184 + (port * 16), ((u32 *)data)[i]);
+	for (i = 0; i < size / 4; i += 0x40) {
+		/* write new tag every 256B, then the page's words */
+		nvkm_falcon_wr32(falcon, 0x188 + (port * 16), tag++);
+		nvkm_falcon_wr32_rep(falcon, 0x184 + (port * 16),
+				     (u32 *)data + i,
+				     min_t(u32, size / 4 - i, 0x40));
 	}
+	i = size / 4;
 
 	/*
 	 * If size is not a multiple of 4, mask the last work to ensure garbage
@@ -74,8 +76,8 @@ nvkm_falcon_v1_load_emem(struct nvkm_falcon *falcon, void *data, u32 start,
 	size -= rem;
 
 	nvkm_falcon_wr32(falcon, 0xac0 + (port * 8), start | (0x1 << 24));
-	for (i = 0; i < size / 4; i++)
-		nvkm_falcon_wr32(falcon, 0xac4 + (port * 8), ((u32 *)data)[i]);
+	nvkm_falcon_wr32_rep(falcon, 0xac4 + (port * 8), data, size / 4);
+	i = size / 4;
 
 	/*
 	 * If size is not a multiple of 4, mask the last word to ensure garbage
@@ -105,8 +107,8 @@ nvkm_falcon_v1_load_dmem(struct nvkm_falcon *falcon, void *data, u32 start,
 	size -= rem;
 
 	nvkm_falcon_wr32(falcon, 0x1c0 + (port * 8), start | (0x1 << 24));
-	for (i = 0; i < size / 4; i++)
-		nvkm_falcon_wr32(falcon, 0x1c4 + (port * 8), ((u32 *)data)[i]);
+	nvkm_falcon_wr32_rep(falcon, 0x1c4 + (port * 8), data, size / 4);
+	i = size / 4;
 
 	/*
 	 * If size is not a multiple of 4, mask the last word to ensure garbage
@@ -120,6 +122,65 @@ nvkm_falcon_v1_load_dmem(struct nvkm_falcon *falcon, void *data, u32 start,
 	}
 }
 
+/* Pull code/data in from memory using the falcon's DMA engine, 256 bytes
+ * per transfer.  For IMEM, the offset into the DMA window is also what
+ * determines the tag of each page.
+ */
+int
+nvkm_falcon_v1_load_dma(struct nvkm_falcon *falcon, struct nvkm_memory *mem,
+			u64 offset, u32 start, u32 size, u16 tag, bool imem,
+			bool secure)
+{
+	struct nvkm_device *device = falcon->owner->device;
+	const u32 fbif = falcon->func->fbif;
+	u64 addr = nvkm_memory_addr(mem) + offset;
+	u32 base = imem ? tag << 8 : 0;
+	u32 cmd, i;
+	u8 dmaidx;
+
+	if (!fbif || ((addr | start | size) & 0xff) || addr < base)
+		return -EINVAL;
+
+	switch (nvkm_memory_target(mem)) {
+	case NVKM_MEM_TARGET_VRAM: dmaidx = FALCON_DMAIDX_PHYS_VID; break;
+	case NVKM_MEM_TARGET_HOST: dmaidx = FALCON_DMAIDX_PHYS_SYS_COH; break;
+	case NVKM_MEM_TARGET_NCOH: dmaidx = FALCON_DMAIDX_PHYS_SYS_NCOH; break;
+	default:
+		return -EINVAL;
+	}
+
+	/* setup physical aperture, and allow its use without a context */
+	nvkm_falcon_wr32(falcon, fbif + 4 * dmaidx,
+			 0x4 | (dmaidx - FALCON_DMAIDX_PHYS_VID));
+	nvkm_falcon_mask(falcon, fbif + 0x24, 0x00000080, 0x00000080);
+
+	cmd = (6 << 8) | (dmaidx << 12);
+	if (imem)
+		cmd |= 0x00000010;
+	if (secure)
+		cmd |= 0x00000004;
+
+	nvkm_falcon_wr32(falcon, 0x110, (addr - base) >> 8);
+	for (i = 0; i < size; i += 256) {
+		/* wait for space in the transfer queue */
+		if (nvkm_msec(device, 2000,
+			if (!(nvkm_falcon_rd32(falcon, 0x118) & 0x00000001))
+				break;
+		) < 0)
+			return -ETIMEDOUT;
+
+		nvkm_falcon_wr32(falcon, 0x114, start + i);
+		nvkm_falcon_wr32(falcon, 0x11c, base + i);
+		nvkm_falcon_wr32(falcon, 0x118, cmd);
+	}
+
+	if (nvkm_wait_msec(device, 2000, falcon->addr + 0x118,
+			   0x00000002, 0x00000002) < 0)
+		return -ETIMEDOUT;
+
+	return 0;
+}
+
 static void
 nvkm_falcon_v1_read_emem(struct nvkm_falcon *falcon, u32 start, u32 size,
 			 u8 port, void *data)
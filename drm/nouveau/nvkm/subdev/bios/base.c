@@ -82,14 +82,15 @@ nvbios_checksum(const u8 *data, int size)
 u16
 nvbios_findstr(const u8 *data, int size, const char *str, int len)
 {
-	int i, j;
+	const u8 *ptr = data, *end = data + size - len + 1;
 
-	for (i = 0; i <= (size - len); i++) {
-		for (j = 0; j < len; j++)
-			if ((char)data[i + j] != str[j])
-				break;
-		if (j == len)
-			return i;
+	if (len <= 0 || size < len)
+		return 0;
+
+	while ((ptr = memchr(ptr, (u8)str[0], end - ptr))) {
+		if (!memcmp(ptr + 1, str + 1, len - 1))
+			return ptr - data;
+		ptr++;
 	}
 
 	return 0;
@@ -130,6 +131,7 @@ static void *
 nvkm_bios_dtor(struct nvkm_subdev *subdev)
 {
 	struct nvkm_bios *bios = nvkm_bios(subdev);
+	nvbios_index_del(bios);
 	kfree(bios->data);
 	return bios;
 }
@@ -182,6 +184,10 @@ nvkm_bios_new(struct nvkm_device *device, int index, struct nvkm_bios **pbios)
 	if (bios->bit_offset)
 		nvkm_debug(&bios->subdev, "BIT signature found\n");
 
+	ret = nvbios_index_new(bios);
+	if (ret)
+		return ret;
+
 	/* determine the vbios version number */
 	if (!bit_entry(bios, 'i', &bit_i) && bit_i.length >= 4) {
 		bios->version.major = nvbios_rd08(bios, bit_i.offset + 3);
@@ -200,5 +206,7 @@ nvkm_bios_new(struct nvkm_device *device, int index, struct nvkm_bios **pbios)
 	nvkm_info(&bios->subdev, "version %02x.%02x.%02x.%02x.%02x\n",
 		  bios->version.major, bios->version.chip,
 		  bios->version.minor, bios->version.micro, bios->version.patch);
+
+	nvbios_index_tables(bios);
 	return 0;
 }
@@ -21,12 +21,18 @@
  *
  * Authors: Ben Skeggs
  */
-#include <subdev/bios.h>
-#include <subdev/bios/bit.h>
+#include "priv.h"
 
 int
 bit_entry(struct nvkm_bios *bios, u8 id, struct bit_entry *bit)
 {
+	if (likely(bios->index) && bios->bit_offset) {
+		if (!test_bit(id, bios->index->bit_mask))
+			return -ENOENT;
+		*bit = bios->index->bit[id];
+		return 0;
+	}
+
 	if (likely(bios->bit_offset)) {
 		u8  entries = nvbios_rd08(bios, bios->bit_offset + 10);
 		u32 entry   = bios->bit_offset + 12;
@@ -21,14 +21,20 @@
  *
  * Authors: Ben Skeggs
  */
-#include <subdev/bios.h>
+#include "priv.h"
 #include <subdev/bios/dcb.h>
 #include <subdev/bios/conn.h>
 
 u32
 nvbios_connTe(struct nvkm_bios *bios, u8 *ver, u8 *hdr, u8 *cnt, u8 *len)
 {
-	u32 dcb = dcb_table(bios, ver, hdr, cnt, len);
+	u32 dcb, index;
+
+	if (nvbios_index_table(bios, NVBIOS_INDEX_CONN, &index,
+			       ver, hdr, cnt, len, NULL, NULL))
+		return index;
+
+	dcb = dcb_table(bios, ver, hdr, cnt, len);
 	if (dcb && *ver >= 0x30 && *hdr >= 0x16) {
 		u32 data = nvbios_rd16(bios, dcb + 0x14);
 		if (data) {
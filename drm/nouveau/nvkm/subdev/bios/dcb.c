@@ -21,7 +21,7 @@
  *
  * Authors: Ben Skeggs
  */
-#include <subdev/bios.h>
+#include "priv.h"
 #include <subdev/bios/dcb.h>
 
 u16
@@ -30,6 +30,11 @@ dcb_table(struct nvkm_bios *bios, u8 *ver, u8 *hdr, u8 *cnt, u8 *len)
 	struct nvkm_subdev *subdev = &bios->subdev;
 	struct nvkm_device *device = subdev->device;
 	u16 dcb = 0x0000;
+	u32 index;
+
+	if (nvbios_index_table(bios, NVBIOS_INDEX_DCB, &index,
+			       ver, hdr, cnt, len, NULL, NULL))
+		return index;
 
 	if (device->card_type > NV_04)
 		dcb = nvbios_rd16(bios, 0x36);
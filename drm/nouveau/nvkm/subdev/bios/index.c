@@ -0,0 +1,129 @@
+/*
+ * Copyright 2012 Red Hat Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER(S) OR AUTHOR(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+#include "priv.h"
+
+#include <subdev/bios/dcb.h>
+#include <subdev/bios/conn.h>
+#include <subdev/bios/perf.h>
+#include <subdev/bios/rammap.h>
+#include <subdev/bios/timing.h>
+
+/* The BIT table and the headers of the most commonly used tables are
+ * decoded once the image has been shadowed, rather than being located
+ * and validated again from the raw image on every lookup.
+ */
+bool
+nvbios_index_table(struct nvkm_bios *bios, enum nvbios_index_type type,
+		   u32 *data, u8 *ver, u8 *hdr, u8 *cnt, u8 *len,
+		   u8 *snr, u8 *ssz)
+{
+	const struct nvbios_index_table *table;
+
+	if (!bios->index || !bios->index->tables)
+		return false;
+
+	table = &bios->index->table[type];
+	*data = table->data;
+	*ver = table->ver;
+	*hdr = table->hdr;
+	*cnt = table->cnt;
+	*len = table->len;
+	if (snr)
+		*snr = table->snr;
+	if (ssz)
+		*ssz = table->ssz;
+	return true;
+}
+
+void
+nvbios_index_tables(struct nvkm_bios *bios)
+{
+	struct nvbios_index *index = bios->index;
+	struct nvbios_index_table *table;
+
+	if (!index)
+		return;
+
+	table = &index->table[NVBIOS_INDEX_DCB];
+	table->data = dcb_table(bios, &table->ver, &table->hdr,
+				&table->cnt, &table->len);
+
+	table = &index->table[NVBIOS_INDEX_CONN];
+	table->data = nvbios_connTe(bios, &table->ver, &table->hdr,
+				    &table->cnt, &table->len);
+
+	table = &index->table[NVBIOS_INDEX_PERF];
+	table->data = nvbios_perf_table(bios, &table->ver, &table->hdr,
+					&table->cnt, &table->len,
+					&table->snr, &table->ssz);
+
+	table = &index->table[NVBIOS_INDEX_RAMMAP];
+	table->data = nvbios_rammapTe(bios, &table->ver, &table->hdr,
+				      &table->cnt, &table->len,
+				      &table->snr, &table->ssz);
+
+	table = &index->table[NVBIOS_INDEX_TIMING];
+	table->data = nvbios_timingTe(bios, &table->ver, &table->hdr,
+				      &table->cnt, &table->len,
+				      &table->snr, &table->ssz);
+
+	index->tables = true;
+}
+
+void
+nvbios_index_del(struct nvkm_bios *bios)
+{
+	kfree(bios->index);
+	bios->index = NULL;
+}
+
+int
+nvbios_index_new(struct nvkm_bios *bios)
+{
+	struct nvbios_index *index;
+	u8  entries, size;
+	u32 entry;
+
+	if (!(index = bios->index = kzalloc(sizeof(*index), GFP_KERNEL)))
+		return -ENOMEM;
+
+	if (!bios->bit_offset)
+		return 0;
+
+	entries = nvbios_rd08(bios, bios->bit_offset + 10);
+	size    = nvbios_rd08(bios, bios->bit_offset + 9);
+	entry   = bios->bit_offset + 12;
+	while (entries--) {
+		u8 id = nvbios_rd08(bios, entry + 0);
+		/* the first entry with a given id takes precedence */
+		if (!__test_and_set_bit(id, index->bit_mask)) {
+			index->bit[id].id      = id;
+			index->bit[id].version = nvbios_rd08(bios, entry + 1);
+			index->bit[id].length  = nvbios_rd16(bios, entry + 2);
+			index->bit[id].offset  = nvbios_rd16(bios, entry + 4);
+		}
+		entry += size;
+	}
+
+	return 0;
+}
@@ -21,7 +21,7 @@
  *
  * Authors: Martin Peres
  */
-#include <subdev/bios.h>
+#include "priv.h"
 #include <subdev/bios/bit.h>
 #include <subdev/bios/perf.h>
 #include <subdev/pci.h>
@@ -32,6 +32,11 @@ nvbios_perf_table(struct nvkm_bios *bios, u8 *ver, u8 *hdr,
 {
 	struct bit_entry bit_P;
 	u32 perf = 0;
+	u32 index;
+
+	if (nvbios_index_table(bios, NVBIOS_INDEX_PERF, &index,
+			       ver, hdr, cnt, len, snr, ssz))
+		return index;
 
 	if (!bit_entry(bios, 'P', &bit_P)) {
 		if (bit_P.version <= 2) {
@@ -3,6 +3,7 @@
 #define __NVKM_BIOS_PRIV_H__
 #define nvkm_bios(p) container_of((p), struct nvkm_bios, subdev)
 #include <subdev/bios.h>
+#include <subdev/bios/bit.h>
 
 struct nvbios_source {
 	const char *name;
@@ -14,8 +15,35 @@ struct nvbios_source {
 	bool ignore_checksum;
 	bool no_pcir;
 	bool require_checksum;
+	bool async; /* doesn't touch the GPU, can be probed concurrently */
 };
 
+enum nvbios_index_type {
+	NVBIOS_INDEX_DCB,
+	NVBIOS_INDEX_CONN,
+	NVBIOS_INDEX_PERF,
+	NVBIOS_INDEX_RAMMAP,
+	NVBIOS_INDEX_TIMING,
+	NVBIOS_INDEX_NR
+};
+
+struct nvbios_index {
+	DECLARE_BITMAP(bit_mask, 256);
+	struct bit_entry bit[256];
+
+	bool tables;
+	struct nvbios_index_table {
+		u32 data;
+		u8 ver, hdr, cnt, len, snr, ssz;
+	} table[NVBIOS_INDEX_NR];
+};
+
+int  nvbios_index_new(struct nvkm_bios *);
+void nvbios_index_tables(struct nvkm_bios *);
+void nvbios_index_del(struct nvkm_bios *);
+bool nvbios_index_table(struct nvkm_bios *, enum nvbios_index_type, u32 *data,
+			u8 *ver, u8 *hdr, u8 *cnt, u8 *len, u8 *snr, u8 *ssz);
+
 int nvbios_extend(struct nvkm_bios *, u32 length);
 int nvbios_shadow(struct nvkm_bios *);
 
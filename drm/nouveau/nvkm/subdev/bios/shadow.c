@@ -24,6 +24,7 @@
 #include "priv.h"
 
 #include <core/option.h>
+#include <core/pci.h>
 #include <subdev/bios.h>
 #include <subdev/bios/image.h>
 
@@ -33,6 +34,9 @@ struct shadow {
 	void *data;
 	u32 size;
 	int score;
+	bool complete;
+	bool first;
+	atomic_t *cancel;
 };
 
 static bool
@@ -41,6 +45,8 @@ shadow_fetch(struct nvkm_bios *bios, struct shadow *mthd, u32 upto)
 	const u32 limit = (upto + 3) & ~3;
 	const u32 start = bios->size;
 	void *data = mthd->data;
+	if (mthd->cancel && atomic_read(mthd->cancel))
+		return false;
 	if (nvbios_extend(bios, limit) > 0) {
 		u32 read = mthd->func->read(data, start, limit - start, bios);
 		bios->size = start + read;
@@ -64,11 +70,13 @@ shadow_image(struct nvkm_bios *bios, int idx, u32 offset, struct shadow *mthd)
 		if (!shadow_fetch(bios, mthd, offset + 0x1000)) {
 			nvkm_debug(subdev, "%08x: header fetch failed\n",
 				   offset);
+			mthd->complete = false;
 			return 0;
 		}
 
 		if (!nvbios_image(bios, idx, &image)) {
 			nvkm_debug(subdev, "image %d invalid\n", idx);
+			mthd->complete = false;
 			return 0;
 		}
 	}
@@ -77,6 +85,7 @@ shadow_image(struct nvkm_bios *bios, int idx, u32 offset, struct shadow *mthd)
 
 	if (!shadow_fetch(bios, mthd, image.size)) {
 		nvkm_debug(subdev, "%08x: fetch failed\n", image.base);
+		mthd->complete = false;
 		return 0;
 	}
 
@@ -86,6 +95,7 @@ shadow_image(struct nvkm_bios *bios, int idx, u32 offset, struct shadow *mthd)
 		    nvbios_checksum(&bios->data[image.base], image.size)) {
 			nvkm_debug(subdev, "%08x: checksum failed\n",
 				   image.base);
+			mthd->complete = false;
 			if (!mthd->func->require_checksum) {
 				if (mthd->func->rw)
 					score += 1;
@@ -112,6 +122,7 @@ shadow_method(struct nvkm_bios *bios, struct shadow *mthd, const char *name)
 	const struct nvbios_source *func = mthd->func;
 	struct nvkm_subdev *subdev = &bios->subdev;
 	if (func->name) {
+		s64 time = ktime_to_us(ktime_get());
 		nvkm_debug(subdev, "trying %s...\n", name ? name : func->name);
 		if (func->init) {
 			mthd->data = func->init(bios, name);
@@ -120,10 +131,18 @@ shadow_method(struct nvkm_bios *bios, struct shadow *mthd, const char *name)
 				return 0;
 			}
 		}
+		/* an image can only be trusted outright if every part of it
+		 * was located through its PCIR header, and checksummed
+		 */
+		mthd->complete = !func->no_pcir && !func->ignore_checksum;
 		mthd->score = shadow_image(bios, 0, 0, mthd);
+		if (!mthd->score)
+			mthd->complete = false;
 		if (func->fini)
 			func->fini(mthd->data);
-		nvkm_debug(subdev, "scored %d\n", mthd->score);
+		nvkm_debug(subdev, "scored %d%s in %lld us\n", mthd->score,
+			   mthd->complete ? " (complete)" : "",
+			   ktime_to_us(ktime_get()) - time);
 		mthd->data = bios->data;
 		mthd->size = bios->size;
 		bios->data  = NULL;
@@ -163,10 +182,78 @@ shadow_fw = {
 	.rw = false,
 };
 
+/* Sources that don't touch the GPU (ie. ACPI) are probed from a worker,
+ * alongside the ones that do.  Whichever finds a complete image first
+ * cancels the rest, and is used over any they'd partially read.
+ */
+struct shadow_async {
+	struct work_struct work;
+	struct nvkm_bios *bios;
+	struct shadow *mthds;
+};
+
+static void
+shadow_complete(struct shadow *mthd)
+{
+	if (mthd->complete && !atomic_xchg(mthd->cancel, 1))
+		mthd->first = true;
+}
+
+static void
+shadow_async(struct work_struct *work)
+{
+	struct shadow_async *async = container_of(work, typeof(*async), work);
+	struct shadow *mthd;
+
+	for (mthd = async->mthds; mthd->func; mthd++) {
+		if (atomic_read(mthd->cancel))
+			break;
+		if (!mthd->func->async || mthd->skip)
+			continue;
+		if (shadow_method(async->bios, mthd, NULL))
+			shadow_complete(mthd);
+	}
+}
+
+static char *
+shadow_cache_name(struct nvkm_bios *bios)
+{
+	struct nvkm_device *device = bios->subdev.device;
+	struct pci_dev *pdev;
+	const char *optarg;
+	char *name;
+	int optlen;
+
+	optarg = nvkm_stropt(device->cfgopt, "NvBiosCache", &optlen);
+	if (!optarg || !device->func->pci)
+		return NULL;
+
+	pdev = device->func->pci(device)->pdev;
+	name = kmalloc(optlen + 32, GFP_KERNEL);
+	if (name) {
+		snprintf(name, optlen + 32, "%.*s/%04x-%04x-%04x-%04x.rom",
+			 optlen, optarg, pdev->vendor, pdev->device,
+			 pdev->subsystem_vendor, pdev->subsystem_device);
+	}
+	return name;
+}
+
+static void
+shadow_cache_store(struct nvkm_bios *bios, const char *name)
+{
+#ifndef __KERNEL__
+	int ret = nvos_firmware_store(name, bios->data, bios->size);
+	if (ret)
+		nvkm_warn(&bios->subdev, "failed to cache image, %d\n", ret);
+	else
+		nvkm_debug(&bios->subdev, "cached image as %s\n", name);
+#endif
+}
+
 int
 nvbios_shadow(struct nvkm_bios *bios)
 {
-	struct nvkm_subdev *subdev = &bios->subdev;
+	struct nvkm_subdev *subdev = &bios->subdev, *scratch;
 	struct nvkm_device *device = subdev->device;
 	struct shadow mthds[] = {
 		{ 0, &nvbios_of },
@@ -178,8 +265,10 @@ nvbios_shadow(struct nvkm_bios *bios)
 		{ 1, &nvbios_platform },
 		{}
 	}, *mthd, *best = NULL;
+	struct shadow_async *async;
 	const char *optarg;
-	char *source;
+	char *source, *cache;
+	atomic_t cancel;
 	int optlen;
 
 	/* handle user-specified bios source */
@@ -210,15 +299,77 @@ nvbios_shadow(struct nvkm_bios *bios)
 		}
 	}
 
+	/* use a previously cached copy of the image, if it's complete */
+	cache = shadow_cache_name(bios);
+	if ((!best || !best->score) && cache) {
+		mthd = &mthds[ARRAY_SIZE(mthds) - 1];
+		kfree(mthd->data);
+		mthd->func = &shadow_fw;
+		shadow_method(bios, mthd, cache);
+		mthd->func = NULL;
+
+		if (mthd->complete) {
+			kfree(source);
+			source = cache;
+			cache = NULL;
+			best = mthd;
+		} else {
+			kfree(mthd->data);
+			mthd->data = NULL;
+			mthd->score = 0;
+		}
+	}
+
 	/* scan all potential bios sources, looking for best image */
 	if (!best || !best->score) {
+		atomic_set(&cancel, 0);
+		for (mthd = mthds; mthd->func; mthd++)
+			mthd->cancel = &cancel;
+
+		async = kzalloc(sizeof(*async), GFP_KERNEL);
+		if (async &&
+		    !(async->bios = kzalloc(sizeof(*async->bios), GFP_KERNEL))) {
+			kfree(async);
+			async = NULL;
+		}
+
+		if (async) {
+			nvkm_subdev_ctor(subdev->func, device, subdev->index,
+					 &async->bios->subdev);
+			async->mthds = mthds;
+			INIT_WORK(&async->work, shadow_async);
+			schedule_work(&async->work);
+		}
+
+		/* sources that are only tried if nothing before them scored
+		 * well enough (slow ACPI, and the fallbacks) are left until
+		 * everything else is done
+		 */
+		for (mthd = mthds; mthd->func; mthd++) {
+			if (atomic_read(&cancel))
+				break;
+			if (mthd->skip || (async && mthd->func->async))
+				continue;
+			if (shadow_method(bios, mthd, NULL))
+				shadow_complete(mthd);
+		}
+
+		if (async) {
+			flush_work(&async->work);
+			scratch = &async->bios->subdev;
+			nvkm_subdev_del(&scratch);
+			kfree(async);
+		}
+
 		for (mthd = mthds, best = mthd; mthd->func; mthd++) {
-			if (!mthd->skip || best->score < mthd->skip) {
-				if (shadow_method(bios, mthd, NULL)) {
-					if (mthd->score > best->score)
-						best = mthd;
-				}
+			if (mthd->first) {
+				best = mthd;
+				break;
 			}
+			if (mthd->skip && best->score < mthd->skip)
+				shadow_method(bios, mthd, NULL);
+			if (mthd->score > best->score)
+				best = mthd;
 		}
 	}
 
@@ -230,6 +381,7 @@ nvbios_shadow(struct nvkm_bios *bios)
 
 	if (!best->score) {
 		nvkm_error(subdev, "unable to locate usable image\n");
+		kfree(cache);
 		return -EINVAL;
 	}
 
@@ -237,6 +389,10 @@ nvbios_shadow(struct nvkm_bios *bios)
 		   best->func->name : source);
 	bios->data = best->data;
 	bios->size = best->size;
+
+	if (cache && best->complete)
+		shadow_cache_store(bios, cache);
+	kfree(cache);
 	kfree(source);
 	return 0;
 }
@@ -129,6 +129,7 @@ nvbios_acpi_fast = {
 	.read = acpi_read_fast,
 	.rw = false,
 	.require_checksum = true,
+	.async = true,
 };
 
 const struct nvbios_source
@@ -137,4 +138,5 @@ nvbios_acpi_slow = {
 	.init = acpi_init,
 	.read = acpi_read_slow,
 	.rw = false,
+	.async = true,
 };
@@ -21,7 +21,7 @@
  *
  * Authors: Ben Skeggs
  */
-#include <subdev/bios.h>
+#include "priv.h"
 #include <subdev/bios/bit.h>
 #include <subdev/bios/timing.h>
 
@@ -31,6 +31,11 @@ nvbios_timingTe(struct nvkm_bios *bios,
 {
 	struct bit_entry bit_P;
 	u32 timing = 0;
+	u32 index;
+
+	if (nvbios_index_table(bios, NVBIOS_INDEX_TIMING, &index,
+			       ver, hdr, cnt, len, snr, ssz))
+		return index;
 
 	if (!bit_entry(bios, 'P', &bit_P)) {
 		if (bit_P.version == 1)
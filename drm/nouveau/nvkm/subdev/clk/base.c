@@ -262,7 +262,7 @@ nvkm_cstate_new(struct nvkm_clk *clk, int idx, struct nvkm_pstate *pstate)
  * P-States
  *****************************************************************************/
 static int
-nvkm_pstate_prog(struct nvkm_clk *clk, int pstatei)
+nvkm_pstate_prog(struct nvkm_clk *clk, int pstatei, int cstatei)
 {
 	struct nvkm_subdev *subdev = &clk->subdev;
 	struct nvkm_fb *fb = subdev->device->fb;
@@ -275,6 +275,11 @@ nvkm_pstate_prog(struct nvkm_clk *clk, int pstatei)
 			break;
 	}
 
+	/* only the core clocks differ between a pstate's cstates */
+	clk->cstate = cstatei;
+	if (pstatei == clk->pstate)
+		return nvkm_cstate_prog(clk, pstate, cstatei);
+
 	nvkm_debug(subdev, "setting performance state %d\n", pstatei);
 	clk->pstate = pstatei;
 
@@ -291,7 +296,7 @@ nvkm_pstate_prog(struct nvkm_clk *clk, int pstatei)
 		ram->func->tidy(ram);
 	}
 
-	return nvkm_cstate_prog(clk, pstate, NVKM_CLK_CSTATE_HIGHEST);
+	return nvkm_cstate_prog(clk, pstate, cstatei);
 }
 
 static void
@@ -299,7 +304,7 @@ nvkm_pstate_work(struct work_struct *work)
 {
 	struct nvkm_clk *clk = container_of(work, typeof(*clk), work);
 	struct nvkm_subdev *subdev = &clk->subdev;
-	int pstate;
+	int pstate, cstate;
 
 	if (!atomic_xchg(&clk->waiting, 0))
 		return;
@@ -310,17 +315,24 @@ nvkm_pstate_work(struct work_struct *work)
 		   clk->astate, clk->temp, clk->dstate);
 
 	pstate = clk->pwrsrc ? clk->ustate_ac : clk->ustate_dc;
+	cstate = NVKM_CLK_CSTATE_HIGHEST;
 	if (clk->state_nr && pstate != -1) {
-		pstate = (pstate < 0) ? clk->astate : pstate;
+		if (pstate < 0) {
+			pstate = clk->astate;
+			cstate = clk->acstate;
+		}
 		pstate = min(pstate, clk->state_nr - 1);
-		pstate = max(pstate, clk->dstate);
+		if (pstate < clk->dstate) {
+			pstate = clk->dstate;
+			cstate = NVKM_CLK_CSTATE_HIGHEST;
+		}
 	} else {
 		pstate = clk->pstate = -1;
 	}
 
-	nvkm_trace(subdev, "-> %d\n", pstate);
-	if (pstate != clk->pstate) {
-		int ret = nvkm_pstate_prog(clk, pstate);
+	nvkm_trace(subdev, "-> %d %d\n", pstate, cstate);
+	if (pstate != clk->pstate || (pstate >= 0 && cstate != clk->cstate)) {
+		int ret = nvkm_pstate_prog(clk, pstate, cstate);
 		if (ret) {
 			nvkm_error(subdev, "error setting pstate %d: %d\n",
 				   pstate, ret);
@@ -465,6 +477,21 @@ nvkm_pstate_new(struct nvkm_clk *clk, int idx)
 	return 0;
 }
 
+/* Every cstate of a pstate is a perfmon level, or the pstate itself if it
+ * has none, lowest first.  This lets the perfmon governor trade the core
+ * clocks within a pstate, before it reclocks memory for the next one.
+ */
+static int
+nvkm_pstate_alevel_nr(struct nvkm_pstate *pstate)
+{
+	struct nvkm_cstate *cstate;
+	int nr = 0;
+
+	list_for_each_entry(cstate, &pstate->list, head)
+		nr++;
+	return max(nr, 1);
+}
+
 /******************************************************************************
  * Adjustment triggers
  *****************************************************************************/
@@ -535,9 +562,62 @@ nvkm_clk_astate(struct nvkm_clk *clk, int req, int rel, bool wait)
 	if ( rel) clk->astate += rel;
 	clk->astate = min(clk->astate, clk->state_nr - 1);
 	clk->astate = max(clk->astate, 0);
+	clk->acstate = NVKM_CLK_CSTATE_HIGHEST;
 	return nvkm_pstate_calc(clk, wait);
 }
 
+int
+nvkm_clk_alevel(struct nvkm_clk *clk, int req, bool wait)
+{
+	struct nvkm_pstate *pstate;
+	struct nvkm_cstate *cstate;
+	int idx = 0, level;
+
+	req = clamp(req, 0, clk->alevel_nr - 1);
+	list_for_each_entry(pstate, &clk->states, head) {
+		level = nvkm_pstate_alevel_nr(pstate);
+		if (req < level) {
+			clk->astate = idx;
+			clk->acstate = NVKM_CLK_CSTATE_HIGHEST;
+			list_for_each_entry(cstate, &pstate->list, head) {
+				if (req-- == 0) {
+					if (!list_is_last(&cstate->head,
+							  &pstate->list))
+						clk->acstate = cstate->id;
+					break;
+				}
+			}
+			break;
+		}
+		req -= level;
+		idx++;
+	}
+
+	return nvkm_pstate_calc(clk, wait);
+}
+
+int
+nvkm_clk_alevel_get(struct nvkm_clk *clk)
+{
+	struct nvkm_pstate *pstate;
+	struct nvkm_cstate *cstate;
+	int idx = 0, level = 0;
+
+	list_for_each_entry(pstate, &clk->states, head) {
+		if (idx++ == clk->astate) {
+			list_for_each_entry(cstate, &pstate->list, head) {
+				if (cstate->id == clk->acstate)
+					return level;
+				level++;
+			}
+			return list_empty(&pstate->list) ? level : level - 1;
+		}
+		level += nvkm_pstate_alevel_nr(pstate);
+	}
+
+	return 0;
+}
+
 int
 nvkm_clk_tstate(struct nvkm_clk *clk, u8 temp)
 {
@@ -614,13 +694,50 @@ nvkm_clk_init(struct nvkm_subdev *subdev)
 		return clk->func->init(clk);
 
 	clk->astate = clk->state_nr - 1;
+	clk->acstate = NVKM_CLK_CSTATE_HIGHEST;
 	clk->dstate = 0;
 	clk->pstate = -1;
+	clk->cstate = NVKM_CLK_CSTATE_HIGHEST;
 	clk->temp = 90; /* reasonable default value */
 	nvkm_pstate_calc(clk, true);
 	return 0;
 }
 
+static void
+nvkm_clk_precalc(struct nvkm_clk *clk, struct nvkm_cstate *cstate)
+{
+	int ret = clk->func->calc(clk, cstate);
+	if (ret)
+		nvkm_debug(&clk->subdev, "precalc failed: %d\n", ret);
+	clk->func->tidy(clk);
+}
+
+static int
+nvkm_clk_oneinit(struct nvkm_subdev *subdev)
+{
+	struct nvkm_clk *clk = nvkm_clk(subdev);
+	struct nvkm_pstate *pstate;
+	struct nvkm_cstate *cstate;
+
+	/* Work out the PLL coefficients for every clock a performance level
+	 * can ask for now, so reclocking later finds them already solved.
+	 * Nothing's programmed, calc() only prepares what prog() would do.
+	 *
+	 * Only the two-stage searches are remembered, on implementations
+	 * that don't use them there'd be nothing to gain.
+	 */
+	if (!clk->func->precalc || !clk->allow_reclock || clk->func->pstates)
+		return 0;
+
+	list_for_each_entry(pstate, &clk->states, head) {
+		nvkm_clk_precalc(clk, &pstate->base);
+		list_for_each_entry(cstate, &pstate->list, head)
+			nvkm_clk_precalc(clk, cstate);
+	}
+
+	return 0;
+}
+
 static void *
 nvkm_clk_dtor(struct nvkm_subdev *subdev)
 {
@@ -643,6 +760,7 @@ nvkm_clk_dtor(struct nvkm_subdev *subdev)
 static const struct nvkm_subdev_func
 nvkm_clk = {
 	.dtor = nvkm_clk_dtor,
+	.oneinit = nvkm_clk_oneinit,
 	.init = nvkm_clk_init,
 	.fini = nvkm_clk_fini,
 };
@@ -656,6 +774,7 @@ nvkm_clk_ctor(const struct nvkm_clk_func *func, struct nvkm_device *device,
 	int ret, idx, arglen;
 	const char *mode;
 	struct nvbios_vpstate_header h;
+	struct nvkm_pstate *pstate;
 
 	nvkm_subdev_ctor(&nvkm_clk, device, index, subdev);
 
@@ -690,6 +809,9 @@ nvkm_clk_ctor(const struct nvkm_clk_func *func, struct nvkm_device *device,
 		clk->state_nr = func->nr_pstates;
 	}
 
+	list_for_each_entry(pstate, &clk->states, head)
+		clk->alevel_nr += nvkm_pstate_alevel_nr(pstate);
+
 	ret = nvkm_notify_init(NULL, &device->event, nvkm_clk_pwrsrc, true,
 			       NULL, 0, 0, &clk->pwrsrc_ntfy);
 	if (ret)
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2020 Red Hat Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER(S) OR AUTHOR(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "pll.h"
+
+#include <subdev/bios.h>
+#include <subdev/bios/pll.h>
+
+/* Four-way set-associative, the least recently used way is replaced. */
+#define NVKM_PLL_MEMO_SETS 64
+#define NVKM_PLL_MEMO_WAYS 4
+
+static struct nvkm_pll_memo {
+	struct nvkm_pll_key key;
+	struct nvkm_pll_coef coef;
+	u32 gen; /* valid if current, flushing moves onto the next */
+	u32 used;
+} nvkm_pll_memo[NVKM_PLL_MEMO_SETS][NVKM_PLL_MEMO_WAYS];
+static u32 nvkm_pll_memo_gen = 1;
+static u32 nvkm_pll_memo_used;
+static DEFINE_SPINLOCK(nvkm_pll_memo_lock);
+
+void
+nvkm_pll_key(struct nvkm_pll_key *key, const struct nvbios_pll *info,
+	     u8 bios_chip, u32 freq)
+{
+	memset(key, 0x00, sizeof(*key));
+	key->freq = freq;
+	key->refclk = info->refclk;
+	key->bios_chip = bios_chip;
+	key->max_p_usable = info->max_p_usable;
+	key->vco1.min_freq = info->vco1.min_freq;
+	key->vco1.max_freq = info->vco1.max_freq;
+	key->vco1.min_inputfreq = info->vco1.min_inputfreq;
+	key->vco1.max_inputfreq = info->vco1.max_inputfreq;
+	key->vco1.min_m = info->vco1.min_m;
+	key->vco1.max_m = info->vco1.max_m;
+	key->vco1.min_n = info->vco1.min_n;
+	key->vco1.max_n = info->vco1.max_n;
+	key->vco2.min_freq = info->vco2.min_freq;
+	key->vco2.max_freq = info->vco2.max_freq;
+	key->vco2.min_inputfreq = info->vco2.min_inputfreq;
+	key->vco2.max_inputfreq = info->vco2.max_inputfreq;
+	key->vco2.min_m = info->vco2.min_m;
+	key->vco2.max_m = info->vco2.max_m;
+	key->vco2.min_n = info->vco2.min_n;
+	key->vco2.max_n = info->vco2.max_n;
+}
+
+static struct nvkm_pll_memo *
+nvkm_pll_memo_set(const struct nvkm_pll_key *key)
+{
+	const u8 *data = (const u8 *)key;
+	u32 hash = 0x811c9dc5;
+	int i;
+
+	for (i = 0; i < sizeof(*key); i++)
+		hash = (hash ^ data[i]) * 0x01000193;
+	return nvkm_pll_memo[(hash ^ (hash >> 16)) % NVKM_PLL_MEMO_SETS];
+}
+
+static struct nvkm_pll_memo *
+nvkm_pll_memo_find(struct nvkm_pll_memo *set, const struct nvkm_pll_key *key)
+{
+	int i;
+
+	for (i = 0; i < NVKM_PLL_MEMO_WAYS; i++) {
+		if (set[i].gen == nvkm_pll_memo_gen &&
+		    !memcmp(&set[i].key, key, sizeof(*key)))
+			return &set[i];
+	}
+
+	return NULL;
+}
+
+bool
+nvkm_pll_memo_get(const struct nvkm_pll_key *key, struct nvkm_pll_coef *coef)
+{
+	struct nvkm_pll_memo *memo;
+
+	spin_lock(&nvkm_pll_memo_lock);
+	memo = nvkm_pll_memo_find(nvkm_pll_memo_set(key), key);
+	if (memo) {
+		memo->used = ++nvkm_pll_memo_used;
+		*coef = memo->coef;
+	}
+	spin_unlock(&nvkm_pll_memo_lock);
+	return memo != NULL;
+}
+
+void
+nvkm_pll_memo_put(const struct nvkm_pll_key *key,
+		  const struct nvkm_pll_coef *coef)
+{
+	struct nvkm_pll_memo *set = nvkm_pll_memo_set(key), *memo;
+	int i;
+
+	spin_lock(&nvkm_pll_memo_lock);
+	if (!(memo = nvkm_pll_memo_find(set, key))) {
+		memo = &set[0];
+		for (i = 1; i < NVKM_PLL_MEMO_WAYS; i++) {
+			if (memo->gen == nvkm_pll_memo_gen &&
+			    (set[i].gen != nvkm_pll_memo_gen ||
+			     set[i].used < memo->used))
+				memo = &set[i];
+		}
+	}
+
+	memo->key = *key;
+	memo->coef = *coef;
+	memo->gen = nvkm_pll_memo_gen;
+	memo->used = ++nvkm_pll_memo_used;
+	spin_unlock(&nvkm_pll_memo_lock);
+}
+
+#ifndef __KERNEL__
+/* Solutions never go stale, this is only so bin/nv_pllsim can time the
+ * search with nothing remembered.
+ */
+void
+nvkm_pll_memo_flush(void)
+{
+	spin_lock(&nvkm_pll_memo_lock);
+	if (!++nvkm_pll_memo_gen)
+		nvkm_pll_memo_gen++;
+	spin_unlock(&nvkm_pll_memo_lock);
+}
+#endif
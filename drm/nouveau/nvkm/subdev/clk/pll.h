@@ -9,4 +9,44 @@ int nv04_pll_calc(struct nvkm_subdev *, struct nvbios_pll *, u32 freq,
 		  int *N1, int *M1, int *N2, int *M2, int *P);
 int gt215_pll_calc(struct nvkm_subdev *, struct nvbios_pll *, u32 freq,
 		  int *N, int *fN, int *M, int *P);
+
+/* Two-stage solutions take a while to search for, but are a function of
+ * the limits and target alone, so they're remembered across calls (and
+ * devices) by everything that went into them.
+ */
+struct nvkm_pll_key {
+	u32 freq;
+	u32 refclk;
+	u8  bios_chip;
+	u8  max_p_usable;
+	struct {
+		u32 min_freq;
+		u32 max_freq;
+		u32 min_inputfreq;
+		u32 max_inputfreq;
+		u8  min_m;
+		u8  max_m;
+		u8  min_n;
+		u8  max_n;
+	} vco1, vco2;
+};
+
+struct nvkm_pll_coef {
+	int ret;
+	bool set; /* coefficients below are valid */
+	u8  N1;
+	u8  M1;
+	u8  N2;
+	u8  M2;
+	u8  P;
+};
+
+void nvkm_pll_key(struct nvkm_pll_key *, const struct nvbios_pll *,
+		  u8 bios_chip, u32 freq);
+bool nvkm_pll_memo_get(const struct nvkm_pll_key *, struct nvkm_pll_coef *);
+void nvkm_pll_memo_put(const struct nvkm_pll_key *,
+		       const struct nvkm_pll_coef *);
+#ifndef __KERNEL__
+void nvkm_pll_memo_flush(void);
+#endif
 #endif
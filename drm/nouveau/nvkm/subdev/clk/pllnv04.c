@@ -152,6 +152,7 @@ getMNP_double(struct nvkm_subdev *subdev, struct nvbios_pll *info, int clk,
 	int clkP, calcclk1, calcclk2, calcclkout;
 	int delta, bestdelta = INT_MAX;
 	int bestclk = 0;
+	int lo2, hi2;
 
 	int vco2 = (maxvco2 - maxvco2/200) / 2;
 	for (log2P = 0; clk && log2P < maxlog2P && clk <= (vco2 >> log2P); log2P++)
@@ -167,14 +168,48 @@ getMNP_double(struct nvkm_subdev *subdev, struct nvbios_pll *info, int clk,
 		if (crystal/M1 > maxU1)
 			continue;
 
-		for (N1 = minN1; N1 <= maxN1; N1++) {
+		/* Start from the first N1 that puts VCO1 in range. */
+		N1 = max(minN1, (minvco1 * M1 + crystal - 1) / crystal);
+		for (; N1 <= maxN1; N1++) {
 			calcclk1 = crystal * N1 / M1;
 			if (calcclk1 < minvco1)
 				continue;
 			if (calcclk1 > maxvco1)
 				break;
 
-			for (M2 = minM2; M2 <= maxM2; M2++) {
+			/* Bound what the second stage can output from here,
+			 * and skip it if nothing it can reach would beat the
+			 * best found so far.  VCO2 only rises with N1, so if
+			 * it's already too high, so is every N1 after it.
+			 */
+			if (!fixedgain2) {
+				lo2 = minvco2;
+				hi2 = maxvco2;
+				if (maxM2)
+					lo2 = max(lo2, calcclk1 * minN2 / maxM2);
+				if (minM2)
+					hi2 = min(hi2, calcclk1 * maxN2 / minM2);
+				if (chip_version < 0x60) {
+					lo2 = max(lo2, calcclk1 * 4);
+					hi2 = min(hi2, calcclk1 * 11 - 1);
+				}
+
+				if ((lo2 >> log2P) > clk &&
+				    (lo2 >> log2P) - clk >= bestdelta)
+					break;
+				if (lo2 > hi2 ||
+				    clk - (hi2 >> log2P) >= bestdelta)
+					continue;
+			}
+
+			/* Start from the first M2 that doesn't put the
+			 * second stage's input above its limit.
+			 */
+			M2 = minM2;
+			if (maxU2 >= minU2 && maxU2 < INT_MAX)
+				M2 = max(M2, calcclk1 / (maxU2 + 1) + 1);
+
+			for (; M2 <= maxM2; M2++) {
 				if (calcclk1/M2 < minU2)
 					break;
 				if (calcclk1/M2 > maxU2)
@@ -223,6 +258,40 @@ getMNP_double(struct nvkm_subdev *subdev, struct nvbios_pll *info, int clk,
 	return bestclk;
 }
 
+static int
+getMNP_double_memo(struct nvkm_subdev *subdev, struct nvbios_pll *info,
+		   int clk, int *pN1, int *pM1, int *pN2, int *pM2, int *pP)
+{
+	struct nvkm_pll_key key;
+	struct nvkm_pll_coef coef;
+	int N1 = -1, M1, N2, M2, P;
+
+	nvkm_pll_key(&key, info, subdev->device->bios->version.chip, clk);
+	if (!nvkm_pll_memo_get(&key, &coef)) {
+		coef.ret = getMNP_double(subdev, info, clk,
+					 &N1, &M1, &N2, &M2, &P);
+		coef.set = N1 >= 0;
+		if (coef.set) {
+			coef.N1 = N1;
+			coef.M1 = M1;
+			coef.N2 = N2;
+			coef.M2 = M2;
+			coef.P = P;
+		}
+		nvkm_pll_memo_put(&key, &coef);
+	}
+
+	if (coef.set) {
+		*pN1 = coef.N1;
+		*pM1 = coef.M1;
+		*pN2 = coef.N2;
+		*pM2 = coef.M2;
+		*pP = coef.P;
+	}
+
+	return coef.ret;
+}
+
 int
 nv04_pll_calc(struct nvkm_subdev *subdev, struct nvbios_pll *info, u32 freq,
 	      int *N1, int *M1, int *N2, int *M2, int *P)
@@ -236,7 +305,8 @@ nv04_pll_calc(struct nvkm_subdev *subdev, struct nvbios_pll *info, u32 freq,
 			*M2 = 1;
 		}
 	} else {
-		ret = getMNP_double(subdev, info, freq, N1, M1, N2, M2, P);
+		ret = getMNP_double_memo(subdev, info, freq,
+					 N1, M1, N2, M2, P);
 	}
 
 	if (!ret)
@@ -13,6 +13,7 @@ struct nvkm_clk_func {
 	void (*tidy)(struct nvkm_clk *);
 	struct nvkm_pstate *pstates;
 	int nr_pstates;
+	bool precalc; /* calc() does two-stage nv04_pll_calc() searches */
 	struct nvkm_domain domains[];
 };
 
@@ -0,0 +1,305 @@
+/*
+ * Copyright 2013 Red Hat Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER(S) OR AUTHOR(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "ramfuc.h"
+
+#include <core/option.h>
+
+/* Out of line, the ram constructors set up dozens of these. */
+struct ramfuc_reg
+ramfuc_reg(u32 addr)
+{
+	return (struct ramfuc_reg) {
+		.sequence = 0,
+		.addr = addr,
+		.stride = 0,
+		.mask = 0x1,
+		.data = 0xdeadbeef,
+	};
+}
+
+/* A reclock script only depends on the target ramcfg/timing data, and on
+ * the registers that were read from the hardware while building it.  We
+ * record both, and replay the recorded MEMX commands in place of running
+ * calc() again if every one of those registers still holds the same value.
+ *
+ * Whatever else calc() works out along the way, that prog() and later
+ * calc()s rely on, is handed to us as an opaque blob, and restored along
+ * with the replay.
+ */
+#define RAMFUC_SCRIPT_MAX 16
+
+struct ramfuc_script_rd {
+	u32 addr;
+	u32 data;
+};
+
+struct ramfuc_script_op {
+	enum ramfuc_op_type type;
+	u32 addr;
+	u32 mask;
+	u32 data;
+	u32 nsec;
+};
+
+struct ramfuc_script {
+	struct list_head head;
+	struct nvkm_ram_data next;
+	void *state;
+	u32 size;
+	bool failed;
+
+	struct ramfuc_script_rd *rd;
+	int rd_nr;
+	int rd_max;
+
+	struct ramfuc_script_op *op;
+	int op_nr;
+	int op_max;
+};
+
+static void
+ramfuc_script_del(struct ramfuc_script **pscript)
+{
+	struct ramfuc_script *script = *pscript;
+	if (script) {
+		kfree(script->state);
+		kfree(script->rd);
+		kfree(script->op);
+		kfree(*pscript);
+		*pscript = NULL;
+	}
+}
+
+static void *
+ramfuc_script_grow(void *data, int *max, size_t size)
+{
+	int nr = *max ? *max * 2 : 64;
+	void *temp = kmalloc_array(nr, size, GFP_KERNEL);
+	if (temp) {
+		if (data)
+			memcpy(temp, data, *max * size);
+		*max = nr;
+	}
+	kfree(data);
+	return temp;
+}
+
+void
+ramfuc_script_rd32(struct ramfuc *ram, u32 addr, u32 data)
+{
+	struct ramfuc_script *script = ram->script;
+
+	if (script->failed)
+		return;
+
+	if (script->rd_nr == script->rd_max) {
+		script->rd = ramfuc_script_grow(script->rd, &script->rd_max,
+						sizeof(*script->rd));
+		if (!script->rd) {
+			script->failed = true;
+			return;
+		}
+	}
+
+	script->rd[script->rd_nr].addr = addr;
+	script->rd[script->rd_nr].data = data;
+	script->rd_nr++;
+}
+
+void
+ramfuc_script_op(struct ramfuc *ram, enum ramfuc_op_type type,
+		 u32 addr, u32 mask, u32 data, u32 nsec)
+{
+	struct ramfuc_script *script = ram->script;
+
+	if (script->failed)
+		return;
+
+	if (script->op_nr == script->op_max) {
+		script->op = ramfuc_script_grow(script->op, &script->op_max,
+						sizeof(*script->op));
+		if (!script->op) {
+			script->failed = true;
+			return;
+		}
+	}
+
+	script->op[script->op_nr].type = type;
+	script->op[script->op_nr].addr = addr;
+	script->op[script->op_nr].mask = mask;
+	script->op[script->op_nr].data = data;
+	script->op[script->op_nr].nsec = nsec;
+	script->op_nr++;
+}
+
+void
+ramfuc_script_begin(struct ramfuc *ram, struct nvkm_ram_data *next)
+{
+	if (!ram->cache)
+		return;
+
+	if ((ram->script = kzalloc(sizeof(*ram->script), GFP_KERNEL)))
+		ram->script->next = *next;
+}
+
+void
+ramfuc_script_end(struct ramfuc *ram, int ret, const void *state, u32 size)
+{
+	struct ramfuc_script *script = ram->script;
+
+	ram->script = NULL;
+	if (!script)
+		return;
+
+	if (!ret && !script->failed) {
+		script->state = kmemdup(state, size, GFP_KERNEL);
+		script->size = size;
+	}
+
+	if (ret || script->failed || !script->state) {
+		ramfuc_script_del(&script);
+		return;
+	}
+
+	nvkm_debug(&ram->fb->subdev, "script for %d kHz: %d ops, %d reads\n",
+		   script->next.freq, script->op_nr, script->rd_nr);
+
+	if (ram->scripts_nr == RAMFUC_SCRIPT_MAX) {
+		struct ramfuc_script *temp =
+			list_last_entry(&ram->scripts, typeof(*temp), head);
+		list_del(&temp->head);
+		ramfuc_script_del(&temp);
+		ram->scripts_nr--;
+	}
+
+	list_add(&script->head, &ram->scripts);
+	ram->scripts_nr++;
+}
+
+static bool
+ramfuc_script_valid(struct nvkm_device *device, struct ramfuc_script *script,
+		    struct nvkm_ram_data *next)
+{
+	int i;
+
+	if (script->next.freq != next->freq ||
+	    memcmp(&script->next.bios, &next->bios, sizeof(next->bios)))
+		return false;
+
+	for (i = 0; i < script->rd_nr; i++) {
+		if (nvkm_rd32(device, script->rd[i].addr) != script->rd[i].data)
+			return false;
+	}
+
+	return true;
+}
+
+int
+ramfuc_script_exec(struct ramfuc *ram, struct nvkm_fb *fb,
+		   struct nvkm_ram_data *next, void *state, u32 size)
+{
+	struct nvkm_subdev *subdev = &fb->subdev;
+	struct ramfuc_script *script;
+	int ret, i;
+
+	if (!ram->cache)
+		return -ENOENT;
+
+	list_for_each_entry(script, &ram->scripts, head) {
+		if (script->size == size &&
+		    ramfuc_script_valid(subdev->device, script, next))
+			break;
+	}
+
+	if (&script->head == &ram->scripts)
+		return -ENOENT;
+
+	list_move(&script->head, &ram->scripts);
+	nvkm_debug(subdev, "script for %d kHz: %d ops, cached\n",
+		   script->next.freq, script->op_nr);
+
+	ret = nvkm_memx_init(subdev->device->pmu, &ram->memx);
+	if (ret)
+		return ret;
+
+	ram->sequence++;
+	ram->fb = fb;
+	memcpy(state, script->state, size);
+
+	for (i = 0; i < script->op_nr; i++) {
+		struct ramfuc_script_op *op = &script->op[i];
+		switch (op->type) {
+		case RAMFUC_OP_WR32:
+			nvkm_memx_wr32(ram->memx, op->addr, op->data);
+			break;
+		case RAMFUC_OP_WAIT:
+			nvkm_memx_wait(ram->memx, op->addr, op->mask,
+				       op->data, op->nsec);
+			break;
+		case RAMFUC_OP_NSEC:
+			nvkm_memx_nsec(ram->memx, op->nsec);
+			break;
+		case RAMFUC_OP_VBLANK:
+			nvkm_memx_wait_vblank(ram->memx);
+			break;
+		case RAMFUC_OP_TRAIN:
+			nvkm_memx_train(ram->memx);
+			break;
+		case RAMFUC_OP_BLOCK:
+			nvkm_memx_block(ram->memx);
+			break;
+		case RAMFUC_OP_UNBLOCK:
+			nvkm_memx_unblock(ram->memx);
+			break;
+		default:
+			WARN_ON(1);
+			break;
+		}
+	}
+
+	return 0;
+}
+
+void
+ramfuc_script_dtor(struct ramfuc *ram)
+{
+	struct ramfuc_script *script, *temp;
+
+	if (!ram->cache)
+		return;
+
+	list_for_each_entry_safe(script, temp, &ram->scripts, head) {
+		list_del(&script->head);
+		ramfuc_script_del(&script);
+	}
+	ram->scripts_nr = 0;
+}
+
+void
+ramfuc_script_ctor(struct ramfuc *ram, struct nvkm_fb *fb)
+{
+	struct nvkm_device *device = fb->subdev.device;
+
+	INIT_LIST_HEAD(&ram->scripts);
+	ram->scripts_nr = 0;
+	ram->cache = nvkm_boolopt(device->cfgopt, "NvMemScriptCache", true);
+}
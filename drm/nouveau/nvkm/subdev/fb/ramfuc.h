@@ -4,12 +4,40 @@
 #include <subdev/fb.h>
 #include <subdev/pmu.h>
 
+struct ramfuc_script;
+
 struct ramfuc {
 	struct nvkm_memx *memx;
 	struct nvkm_fb *fb;
 	int sequence;
+
+	/* memoised scripts, see ramfuc.c */
+	struct ramfuc_script *script;
+	struct list_head scripts;
+	int scripts_nr;
+	bool cache;
+};
+
+enum ramfuc_op_type {
+	RAMFUC_OP_WR32,
+	RAMFUC_OP_WAIT,
+	RAMFUC_OP_NSEC,
+	RAMFUC_OP_VBLANK,
+	RAMFUC_OP_TRAIN,
+	RAMFUC_OP_BLOCK,
+	RAMFUC_OP_UNBLOCK,
 };
 
+void ramfuc_script_ctor(struct ramfuc *, struct nvkm_fb *);
+void ramfuc_script_dtor(struct ramfuc *);
+void ramfuc_script_begin(struct ramfuc *, struct nvkm_ram_data *);
+void ramfuc_script_end(struct ramfuc *, int ret, const void *state, u32 size);
+int  ramfuc_script_exec(struct ramfuc *, struct nvkm_fb *,
+			 struct nvkm_ram_data *, void *state, u32 size);
+void ramfuc_script_rd32(struct ramfuc *, u32 addr, u32 data);
+void ramfuc_script_op(struct ramfuc *, enum ramfuc_op_type,
+		      u32 addr, u32 mask, u32 data, u32 nsec);
+
 struct ramfuc_reg {
 	int sequence;
 	bool force;
@@ -43,17 +71,7 @@ ramfuc_reg2(u32 addr1, u32 addr2)
 	};
 }
 
-static noinline struct ramfuc_reg
-ramfuc_reg(u32 addr)
-{
-	return (struct ramfuc_reg) {
-		.sequence = 0,
-		.addr = addr,
-		.stride = 0,
-		.mask = 0x1,
-		.data = 0xdeadbeef,
-	};
-}
+struct ramfuc_reg ramfuc_reg(u32 addr);
 
 static inline int
 ramfuc_init(struct ramfuc *ram, struct nvkm_fb *fb)
@@ -82,8 +100,11 @@ static inline u32
 ramfuc_rd32(struct ramfuc *ram, struct ramfuc_reg *reg)
 {
 	struct nvkm_device *device = ram->fb->subdev.device;
-	if (reg->sequence != ram->sequence)
+	if (reg->sequence != ram->sequence) {
 		reg->data = nvkm_rd32(device, reg->addr);
+		if (ram->script)
+			ramfuc_script_rd32(ram, reg->addr, reg->data);
+	}
 	return reg->data;
 }
 
@@ -96,8 +117,13 @@ ramfuc_wr32(struct ramfuc *ram, struct ramfuc_reg *reg, u32 data)
 	reg->data = data;
 
 	for (mask = reg->mask; mask > 0; mask = (mask & ~1) >> 1) {
-		if (mask & 1)
+		if (mask & 1) {
 			nvkm_memx_wr32(ram->memx, reg->addr+off, reg->data);
+			if (ram->script) {
+				ramfuc_script_op(ram, RAMFUC_OP_WR32,
+						 reg->addr+off, 0, reg->data, 0);
+			}
+		}
 		off += reg->stride;
 	}
 }
@@ -123,24 +149,32 @@ static inline void
 ramfuc_wait(struct ramfuc *ram, u32 addr, u32 mask, u32 data, u32 nsec)
 {
 	nvkm_memx_wait(ram->memx, addr, mask, data, nsec);
+	if (ram->script)
+		ramfuc_script_op(ram, RAMFUC_OP_WAIT, addr, mask, data, nsec);
 }
 
 static inline void
 ramfuc_nsec(struct ramfuc *ram, u32 nsec)
 {
 	nvkm_memx_nsec(ram->memx, nsec);
+	if (ram->script)
+		ramfuc_script_op(ram, RAMFUC_OP_NSEC, 0, 0, 0, nsec);
 }
 
 static inline void
 ramfuc_wait_vblank(struct ramfuc *ram)
 {
 	nvkm_memx_wait_vblank(ram->memx);
+	if (ram->script)
+		ramfuc_script_op(ram, RAMFUC_OP_VBLANK, 0, 0, 0, 0);
 }
 
 static inline void
 ramfuc_train(struct ramfuc *ram)
 {
 	nvkm_memx_train(ram->memx);
+	if (ram->script)
+		ramfuc_script_op(ram, RAMFUC_OP_TRAIN, 0, 0, 0, 0);
 }
 
 static inline int
@@ -153,12 +187,16 @@ static inline void
 ramfuc_block(struct ramfuc *ram)
 {
 	nvkm_memx_block(ram->memx);
+	if (ram->script)
+		ramfuc_script_op(ram, RAMFUC_OP_BLOCK, 0, 0, 0, 0);
 }
 
 static inline void
 ramfuc_unblock(struct ramfuc *ram)
 {
 	nvkm_memx_unblock(ram->memx);
+	if (ram->script)
+		ramfuc_script_op(ram, RAMFUC_OP_UNBLOCK, 0, 0, 0, 0);
 }
 
 #define ram_init(s,p)        ramfuc_init(&(s)->base, (p))
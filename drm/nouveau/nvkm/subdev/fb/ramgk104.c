@@ -242,6 +242,11 @@ gk104_ram_nuts(struct gk104_ram *ram, struct ramfuc_reg *reg,
 			u32 prev = nvkm_rd32(device, addr);
 			u32 next = (prev & ~mask) | data;
 			nvkm_memx_wr32(fuc->memx, addr, next);
+			if (fuc->script) {
+				ramfuc_script_rd32(fuc, addr, prev);
+				ramfuc_script_op(fuc, RAMFUC_OP_WR32,
+						 addr, 0, next, 0);
+			}
 		}
 	}
 }
@@ -1108,6 +1113,56 @@ gk104_ram_calc_xits(struct gk104_ram *ram, struct nvkm_ram_data *next)
 	return ret;
 }
 
+/* Everything gk104_ram_calc_xits() works out besides the script itself,
+ * which prog() and the next calc() rely on, and a replay has to restore.
+ */
+struct gk104_ram_xits {
+	int from;
+	int mode;
+	int N1, fN1, M1, P1;
+	int N2, M2, P2;
+	u32 refclk;
+	u32 mr[16];
+	u32 mr1_nuts;
+	u32 freq;
+};
+
+static void
+gk104_ram_xits_save(struct gk104_ram *ram, struct gk104_ram_xits *xits)
+{
+	xits->from = ram->from;
+	xits->mode = ram->mode;
+	xits->N1 = ram->N1;
+	xits->fN1 = ram->fN1;
+	xits->M1 = ram->M1;
+	xits->P1 = ram->P1;
+	xits->N2 = ram->N2;
+	xits->M2 = ram->M2;
+	xits->P2 = ram->P2;
+	xits->refclk = ram->fuc.mempll.refclk;
+	memcpy(xits->mr, ram->base.mr, sizeof(xits->mr));
+	xits->mr1_nuts = ram->base.mr1_nuts;
+	xits->freq = ram->base.freq;
+}
+
+static void
+gk104_ram_xits_load(struct gk104_ram *ram, struct gk104_ram_xits *xits)
+{
+	ram->from = xits->from;
+	ram->mode = xits->mode;
+	ram->N1 = xits->N1;
+	ram->fN1 = xits->fN1;
+	ram->M1 = xits->M1;
+	ram->P1 = xits->P1;
+	ram->N2 = xits->N2;
+	ram->M2 = xits->M2;
+	ram->P2 = xits->P2;
+	ram->fuc.mempll.refclk = xits->refclk;
+	memcpy(ram->base.mr, xits->mr, sizeof(ram->base.mr));
+	ram->base.mr1_nuts = xits->mr1_nuts;
+	ram->base.freq = xits->freq;
+}
+
 int
 gk104_ram_calc(struct nvkm_ram *base, u32 freq)
 {
@@ -1115,6 +1170,7 @@ gk104_ram_calc(struct nvkm_ram *base, u32 freq)
 	struct nvkm_clk *clk = ram->base.fb->subdev.device->clk;
 	struct nvkm_ram_data *xits = &ram->base.xition;
 	struct nvkm_ram_data *copy;
+	struct gk104_ram_xits state;
 	int ret;
 
 	if (ram->base.next == NULL) {
@@ -1148,7 +1204,22 @@ gk104_ram_calc(struct nvkm_ram *base, u32 freq)
 		ram->base.next = &ram->base.target;
 	}
 
-	return gk104_ram_calc_xits(ram, ram->base.next);
+	/* replay a previously generated script if nothing it depends on
+	 * has changed since, otherwise build (and remember) a new one
+	 */
+	ret = ramfuc_script_exec(&ram->fuc.base, ram->base.fb, ram->base.next,
+				 &state, sizeof(state));
+	if (ret != -ENOENT) {
+		if (ret == 0)
+			gk104_ram_xits_load(ram, &state);
+		return ret;
+	}
+
+	ramfuc_script_begin(&ram->fuc.base, ram->base.next);
+	ret = gk104_ram_calc_xits(ram, ram->base.next);
+	gk104_ram_xits_save(ram, &state);
+	ramfuc_script_end(&ram->fuc.base, ret, &state, sizeof(state));
+	return ret;
 }
 
 static void
@@ -1432,6 +1503,8 @@ gk104_ram_init(struct nvkm_ram *ram)
 	nvkm_wr32(device, 0x10ecc0, 0xffffffff);
 	nvkm_mask(device, 0x10f160, 0x00000010, 0x00000010);
 
+	/* scripts built before suspend are no longer trustworthy */
+	ramfuc_script_dtor(&gk104_ram(ram)->fuc.base);
 	return gk104_ram_train_init(ram);
 }
 
@@ -1510,6 +1583,8 @@ gk104_ram_dtor(struct nvkm_ram *base)
 	struct gk104_ram *ram = gk104_ram(base);
 	struct nvkm_ram_data *cfg, *tmp;
 
+	ramfuc_script_dtor(&ram->fuc.base);
+
 	list_for_each_entry_safe(cfg, tmp, &ram->cfg, head) {
 		kfree(cfg);
 	}
@@ -1539,6 +1614,7 @@ gk104_ram_new_(const struct nvkm_ram_func *func, struct nvkm_fb *fb,
 		return ret;
 
 	INIT_LIST_HEAD(&ram->cfg);
+	ramfuc_script_ctor(&ram->fuc.base, fb);
 
 	/* calculate a mask of differently configured memory partitions,
 	 * because, of course reclocking wasn't complicated enough
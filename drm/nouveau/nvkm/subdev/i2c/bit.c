@@ -28,16 +28,27 @@
 #define T_RISEFALL 1000
 #define T_HOLD     5000
 
-static inline void
+/* The lines are open-drain, so driving one to the state we last drove it
+ * to changes nothing, and there's no need to wait for it to settle.
+ */
+static inline bool
 nvkm_i2c_drive_scl(struct nvkm_i2c_bus *bus, int state)
 {
+	if (bus->scl == state)
+		return false;
 	bus->func->drive_scl(bus, state);
+	bus->scl = state;
+	return true;
 }
 
-static inline void
+static inline bool
 nvkm_i2c_drive_sda(struct nvkm_i2c_bus *bus, int state)
 {
+	if (bus->sda == state)
+		return false;
 	bus->func->drive_sda(bus, state);
+	bus->sda = state;
+	return true;
 }
 
 static inline int
@@ -63,12 +74,17 @@ nvkm_i2c_raise_scl(struct nvkm_i2c_bus *bus)
 {
 	u32 timeout = T_TIMEOUT / T_RISEFALL;
 
+	/* Once it's seen high, it has risen, unless the slave's
+	 * stretching the clock there's no need to wait.
+	 */
 	nvkm_i2c_drive_scl(bus, 1);
-	do {
+	while (!nvkm_i2c_sense_scl(bus)) {
+		if (!--timeout)
+			return false;
 		nvkm_i2c_delay(bus, T_RISEFALL);
-	} while (!nvkm_i2c_sense_scl(bus) && --timeout);
+	}
 
-	return timeout != 0;
+	return true;
 }
 
 static int
@@ -95,8 +111,8 @@ static void
 i2c_stop(struct nvkm_i2c_bus *bus)
 {
 	nvkm_i2c_drive_scl(bus, 0);
-	nvkm_i2c_drive_sda(bus, 0);
-	nvkm_i2c_delay(bus, T_RISEFALL);
+	if (nvkm_i2c_drive_sda(bus, 0))
+		nvkm_i2c_delay(bus, T_RISEFALL);
 
 	nvkm_i2c_drive_scl(bus, 1);
 	nvkm_i2c_delay(bus, T_HOLD);
@@ -107,8 +123,8 @@ i2c_stop(struct nvkm_i2c_bus *bus)
 static int
 i2c_bitw(struct nvkm_i2c_bus *bus, int sda)
 {
-	nvkm_i2c_drive_sda(bus, sda);
-	nvkm_i2c_delay(bus, T_RISEFALL);
+	if (nvkm_i2c_drive_sda(bus, sda))
+		nvkm_i2c_delay(bus, T_RISEFALL);
 
 	if (!nvkm_i2c_raise_scl(bus))
 		return -ETIMEDOUT;
@@ -124,8 +140,8 @@ i2c_bitr(struct nvkm_i2c_bus *bus)
 {
 	int sda;
 
-	nvkm_i2c_drive_sda(bus, 1);
-	nvkm_i2c_delay(bus, T_RISEFALL);
+	if (nvkm_i2c_drive_sda(bus, 1))
+		nvkm_i2c_delay(bus, T_RISEFALL);
 
 	if (!nvkm_i2c_raise_scl(bus))
 		return -ETIMEDOUT;
@@ -185,6 +201,10 @@ nvkm_i2c_bit_xfer(struct nvkm_i2c_bus *bus, struct i2c_msg *msgs, int num)
 	struct i2c_msg *msg = msgs;
 	int ret = 0, mcnt = num;
 
+	/* The pad may have been used for something else since. */
+	bus->scl = -1;
+	bus->sda = -1;
+
 	while (!ret && mcnt--) {
 		u8 remaining = msg->len;
 		u8 *ptr = msg->buf;
@@ -78,13 +78,25 @@ static int
 nvkm_i2c_bus_xfer(struct i2c_adapter *adap, struct i2c_msg *msgs, int num)
 {
 	struct nvkm_i2c_bus *bus = container_of(adap, typeof(*bus), i2c);
-	int ret;
+	s64 time;
+	int ret, i;
 
 	ret = nvkm_i2c_bus_acquire(bus);
 	if (ret)
 		return ret;
 
+	time = ktime_to_ns(ktime_get());
 	ret = bus->func->xfer(bus, msgs, num);
+	time = ktime_to_ns(ktime_get()) - time;
+
+	bus->stats.xfers++;
+	bus->stats.time += time;
+	if (ret < 0)
+		bus->stats.errors++;
+	for (i = 0; ret >= 0 && i < num; i++)
+		bus->stats.bytes += msgs[i].len;
+
+	BUS_TRACE(bus, "xfer %d msg(s), %d, %lld ns", num, ret, time);
 	nvkm_i2c_bus_release(bus);
 	return ret;
 }
@@ -122,6 +134,11 @@ nvkm_i2c_bus_fini(struct nvkm_i2c_bus *bus)
 	BUS_TRACE(bus, "fini");
 	mutex_lock(&bus->mutex);
 	bus->enabled = false;
+	if (bus->stats.xfers) {
+		BUS_DBG(bus, "%lld xfers, %lld bytes, %lld errors, %lld us",
+			bus->stats.xfers, bus->stats.bytes, bus->stats.errors,
+			bus->stats.time / 1000);
+	}
 	mutex_unlock(&bus->mutex);
 }
 
@@ -221,6 +238,8 @@ nvkm_i2c_bus_ctor(const struct nvkm_i2c_bus_func *func,
 	bus->func = func;
 	bus->pad = pad;
 	bus->id = id;
+	bus->scl = -1;
+	bus->sda = -1;
 	mutex_init(&bus->mutex);
 	list_add_tail(&bus->head, &pad->i2c->bus);
 	BUS_TRACE(bus, "ctor");
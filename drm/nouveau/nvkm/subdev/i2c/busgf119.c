@@ -27,6 +27,7 @@
 struct gf119_i2c_bus {
 	struct nvkm_i2c_bus base;
 	u32 addr;
+	u32 data;
 };
 
 static void
@@ -34,7 +35,9 @@ gf119_i2c_bus_drive_scl(struct nvkm_i2c_bus *base, int state)
 {
 	struct gf119_i2c_bus *bus = gf119_i2c_bus(base);
 	struct nvkm_device *device = bus->base.pad->i2c->subdev.device;
-	nvkm_mask(device, bus->addr, 0x00000001, state ? 0x00000001 : 0);
+	if (state) bus->data |= 0x01;
+	else	   bus->data &= 0xfe;
+	nvkm_wr32(device, bus->addr, bus->data);
 }
 
 static void
@@ -42,7 +45,9 @@ gf119_i2c_bus_drive_sda(struct nvkm_i2c_bus *base, int state)
 {
 	struct gf119_i2c_bus *bus = gf119_i2c_bus(base);
 	struct nvkm_device *device = bus->base.pad->i2c->subdev.device;
-	nvkm_mask(device, bus->addr, 0x00000002, state ? 0x00000002 : 0);
+	if (state) bus->data |= 0x02;
+	else	   bus->data &= 0xfd;
+	nvkm_wr32(device, bus->addr, bus->data);
 }
 
 static int
@@ -66,7 +71,7 @@ gf119_i2c_bus_init(struct nvkm_i2c_bus *base)
 {
 	struct gf119_i2c_bus *bus = gf119_i2c_bus(base);
 	struct nvkm_device *device = bus->base.pad->i2c->subdev.device;
-	nvkm_wr32(device, bus->addr, 0x00000007);
+	nvkm_wr32(device, bus->addr, (bus->data = 0x00000007));
 }
 
 static const struct nvkm_i2c_bus_func
@@ -24,6 +24,7 @@
 #include "priv.h"
 
 #include <core/memory.h>
+#include <subdev/fb.h>
 
 void
 nvkm_ltc_tags_clear(struct nvkm_device *device, u32 first, u32 count)
@@ -105,6 +106,10 @@ nvkm_ltc_init(struct nvkm_subdev *subdev)
 	}
 
 	ltc->func->init(ltc);
+
+	/* whatever state the tags were left in is gone */
+	if (ltc->subdev.device->fb)
+		nvkm_comptag_invalidate(&ltc->subdev.device->fb->tags);
 	return 0;
 }
 
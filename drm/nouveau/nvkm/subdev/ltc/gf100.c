@@ -200,8 +200,9 @@ gf100_ltc_oneinit_tag_ram(struct nvkm_ltc *ltc)
 	}
 
 mm_init:
-	nvkm_mm_fini(&fb->tags);
-	return nvkm_mm_init(&fb->tags, 0, 0, ltc->num_tags, 1);
+	nvkm_comptag_fini(&fb->tags);
+	return nvkm_comptag_init(&fb->tags, device, ltc->num_tags,
+				 nvkm_ltc_tags_clear);
 }
 
 int
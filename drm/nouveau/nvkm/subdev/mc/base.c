@@ -140,9 +140,13 @@ nvkm_mc_reset(struct nvkm_device *device, enum nvkm_devidx devidx)
 {
 	u64 pmc_enable = nvkm_mc_reset_mask(device, true, devidx);
 	if (pmc_enable) {
+		struct nvkm_mc *mc = device->mc;
+		unsigned long flags;
+		spin_lock_irqsave(&mc->lock, flags);
 		nvkm_mask(device, 0x000200, pmc_enable, 0x00000000);
 		nvkm_mask(device, 0x000200, pmc_enable, pmc_enable);
 		nvkm_rd32(device, 0x000200);
+		spin_unlock_irqrestore(&mc->lock, flags);
 	}
 }
 
@@ -150,8 +154,13 @@ void
 nvkm_mc_disable(struct nvkm_device *device, enum nvkm_devidx devidx)
 {
 	u64 pmc_enable = nvkm_mc_reset_mask(device, false, devidx);
-	if (pmc_enable)
+	if (pmc_enable) {
+		struct nvkm_mc *mc = device->mc;
+		unsigned long flags;
+		spin_lock_irqsave(&mc->lock, flags);
 		nvkm_mask(device, 0x000200, pmc_enable, 0x00000000);
+		spin_unlock_irqrestore(&mc->lock, flags);
+	}
 }
 
 void
@@ -159,8 +168,12 @@ nvkm_mc_enable(struct nvkm_device *device, enum nvkm_devidx devidx)
 {
 	u64 pmc_enable = nvkm_mc_reset_mask(device, false, devidx);
 	if (pmc_enable) {
+		struct nvkm_mc *mc = device->mc;
+		unsigned long flags;
+		spin_lock_irqsave(&mc->lock, flags);
 		nvkm_mask(device, 0x000200, pmc_enable, pmc_enable);
 		nvkm_rd32(device, 0x000200);
+		spin_unlock_irqrestore(&mc->lock, flags);
 	}
 }
 
@@ -210,6 +223,7 @@ nvkm_mc_ctor(const struct nvkm_mc_func *func, struct nvkm_device *device,
 {
 	nvkm_subdev_ctor(&nvkm_mc, device, index, &mc->subdev);
 	mc->func = func;
+	spin_lock_init(&mc->lock);
 }
 
 int
@@ -360,9 +360,7 @@ gp100_vmm_valid(struct nvkm_vmm *vmm, void *argv, u32 argc,
 			return -EINVAL;
 		}
 
-		ret = nvkm_memory_tags_get(memory, device, tags,
-					   nvkm_ltc_tags_clear,
-					   &map->tags);
+		ret = nvkm_memory_tags_get(memory, device, tags, &map->tags);
 		if (ret) {
 			VMM_DEBUG(vmm, "comp %d", ret);
 			return ret;
@@ -58,13 +58,147 @@ nvkm_pmu_recv(struct work_struct *work)
 	return pmu->func->recv(pmu);
 }
 
+static struct nvkm_pmu_seq *
+nvkm_pmu_seq_acquire(struct nvkm_pmu *pmu)
+{
+	struct nvkm_pmu_seq *seq = NULL;
+	u32 index;
+
+	mutex_lock(&pmu->recv.mutex);
+	index = find_first_zero_bit(pmu->recv.tbl, NVKM_PMU_SEQ_NUM);
+	if (index < NVKM_PMU_SEQ_NUM) {
+		set_bit(index, pmu->recv.tbl);
+		seq = &pmu->recv.seq[index];
+		seq->state = NVKM_PMU_SEQ_PENDING;
+	}
+	mutex_unlock(&pmu->recv.mutex);
+	return seq;
+}
+
+static void
+nvkm_pmu_seq_release(struct nvkm_pmu *pmu, struct nvkm_pmu_seq *seq)
+{
+	seq->state = NVKM_PMU_SEQ_FREE;
+	seq->callback = NULL;
+	reinit_completion(&seq->done);
+	clear_bit(seq->id, pmu->recv.tbl);
+	wake_up(&pmu->recv.wait);
+}
+
+bool
+nvkm_pmu_reply(struct nvkm_pmu *pmu, u32 process, u32 message,
+	       u32 data0, u32 data1)
+{
+	struct nvkm_pmu_seq *seq = NULL;
+	int i;
+
+	/* each PMU process handles its messages in order, so the reply
+	 * belongs to the oldest request posted with a matching header
+	 */
+	mutex_lock(&pmu->recv.mutex);
+	for (i = 0; i < NVKM_PMU_SEQ_NUM; i++) {
+		struct nvkm_pmu_seq *temp = &pmu->recv.seq[i];
+		if (temp->state != NVKM_PMU_SEQ_USED ||
+		    temp->process != process || temp->message != message)
+			continue;
+		if (!seq || (s32)(temp->serial - seq->serial) < 0)
+			seq = temp;
+	}
+
+	if (seq) {
+		seq->state = NVKM_PMU_SEQ_PENDING;
+		seq->data[0] = data0;
+		seq->data[1] = data1;
+	}
+	mutex_unlock(&pmu->recv.mutex);
+	if (!seq)
+		return false;
+
+	if (seq->callback) {
+		seq->callback(seq->priv, data0, data1);
+		nvkm_pmu_seq_release(pmu, seq);
+	} else {
+		complete_all(&seq->done);
+	}
+
+	return true;
+}
+
+static int
+nvkm_pmu_post(struct nvkm_pmu *pmu, struct nvkm_pmu_seq *seq,
+	      u32 process, u32 message, u32 data0, u32 data1)
+{
+	int ret;
+
+	/* the serial has to follow FIFO order, so it's assigned with the
+	 * send lock held, and before the PMU could possibly reply
+	 */
+	mutex_lock(&pmu->send.mutex);
+	if (seq) {
+		mutex_lock(&pmu->recv.mutex);
+		seq->process = process;
+		seq->message = message;
+		seq->serial = pmu->recv.serial++;
+		seq->state = NVKM_PMU_SEQ_USED;
+		mutex_unlock(&pmu->recv.mutex);
+	}
+
+	ret = pmu->func->send(pmu, process, message, data0, data1);
+	if (ret && seq) {
+		mutex_lock(&pmu->recv.mutex);
+		seq->state = NVKM_PMU_SEQ_PENDING;
+		mutex_unlock(&pmu->recv.mutex);
+	}
+	mutex_unlock(&pmu->send.mutex);
+	return ret;
+}
+
+int
+nvkm_pmu_send_async(struct nvkm_pmu *pmu, nvkm_pmu_callback func, void *priv,
+		    u32 process, u32 message, u32 data0, u32 data1)
+{
+	struct nvkm_pmu_seq *seq = NULL;
+	int ret;
+
+	if (!pmu || !pmu->func->send)
+		return -ENODEV;
+
+	if (func) {
+		wait_event(pmu->recv.wait, (seq = nvkm_pmu_seq_acquire(pmu)));
+		seq->callback = func;
+		seq->priv = priv;
+	}
+
+	ret = nvkm_pmu_post(pmu, seq, process, message, data0, data1);
+	if (ret && seq)
+		nvkm_pmu_seq_release(pmu, seq);
+	return ret;
+}
+
 int
 nvkm_pmu_send(struct nvkm_pmu *pmu, u32 reply[2],
 	      u32 process, u32 message, u32 data0, u32 data1)
 {
+	struct nvkm_pmu_seq *seq = NULL;
+	int ret;
+
 	if (!pmu || !pmu->func->send)
 		return -ENODEV;
-	return pmu->func->send(pmu, reply, process, message, data0, data1);
+
+	if (reply)
+		wait_event(pmu->recv.wait, (seq = nvkm_pmu_seq_acquire(pmu)));
+
+	ret = nvkm_pmu_post(pmu, seq, process, message, data0, data1);
+	if (seq) {
+		if (ret == 0) {
+			wait_for_completion(&seq->done);
+			reply[0] = seq->data[0];
+			reply[1] = seq->data[1];
+		}
+		nvkm_pmu_seq_release(pmu, seq);
+	}
+
+	return ret;
 }
 
 static void
@@ -81,6 +215,8 @@ nvkm_pmu_fini(struct nvkm_subdev *subdev, bool suspend)
 {
 	struct nvkm_pmu *pmu = nvkm_pmu(subdev);
 
+	nvkm_pmu_dvfs_fini(pmu);
+
 	if (pmu->func->fini)
 		pmu->func->fini(pmu);
 
@@ -136,6 +272,8 @@ nvkm_pmu_init(struct nvkm_subdev *subdev)
 	int ret = nvkm_pmu_reset(pmu);
 	if (ret == 0 && pmu->func->init)
 		ret = pmu->func->init(pmu);
+	if (ret == 0)
+		nvkm_pmu_dvfs_init(pmu);
 	return ret;
 }
 
@@ -143,6 +281,7 @@ static void *
 nvkm_pmu_dtor(struct nvkm_subdev *subdev)
 {
 	struct nvkm_pmu *pmu = nvkm_pmu(subdev);
+	kfree(pmu->dvfs);
 	nvkm_falcon_msgq_del(&pmu->msgq);
 	nvkm_falcon_cmdq_del(&pmu->lpq);
 	nvkm_falcon_cmdq_del(&pmu->hpq);
@@ -164,12 +303,18 @@ int
 nvkm_pmu_ctor(const struct nvkm_pmu_fwif *fwif, struct nvkm_device *device,
 	      int index, struct nvkm_pmu *pmu)
 {
-	int ret;
+	int ret, i;
 
 	nvkm_subdev_ctor(&nvkm_pmu, device, index, &pmu->subdev);
 
+	mutex_init(&pmu->send.mutex);
 	INIT_WORK(&pmu->recv.work, nvkm_pmu_recv);
 	init_waitqueue_head(&pmu->recv.wait);
+	mutex_init(&pmu->recv.mutex);
+	for (i = 0; i < NVKM_PMU_SEQ_NUM; i++) {
+		pmu->recv.seq[i].id = i;
+		init_completion(&pmu->recv.seq[i].done);
+	}
 
 	fwif = nvkm_firmware_load(&pmu->subdev, fwif, "Pmu", pmu);
 	if (IS_ERR(fwif))
@@ -177,6 +322,12 @@ nvkm_pmu_ctor(const struct nvkm_pmu_fwif *fwif, struct nvkm_device *device,
 
 	pmu->func = fwif->func;
 
+	if (pmu->func->dvfs) {
+		ret = nvkm_pmu_dvfs_new(pmu);
+		if (ret)
+			return ret;
+	}
+
 	ret = nvkm_falcon_ctor(pmu->func->flcn, &pmu->subdev,
 			       nvkm_subdev_name[pmu->subdev.index], 0x10a000,
 			       &pmu->falcon);
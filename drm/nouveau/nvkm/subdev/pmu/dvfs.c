@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2014, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include "priv.h"
+
+#include <core/option.h>
+#include <subdev/clk.h>
+#include <subdev/timer.h>
+
+#define BUSY_SLOT	0
+#define CLK_SLOT	7
+
+/* Pick the next performance level from a busy/total counter sample.
+ *
+ * This only touches the governor state passed in, so that the policy can
+ * be replayed against recorded load traces without any hardware.
+ */
+int
+nvkm_pmu_dvfs_target(const struct nvkm_pmu_dvfs_data *data,
+		     struct nvkm_pmu_dvfs *dvfs, int level, int level_nr,
+		     u32 busy, u32 total, u64 time)
+{
+	unsigned int load = 0;
+	int target;
+
+	if (total)
+		load = div_u64((u64)busy * 100, total);
+
+	dvfs->avg_load = (data->p_smooth * dvfs->avg_load) + load;
+	dvfs->avg_load /= data->p_smooth + 1;
+
+	if (dvfs->avg_load > data->p_load_max) {
+		target = level + max(level_nr / 3, 1);
+	} else {
+		target = level + (((int)dvfs->avg_load - data->p_load_target) *
+				  10 / data->p_load_target) / 2;
+	}
+	target = clamp(target, 0, level_nr - 1);
+
+	/* clock up straight away, but only clock down once the load has
+	 * stayed below the hysteresis band for enough samples, and the last
+	 * change has been held for long enough
+	 */
+	if (target < level) {
+		if (dvfs->avg_load + data->p_hyst > data->p_load_target ||
+		    ++dvfs->down < data->down_samples)
+			return level;
+		if (dvfs->changes && time - dvfs->changed < data->hold)
+			return level;
+	}
+	dvfs->down = 0;
+
+	if (target != level) {
+		dvfs->changed = time;
+		dvfs->changes++;
+	}
+
+	return target;
+}
+
+static void
+nvkm_pmu_dvfs_reset(struct nvkm_pmu *pmu)
+{
+	struct nvkm_falcon *falcon = &pmu->falcon;
+
+	nvkm_falcon_wr32(falcon, 0x508 + (BUSY_SLOT * 0x10), 0x80000000);
+	nvkm_falcon_wr32(falcon, 0x508 + (CLK_SLOT * 0x10), 0x80000000);
+}
+
+static void
+nvkm_pmu_dvfs_work(struct nvkm_alarm *alarm)
+{
+	struct nvkm_pmu_dvfs *dvfs =
+		container_of(alarm, struct nvkm_pmu_dvfs, alarm);
+	struct nvkm_pmu *pmu = dvfs->pmu;
+	struct nvkm_subdev *subdev = &pmu->subdev;
+	struct nvkm_device *device = subdev->device;
+	struct nvkm_falcon *falcon = &pmu->falcon;
+	struct nvkm_clk *clk = device->clk;
+	struct nvkm_timer *tmr = device->timer;
+	u32 busy, total;
+	int level, next;
+
+	/*
+	 * The PMU is initialized before CLK, so we have to make sure the
+	 * CLK is ready here.
+	 */
+	if (!clk || !clk->state_nr)
+		goto resched;
+
+	busy  = nvkm_falcon_rd32(falcon, 0x508 + (BUSY_SLOT * 0x10));
+	total = nvkm_falcon_rd32(falcon, 0x508 + (CLK_SLOT * 0x10));
+
+	level = nvkm_clk_alevel_get(clk);
+	next = nvkm_pmu_dvfs_target(dvfs->data, dvfs, level, clk->alevel_nr,
+				    busy, total, nvkm_timer_read(tmr));
+	nvkm_trace(subdev, "avg_load = %d %%, level %d -> %d\n",
+		   dvfs->avg_load, level, next);
+
+	if (next != level)
+		nvkm_clk_alevel(clk, next, false);
+
+resched:
+	nvkm_pmu_dvfs_reset(pmu);
+	nvkm_timer_alarm(tmr, dvfs->data->period, alarm);
+}
+
+void
+nvkm_pmu_dvfs_fini(struct nvkm_pmu *pmu)
+{
+	if (pmu->dvfs)
+		nvkm_timer_alarm(pmu->subdev.device->timer, 0,
+				 &pmu->dvfs->alarm);
+}
+
+void
+nvkm_pmu_dvfs_init(struct nvkm_pmu *pmu)
+{
+	struct nvkm_pmu_dvfs *dvfs = pmu->dvfs;
+	struct nvkm_falcon *falcon = &pmu->falcon;
+
+	if (!dvfs)
+		return;
+
+	/* init pwr perf counter */
+	nvkm_falcon_wr32(falcon, 0x504 + (BUSY_SLOT * 0x10),
+			 dvfs->data->busy_mask);
+	nvkm_falcon_wr32(falcon, 0x50c + (BUSY_SLOT * 0x10), 0x00000002);
+	nvkm_falcon_wr32(falcon, 0x50c + (CLK_SLOT * 0x10), 0x00000003);
+	nvkm_pmu_dvfs_reset(pmu);
+
+	dvfs->avg_load = 0;
+	dvfs->down = 0;
+	dvfs->changes = 0;
+	nvkm_timer_alarm(pmu->subdev.device->timer, dvfs->data->delay,
+			 &dvfs->alarm);
+}
+
+int
+nvkm_pmu_dvfs_new(struct nvkm_pmu *pmu)
+{
+	const struct nvkm_pmu_dvfs_data *data = pmu->func->dvfs;
+	struct nvkm_device *device = pmu->subdev.device;
+	struct nvkm_pmu_dvfs *dvfs;
+
+	if (!nvkm_boolopt(device->cfgopt, "NvPmuDvfs", data->enable))
+		return 0;
+
+	if (!(dvfs = pmu->dvfs = kzalloc(sizeof(*dvfs), GFP_KERNEL)))
+		return -ENOMEM;
+
+	dvfs->pmu = pmu;
+	dvfs->data = data;
+	nvkm_alarm_init(&dvfs->alarm, nvkm_pmu_dvfs_work);
+	return 0;
+}
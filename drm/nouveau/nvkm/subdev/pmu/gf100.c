@@ -54,6 +54,7 @@ gf100_pmu = {
 	.intr = gt215_pmu_intr,
 	.send = gt215_pmu_send,
 	.recv = gt215_pmu_recv,
+	.dvfs = &gt215_pmu_dvfs,
 };
 
 int
@@ -38,6 +38,7 @@ gf119_pmu = {
 	.intr = gt215_pmu_intr,
 	.send = gt215_pmu_send,
 	.recv = gt215_pmu_recv,
+	.dvfs = &gt215_pmu_dvfs,
 };
 
 static const struct nvkm_pmu_fwif
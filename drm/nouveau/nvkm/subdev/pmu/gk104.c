@@ -117,6 +117,7 @@ gk104_pmu = {
 	.intr = gt215_pmu_intr,
 	.send = gt215_pmu_send,
 	.recv = gt215_pmu_recv,
+	.dvfs = &gt215_pmu_dvfs,
 	.pgob = gk104_pmu_pgob,
 };
 
@@ -96,6 +96,7 @@ gk110_pmu = {
 	.intr = gt215_pmu_intr,
 	.send = gt215_pmu_send,
 	.recv = gt215_pmu_recv,
+	.dvfs = &gt215_pmu_dvfs,
 	.pgob = gk110_pmu_pgob,
 };
 
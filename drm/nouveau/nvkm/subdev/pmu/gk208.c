@@ -38,6 +38,7 @@ gk208_pmu = {
 	.intr = gt215_pmu_intr,
 	.send = gt215_pmu_send,
 	.recv = gt215_pmu_recv,
+	.dvfs = &gt215_pmu_dvfs,
 	.pgob = gk110_pmu_pgob,
 };
 
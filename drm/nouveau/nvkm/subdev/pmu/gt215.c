@@ -27,33 +27,21 @@
 #include <subdev/timer.h>
 
 int
-gt215_pmu_send(struct nvkm_pmu *pmu, u32 reply[2],
-	       u32 process, u32 message, u32 data0, u32 data1)
+gt215_pmu_send(struct nvkm_pmu *pmu, u32 process, u32 message,
+	       u32 data0, u32 data1)
 {
 	struct nvkm_subdev *subdev = &pmu->subdev;
 	struct nvkm_device *device = subdev->device;
 	u32 addr;
 
-	mutex_lock(&subdev->mutex);
 	/* wait for a free slot in the fifo */
 	addr  = nvkm_rd32(device, 0x10a4a0);
 	if (nvkm_msec(device, 2000,
 		u32 tmp = nvkm_rd32(device, 0x10a4b0);
 		if (tmp != (addr ^ 8))
 			break;
-	) < 0) {
-		mutex_unlock(&subdev->mutex);
+	) < 0)
 		return -EBUSY;
-	}
-
-	/* we currently only support a single process at a time waiting
-	 * on a synchronous reply, take the PMU mutex and tell the
-	 * receive handler what we're waiting for
-	 */
-	if (reply) {
-		pmu->recv.message = message;
-		pmu->recv.process = process;
-	}
 
 	/* acquire data segment access */
 	do {
@@ -71,15 +59,6 @@ gt215_pmu_send(struct nvkm_pmu *pmu, u32 reply[2],
 
 	/* release data segment access */
 	nvkm_wr32(device, 0x10a580, 0x00000000);
-
-	/* wait for reply, if requested */
-	if (reply) {
-		wait_event(pmu->recv.wait, (pmu->recv.process == 0));
-		reply[0] = pmu->recv.data[0];
-		reply[1] = pmu->recv.data[1];
-	}
-
-	mutex_unlock(&subdev->mutex);
 	return 0;
 }
 
@@ -89,50 +68,44 @@ gt215_pmu_recv(struct nvkm_pmu *pmu)
 	struct nvkm_subdev *subdev = &pmu->subdev;
 	struct nvkm_device *device = subdev->device;
 	u32 process, message, data0, data1;
+	u32 addr;
 
-	/* nothing to do if GET == PUT */
-	u32 addr =  nvkm_rd32(device, 0x10a4cc);
-	if (addr == nvkm_rd32(device, 0x10a4c8))
-		return;
-
-	/* acquire data segment access */
-	do {
-		nvkm_wr32(device, 0x10a580, 0x00000002);
-	} while (nvkm_rd32(device, 0x10a580) != 0x00000002);
-
-	/* read the packet */
-	nvkm_wr32(device, 0x10a1c0, 0x02000000 | (((addr & 0x07) << 4) +
-				pmu->recv.base));
-	process = nvkm_rd32(device, 0x10a1c4);
-	message = nvkm_rd32(device, 0x10a1c4);
-	data0   = nvkm_rd32(device, 0x10a1c4);
-	data1   = nvkm_rd32(device, 0x10a1c4);
-	nvkm_wr32(device, 0x10a4cc, (addr + 1) & 0x0f);
-
-	/* release data segment access */
-	nvkm_wr32(device, 0x10a580, 0x00000000);
-
-	/* wake process if it's waiting on a synchronous reply */
-	if (pmu->recv.process) {
-		if (process == pmu->recv.process &&
-		    message == pmu->recv.message) {
-			pmu->recv.data[0] = data0;
-			pmu->recv.data[1] = data1;
-			pmu->recv.process = 0;
-			wake_up(&pmu->recv.wait);
-			return;
-		}
-	}
-
-	/* right now there's no other expected responses from the engine,
-	 * so assume that any unexpected message is an error.
+	/* several replies may be pending if more than one request is in
+	 * flight, drain them all until GET == PUT
 	 */
-	nvkm_warn(subdev, "%c%c%c%c %08x %08x %08x %08x\n",
-		  (char)((process & 0x000000ff) >>  0),
-		  (char)((process & 0x0000ff00) >>  8),
-		  (char)((process & 0x00ff0000) >> 16),
-		  (char)((process & 0xff000000) >> 24),
-		  process, message, data0, data1);
+	while ((addr = nvkm_rd32(device, 0x10a4cc)) !=
+		       nvkm_rd32(device, 0x10a4c8)) {
+		/* acquire data segment access */
+		do {
+			nvkm_wr32(device, 0x10a580, 0x00000002);
+		} while (nvkm_rd32(device, 0x10a580) != 0x00000002);
+
+		/* read the packet */
+		nvkm_wr32(device, 0x10a1c0, 0x02000000 | (((addr & 0x07) << 4) +
+					pmu->recv.base));
+		process = nvkm_rd32(device, 0x10a1c4);
+		message = nvkm_rd32(device, 0x10a1c4);
+		data0   = nvkm_rd32(device, 0x10a1c4);
+		data1   = nvkm_rd32(device, 0x10a1c4);
+		nvkm_wr32(device, 0x10a4cc, (addr + 1) & 0x0f);
+
+		/* release data segment access */
+		nvkm_wr32(device, 0x10a580, 0x00000000);
+
+		/* hand the reply to whoever is waiting on it */
+		if (nvkm_pmu_reply(pmu, process, message, data0, data1))
+			continue;
+
+		/* right now there's no other expected responses from the
+		 * engine, so assume that any unexpected message is an error.
+		 */
+		nvkm_warn(subdev, "%c%c%c%c %08x %08x %08x %08x\n",
+			  (char)((process & 0x000000ff) >>  0),
+			  (char)((process & 0x0000ff00) >>  8),
+			  (char)((process & 0x00ff0000) >> 16),
+			  (char)((process & 0xff000000) >> 24),
+			  process, message, data0, data1);
+	}
 }
 
 void
@@ -248,6 +221,7 @@ gt215_pmu_flcn = {
 	.load_imem = nvkm_falcon_v1_load_imem,
 	.load_dmem = nvkm_falcon_v1_load_dmem,
 	.read_dmem = nvkm_falcon_v1_read_dmem,
+	.load_dma = nvkm_falcon_v1_load_dma,
 	.bind_context = nvkm_falcon_v1_bind_context,
 	.wait_for_halt = nvkm_falcon_v1_wait_for_halt,
 	.clear_interrupt = nvkm_falcon_v1_clear_interrupt,
@@ -259,6 +233,19 @@ gt215_pmu_flcn = {
 	.msgq = { 0x4c8, 0x4cc, 0 },
 };
 
+const struct nvkm_pmu_dvfs_data
+gt215_pmu_dvfs = {
+	.busy_mask = 0x00200001,
+	.delay = 100000000,
+	.period = 100000000,
+	.hold = 500000000,
+	.p_load_target = 70,
+	.p_load_max = 90,
+	.p_hyst = 10,
+	.down_samples = 3,
+	.p_smooth = 1,
+};
+
 static const struct nvkm_pmu_func
 gt215_pmu = {
 	.flcn = &gt215_pmu_flcn,
@@ -273,6 +260,7 @@ gt215_pmu = {
 	.intr = gt215_pmu_intr,
 	.send = gt215_pmu_send,
 	.recv = gt215_pmu_recv,
+	.dvfs = &gt215_pmu_dvfs,
 };
 
 static const struct nvkm_pmu_fwif
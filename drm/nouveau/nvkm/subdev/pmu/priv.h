@@ -4,6 +4,7 @@
 #define nvkm_pmu(p) container_of((p), struct nvkm_pmu, subdev)
 #include <subdev/pmu.h>
 #include <subdev/pmu/fuc/os.h>
+#include <subdev/timer.h>
 enum nvkm_acr_lsf_id;
 struct nvkm_acr_lsfw;
 
@@ -25,19 +26,55 @@ struct nvkm_pmu_func {
 	int (*init)(struct nvkm_pmu *);
 	void (*fini)(struct nvkm_pmu *);
 	void (*intr)(struct nvkm_pmu *);
-	int (*send)(struct nvkm_pmu *, u32 reply[2], u32 process,
-		    u32 message, u32 data0, u32 data1);
+	int (*send)(struct nvkm_pmu *, u32 process, u32 message,
+		    u32 data0, u32 data1);
 	void (*recv)(struct nvkm_pmu *);
 	int (*initmsg)(struct nvkm_pmu *);
 	void (*pgob)(struct nvkm_pmu *, bool);
+
+	const struct nvkm_pmu_dvfs_data *dvfs;
+};
+
+struct nvkm_pmu_dvfs_data {
+	u32 busy_mask; /* idle counter config for the busy slot */
+	u32 delay; /* ns, before the first sample */
+	u32 period; /* ns, between samples */
+	u32 hold; /* ns, after a level change before clocking down */
+	int p_load_target;
+	int p_load_max;
+	int p_hyst; /* clock down only below (target - hyst)... */
+	int down_samples; /* ...for this many samples in a row */
+	int p_smooth;
+	bool enable; /* default, NvPmuDvfs overrides */
 };
 
+struct nvkm_pmu_dvfs {
+	struct nvkm_pmu *pmu;
+	const struct nvkm_pmu_dvfs_data *data;
+	struct nvkm_alarm alarm;
+	unsigned int avg_load;
+	int down;
+	u64 changed;
+	u32 changes;
+};
+
+extern const struct nvkm_pmu_dvfs_data gt215_pmu_dvfs;
+int nvkm_pmu_dvfs_new(struct nvkm_pmu *);
+void nvkm_pmu_dvfs_init(struct nvkm_pmu *);
+void nvkm_pmu_dvfs_fini(struct nvkm_pmu *);
+int nvkm_pmu_dvfs_target(const struct nvkm_pmu_dvfs_data *,
+			 struct nvkm_pmu_dvfs *, int level, int level_nr,
+			 u32 busy, u32 total, u64 time);
+
 extern const struct nvkm_falcon_func gt215_pmu_flcn;
 int gt215_pmu_init(struct nvkm_pmu *);
 void gt215_pmu_fini(struct nvkm_pmu *);
 void gt215_pmu_intr(struct nvkm_pmu *);
 void gt215_pmu_recv(struct nvkm_pmu *);
-int gt215_pmu_send(struct nvkm_pmu *, u32[2], u32, u32, u32, u32);
+int gt215_pmu_send(struct nvkm_pmu *, u32, u32, u32, u32);
+
+bool nvkm_pmu_reply(struct nvkm_pmu *, u32 process, u32 message,
+		    u32 data0, u32 data1);
 
 bool gf100_pmu_enabled(struct nvkm_pmu *);
 void gf100_pmu_reset(struct nvkm_pmu *);
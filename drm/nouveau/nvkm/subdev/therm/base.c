@@ -102,11 +102,10 @@ nvkm_therm_update_linear_fallback(struct nvkm_therm *therm)
 	return nvkm_therm_compute_linear_duty(therm, 30, max);
 }
 
-static void
+void
 nvkm_therm_update(struct nvkm_therm *therm, int mode)
 {
 	struct nvkm_subdev *subdev = &therm->subdev;
-	struct nvkm_timer *tmr = subdev->device->timer;
 	unsigned long flags;
 	bool immd = true;
 	bool poll = true;
@@ -119,7 +118,6 @@ nvkm_therm_update(struct nvkm_therm *therm, int mode)
 
 	switch (mode) {
 	case NVKM_THERM_CTRL_MANUAL:
-		nvkm_timer_alarm(tmr, 0, &therm->alarm);
 		duty = nvkm_therm_fan_get(therm);
 		if (duty < 0)
 			duty = 100;
@@ -146,12 +144,11 @@ nvkm_therm_update(struct nvkm_therm *therm, int mode)
 		break;
 	case NVKM_THERM_CTRL_NONE:
 	default:
-		nvkm_timer_alarm(tmr, 0, &therm->alarm);
 		poll = false;
 	}
 
-	if (poll)
-		nvkm_timer_alarm(tmr, 1000000000ULL, &therm->alarm);
+	/* Re-evaluated whenever the sensor poll sees the temperature move. */
+	nvkm_therm_sensor_poll(therm, poll);
 	spin_unlock_irqrestore(&therm->lock, flags);
 
 	if (duty >= 0) {
@@ -173,14 +170,6 @@ nvkm_therm_cstate(struct nvkm_therm *therm, int fan, int dir)
 	return 0;
 }
 
-static void
-nvkm_therm_alarm(struct nvkm_alarm *alarm)
-{
-	struct nvkm_therm *therm =
-	       container_of(alarm, struct nvkm_therm, alarm);
-	nvkm_therm_update(therm, -1);
-}
-
 int
 nvkm_therm_fan_mode(struct nvkm_therm *therm, int mode)
 {
@@ -253,6 +242,7 @@ nvkm_therm_attr_set(struct nvkm_therm *therm,
 		if (value > therm->fan->bios.max_duty)
 			value = therm->fan->bios.max_duty;
 		therm->fan->bios.min_duty = value;
+		nvkm_therm_update(therm, -1);
 		return 0;
 	case NVKM_THERM_ATTR_FAN_MAX_DUTY:
 		if (value < 0)
@@ -260,6 +250,7 @@ nvkm_therm_attr_set(struct nvkm_therm *therm,
 		if (value < therm->fan->bios.min_duty)
 			value = therm->fan->bios.min_duty;
 		therm->fan->bios.max_duty = value;
+		nvkm_therm_update(therm, -1);
 		return 0;
 	case NVKM_THERM_ATTR_FAN_MODE:
 		return nvkm_therm_fan_mode(therm, value);
@@ -427,7 +418,6 @@ nvkm_therm_ctor(struct nvkm_therm *therm, struct nvkm_device *device,
 	nvkm_subdev_ctor(&nvkm_therm, device, index, &therm->subdev);
 	therm->func = func;
 
-	nvkm_alarm_init(&therm->alarm, nvkm_therm_alarm);
 	spin_lock_init(&therm->lock);
 	spin_lock_init(&therm->sensor.alarm_program_lock);
 
@@ -439,6 +429,7 @@ nvkm_therm_ctor(struct nvkm_therm *therm, struct nvkm_device *device,
 
 	therm->clkgating_enabled = nvkm_boolopt(device->cfgopt,
 						"NvPmEnableGating", false);
+	therm->sensor.intr = nvkm_boolopt(device->cfgopt, "NvThermIntr", false);
 }
 
 int
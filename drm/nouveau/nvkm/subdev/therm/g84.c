@@ -50,7 +50,7 @@ g84_sensor_setup(struct nvkm_therm *therm)
 	}
 }
 
-static void
+void
 g84_therm_program_alarms(struct nvkm_therm *therm)
 {
 	struct nvbios_therm_sensor *sensor = &therm->bios_sensor;
@@ -59,6 +59,7 @@ g84_therm_program_alarms(struct nvkm_therm *therm)
 	unsigned long flags;
 
 	spin_lock_irqsave(&therm->sensor.alarm_program_lock, flags);
+	therm->sensor.poll_thrs = false;
 
 	/* enable RISING and FALLING IRQs for shutdown, THRS 0, 1, 2 and 4 */
 	nvkm_wr32(device, 0x20000, 0x000003ff);
@@ -135,7 +136,7 @@ g84_therm_threshold_hyst_emulation(struct nvkm_therm *therm,
 	nvkm_therm_sensor_event(therm, thrs_name, direction);
 }
 
-static void
+void
 g84_therm_intr(struct nvkm_therm *therm)
 {
 	struct nvkm_subdev *subdev = &therm->subdev;
@@ -233,6 +234,8 @@ g84_therm_new(struct nvkm_device *device, int index, struct nvkm_therm **ptherm)
 	if (ret)
 		return ret;
 
+	therm->sensor.intr = true;
+
 	/* init the thresholds */
 	nvkm_therm_sensor_set_threshold_state(therm, NVKM_THERM_THRS_SHUTDOWN,
 						     NVKM_THERM_THRS_LOWER);
@@ -136,13 +136,14 @@ static const struct nvkm_therm_func
 gf119_therm = {
 	.init = gf119_therm_init,
 	.fini = g84_therm_fini,
+	.intr = gt215_therm_intr,
 	.pwm_ctrl = gf119_fan_pwm_ctrl,
 	.pwm_get = gf119_fan_pwm_get,
 	.pwm_set = gf119_fan_pwm_set,
 	.pwm_clock = gf119_fan_pwm_clock,
 	.temp_get = g84_temp_get,
 	.fan_sense = gt215_therm_fan_sense,
-	.program_alarms = nvkm_therm_program_alarms_polling,
+	.program_alarms = gt215_therm_program_alarms,
 };
 
 int
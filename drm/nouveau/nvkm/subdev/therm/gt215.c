@@ -54,17 +54,37 @@ gt215_therm_init(struct nvkm_therm *therm)
 	nvkm_mask(device, 0x00e720, 0x00000002, 0x00000000);
 }
 
+/* The thresholds' interrupts work as they do on G84, but are only used
+ * when asked for (NvThermIntr), the sensor's polled otherwise.
+ */
+void
+gt215_therm_intr(struct nvkm_therm *therm)
+{
+	if (therm->sensor.intr)
+		g84_therm_intr(therm);
+}
+
+void
+gt215_therm_program_alarms(struct nvkm_therm *therm)
+{
+	if (therm->sensor.intr)
+		g84_therm_program_alarms(therm);
+	else
+		nvkm_therm_program_alarms_polling(therm);
+}
+
 static const struct nvkm_therm_func
 gt215_therm = {
 	.init = gt215_therm_init,
 	.fini = g84_therm_fini,
+	.intr = gt215_therm_intr,
 	.pwm_ctrl = nv50_fan_pwm_ctrl,
 	.pwm_get = nv50_fan_pwm_get,
 	.pwm_set = nv50_fan_pwm_set,
 	.pwm_clock = nv50_fan_pwm_clock,
 	.temp_get = g84_temp_get,
 	.fan_sense = gt215_therm_fan_sense,
-	.program_alarms = nvkm_therm_program_alarms_polling,
+	.program_alarms = gt215_therm_program_alarms,
 };
 
 int
@@ -52,6 +52,7 @@ struct nvkm_fan {
 	struct dcb_gpio_func tach;
 };
 
+void nvkm_therm_update(struct nvkm_therm *, int mode);
 int nvkm_therm_fan_mode(struct nvkm_therm *, int mode);
 int nvkm_therm_attr_get(struct nvkm_therm *, enum nvkm_therm_attr_type);
 int nvkm_therm_attr_set(struct nvkm_therm *, enum nvkm_therm_attr_type, int);
@@ -79,6 +80,7 @@ nvkm_therm_sensor_get_threshold_state(struct nvkm_therm *,
 				      enum nvkm_therm_thrs);
 void nvkm_therm_sensor_event(struct nvkm_therm *, enum nvkm_therm_thrs,
 			     enum nvkm_therm_thrs_direction);
+void nvkm_therm_sensor_poll(struct nvkm_therm *, bool fan);
 void nvkm_therm_program_alarms_polling(struct nvkm_therm *);
 
 struct nvkm_therm_func {
@@ -113,8 +115,12 @@ int  nv50_fan_pwm_clock(struct nvkm_therm *, int);
 int  g84_temp_get(struct nvkm_therm *);
 void g84_sensor_setup(struct nvkm_therm *);
 void g84_therm_fini(struct nvkm_therm *);
+void g84_therm_intr(struct nvkm_therm *);
+void g84_therm_program_alarms(struct nvkm_therm *);
 
 int gt215_therm_fan_sense(struct nvkm_therm *);
+void gt215_therm_intr(struct nvkm_therm *);
+void gt215_therm_program_alarms(struct nvkm_therm *);
 
 void gf100_clkgate_init(struct nvkm_therm *,
 			const struct nvkm_therm_clkgate_pack *);
@@ -99,6 +99,11 @@ nvkm_therm_sensor_event(struct nvkm_therm *therm, enum nvkm_therm_thrs thrs,
 		nvkm_info(subdev, "temperature (%i C) hit the '%s' threshold\n",
 			  temperature, thresholds[thrs]);
 
+	/* Whatever the event did to the fan, have fan management take over
+	 * again on the next poll, even if the temperature hasn't moved.
+	 */
+	therm->sensor.poll_update = true;
+
 	active = (dir == NVKM_THERM_THRS_RISING);
 	switch (thrs) {
 	case NVKM_THERM_THRS_FANBOOST:
@@ -136,11 +141,10 @@ nvkm_therm_sensor_event(struct nvkm_therm *therm, enum nvkm_therm_thrs thrs,
 static void
 nvkm_therm_threshold_hyst_polling(struct nvkm_therm *therm,
 				  const struct nvbios_therm_threshold *thrs,
-				  enum nvkm_therm_thrs thrs_name)
+				  enum nvkm_therm_thrs thrs_name, int temp)
 {
 	enum nvkm_therm_thrs_direction direction;
 	enum nvkm_therm_thrs_state prev_state, new_state;
-	int temp = therm->func->temp_get(therm);
 
 	prev_state = nvkm_therm_sensor_get_threshold_state(therm, thrs_name);
 
@@ -158,6 +162,49 @@ nvkm_therm_threshold_hyst_polling(struct nvkm_therm *therm,
 	nvkm_therm_sensor_event(therm, thrs_name, direction);
 }
 
+/* Poll intervals, in milliseconds, and how long the temperature's assumed
+ * to take to change by a degree when working out how close a threshold is.
+ */
+#define NVKM_THERM_POLL_MIN 1000
+#define NVKM_THERM_POLL_MAX 4000
+#define NVKM_THERM_POLL_RATE 500
+
+/* must be called with alarm_program_lock taken ! */
+static u32
+nvkm_therm_sensor_interval(struct nvkm_therm *therm, int temp)
+{
+	struct nvbios_therm_sensor *sensor = &therm->bios_sensor;
+	const struct nvbios_therm_threshold *thrs[NVKM_THERM_THRS_NR] = {
+		[NVKM_THERM_THRS_FANBOOST] = &sensor->thrs_fan_boost,
+		[NVKM_THERM_THRS_DOWNCLOCK] = &sensor->thrs_down_clock,
+		[NVKM_THERM_THRS_CRITICAL] = &sensor->thrs_critical,
+		[NVKM_THERM_THRS_SHUTDOWN] = &sensor->thrs_shutdown,
+	};
+	u32 interval = therm->sensor.poll_interval;
+	int i, margin;
+
+	/* Back off while the temperature's steady, and come back to polling
+	 * every second as soon as it moves by more than a degree.
+	 */
+	if (temp == therm->sensor.poll_temp)
+		interval = min_t(u32, interval * 2, NVKM_THERM_POLL_MAX);
+	else
+	if (abs(temp - therm->sensor.poll_temp) > 1)
+		interval = NVKM_THERM_POLL_MIN;
+
+	/* Never wait long enough to miss a threshold being crossed. */
+	for (i = 0; therm->sensor.poll_thrs && i < ARRAY_SIZE(thrs); i++) {
+		if (therm->sensor.alarm_state[i] == NVKM_THERM_THRS_LOWER)
+			margin = thrs[i]->temp - temp;
+		else
+			margin = temp - (thrs[i]->temp - thrs[i]->hysteresis);
+		interval = min_t(u32, interval,
+				 max(margin, 1) * NVKM_THERM_POLL_RATE);
+	}
+
+	return max_t(u32, interval, NVKM_THERM_POLL_MIN);
+}
+
 static void
 alarm_timer_callback(struct nvkm_alarm *alarm)
 {
@@ -165,34 +212,90 @@ alarm_timer_callback(struct nvkm_alarm *alarm)
 		container_of(alarm, struct nvkm_therm, sensor.therm_poll_alarm);
 	struct nvbios_therm_sensor *sensor = &therm->bios_sensor;
 	struct nvkm_timer *tmr = therm->subdev.device->timer;
+	int temp = therm->func->temp_get(therm);
 	unsigned long flags;
+	bool changed;
+	u32 interval;
+
+	if (temp < 0)
+		return;
 
 	spin_lock_irqsave(&therm->sensor.alarm_program_lock, flags);
 
-	nvkm_therm_threshold_hyst_polling(therm, &sensor->thrs_fan_boost,
-					  NVKM_THERM_THRS_FANBOOST);
+	if (therm->sensor.poll_thrs) {
+		nvkm_therm_threshold_hyst_polling(therm,
+						  &sensor->thrs_fan_boost,
+						  NVKM_THERM_THRS_FANBOOST,
+						  temp);
+
+		nvkm_therm_threshold_hyst_polling(therm,
+						  &sensor->thrs_down_clock,
+						  NVKM_THERM_THRS_DOWNCLOCK,
+						  temp);
+
+		nvkm_therm_threshold_hyst_polling(therm,
+						  &sensor->thrs_critical,
+						  NVKM_THERM_THRS_CRITICAL,
+						  temp);
+
+		nvkm_therm_threshold_hyst_polling(therm,
+						  &sensor->thrs_shutdown,
+						  NVKM_THERM_THRS_SHUTDOWN,
+						  temp);
+	}
+
+	interval = nvkm_therm_sensor_interval(therm, temp);
+	changed = temp != therm->sensor.poll_temp ||
+		  therm->sensor.poll_update;
+	therm->sensor.poll_update = false;
+	therm->sensor.poll_temp = temp;
+	therm->sensor.poll_interval = interval;
 
-	nvkm_therm_threshold_hyst_polling(therm,
-					  &sensor->thrs_down_clock,
-					  NVKM_THERM_THRS_DOWNCLOCK);
+	spin_unlock_irqrestore(&therm->sensor.alarm_program_lock, flags);
 
-	nvkm_therm_threshold_hyst_polling(therm, &sensor->thrs_critical,
-					  NVKM_THERM_THRS_CRITICAL);
+	/* Fan management only has anything to do if the temperature's
+	 * changed, or a threshold event's been and gone, and does it on the
+	 * same wakeup.
+	 */
+	if (therm->sensor.poll_fan && changed)
+		nvkm_therm_update(therm, -1);
 
-	nvkm_therm_threshold_hyst_polling(therm, &sensor->thrs_shutdown,
-					  NVKM_THERM_THRS_SHUTDOWN);
+	/* schedule the next poll */
+	if (therm->sensor.poll_thrs || therm->sensor.poll_fan)
+		nvkm_timer_alarm(tmr, interval * 1000 * 1000, alarm);
+}
 
-	spin_unlock_irqrestore(&therm->sensor.alarm_program_lock, flags);
+/* Starts or stops polling the temperature for fan management, on top of
+ * any polling the thresholds need.
+ *
+ * must be called with therm->lock taken !
+ */
+void
+nvkm_therm_sensor_poll(struct nvkm_therm *therm, bool fan)
+{
+	struct nvkm_timer *tmr = therm->subdev.device->timer;
+	struct nvkm_alarm *alarm = &therm->sensor.therm_poll_alarm;
+
+	if (fan == therm->sensor.poll_fan)
+		return;
+
+	therm->sensor.poll_fan = fan;
+	if (therm->sensor.poll_thrs)
+		return;
 
-	/* schedule the next poll in one second */
-	if (therm->func->temp_get(therm) >= 0)
-		nvkm_timer_alarm(tmr, 1000000000ULL, alarm);
+	if (fan) {
+		therm->sensor.poll_interval = NVKM_THERM_POLL_MIN;
+		nvkm_timer_alarm(tmr, NVKM_THERM_POLL_MIN * 1000 * 1000, alarm);
+	} else {
+		nvkm_timer_alarm(tmr, 0, alarm);
+	}
 }
 
 void
 nvkm_therm_program_alarms_polling(struct nvkm_therm *therm)
 {
 	struct nvbios_therm_sensor *sensor = &therm->bios_sensor;
+	unsigned long flags;
 
 	nvkm_debug(&therm->subdev,
 		   "programmed thresholds [ %d(%d), %d(%d), %d(%d), %d(%d) ]\n",
@@ -205,6 +308,14 @@ nvkm_therm_program_alarms_polling(struct nvkm_therm *therm)
 		   sensor->thrs_shutdown.temp,
 		   sensor->thrs_shutdown.hysteresis);
 
+	/* Start over at the shortest interval, the thresholds may be a lot
+	 * closer than they were.
+	 */
+	spin_lock_irqsave(&therm->sensor.alarm_program_lock, flags);
+	therm->sensor.poll_thrs = true;
+	therm->sensor.poll_interval = NVKM_THERM_POLL_MIN;
+	spin_unlock_irqrestore(&therm->sensor.alarm_program_lock, flags);
+
 	alarm_timer_callback(&therm->sensor.therm_poll_alarm);
 }
 
@@ -219,8 +330,11 @@ int
 nvkm_therm_sensor_fini(struct nvkm_therm *therm, bool suspend)
 {
 	struct nvkm_timer *tmr = therm->subdev.device->timer;
-	if (suspend)
+	if (suspend) {
 		nvkm_timer_alarm(tmr, 0, &therm->sensor.therm_poll_alarm);
+		therm->sensor.poll_thrs = false;
+		therm->sensor.poll_fan = false;
+	}
 	return 0;
 }
 
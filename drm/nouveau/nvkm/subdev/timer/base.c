@@ -65,34 +65,169 @@ nvkm_timer_read(struct nvkm_timer *tmr)
 	return tmr->func->read(tmr);
 }
 
+/* Alarms may go off late by up to 1/64th of their delay, capped at 1ms,
+ * so that ones due around the same time share a single interrupt.
+ */
+#define NVKM_ALARM_SLACK_SHIFT 6
+#define NVKM_ALARM_SLACK_MAX 1000000
+
+static struct nvkm_alarm **
+nvkm_alarm_slot(struct nvkm_timer *tmr, struct nvkm_alarm *alarm)
+{
+	struct nvkm_alarm *parent = alarm->parent;
+	if (!parent)
+		return &tmr->alarms;
+	return &parent->child[parent->child[1] == alarm];
+}
+
+/* Walks down to the n'th (from 1) position of the heap, in level order. */
+static struct nvkm_alarm **
+nvkm_alarm_path(struct nvkm_timer *tmr, u32 n, struct nvkm_alarm **pparent)
+{
+	struct nvkm_alarm **slot = &tmr->alarms;
+	int bit;
+
+	*pparent = NULL;
+	for (bit = fls(n) - 2; bit >= 0; bit--) {
+		*pparent = *slot;
+		slot = &(*slot)->child[(n >> bit) & 1];
+	}
+
+	return slot;
+}
+
+/* Exchanges an alarm with one of its children. */
+static void
+nvkm_alarm_swap(struct nvkm_timer *tmr, struct nvkm_alarm *parent,
+		struct nvkm_alarm *alarm)
+{
+	struct nvkm_alarm *child[2] = { alarm->child[0], alarm->child[1] };
+	const int i = parent->child[1] == alarm;
+
+	*nvkm_alarm_slot(tmr, parent) = alarm;
+	alarm->parent = parent->parent;
+	alarm->child[i] = parent;
+	alarm->child[!i] = parent->child[!i];
+	if (alarm->child[!i])
+		alarm->child[!i]->parent = alarm;
+
+	parent->parent = alarm;
+	parent->child[0] = child[0];
+	parent->child[1] = child[1];
+	if (child[0])
+		child[0]->parent = parent;
+	if (child[1])
+		child[1]->parent = parent;
+}
+
+static void
+nvkm_alarm_sift(struct nvkm_timer *tmr, struct nvkm_alarm *alarm)
+{
+	struct nvkm_alarm *child;
+
+	while (alarm->parent && alarm->parent->timestamp > alarm->timestamp)
+		nvkm_alarm_swap(tmr, alarm->parent, alarm);
+
+	while ((child = alarm->child[0])) {
+		if (alarm->child[1] &&
+		    alarm->child[1]->timestamp < child->timestamp)
+			child = alarm->child[1];
+		if (child->timestamp >= alarm->timestamp)
+			break;
+		nvkm_alarm_swap(tmr, alarm, child);
+	}
+}
+
+static void
+nvkm_alarm_insert(struct nvkm_timer *tmr, struct nvkm_alarm *alarm)
+{
+	struct nvkm_alarm *parent;
+
+	*nvkm_alarm_path(tmr, ++tmr->alarms_nr, &parent) = alarm;
+	alarm->parent = parent;
+	alarm->child[0] = NULL;
+	alarm->child[1] = NULL;
+	alarm->pending = true;
+	nvkm_alarm_sift(tmr, alarm);
+}
+
+static void
+nvkm_alarm_remove(struct nvkm_timer *tmr, struct nvkm_alarm *alarm)
+{
+	struct nvkm_alarm *last, *parent, **slot;
+
+	/* Unhook the last alarm in the heap, and put it in the removed
+	 * alarm's place.
+	 */
+	slot = nvkm_alarm_path(tmr, tmr->alarms_nr--, &parent);
+	last = *slot;
+	*slot = NULL;
+
+	if (last != alarm) {
+		*nvkm_alarm_slot(tmr, alarm) = last;
+		last->parent = alarm->parent;
+		last->child[0] = alarm->child[0];
+		last->child[1] = alarm->child[1];
+		if (last->child[0])
+			last->child[0]->parent = last;
+		if (last->child[1])
+			last->child[1]->parent = last;
+		nvkm_alarm_sift(tmr, last);
+	}
+
+	alarm->pending = false;
+}
+
+/* Returns the time to raise the next interrupt at: the earliest deadline
+ * of any pending alarm, at which every alarm that's due by then can run.
+ * Only looks at alarms due before the best time found so far, which are
+ * the ones that interrupt will handle.
+ */
+static u64
+nvkm_alarm_next(struct nvkm_alarm *alarm, u64 time)
+{
+	if (alarm && alarm->timestamp < time) {
+		time = min(time, alarm->deadline);
+		time = nvkm_alarm_next(alarm->child[0], time);
+		time = nvkm_alarm_next(alarm->child[1], time);
+	}
+	return time;
+}
+
 void
 nvkm_timer_alarm_trigger(struct nvkm_timer *tmr)
 {
 	struct nvkm_alarm *alarm, *atemp;
 	unsigned long flags;
 	LIST_HEAD(exec);
+	u64 time;
 
 	/* Process pending alarms. */
 	spin_lock_irqsave(&tmr->lock, flags);
-	list_for_each_entry_safe(alarm, atemp, &tmr->alarms, head) {
-		/* Have we hit the earliest alarm that hasn't gone off? */
-		if (alarm->timestamp > nvkm_timer_read(tmr)) {
-			/* Schedule it.  If we didn't race, we're done. */
-			tmr->func->alarm_init(tmr, alarm->timestamp);
-			if (alarm->timestamp > nvkm_timer_read(tmr))
-				break;
-		}
-
+	time = nvkm_timer_read(tmr);
+	while ((alarm = tmr->alarms)) {
 		/* Move to completed list.  We'll drop the lock before
 		 * executing the callback so it can reschedule itself.
 		 */
-		list_del_init(&alarm->head);
-		list_add(&alarm->exec, &exec);
+		if (alarm->timestamp <= time) {
+			nvkm_alarm_remove(tmr, alarm);
+			list_add_tail(&alarm->exec, &exec);
+			continue;
+		}
+
+		/* Schedule the rest.  If we didn't race, we're done. */
+		tmr->armed = nvkm_alarm_next(alarm, ~0ULL);
+		tmr->func->alarm_init(tmr, tmr->armed);
+		time = nvkm_timer_read(tmr);
+		if (tmr->armed > time)
+			break;
 	}
 
 	/* Shut down interrupt if no more pending alarms. */
-	if (list_empty(&tmr->alarms))
+	if (!tmr->alarms) {
 		tmr->func->alarm_fini(tmr);
+		tmr->armed = ~0ULL;
+	}
 	spin_unlock_irqrestore(&tmr->lock, flags);
 
 	/* Execute completed callbacks. */
@@ -105,37 +240,34 @@ nvkm_timer_alarm_trigger(struct nvkm_timer *tmr)
 void
 nvkm_timer_alarm(struct nvkm_timer *tmr, u32 nsec, struct nvkm_alarm *alarm)
 {
-	struct nvkm_alarm *list;
 	unsigned long flags;
 
-	/* Remove alarm from pending list.
+	/* Remove alarm from pending heap.
 	 *
-	 * This both protects against the corruption of the list,
+	 * This both protects against the corruption of the heap,
 	 * and implements alarm rescheduling/cancellation.
 	 */
 	spin_lock_irqsave(&tmr->lock, flags);
-	list_del_init(&alarm->head);
+	if (alarm->pending)
+		nvkm_alarm_remove(tmr, alarm);
 
 	if (nsec) {
-		/* Insert into pending list, ordered earliest to latest. */
 		alarm->timestamp = nvkm_timer_read(tmr) + nsec;
-		list_for_each_entry(list, &tmr->alarms, head) {
-			if (list->timestamp > alarm->timestamp)
-				break;
-		}
-
-		list_add_tail(&alarm->head, &list->head);
+		alarm->deadline = alarm->timestamp +
+				  min_t(u32, nsec >> NVKM_ALARM_SLACK_SHIFT,
+					NVKM_ALARM_SLACK_MAX);
+		nvkm_alarm_insert(tmr, alarm);
 
-		/* Update HW if this is now the earliest alarm. */
-		list = list_first_entry(&tmr->alarms, typeof(*list), head);
-		if (list == alarm) {
-			tmr->func->alarm_init(tmr, alarm->timestamp);
+		/* Update HW if the interrupt it's set for is too late. */
+		if (alarm->deadline < tmr->armed) {
+			tmr->armed = alarm->deadline;
+			tmr->func->alarm_init(tmr, tmr->armed);
 			/* This shouldn't happen if callers aren't stupid.
 			 *
 			 * Worst case scenario is that it'll take roughly
 			 * 4 seconds for the next alarm to trigger.
 			 */
-			WARN_ON(alarm->timestamp <= nvkm_timer_read(tmr));
+			WARN_ON(tmr->armed <= nvkm_timer_read(tmr));
 		}
 	}
 	spin_unlock_irqrestore(&tmr->lock, flags);
@@ -153,6 +285,7 @@ nvkm_timer_fini(struct nvkm_subdev *subdev, bool suspend)
 {
 	struct nvkm_timer *tmr = nvkm_timer(subdev);
 	tmr->func->alarm_fini(tmr);
+	tmr->armed = ~0ULL;
 	return 0;
 }
 
@@ -192,7 +325,7 @@ nvkm_timer_new_(const struct nvkm_timer_func *func, struct nvkm_device *device,
 
 	nvkm_subdev_ctor(&nvkm_timer, device, index, &tmr->subdev);
 	tmr->func = func;
-	INIT_LIST_HEAD(&tmr->alarms);
+	tmr->armed = ~0ULL;
 	spin_lock_init(&tmr->lock);
 	return 0;
 }
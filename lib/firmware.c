@@ -23,39 +23,160 @@
  */
 #include <nvif/os.h>
 
-static int
-request_firmware_(const struct firmware **pfw, const char *prefix,
-		  const char *name, struct device *dev)
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Images are kept mapped, and shared between all devices in the process,
+ * for as long as the process lives (or until nvos_firmware_flush()), so
+ * repeated loads on init/resume don't touch the filesystem again.
+ */
+struct nvos_firmware {
+	struct rb_node node;
+	struct firmware fw;
+	int refs;
+	bool stale;
+	char path[];
+};
+
+#define NVOS_FIRMWARE_PATH 512
+
+static DEFINE_MUTEX(nvos_firmware_mutex);
+static struct rb_root nvos_firmware_tree = RB_ROOT;
+static char nvos_firmware_root[NVOS_FIRMWARE_PATH] = "/lib/firmware/";
+static struct {
+	u64 hits;
+	u64 misses;
+	u64 load_ns;
+} nvos_firmware_count;
+
+static struct nvos_firmware *
+nvos_firmware_find(const char *path)
+{
+	struct rb_node *node = nvos_firmware_tree.rb_node;
+	while (node) {
+		struct nvos_firmware *fw =
+			rb_entry(node, typeof(*fw), node);
+		int cmp = strcmp(path, fw->path);
+		if (cmp < 0)
+			node = node->rb_left;
+		else
+		if (cmp > 0)
+			node = node->rb_right;
+		else
+			return fw;
+	}
+	return NULL;
+}
+
+static void
+nvos_firmware_insert(struct nvos_firmware *fw)
+{
+	struct rb_node **ptr = &nvos_firmware_tree.rb_node;
+	struct rb_node *parent = NULL;
+
+	while (*ptr) {
+		struct nvos_firmware *this =
+			rb_entry(*ptr, typeof(*this), node);
+		parent = *ptr;
+		if (strcmp(fw->path, this->path) < 0)
+			ptr = &parent->rb_left;
+		else
+			ptr = &parent->rb_right;
+	}
+
+	rb_link_node(&fw->node, parent, ptr);
+	rb_insert_color(&fw->node, &nvos_firmware_tree);
+}
+
+static void
+nvos_firmware_free(struct nvos_firmware *fw)
+{
+	if (fw->fw.size)
+		munmap((void *)fw->fw.data, fw->fw.size);
+	free(fw);
+}
+
+/* Drop an image from the tree, it goes away once the last user's done. */
+static void
+nvos_firmware_drop(struct nvos_firmware *fw)
 {
-	struct firmware *fw = malloc(sizeof(*fw));
-	char *path;
+	rb_erase(&fw->node, &nvos_firmware_tree);
+	fw->stale = true;
+	if (!fw->refs)
+		nvos_firmware_free(fw);
+}
+
+static struct nvos_firmware *
+nvos_firmware_load(const char *path)
+{
+	struct nvos_firmware *fw;
+	struct stat st;
+	s64 time = ktime_to_ns(ktime_get());
+	void *map = NULL;
 	int fd;
 
-	if (!(path = malloc(strlen(prefix) + strlen(name) + 1))) {
-		free(fw);
-		return -ENOMEM;
+	if ((fd = open(path, O_RDONLY)) < 0)
+		return NULL;
+
+	if (fstat(fd, &st) || !S_ISREG(st.st_mode)) {
+		close(fd);
+		return NULL;
 	}
-	sprintf(path, "%s%s", prefix, name);
-
-	fd = open(path, O_RDONLY);
-	free(path);
-	if (fd >= 0) {
-		off_t len = lseek(fd, 0, SEEK_END);
-		fw->data = malloc(len);
-		fw->size = pread(fd, (void *)fw->data, len, 0);
-		*pfw = fw;
-		return 0;
+
+	if (st.st_size) {
+		map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (map == MAP_FAILED) {
+			close(fd);
+			return NULL;
+		}
 	}
+	close(fd);
 
-	free(fw);
-	return -EINVAL;
+	if (!(fw = calloc(1, sizeof(*fw) + strlen(path) + 1))) {
+		if (map)
+			munmap(map, st.st_size);
+		return NULL;
+	}
+
+	strcpy(fw->path, path);
+	fw->fw.data = map ? map : (const u8 *)"";
+	fw->fw.size = st.st_size;
+	nvos_firmware_insert(fw);
+
+	nvos_firmware_count.misses++;
+	nvos_firmware_count.load_ns += ktime_to_ns(ktime_get()) - time;
+	return fw;
+}
+
+static int
+request_firmware_(const struct firmware **pfw, const char *prefix,
+		  const char *name, struct device *dev)
+{
+	struct nvos_firmware *fw;
+	char path[NVOS_FIRMWARE_PATH];
+
+	if (snprintf(path, sizeof(path), "%s%s", prefix, name) >= sizeof(path))
+		return -ENAMETOOLONG;
+
+	mutex_lock(&nvos_firmware_mutex);
+	if ((fw = nvos_firmware_find(path)))
+		nvos_firmware_count.hits++;
+	else
+		fw = nvos_firmware_load(path);
+	if (fw) {
+		fw->refs++;
+		*pfw = &fw->fw;
+	}
+	mutex_unlock(&nvos_firmware_mutex);
+	return fw ? 0 : -EINVAL;
 }
 
 int
 request_firmware(const struct firmware **pfw, const char *name,
 		 struct device *dev)
 {
-	if (!request_firmware_(pfw, "/lib/firmware/", name, dev))
+	if (!request_firmware_(pfw, nvos_firmware_root, name, dev))
 		return 0;
 	if (!request_firmware_(pfw, "", name, dev))
 		return 0;
@@ -66,7 +187,147 @@ void
 release_firmware(const struct firmware *fw)
 {
 	if (fw) {
-		free((void *)fw->data);
-		free((void *)fw);
+		struct nvos_firmware *cache = container_of(fw, typeof(*cache), fw);
+		mutex_lock(&nvos_firmware_mutex);
+		if (!--cache->refs && cache->stale)
+			nvos_firmware_free(cache);
+		mutex_unlock(&nvos_firmware_mutex);
 	}
 }
+
+static int
+nvos_firmware_preload_dir(char *path, size_t len)
+{
+	struct dirent *ent;
+	DIR *dir;
+	int nr = 0;
+
+	if (!(dir = opendir(path)))
+		return -errno;
+
+	while ((ent = readdir(dir))) {
+		if (ent->d_name[0] == '.')
+			continue;
+		if (snprintf(path + len, NVOS_FIRMWARE_PATH - len, "/%s",
+			     ent->d_name) >= NVOS_FIRMWARE_PATH - len)
+			continue;
+
+		if (ent->d_type == DT_DIR) {
+			int ret = nvos_firmware_preload_dir(path,
+							    strlen(path));
+			if (ret > 0)
+				nr += ret;
+		} else
+		if (!nvos_firmware_find(path) && nvos_firmware_load(path)) {
+			nr++;
+		}
+	}
+
+	path[len] = '\0';
+	closedir(dir);
+	return nr;
+}
+
+/* Map every image under "dir" (relative to the firmware root, for example
+ * "nvidia/gp102") ahead of time.  Returns the number of images loaded.
+ */
+int
+nvos_firmware_preload(const char *dir)
+{
+	char path[NVOS_FIRMWARE_PATH];
+	int ret;
+
+	if (snprintf(path, sizeof(path), "%s%s", nvos_firmware_root, dir) >=
+	    sizeof(path))
+		return -ENAMETOOLONG;
+
+	mutex_lock(&nvos_firmware_mutex);
+	ret = nvos_firmware_preload_dir(path, strlen(path));
+	mutex_unlock(&nvos_firmware_mutex);
+	return ret;
+}
+
+/* Unmap every image that nobody's holding a reference to. */
+void
+nvos_firmware_flush(void)
+{
+	struct rb_node *node, *next;
+
+	mutex_lock(&nvos_firmware_mutex);
+	for (node = rb_first(&nvos_firmware_tree); node; node = next) {
+		struct nvos_firmware *fw = rb_entry(node, typeof(*fw), node);
+		next = rb_next(node);
+		if (!fw->refs)
+			nvos_firmware_drop(fw);
+	}
+	mutex_unlock(&nvos_firmware_mutex);
+}
+
+void
+nvos_firmware_path(const char *root)
+{
+	mutex_lock(&nvos_firmware_mutex);
+	snprintf(nvos_firmware_root, sizeof(nvos_firmware_root), "%s", root);
+	mutex_unlock(&nvos_firmware_mutex);
+}
+
+void
+nvos_firmware_stats(struct nvos_firmware_stats *stats)
+{
+	struct rb_node *node;
+
+	memset(stats, 0x00, sizeof(*stats));
+	mutex_lock(&nvos_firmware_mutex);
+	for (node = rb_first(&nvos_firmware_tree); node; node = rb_next(node)) {
+		struct nvos_firmware *fw = rb_entry(node, typeof(*fw), node);
+		stats->images++;
+		stats->users += fw->refs;
+		stats->bytes += fw->fw.size;
+	}
+	stats->hits = nvos_firmware_count.hits;
+	stats->misses = nvos_firmware_count.misses;
+	stats->load_ns = nvos_firmware_count.load_ns;
+	mutex_unlock(&nvos_firmware_mutex);
+}
+
+int
+nvos_firmware_store(const char *name, const void *data, size_t size)
+{
+	struct nvos_firmware *fw;
+	char path[NVOS_FIRMWARE_PATH];
+	char *temp;
+	int fd, ret = 0;
+
+	if (!(temp = malloc(strlen(name) + 5)))
+		return -ENOMEM;
+	sprintf(temp, "%s.tmp", name);
+
+	/* write to a temporary file first so that a concurrent reader never
+	 * sees a partial image
+	 */
+	fd = open(temp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		free(temp);
+		return -errno;
+	}
+
+	if (write(fd, data, size) != size)
+		ret = -EIO;
+	close(fd);
+
+	if (ret == 0 && rename(temp, name))
+		ret = -errno;
+	if (ret)
+		unlink(temp);
+	free(temp);
+
+	/* don't keep serving the image that was just replaced */
+	mutex_lock(&nvos_firmware_mutex);
+	if ((fw = nvos_firmware_find(name)))
+		nvos_firmware_drop(fw);
+	snprintf(path, sizeof(path), "%s%s", nvos_firmware_root, name);
+	if ((fw = nvos_firmware_find(path)))
+		nvos_firmware_drop(fw);
+	mutex_unlock(&nvos_firmware_mutex);
+	return ret;
+}
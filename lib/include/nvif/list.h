@@ -237,6 +237,19 @@ list_empty(struct list_head *head)
     return head->next == head;
 }
 
+/**
+ * Check if the list element is the last one in the list.
+ *
+ * @param entry The list element.
+ * @param head The list.
+ * @return True if entry is the last element of the list, false otherwise.
+ */
+static inline bool
+list_is_last(const struct list_head *entry, const struct list_head *head)
+{
+    return entry->next == head;
+}
+
 /**
  * Returns a pointer to the container of this list element.
  *
@@ -348,6 +348,17 @@ find_first_zero_bit(volatile unsigned long *addr, int bits)
 	return bit;
 }
 
+static inline long
+find_next_zero_bit(const volatile unsigned long *addr, int bits, int bit)
+{
+	while (bit < bits) {
+		if (!test_bit(bit, addr))
+			break;
+		bit++;
+	}
+	return bit;
+}
+
 static inline void
 bitmap_fill(unsigned long *addr, unsigned int bits)
 {
@@ -363,6 +374,13 @@ bitmap_clear(unsigned long *addr, unsigned int pos, unsigned int bits)
 		__clear_bit(pos++, addr);
 }
 
+static inline void
+bitmap_set(unsigned long *addr, unsigned int pos, unsigned int bits)
+{
+	while (bits--)
+		__set_bit(pos++, addr);
+}
+
 #define for_each_set_bit(bit, addr, size)                                      \
 	for ((bit) = find_next_bit((addr), (size), 0); (bit) < (size);         \
 	     (bit) = find_next_bit((addr), (size), (bit) + 1))
@@ -656,6 +674,9 @@ nvos_backtrace(void)
 	_ret;                                                                  \
 })
 
+#define READ_ONCE(x) (*(const volatile typeof(x) *)&(x))
+#define WRITE_ONCE(x,v) (*(volatile typeof(x) *)&(x) = (v))
+
 #define WARN_ON(c) ({                                                          \
 	int _ret = !!(c);                                                      \
 	if (_ret)                                                              \
@@ -730,6 +751,23 @@ typedef struct rwlock_t {
 #define read_unlock(a) pthread_rwlock_unlock(&(a)->lock)
 #define write_lock_irq(a) pthread_rwlock_wrlock(&(a)->lock)
 #define write_unlock_irq(a) pthread_rwlock_unlock(&(a)->lock)
+#define read_lock_irqsave(a,b) do { (b) = 1; read_lock((a)); } while (0)
+#define read_unlock_irqrestore(a,b) do { (void)(b); read_unlock((a)); } while (0)
+#define write_lock_irqsave(a,b) do { (b) = 1; write_lock_irq((a)); } while (0)
+#define write_unlock_irqrestore(a,b) do { (void)(b); write_unlock_irq((a)); } while (0)
+
+/******************************************************************************
+ * rw semaphores
+ *****************************************************************************/
+struct rw_semaphore {
+	pthread_rwlock_t lock;
+};
+
+#define init_rwsem(a) pthread_rwlock_init(&(a)->lock, NULL)
+#define down_read(a) pthread_rwlock_rdlock(&(a)->lock)
+#define up_read(a) pthread_rwlock_unlock(&(a)->lock)
+#define down_write(a) pthread_rwlock_wrlock(&(a)->lock)
+#define up_write(a) pthread_rwlock_unlock(&(a)->lock)
 
 /******************************************************************************
  * mutexes
@@ -754,6 +792,8 @@ struct lock_class_key {
 	pthread_mutex_init(&(a)->mutex, NULL);                                 \
 } while(0)
 
+#define lockdep_assert_held(a) (void)(a)
+
 /******************************************************************************
  * lists
  *****************************************************************************/
@@ -817,6 +857,14 @@ void  nvos_iounmap(void __iomem *ptr);
 #define iowrite16(b,a) *((volatile u16 *)(a)) = (b)
 #define iowrite32(b,a) *((volatile u32 *)(a)) = (b)
 
+static inline void
+iowrite32_rep(void __iomem *addr, const void *data, unsigned long count)
+{
+	const u32 *src = data;
+	while (count--)
+		iowrite32(*src++, addr);
+}
+
 #define memset_io memset
 #define memcpy_fromio memcpy
 #define memcpy_toio memcpy
@@ -1348,10 +1396,34 @@ struct firmware {
 
 int request_firmware(const struct firmware **, const char *, struct device *);
 void release_firmware(const struct firmware *);
+int nvos_firmware_store(const char *, const void *, size_t);
+
+struct nvos_firmware_stats {
+	u32 images;
+	u32 users;
+	u64 bytes;
+	u64 hits;
+	u64 misses;
+	u64 load_ns;
+};
+
+void nvos_firmware_path(const char *root);
+int  nvos_firmware_preload(const char *dir);
+void nvos_firmware_flush(void);
+void nvos_firmware_stats(struct nvos_firmware_stats *);
 #define firmware_request_nowarn request_firmware
 
 #define MODULE_FIRMWARE(a)
 
+/******************************************************************************
+ * cpus
+ *****************************************************************************/
+int nvos_cpu(void);
+int nvos_cpus(void);
+
+#define raw_smp_processor_id() nvos_cpu()
+#define nr_cpu_ids nvos_cpus()
+
 /******************************************************************************
  * workqueues
  *****************************************************************************/
@@ -1446,18 +1518,27 @@ reinit_completion(struct completion *c)
 	init_completion(c);
 }
 
+/* Waiters poll, rather than sleep until woken, and time never runs out. */
 static inline unsigned long
 wait_for_completion_timeout(struct completion *c, unsigned long timeout)
 {
-	while (!c->done)
+	while (!READ_ONCE(c->done))
 		sched_yield();
 	return 1;
 }
 
+static inline void
+wait_for_completion(struct completion *c)
+{
+	while (!READ_ONCE(c->done))
+		sched_yield();
+}
+
 static inline void
 complete(struct completion *c)
 {
-	c->done = 1;
+	__sync_synchronize();
+	WRITE_ONCE(c->done, 1);
 }
 
 static inline void
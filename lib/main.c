@@ -47,96 +47,240 @@ u64  os_device_subdev = ~0ULL;
  * horrific stuff to implement linux's ioremap interface on top of pciaccess
  *****************************************************************************/
 static DEFINE_MUTEX(os_ioremap_mutex);
-static struct os_ioremap_info {
-       struct pci_device *pdev;
-       int refs;
-       u64 addr;
-       u64 size;
-       void *ptr;
-} os_ioremap[32];
+static struct rb_root os_iomem_tree = RB_ROOT;
 
-void __iomem *
-nvos_ioremap_bar(struct pci_device *pdev, int bar, u64 addr)
+/* Mappings are made in 2MiB-aligned sections where the resource allows it,
+ * so that small, neighbouring, requests share a mapping.  A request that
+ * overlaps existing mappings without fitting in one gets a new mapping of
+ * their union, which replaces them for lookups, and those are unmapped as
+ * their remaining users go away.
+ */
+#define OS_IOREMAP_ALIGN 0x200000ULL
+
+static struct os_ioremap_info {
+	struct rb_node addr; /* current mappings, by bus address */
+	struct rb_node ptr;  /* all mappings, by cpu address */
+	struct os_iomem *iomem;
+	bool current;
+	int refs;
+	u64 base;
+	u64 size;
+	void *map;
+} *os_ioremap_last;
+static struct rb_root os_ioremap_addr = RB_ROOT;
+static struct rb_root os_ioremap_ptr = RB_ROOT;
+static struct os_ioremap_stats os_ioremap_count;
+
+/* Find the entry with the greatest key <= "key". */
+#define OS_IOREMAP_FIND(root,type,member,field,key) ({                        \
+	struct rb_node *_node = (root)->rb_node;                               \
+	type *_best = NULL;                                                    \
+	while (_node) {                                                        \
+		type *_this = rb_entry(_node, type, member);                   \
+		if ((key) < _this->field) {                                    \
+			_node = _node->rb_left;                                \
+		} else {                                                       \
+			_best = _this;                                         \
+			_node = _node->rb_right;                               \
+		}                                                              \
+	}                                                                      \
+	_best;                                                                 \
+})
+
+#define OS_IOREMAP_INSERT(root,type,member,field,this) do {                    \
+	struct rb_node **_ptr = &(root)->rb_node, *_parent = NULL;             \
+	while (*_ptr) {                                                        \
+		type *_that = rb_entry(*_ptr, type, member);                   \
+		_parent = *_ptr;                                               \
+		if ((this)->field < _that->field)                              \
+			_ptr = &_parent->rb_left;                              \
+		else                                                           \
+			_ptr = &_parent->rb_right;                             \
+	}                                                                      \
+	rb_link_node(&(this)->member, _parent, _ptr);                          \
+	rb_insert_color(&(this)->member, (root));                              \
+} while (0)
+
+int
+os_iomem_add(struct os_iomem *iomem)
 {
-	u64 base = pdev->regions[bar].base_addr;
-	u64 size = pdev->regions[bar].size;
-	u64 offset = addr - base;
-	void __iomem *ptr = NULL;
-	int i;
+	struct os_iomem *prev;
 
 	mutex_lock(&os_ioremap_mutex);
-	for (i = 0; !ptr && i < ARRAY_SIZE(os_ioremap); i++) {
-		if (os_ioremap[i].refs && os_ioremap[i].addr == base) {
-			os_ioremap[i].refs++;
-			ptr = os_ioremap[i].ptr + offset;
-		}
+	prev = OS_IOREMAP_FIND(&os_iomem_tree, struct os_iomem, node, addr,
+			       iomem->addr + iomem->size - 1);
+	if (prev && prev->addr + prev->size > iomem->addr) {
+		mutex_unlock(&os_ioremap_mutex);
+		return -EEXIST;
 	}
 
-	for (i = 0; !ptr && i < ARRAY_SIZE(os_ioremap); i++) {
-		if (!os_ioremap[i].refs &&
-		    !pci_device_map_range(pdev, base, size,
-					  PCI_DEV_MAP_FLAG_WRITABLE,
-					  &os_ioremap[i].ptr)) {
-			os_ioremap[i].pdev = pdev;
-			os_ioremap[i].refs = 1;
-			os_ioremap[i].addr = base;
-			os_ioremap[i].size = size;
-			ptr = os_ioremap[i].ptr + offset;
-		}
-	}
+	OS_IOREMAP_INSERT(&os_iomem_tree, struct os_iomem, node, addr, iomem);
 	mutex_unlock(&os_ioremap_mutex);
+	return 0;
+}
 
-	return ptr;
+void
+os_iomem_del(struct os_iomem *iomem)
+{
+	mutex_lock(&os_ioremap_mutex);
+	rb_erase(&iomem->node, &os_iomem_tree);
+	mutex_unlock(&os_ioremap_mutex);
+}
+
+static void
+os_ioremap_retire(struct os_ioremap_info *info)
+{
+	if (os_ioremap_last == info)
+		os_ioremap_last = NULL;
+
+	if (info->current) {
+		rb_erase(&info->addr, &os_ioremap_addr);
+		info->current = false;
+	}
+
+	if (!info->refs) {
+		rb_erase(&info->ptr, &os_ioremap_ptr);
+		info->iomem->unmap(info->iomem, info->map, info->size);
+		os_ioremap_count.mappings--;
+		free(info);
+	}
+}
+
+static struct os_ioremap_info *
+os_ioremap_new(struct os_iomem *iomem, u64 addr, u64 size)
+{
+	struct os_ioremap_info *info, *prev;
+	u64 base = max(ALIGN_DOWN(addr, OS_IOREMAP_ALIGN), iomem->addr);
+	u64 end  = min(ALIGN(addr + size, OS_IOREMAP_ALIGN),
+		       iomem->addr + iomem->size);
+	u64 next = end;
+
+	/* Grow to cover anything already mapped that overlaps. */
+	while ((prev = OS_IOREMAP_FIND(&os_ioremap_addr, typeof(*prev), addr,
+				       base, next - 1)) &&
+	       prev->base + prev->size > base) {
+		base = min(base, prev->base);
+		end  = max(end, prev->base + prev->size);
+		if (!(next = prev->base))
+			break;
+	}
+
+	if (!(info = calloc(1, sizeof(*info))))
+		return NULL;
+
+	if (iomem->map(iomem, base, end - base, &info->map)) {
+		free(info);
+		return NULL;
+	}
+
+	while ((prev = OS_IOREMAP_FIND(&os_ioremap_addr, typeof(*prev), addr,
+				       base, end - 1)) && prev->base >= base)
+		os_ioremap_retire(prev);
+
+	info->iomem = iomem;
+	info->current = true;
+	info->base = base;
+	info->size = end - base;
+	OS_IOREMAP_INSERT(&os_ioremap_addr, typeof(*info), addr, base, info);
+	OS_IOREMAP_INSERT(&os_ioremap_ptr, typeof(*info), ptr, map, info);
+	os_ioremap_count.mappings++;
+	os_ioremap_count.maps++;
+	return info;
 }
 
 void __iomem *
 nvos_ioremap(u64 addr, u64 size)
 {
-	struct os_device *odev;
-	int i;
+	struct os_ioremap_info *info;
+	struct os_iomem *iomem;
+	void __iomem *ptr = NULL;
+
+	if (!size)
+		return NULL;
+
+	mutex_lock(&os_ioremap_mutex);
+	os_ioremap_count.ioremaps++;
+
+	/* Drivers tend to map the same range repeatedly. */
+	info = os_ioremap_last;
+	if (!info || addr < info->base ||
+	    addr + size > info->base + info->size) {
+		info = OS_IOREMAP_FIND(&os_ioremap_addr, typeof(*info), addr,
+				       base, addr);
+	}
 
-	list_for_each_entry(odev, &os_device_list, head) {
-		struct pci_device *pdev = odev->pdev.pdev;
-		for (i = 0; i < ARRAY_SIZE(pdev->regions); i++) {
-			if (addr        >= pdev->regions[i].base_addr &&
-			    addr + size <= pdev->regions[i].base_addr +
-					   pdev->regions[i].size) {
-				return nvos_ioremap_bar(pdev, i, addr);
-			}
-		}
+	if (info && addr + size <= info->base + info->size) {
+		os_ioremap_count.hits++;
+	} else {
+		iomem = OS_IOREMAP_FIND(&os_iomem_tree, struct os_iomem, node,
+					addr, addr);
+		if (iomem && addr + size <= iomem->addr + iomem->size)
+			info = os_ioremap_new(iomem, addr, size);
+		else
+			info = NULL;
 	}
 
-	return NULL;
+	if (info) {
+		info->refs++;
+		os_ioremap_last = info;
+		ptr = info->map + (addr - info->base);
+	}
+	mutex_unlock(&os_ioremap_mutex);
+	return ptr;
 }
 
 void
 nvos_iounmap(void __iomem *ptr)
 {
-	int i;
+	struct os_ioremap_info *info;
+
+	if (!ptr)
+		return;
 
 	mutex_lock(&os_ioremap_mutex);
-	for (i = 0; ptr && i < ARRAY_SIZE(os_ioremap); i++) {
-		if (os_ioremap[i].refs &&
-		    ptr >= os_ioremap[i].ptr &&
-		    ptr <  os_ioremap[i].ptr + os_ioremap[i].size) {
-			if (!--os_ioremap[i].refs) {
-				pci_device_unmap_range(os_ioremap[i].pdev,
-						       os_ioremap[i].ptr,
-						       os_ioremap[i].size);
-			}
-			break;
-		}
+	info = OS_IOREMAP_FIND(&os_ioremap_ptr, typeof(*info), ptr, map,
+			       (void *)ptr);
+	if (!WARN_ON(!info || ptr >= info->map + info->size)) {
+		if (!--info->refs)
+			os_ioremap_retire(info);
 	}
 	mutex_unlock(&os_ioremap_mutex);
 }
 
+void
+os_ioremap_stats(struct os_ioremap_stats *stats)
+{
+	mutex_lock(&os_ioremap_mutex);
+	*stats = os_ioremap_count;
+	mutex_unlock(&os_ioremap_mutex);
+}
+
+static int
+os_iomem_pci_map(struct os_iomem *iomem, u64 addr, u64 size, void **ptr)
+{
+	return pci_device_map_range(iomem->priv, addr, size,
+				    PCI_DEV_MAP_FLAG_WRITABLE, ptr);
+}
+
+static void
+os_iomem_pci_unmap(struct os_iomem *iomem, void *ptr, u64 size)
+{
+	pci_device_unmap_range(iomem->priv, ptr, size);
+}
+
 /******************************************************************************
  * client interfaces
  *****************************************************************************/
 static void
 os_fini_device(struct os_device *odev)
 {
+	int i;
+
 	nvkm_device_del(&odev->device);
+	for (i = 0; i < ARRAY_SIZE(odev->bar); i++) {
+		if (odev->bar[i].size)
+			os_iomem_del(&odev->bar[i]);
+	}
 	list_del(&odev->head);
 	kfree(odev);
 }
@@ -146,7 +290,7 @@ os_init_device(struct pci_device *pdev, const char *cfgopt, const char *dbg)
 {
 	struct os_device *odev;
 	char cfg[512];
-	int ret;
+	int ret, i;
 
 	ret = pci_device_probe(pdev);
 	if (ret) {
@@ -172,6 +316,20 @@ os_init_device(struct pci_device *pdev, const char *cfgopt, const char *dbg)
 	odev->pdev.devfn = PCI_DEVFN(pdev->dev, pdev->func);
 	list_add_tail(&odev->head, &os_device_list);
 
+	for (i = 0; i < ARRAY_SIZE(odev->bar); i++) {
+		struct os_iomem *bar = &odev->bar[i];
+		if (!pdev->regions[i].size)
+			continue;
+
+		bar->addr = pdev->regions[i].base_addr;
+		bar->size = pdev->regions[i].size;
+		bar->map = os_iomem_pci_map;
+		bar->unmap = os_iomem_pci_unmap;
+		bar->priv = pdev;
+		if (os_iomem_add(bar))
+			bar->size = 0;
+	}
+
 	snprintf(cfg, sizeof(cfg), "%s,NvBar2Halve=1", cfgopt ? cfgopt : "");
 
 	ret = nvkm_device_pci_new(&odev->pdev, cfg, dbg, os_device_detect,
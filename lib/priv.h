@@ -6,12 +6,35 @@
 #include <pthread.h>
 #include <unistd.h>
 
+/* A range of bus addresses that ioremap() may map. */
+struct os_iomem {
+	struct rb_node node;
+	u64 addr;
+	u64 size;
+	int  (*map)(struct os_iomem *, u64 addr, u64 size, void **);
+	void (*unmap)(struct os_iomem *, void *, u64 size);
+	void *priv;
+};
+
+int  os_iomem_add(struct os_iomem *);
+void os_iomem_del(struct os_iomem *);
+
+struct os_ioremap_stats {
+	u64 ioremaps;
+	u64 hits;     /* served by an existing mapping */
+	u64 maps;     /* new mappings created */
+	u32 mappings; /* currently mapped */
+};
+
+void os_ioremap_stats(struct os_ioremap_stats *);
+
 struct os_device {
 	struct nvkm_device *device;
 	struct list_head head;
 	char *cfg;
 	char *dbg;
 	struct pci_dev pdev;
+	struct os_iomem bar[6];
 };
 
 extern bool os_device_detect;
@@ -21,6 +21,9 @@
  *
  * Authors: Ben Skeggs <bskeggs@redhat.com>
  */
+#define _GNU_SOURCE
+#include <sched.h>
+
 #include "priv.h"
 
 struct nvos_work {
@@ -105,3 +108,19 @@ fail_mutex:
 	free(work);
 	return false;
 }
+
+int
+nvos_cpu(void)
+{
+	int cpu = sched_getcpu();
+	return cpu >= 0 ? cpu : 0;
+}
+
+int
+nvos_cpus(void)
+{
+	static int cpus;
+	if (!cpus)
+		cpus = max_t(long, sysconf(_SC_NPROCESSORS_CONF), 1);
+	return cpus;
+}